@@ -0,0 +1,173 @@
+"""
+@file invaders_env.py
+@brief Тонкая обертка над C API libinvaders_env (см. src/invadersenv.h) для обучения агентов на Python.
+
+Наблюдения, награды и флаги окончания пишутся библиотекой прямо в массивы NumPy, принадлежащие
+объекту; на шаге ничего не копируется и не преобразуется. Вызовы через ctypes.CDLL отпускают GIL
+на время работы библиотеки, поэтому несколько наборов можно шагать из разных потоков.
+"""
+
+import ctypes
+import os
+
+import numpy as np
+
+API_VERSION = 1
+
+OBS_FEATURES = 0
+OBS_PIXELS = 1
+
+ACTION_NOOP = 0
+ACTION_LEFT = 1
+ACTION_RIGHT = 2
+ACTION_FIRE = 4
+
+
+def _load_library(path=None):
+    """
+    @brief Загружает библиотеку и объявляет сигнатуры функций.
+
+    @param path Путь к libinvaders_env; по умолчанию ищется рядом с каталогом сборки.
+    """
+    if path is None:
+        names = {"nt": "invaders_env.dll", "posix": "libinvaders_env.so"}
+        root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+        path = os.path.join(root, "build", names.get(os.name, "libinvaders_env.so"))
+    lib = ctypes.CDLL(path)
+
+    env_p = ctypes.c_void_p
+    lib.invaders_env_api_version.restype = ctypes.c_int
+    lib.invaders_env_api_version.argtypes = []
+    lib.invaders_env_create.restype = env_p
+    lib.invaders_env_create.argtypes = [ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int,
+                                        ctypes.c_int, ctypes.c_uint32]
+    lib.invaders_env_destroy.restype = None
+    lib.invaders_env_destroy.argtypes = [env_p]
+    lib.invaders_env_num_envs.restype = ctypes.c_int
+    lib.invaders_env_num_envs.argtypes = [env_p]
+    lib.invaders_env_observation_size.restype = ctypes.c_int
+    lib.invaders_env_observation_size.argtypes = [env_p]
+    lib.invaders_env_reset.restype = None
+    lib.invaders_env_reset.argtypes = [env_p, ctypes.c_int, ctypes.c_uint32, ctypes.c_void_p]
+    lib.invaders_env_reset_all.restype = None
+    lib.invaders_env_reset_all.argtypes = [env_p, ctypes.c_void_p]
+    lib.invaders_env_step.restype = None
+    lib.invaders_env_step.argtypes = [env_p, ctypes.c_int, ctypes.c_int32, ctypes.c_void_p, ctypes.c_void_p,
+                                      ctypes.c_void_p]
+    lib.invaders_env_step_all.restype = None
+    lib.invaders_env_step_all.argtypes = [env_p, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p,
+                                          ctypes.c_void_p]
+
+    if lib.invaders_env_api_version() != API_VERSION:
+        raise RuntimeError("invaders_env API version mismatch")
+    return lib, os.path.dirname(os.path.abspath(path))
+
+
+def _address(array):
+    """
+    @brief Возвращает адрес данных массива, проверив, что его можно передать в библиотеку без копии.
+    """
+    if not array.flags.c_contiguous or not array.flags.writeable:
+        raise ValueError("buffer must be C-contiguous and writeable")
+    return array.ctypes.data
+
+
+class VecEnv:
+    """
+    @brief Набор игр без окна с пакетным шагом.
+
+    Массивы obs, rewards и dones переиспользуются между вызовами: step() и reset() возвращают
+    их же, обновленные на месте. Если нужна история, копируйте их на стороне вызывающего кода.
+    """
+
+    def __init__(self, num_envs, observation_type=OBS_FEATURES, width=84, height=84, stack=4,
+                 auto_reset=True, seed=1, library=None):
+        """
+        @brief Создает набор игр.
+
+        @param num_envs Количество игр.
+        @param observation_type OBS_FEATURES или OBS_PIXELS.
+        @param width Ширина кадра для OBS_PIXELS.
+        @param height Высота кадра для OBS_PIXELS.
+        @param stack Количество кадров в стопке для OBS_PIXELS.
+        @param auto_reset Закончившиеся игры начинаются заново внутри шага.
+        @param seed Начальное значение генераторов; игра i получает seed + i.
+        @param library Путь к libinvaders_env.
+        """
+        self._lib, directory = _load_library(library)
+
+        # Ресурсы игры загружаются по путям вида "../Graphics" относительно каталога сборки
+        cwd = os.getcwd()
+        os.chdir(directory)
+        try:
+            self._env = self._lib.invaders_env_create(num_envs, observation_type, width, height, stack,
+                                                      int(auto_reset), seed)
+        finally:
+            os.chdir(cwd)
+        if not self._env:
+            raise ValueError("invalid environment parameters")
+
+        self.num_envs = num_envs
+        size = self._lib.invaders_env_observation_size(self._env)
+        if observation_type == OBS_PIXELS:
+            self.obs = np.zeros((num_envs, stack, height, width), dtype=np.uint8)
+        else:
+            self.obs = np.zeros((num_envs, size), dtype=np.float32)
+        self.rewards = np.zeros(num_envs, dtype=np.float32)
+        self.dones = np.zeros(num_envs, dtype=np.uint8)
+        self.actions = np.zeros(num_envs, dtype=np.int32)
+
+    def reset(self):
+        """
+        @brief Начинает заново все игры.
+
+        @return Массив наблюдений.
+        """
+        self._lib.invaders_env_reset_all(self._env, _address(self.obs))
+        return self.obs
+
+    def reset_one(self, index, seed=0):
+        """
+        @brief Начинает заново одну игру.
+
+        @param index Номер игры.
+        @param seed Новое начальное значение генератора или 0.
+        @return Наблюдение этой игры (представление общего массива).
+        """
+        view = self.obs[index]
+        self._lib.invaders_env_reset(self._env, index, seed, _address(view))
+        return view
+
+    def step(self, actions):
+        """
+        @brief Выполняет один тик во всех играх.
+
+        @param actions Действия для каждой игры (комбинации ACTION_*).
+        @return Кортеж (obs, rewards, dones).
+        """
+        if isinstance(actions, np.ndarray) and actions.dtype == np.int32 and actions.shape == (self.num_envs,) \
+                and actions.flags.c_contiguous:
+            source = actions
+        else:
+            self.actions[:] = actions
+            source = self.actions
+        self._lib.invaders_env_step_all(self._env, source.ctypes.data, _address(self.obs), _address(self.rewards),
+                                        _address(self.dones))
+        return self.obs, self.rewards, self.dones
+
+    def close(self):
+        """
+        @brief Уничтожает набор игр.
+        """
+        if self._env:
+            self._lib.invaders_env_destroy(self._env)
+            self._env = None
+
+    def __del__(self):
+        self.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
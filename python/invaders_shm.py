@@ -0,0 +1,226 @@
+"""
+@file invaders_shm.py
+@brief Клиент сервера игр invaders_shm_server, работающий через разделяемую память (см. src/shmprotocol.hpp).
+
+Клиент не линкуется с библиотекой игры: он отображает сегмент /dev/shm/<name>, пишет действия в ячейку
+кольца и ждет ответа на futex. Массивы, возвращаемые step() и reset(), являются представлениями ячейки
+сегмента и действительны до следующего запроса в ту же ячейку.
+"""
+
+import ctypes
+import mmap
+import os
+
+import numpy as np
+
+SHM_MAGIC = 0x53564e49
+SHM_VERSION = 1
+SHM_HEADER_SIZE = 256
+SHM_ALIGNMENT = 64
+
+SHM_STEP = 0
+SHM_RESET = 1
+
+OBS_PIXELS = 1
+
+_SYS_FUTEX = {"x86_64": 202, "aarch64": 98}.get(os.uname().machine)
+_FUTEX_WAIT = 0
+_FUTEX_WAKE = 1
+
+_libc = ctypes.CDLL(None, use_errno=True)
+_libc.syscall.restype = ctypes.c_long
+
+
+class _Timespec(ctypes.Structure):
+    _fields_ = [("tv_sec", ctypes.c_long), ("tv_nsec", ctypes.c_long)]
+
+
+def _align_up(size):
+    return (size + SHM_ALIGNMENT - 1) // SHM_ALIGNMENT * SHM_ALIGNMENT
+
+
+class ShmClient:
+    """
+    @brief Подключение к серверу игр.
+
+    Пока клиент открыт, сегмент занят его процессом; другой клиент сможет подключиться после close()
+    или после завершения этого процесса.
+    """
+
+    def __init__(self, name="/invaders_env", spins=2000, timeout_ms=100):
+        """
+        @brief Подключается к сегменту и занимает его.
+
+        @param name Имя сегмента, переданное серверу в --name.
+        @param spins Количество проверок ответа перед засыпанием на futex.
+        @param timeout_ms Наибольшее время одного сна в миллисекундах.
+        """
+        if _SYS_FUTEX is None:
+            raise OSError("futex syscall number is unknown for this architecture")
+        fd = os.open("/dev/shm/" + name.lstrip("/"), os.O_RDWR)
+        try:
+            self._mm = mmap.mmap(fd, 0)
+        finally:
+            os.close(fd)
+        # На одном ядре вращение только отнимает время у сервера
+        self.spins = spins if (os.cpu_count() or 1) > 1 else 0
+        self.timeout_ms = timeout_ms
+
+        header = np.frombuffer(self._mm, dtype=np.uint32, count=SHM_HEADER_SIZE // 4)
+        magic, version, num_envs, observation_type, observation_size, element_size, ring_slots, slot_size = \
+            (int(value) for value in header[:8])
+        if magic != SHM_MAGIC or version != SHM_VERSION:
+            self._mm.close()
+            raise RuntimeError("segment %s is not a compatible invaders server" % name)
+        # Номер запроса 32-битный: без степени двойки запросы у переполнения делят ячейку
+        if ring_slots == 0 or ring_slots & (ring_slots - 1):
+            self._mm.close()
+            raise RuntimeError("segment %s has %d ring slots, expected a power of two" % (name, ring_slots))
+        self._header = header
+        self.num_envs = num_envs
+        self.ring_slots = ring_slots
+        self._slot_size = slot_size
+        self._request_address = self._address(64)
+        self._response_address = self._address(128)
+
+        actions = SHM_ALIGNMENT
+        rewards = actions + _align_up(num_envs * 4)
+        dones = rewards + _align_up(num_envs * 4)
+        observations = dones + _align_up(num_envs)
+        dtype = np.uint8 if observation_type == OBS_PIXELS else np.float32
+        self._slots = []
+        for i in range(ring_slots):
+            base = SHM_HEADER_SIZE + i * slot_size
+            self._slots.append({
+                "command": np.frombuffer(self._mm, dtype=np.uint32, count=2, offset=base),
+                "actions": np.frombuffer(self._mm, dtype=np.int32, count=num_envs, offset=base + actions),
+                "rewards": np.frombuffer(self._mm, dtype=np.float32, count=num_envs, offset=base + rewards),
+                "dones": np.frombuffer(self._mm, dtype=np.uint8, count=num_envs, offset=base + dones),
+                "obs": np.frombuffer(self._mm, dtype=dtype, count=num_envs * observation_size,
+                                     offset=base + observations).reshape(num_envs, observation_size),
+            })
+
+        self._acquire()
+        self._sequence = int(self._header[16])
+
+    def _address(self, offset):
+        return ctypes.addressof(ctypes.c_uint32.from_buffer(self._mm, offset))
+
+    def _pid_alive(self, pid):
+        try:
+            os.kill(pid, 0)
+        except ProcessLookupError:
+            return False
+        except PermissionError:
+            pass
+        return True
+
+    def _acquire(self):
+        """
+        @brief Занимает сегмент: clientPid (смещение 36) меняется с 0 или с завершившегося процесса на свой pid.
+        """
+        pid = os.getpid()
+        current = int(self._header[9])
+        if current not in (0, pid) and self._pid_alive(current):
+            raise RuntimeError("segment is used by process %d" % current)
+        # Python не умеет сравнивать-и-обменивать в разделяемой памяти; гонка двух одновременно
+        # подключающихся клиентов обнаруживается повторным чтением
+        self._header[9] = pid
+        if int(self._header[9]) != pid:
+            raise RuntimeError("segment was taken by another client")
+        self._wait(lambda: int(self._header[32]) == int(self._header[16]))
+
+    def _wait(self, ready):
+        """
+        @brief Ждет условия ready(), засыпая на futex по счетчику выполненных запросов (смещение 128).
+        """
+        for _ in range(self.spins):
+            if ready():
+                return
+        timeout = _Timespec(self.timeout_ms // 1000, (self.timeout_ms % 1000) * 1000000)
+        address = self._response_address
+        while not ready():
+            if int(self._header[8]) == 0:
+                raise RuntimeError("server stopped")
+            value = int(self._header[32])
+            if ready():
+                return
+            _libc.syscall(_SYS_FUTEX, ctypes.c_void_p(address), _FUTEX_WAIT, ctypes.c_uint32(value),
+                          ctypes.byref(timeout), None, 0)
+
+    def submit(self, command, actions=None, seed=0):
+        """
+        @brief Отправляет запрос без ожидания ответа.
+
+        @param command SHM_STEP или SHM_RESET.
+        @param actions Действия для каждой игры.
+        @param seed Начальное значение генераторов для SHM_RESET.
+        @return Номер запроса для wait().
+        """
+        sequence = self._sequence
+        self._wait(lambda: (sequence - int(self._header[32])) & 0xffffffff < self.ring_slots)
+        slot = self._slots[sequence % self.ring_slots]
+        slot["command"][0] = command
+        slot["command"][1] = seed
+        if actions is not None:
+            slot["actions"][:] = actions
+        self._sequence = (sequence + 1) & 0xffffffff
+        # Счетчик пишется последним; на x86 и с барьером futex этого достаточно для упорядочивания
+        self._header[16] = self._sequence
+        _libc.syscall(_SYS_FUTEX, ctypes.c_void_p(self._request_address), _FUTEX_WAKE, 1, None, None, 0)
+        return sequence
+
+    def wait(self, sequence):
+        """
+        @brief Ждет выполнения запроса.
+
+        @param sequence Номер запроса, возвращенный submit().
+        @return Кортеж (obs, rewards, dones) - представления ячейки запроса.
+        """
+        self._wait(lambda: (int(self._header[32]) - sequence - 1) & 0xffffffff < 0x80000000)
+        slot = self._slots[sequence % self.ring_slots]
+        return slot["obs"], slot["rewards"], slot["dones"]
+
+    def reset(self, seed=0):
+        """
+        @brief Начинает заново все игры.
+
+        @param seed Начальное значение генераторов или 0.
+        @return Массив наблюдений.
+        """
+        return self.wait(self.submit(SHM_RESET, seed=seed))[0]
+
+    def step(self, actions):
+        """
+        @brief Выполняет один тик во всех играх.
+
+        @param actions Действия для каждой игры.
+        @return Кортеж (obs, rewards, dones).
+        """
+        return self.wait(self.submit(SHM_STEP, actions))
+
+    def close(self):
+        """
+        @brief Освобождает сегмент и закрывает отображение.
+        """
+        if self._mm is None:
+            return
+        if int(self._header[9]) == os.getpid():
+            self._header[9] = 0
+        self._slots = []
+        self._header = None
+        try:
+            self._mm.close()
+        except BufferError:
+            # Пользователь еще держит представления ячеек; отображение закроется вместе с ними
+            pass
+        self._mm = None
+
+    def __del__(self):
+        self.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
@@ -0,0 +1,224 @@
+/**
+ * @file aabbbatch.cpp
+ * @brief Файл реализации, содержащий методы класса AabbBatch.
+ */
+
+#include "aabbbatch.hpp"
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define AABB_BATCH_X86 1
+#endif
+
+/**
+ * @brief Количество прямоугольников в одном блоке дополнения.
+ */
+
+static const int laneCount = 8;
+
+#ifdef AABB_BATCH_X86
+
+/**
+ * @brief Проверка столкновений с помощью AVX (8 прямоугольников за итерацию).
+ */
+
+__attribute__((target("avx")))
+static int CollideAvx(const float *left, const float *top, const float *right, const float *bottom, int padded,
+                      float x, float y, float r, float b, uint64_t *mask) {
+    const __m256 vx = _mm256_set1_ps(x);
+    const __m256 vy = _mm256_set1_ps(y);
+    const __m256 vr = _mm256_set1_ps(r);
+    const __m256 vb = _mm256_set1_ps(b);
+    int hits = 0;
+    for (int i = 0; i < padded; i += 8) {
+        __m256 horizontal = _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(left + i), vr, _CMP_LT_OQ),
+                                          _mm256_cmp_ps(_mm256_loadu_ps(right + i), vx, _CMP_GT_OQ));
+        __m256 vertical = _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(top + i), vb, _CMP_LT_OQ),
+                                        _mm256_cmp_ps(_mm256_loadu_ps(bottom + i), vy, _CMP_GT_OQ));
+        uint64_t bits = _mm256_movemask_ps(_mm256_and_ps(horizontal, vertical));
+        if (bits) {
+            mask[i >> 6] |= bits << (i & 63);
+            hits += __builtin_popcountll(bits);
+        }
+    }
+    return hits;
+}
+
+/**
+ * @brief Проверка столкновений с помощью SSE (4 прямоугольника за итерацию).
+ */
+
+__attribute__((target("sse2")))
+static int CollideSse(const float *left, const float *top, const float *right, const float *bottom, int padded,
+                      float x, float y, float r, float b, uint64_t *mask) {
+    const __m128 vx = _mm_set1_ps(x);
+    const __m128 vy = _mm_set1_ps(y);
+    const __m128 vr = _mm_set1_ps(r);
+    const __m128 vb = _mm_set1_ps(b);
+    int hits = 0;
+    for (int i = 0; i < padded; i += 4) {
+        __m128 horizontal = _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(left + i), vr),
+                                       _mm_cmpgt_ps(_mm_loadu_ps(right + i), vx));
+        __m128 vertical = _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(top + i), vb),
+                                     _mm_cmpgt_ps(_mm_loadu_ps(bottom + i), vy));
+        uint64_t bits = _mm_movemask_ps(_mm_and_ps(horizontal, vertical));
+        if (bits) {
+            mask[i >> 6] |= bits << (i & 63);
+            hits += __builtin_popcountll(bits);
+        }
+    }
+    return hits;
+}
+
+#endif
+
+/**
+ * @brief Конструктор класса AabbBatch.
+ *
+ * Создает пустой массив.
+ */
+
+AabbBatch::AabbBatch() {
+    count = 0;
+}
+
+/**
+ * @brief Удаляет все прямоугольники из массива.
+ */
+
+void AabbBatch::Clear() {
+    left.clear();
+    top.clear();
+    right.clear();
+    bottom.clear();
+    count = 0;
+}
+
+/**
+ * @brief Добавляет прямоугольник в конец массива.
+ *
+ * Массив растет блоками по 8 элементов; неиспользуемые элементы блока заполняются
+ * прямоугольниками, которые ни с чем не пересекаются.
+ *
+ * @param x Координата левого края.
+ * @param y Координата верхнего края.
+ * @param width Ширина.
+ * @param height Высота.
+ */
+
+void AabbBatch::Add(float x, float y, float width, float height) {
+    if (count == (int) left.size()) {
+        const float infinity = std::numeric_limits<float>::infinity();
+        left.insert(left.end(), laneCount, infinity);
+        top.insert(top.end(), laneCount, infinity);
+        right.insert(right.end(), laneCount, -infinity);
+        bottom.insert(bottom.end(), laneCount, -infinity);
+    }
+    left[count] = x;
+    top[count] = y;
+    right[count] = x + width;
+    bottom[count] = y + height;
+    count++;
+}
+
+/**
+ * @brief Задает количество прямоугольников массива.
+ *
+ * Массив дополняется до кратного 8 размера; новые элементы и дополнение заполняются
+ * прямоугольниками, которые ни с чем не пересекаются.
+ *
+ * @param count Количество прямоугольников.
+ */
+
+void AabbBatch::Resize(int count) {
+    const float infinity = std::numeric_limits<float>::infinity();
+    int padded = (count + laneCount - 1) / laneCount * laneCount;
+    left.assign(padded, infinity);
+    top.assign(padded, infinity);
+    right.assign(padded, -infinity);
+    bottom.assign(padded, -infinity);
+    this->count = count;
+}
+
+/**
+ * @brief Задает прямоугольник с заданным номером.
+ *
+ * @param index Номер прямоугольника (меньше Size()).
+ * @param x Координата левого края.
+ * @param y Координата верхнего края.
+ * @param width Ширина.
+ * @param height Высота.
+ */
+
+void AabbBatch::Set(int index, float x, float y, float width, float height) {
+    left[index] = x;
+    top[index] = y;
+    right[index] = x + width;
+    bottom[index] = y + height;
+}
+
+/**
+ * @brief Возвращает количество прямоугольников в массиве.
+ */
+
+int AabbBatch::Size() const {
+    return count;
+}
+
+/**
+ * @brief Проверяет прямоугольник против всех прямоугольников массива.
+ *
+ * @param x Координата левого края.
+ * @param y Координата верхнего края.
+ * @param width Ширина.
+ * @param height Высота.
+ * @param mask Маска попаданий, размер устанавливается в (Size() + 63) / 64 слов.
+ * @return Количество попаданий.
+ */
+
+int AabbBatch::Collide(float x, float y, float width, float height, std::vector<uint64_t> &mask) const {
+#ifdef AABB_BATCH_X86
+    static const bool hasAvx = __builtin_cpu_supports("avx");
+    static const bool hasSse = __builtin_cpu_supports("sse2");
+    if (hasAvx || hasSse) {
+        mask.assign((count + 63) / 64, 0);
+        if (count == 0) {
+            return 0;
+        }
+        int padded = left.size();
+        if (hasAvx) {
+            return CollideAvx(left.data(), top.data(), right.data(), bottom.data(), padded,
+                              x, y, x + width, y + height, mask.data());
+        }
+        return CollideSse(left.data(), top.data(), right.data(), bottom.data(), padded,
+                          x, y, x + width, y + height, mask.data());
+    }
+#endif
+    return CollideScalar(x, y, width, height, mask);
+}
+
+/**
+ * @brief Скалярная эталонная реализация метода Collide.
+ *
+ * @param x Координата левого края.
+ * @param y Координата верхнего края.
+ * @param width Ширина.
+ * @param height Высота.
+ * @param mask Маска попаданий, размер устанавливается в (Size() + 63) / 64 слов.
+ * @return Количество попаданий.
+ */
+
+int AabbBatch::CollideScalar(float x, float y, float width, float height, std::vector<uint64_t> &mask) const {
+    mask.assign((count + 63) / 64, 0);
+    float r = x + width;
+    float b = y + height;
+    int hits = 0;
+    for (int i = 0; i < count; i++) {
+        if (left[i] < r && right[i] > x && top[i] < b && bottom[i] > y) {
+            mask[i >> 6] |= uint64_t(1) << (i & 63);
+            hits++;
+        }
+    }
+    return hits;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file aabbbatch.hpp
+ * @brief Заголовочный файл, содержащий класс AabbBatch.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class AabbBatch
+ * @brief Упакованный массив прямоугольников для пакетной проверки столкновений.
+ *
+ * Прямоугольники хранятся в виде структуры массивов (левый, верхний, правый и нижний края),
+ * дополненной до кратного 8 размера, чтобы один прямоугольник можно было проверить сразу
+ * против 4 (SSE) или 8 (AVX) кандидатов. Результат совпадает с CheckCollisionRecs из raylib.
+ */
+
+class AabbBatch {
+public:
+    /**
+     * @brief Конструктор класса AabbBatch.
+     *
+     * Создает пустой массив.
+     */
+    AabbBatch();
+
+    /**
+     * @brief Удаляет все прямоугольники из массива.
+     */
+    void Clear();
+
+    /**
+     * @brief Добавляет прямоугольник в конец массива.
+     *
+     * @param x Координата левого края.
+     * @param y Координата верхнего края.
+     * @param width Ширина.
+     * @param height Высота.
+     */
+    void Add(float x, float y, float width, float height);
+
+    /**
+     * @brief Задает количество прямоугольников массива.
+     *
+     * Новые элементы ни с чем не пересекаются, пока не заданы методом Set.
+     *
+     * @param count Количество прямоугольников.
+     */
+    void Resize(int count);
+
+    /**
+     * @brief Задает прямоугольник с заданным номером.
+     *
+     * Разные элементы можно задавать из разных потоков одновременно.
+     *
+     * @param index Номер прямоугольника (меньше Size()).
+     * @param x Координата левого края.
+     * @param y Координата верхнего края.
+     * @param width Ширина.
+     * @param height Высота.
+     */
+    void Set(int index, float x, float y, float width, float height);
+
+    /**
+     * @brief Возвращает количество прямоугольников в массиве.
+     */
+    int Size() const;
+
+    /**
+     * @brief Проверяет прямоугольник против всех прямоугольников массива.
+     *
+     * Использует AVX или SSE, если процессор их поддерживает, иначе скалярную реализацию.
+     * Бит i маски установлен, если прямоугольник пересекается с i-м элементом массива.
+     *
+     * @param x Координата левого края.
+     * @param y Координата верхнего края.
+     * @param width Ширина.
+     * @param height Высота.
+     * @param mask Маска попаданий, размер устанавливается в (Size() + 63) / 64 слов.
+     * @return Количество попаданий.
+     */
+    int Collide(float x, float y, float width, float height, std::vector<uint64_t> &mask) const;
+
+    /**
+     * @brief Скалярная эталонная реализация метода Collide.
+     *
+     * @param x Координата левого края.
+     * @param y Координата верхнего края.
+     * @param width Ширина.
+     * @param height Высота.
+     * @param mask Маска попаданий, размер устанавливается в (Size() + 63) / 64 слов.
+     * @return Количество попаданий.
+     */
+    int CollideScalar(float x, float y, float width, float height, std::vector<uint64_t> &mask) const;
+
+private:
+    /**
+     * @brief Левые края прямоугольников.
+     */
+    std::vector<float> left;
+    /**
+     * @brief Верхние края прямоугольников.
+     */
+    std::vector<float> top;
+    /**
+     * @brief Правые края прямоугольников (x + width).
+     */
+    std::vector<float> right;
+    /**
+     * @brief Нижние края прямоугольников (y + height).
+     */
+    std::vector<float> bottom;
+    /**
+     * @brief Количество прямоугольников без учета дополнения.
+     */
+    int count;
+};
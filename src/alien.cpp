@@ -4,6 +4,7 @@
  */
 
 #include "alien.hpp"
+#include "platform.hpp"
 
 /**
  * @brief Статический массив текстур для изображений инопланетян.
@@ -11,6 +12,12 @@
 
 Texture2D Alien::alienImages[3] = {};
 
+/**
+ * @brief Статический массив масок столкновений для изображений инопланетян.
+ */
+
+SpriteMask Alien::alienMasks[3];
+
 /**
  * @brief Конструктор класса Alien.
  *
@@ -19,27 +26,35 @@ Texture2D Alien::alienImages[3] = {};
  *
  * @param type Тип инопланетянина (1, 2 или 3).
  * @param position Позиция инопланетянина на экране.
+ * @param row Ряд инопланетянина в формации.
+ * @param column Столбец инопланетянина в формации.
  */
 
-Alien::Alien(int type, Vector2 position)
+Alien::Alien(int type, Vector2 position, int row, int column)
 {
     this -> type = type;
     this -> position = position;
+    this -> row = row;
+    this -> column = column;
 
-    if(alienImages[type -1].id == 0){
+    if(alienImages[type -1].width == 0){
 
     switch (type) {
         case 1:
-            alienImages[0] = LoadTexture("../Graphics/alien_1.png");
+            alienImages[0] = LoadGameTexture("../Graphics/alien_1.png");
+            alienMasks[0] = SpriteMask::Load("../Graphics/alien_1.png");
             break;
         case 2:
-            alienImages[1] = LoadTexture("../Graphics/alien_2.png");
+            alienImages[1] = LoadGameTexture("../Graphics/alien_2.png");
+            alienMasks[1] = SpriteMask::Load("../Graphics/alien_2.png");
             break;
         case 3: 
-            alienImages[2] = LoadTexture("../Graphics/alien_3.png");
+            alienImages[2] = LoadGameTexture("../Graphics/alien_3.png");
+            alienMasks[2] = SpriteMask::Load("../Graphics/alien_3.png");
             break;
         default:
-            alienImages[0] = LoadTexture("../Graphics/alien_1.png");
+            alienImages[0] = LoadGameTexture("../Graphics/alien_1.png");
+            alienMasks[0] = SpriteMask::Load("../Graphics/alien_1.png");
             break;
     }
 }
@@ -69,8 +84,9 @@ int Alien::GetType() {
 
 void Alien::UnloadImages()
 {
-    for(int i = 0; i < 4; i++) {
-        UnloadTexture(alienImages[i]);
+    for(int i = 0; i < 3; i++) {
+        UnloadGameTexture(alienImages[i]);
+        alienImages[i] = {};
     }
 }
 
@@ -88,6 +104,44 @@ Rectangle Alien::getRect()
     };
 }
 
+/**
+ * @brief Проверяет попадание прямоугольника в непрозрачные пиксели инопланетянина.
+ *
+ * Если маска не загружена, используется прямоугольник текстуры.
+ *
+ * @param rect Прямоугольник, например лазер.
+ * @return true, если прямоугольник задевает инопланетянина.
+ */
+
+bool Alien::CollidesWith(Rectangle rect)
+{
+    const SpriteMask &mask = alienMasks[type - 1];
+    if (mask.Empty()) {
+        return CheckCollisionRecs(getRect(), rect);
+    }
+    return mask.OverlapsRect(position.x, position.y, rect.x, rect.y, rect.width, rect.height);
+}
+
+/**
+ * @brief Проверяет пересечение непрозрачных пикселей инопланетянина и другого спрайта.
+ *
+ * @param rect Прямоугольник другого спрайта.
+ * @param mask Маска столкновений другого спрайта.
+ * @return true, если спрайты пересекаются.
+ */
+
+bool Alien::CollidesWith(Rectangle rect, const SpriteMask &mask)
+{
+    if (!CheckCollisionRecs(getRect(), rect)) {
+        return false;
+    }
+    const SpriteMask &alienMask = alienMasks[type - 1];
+    if (alienMask.Empty() || mask.Empty()) {
+        return true;
+    }
+    return alienMask.Overlaps(position.x, position.y, mask, rect.x, rect.y);
+}
+
 /**
  * @brief Обновляет позицию инопланетянина.
  *
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <raylib.h>
+#include "spritemask.hpp"
 
 /**
  * @class Alien
@@ -21,8 +22,10 @@ public:
      *
      * @param type Тип инопланетянина (1, 2 или 3).
      * @param position Позиция инопланетянина на экране.
+     * @param row Ряд инопланетянина в формации.
+     * @param column Столбец инопланетянина в формации.
      */
-    Alien(int type, Vector2 position);
+    Alien(int type, Vector2 position, int row = 0, int column = 0);
 
     /**
  * @brief Обновляет позицию инопланетянина.
@@ -55,11 +58,32 @@ public:
 */
     Rectangle getRect();
 
+    /**
+* @brief Проверяет попадание прямоугольника в непрозрачные пиксели инопланетянина.
+*
+* @param rect Прямоугольник, например лазер.
+* @return true, если прямоугольник задевает инопланетянина.
+*/
+    bool CollidesWith(Rectangle rect);
+
+    /**
+* @brief Проверяет пересечение непрозрачных пикселей инопланетянина и другого спрайта.
+*
+* @param rect Прямоугольник другого спрайта.
+* @param mask Маска столкновений другого спрайта.
+* @return true, если спрайты пересекаются.
+*/
+    bool CollidesWith(Rectangle rect, const SpriteMask &mask);
+
     /**
  * @brief Статический массив текстур для изображений инопланетян.
  */
     static Texture2D alienImages[3];
     /**
+ * @brief Статический массив масок столкновений для изображений инопланетян.
+ */
+    static SpriteMask alienMasks[3];
+    /**
 * @brief Тип инопланетянина.
 */
     int type;
@@ -67,5 +91,13 @@ public:
  * @brief Позиция инопланетянина на экране.
  */
     Vector2 position;
+    /**
+ * @brief Ряд инопланетянина в формации.
+ */
+    int row;
+    /**
+ * @brief Столбец инопланетянина в формации.
+ */
+    int column;
 private:
 };
\ No newline at end of file
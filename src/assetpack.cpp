@@ -0,0 +1,266 @@
+/**
+ * @file assetpack.cpp
+ * @brief Файл реализации чтения и записи архива ресурсов игры.
+ */
+
+#include "assetpack.hpp"
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <cstdlib>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Сигнатура архива.
+ */
+static const char assetPackMagic[8] = {'I', 'N', 'V', 'P', 'A', 'C', 'K', 0};
+
+/**
+ * @brief Округляет размер вверх до выравнивания данных архива.
+ */
+
+static size_t AlignUp(size_t value) {
+    return (value + assetPackAlignment - 1) / assetPackAlignment * assetPackAlignment;
+}
+
+/**
+ * @brief Конструктор класса AssetPack. Создает закрытый архив.
+ */
+
+AssetPack::AssetPack() {
+    base = nullptr;
+    size = 0;
+    entries = nullptr;
+    entryCount = 0;
+}
+
+/**
+ * @brief Деструктор класса AssetPack. Закрывает архив.
+ */
+
+AssetPack::~AssetPack() {
+    Close();
+}
+
+/**
+ * @brief Отображает архив в память и проверяет заголовок и каталог.
+ *
+ * В Windows архив читается в память одним вызовом.
+ *
+ * @param fileName Путь к архиву.
+ * @return false, если файл не открыт или поврежден.
+ */
+
+bool AssetPack::Open(const char *fileName) {
+    Close();
+#if defined(_WIN32)
+    FILE *file = fopen(fileName, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t *buffer = length > 0 ? (uint8_t *) malloc(length) : nullptr;
+    if (buffer == nullptr || fread(buffer, 1, length, file) != (size_t) length) {
+        free(buffer);
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+    base = buffer;
+    size = length;
+#else
+    int fd = open(fileName, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    void *mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    // Все ресурсы понадобятся при запуске, поэтому страницы читаются заранее
+    madvise(mapping, status.st_size, MADV_WILLNEED);
+    base = (const uint8_t *) mapping;
+    size = status.st_size;
+#endif
+
+    const AssetPackHeader *header = (const AssetPackHeader *) base;
+    bool valid = size >= sizeof(AssetPackHeader) && memcmp(header->magic, assetPackMagic, 8) == 0 &&
+                 header->version == assetPackVersion && header->fileSize == size &&
+                 header->entryCount <= (size - sizeof(AssetPackHeader)) / sizeof(AssetEntry);
+    if (valid) {
+        entries = (const AssetEntry *) (base + sizeof(AssetPackHeader));
+        entryCount = header->entryCount;
+        for (uint32_t i = 0; i < entryCount && valid; ++i) {
+            const AssetEntry &entry = entries[i];
+            valid = entry.name[assetNameSize - 1] == 0 && entry.offset <= size && entry.size <= size - entry.offset;
+        }
+    }
+    if (!valid) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Закрывает архив. Указатели на его данные становятся недействительными.
+ */
+
+void AssetPack::Close() {
+    if (base != nullptr) {
+#if defined(_WIN32)
+        free((void *) base);
+#else
+        munmap((void *) base, size);
+#endif
+    }
+    base = nullptr;
+    size = 0;
+    entries = nullptr;
+    entryCount = 0;
+}
+
+/**
+ * @brief Ищет ресурс по имени.
+ *
+ * @param name Путь ресурса относительно корня игры.
+ * @return Запись каталога или nullptr.
+ */
+
+const AssetEntry *AssetPack::Find(const char *name) const {
+    for (uint32_t i = 0; i < entryCount; ++i) {
+        if (strcmp(entries[i].name, name) == 0) {
+            return &entries[i];
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Возвращает данные ресурса.
+ *
+ * @param entry Запись каталога этого архива.
+ */
+
+const uint8_t *AssetPack::Data(const AssetEntry &entry) const {
+    return base + entry.offset;
+}
+
+/**
+ * @brief Проверяет, указывает ли указатель внутрь архива.
+ */
+
+bool AssetPack::Contains(const void *pointer) const {
+    const uint8_t *bytes = (const uint8_t *) pointer;
+    return base != nullptr && bytes >= base && bytes < base + size;
+}
+
+/**
+ * @brief Возвращает количество ресурсов.
+ */
+
+int AssetPack::EntryCount() const {
+    return entryCount;
+}
+
+/**
+ * @brief Возвращает запись каталога по номеру.
+ */
+
+const AssetEntry &AssetPack::Entry(int index) const {
+    return entries[index];
+}
+
+/**
+ * @brief Добавляет ресурс.
+ *
+ * @param name Путь ресурса относительно корня игры (короче assetNameSize).
+ * @param type Тип ресурса.
+ * @param params Параметры ресурса (до 7 значений, остальные нули).
+ * @param data Данные.
+ * @param size Размер данных.
+ * @return false, если имя слишком длинное или уже добавлено.
+ */
+
+bool AssetPackWriter::Add(const char *name, AssetType type, std::vector<uint32_t> params, const void *data,
+                          size_t size) {
+    if (strlen(name) >= assetNameSize || params.size() > 7) {
+        return false;
+    }
+    for (auto &entry: entries) {
+        if (strcmp(entry.name, name) == 0) {
+            return false;
+        }
+    }
+    AssetEntry entry = {};
+    strcpy(entry.name, name);
+    entry.type = type;
+    for (size_t i = 0; i < params.size(); ++i) {
+        entry.params[i] = params[i];
+    }
+    entry.size = size;
+    entries.push_back(entry);
+    blobs.emplace_back((const uint8_t *) data, (const uint8_t *) data + size);
+    return true;
+}
+
+/**
+ * @brief Возвращает архив в виде байтов.
+ */
+
+std::vector<uint8_t> AssetPackWriter::Build() const {
+    size_t offset = AlignUp(sizeof(AssetPackHeader) + entries.size() * sizeof(AssetEntry));
+    std::vector<AssetEntry> directory = entries;
+    for (size_t i = 0; i < directory.size(); ++i) {
+        directory[i].offset = offset;
+        offset = AlignUp(offset + directory[i].size);
+    }
+
+    std::vector<uint8_t> pack(offset, 0);
+    AssetPackHeader header = {};
+    memcpy(header.magic, assetPackMagic, 8);
+    header.version = assetPackVersion;
+    header.entryCount = directory.size();
+    header.fileSize = pack.size();
+    memcpy(pack.data(), &header, sizeof(header));
+    if (!directory.empty()) {
+        memcpy(pack.data() + sizeof(header), directory.data(), directory.size() * sizeof(AssetEntry));
+    }
+    for (size_t i = 0; i < directory.size(); ++i) {
+        if (!blobs[i].empty()) {
+            memcpy(pack.data() + directory[i].offset, blobs[i].data(), blobs[i].size());
+        }
+    }
+    return pack;
+}
+
+/**
+ * @brief Записывает архив в файл.
+ *
+ * @param fileName Путь к архиву.
+ * @return false при ошибке записи.
+ */
+
+bool AssetPackWriter::Write(const char *fileName) const {
+    std::vector<uint8_t> pack = Build();
+    FILE *file = fopen(fileName, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    bool written = fwrite(pack.data(), 1, pack.size(), file) == pack.size();
+    return fclose(file) == 0 && written;
+}
@@ -0,0 +1,288 @@
+/**
+ * @file assetpack.hpp
+ * @brief Заголовочный файл, содержащий формат архива ресурсов игры и классы для его чтения и записи.
+ *
+ * Архив собирается заранее программой invaders_assetpack: изображения хранятся распакованными
+ * пикселями в формате для загрузки в видеопамять, звуковые эффекты - готовым PCM, шрифт -
+ * построенным атласом с описаниями символов, музыка - исходным сжатым файлом (она проигрывается
+ * потоком). Во время работы архив отображается в память целиком, и ресурсы создаются прямо из
+ * отображенных байтов без чтения файлов и декодирования.
+ *
+ * Формат (little-endian): заголовок AssetPackHeader, каталог из entryCount записей AssetEntry,
+ * затем данные ресурсов, каждый с выравниванием assetPackAlignment.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Версия формата архива.
+ */
+constexpr uint32_t assetPackVersion = 1;
+
+/**
+ * @brief Выравнивание данных ресурсов в архиве.
+ */
+constexpr size_t assetPackAlignment = 64;
+
+/**
+ * @brief Наибольшая длина имени ресурса с завершающим нулем.
+ */
+constexpr size_t assetNameSize = 48;
+
+/**
+ * @brief Типы ресурсов архива и значения AssetEntry::params для них.
+ */
+enum AssetType : uint32_t {
+    /**
+     * @brief Изображение: ширина, высота, количество mip-уровней, формат пикселей raylib.
+     */
+    ASSET_IMAGE = 1,
+    /**
+     * @brief Звук в PCM: количество кадров, частота, разрядность, количество каналов.
+     */
+    ASSET_WAVE = 2,
+    /**
+     * @brief Сжатый музыкальный файл без параметров; тип файла - по расширению имени.
+     */
+    ASSET_MUSIC = 3,
+    /**
+     * @brief Шрифт: размер, количество символов, отступ символов, ширина, высота и формат атласа.
+     *
+     * Данные: glyphCount записей PackedGlyph, glyphCount записей PackedRect, затем с
+     * выравниванием assetPackAlignment пиксели атласа.
+     */
+    ASSET_FONT = 4
+};
+
+/**
+ * @struct AssetPackHeader
+ * @brief Заголовок архива.
+ */
+struct AssetPackHeader {
+    /**
+     * @brief Сигнатура "INVPACK" и нулевой байт.
+     */
+    char magic[8];
+    /**
+     * @brief Версия формата.
+     */
+    uint32_t version;
+    /**
+     * @brief Количество записей каталога.
+     */
+    uint32_t entryCount;
+    /**
+     * @brief Размер архива в байтах.
+     */
+    uint64_t fileSize;
+};
+
+/**
+ * @struct AssetEntry
+ * @brief Запись каталога архива.
+ */
+struct AssetEntry {
+    /**
+     * @brief Путь ресурса относительно корня игры, например "Graphics/alien_1.png".
+     */
+    char name[assetNameSize];
+    /**
+     * @brief Тип ресурса (AssetType).
+     */
+    uint32_t type;
+    /**
+     * @brief Параметры ресурса; значение зависит от типа.
+     */
+    uint32_t params[7];
+    /**
+     * @brief Смещение данных от начала архива.
+     */
+    uint64_t offset;
+    /**
+     * @brief Размер данных.
+     */
+    uint64_t size;
+};
+
+/**
+ * @struct PackedGlyph
+ * @brief Описание символа шрифта в архиве.
+ */
+struct PackedGlyph {
+    /**
+     * @brief Код символа.
+     */
+    int32_t value;
+    /**
+     * @brief Смещение изображения символа по X.
+     */
+    int32_t offsetX;
+    /**
+     * @brief Смещение изображения символа по Y.
+     */
+    int32_t offsetY;
+    /**
+     * @brief Сдвиг пера после символа.
+     */
+    int32_t advanceX;
+};
+
+/**
+ * @struct PackedRect
+ * @brief Прямоугольник символа в атласе шрифта.
+ */
+struct PackedRect {
+    /**
+     * @brief Координата X левого края.
+     */
+    float x;
+    /**
+     * @brief Координата Y верхнего края.
+     */
+    float y;
+    /**
+     * @brief Ширина.
+     */
+    float width;
+    /**
+     * @brief Высота.
+     */
+    float height;
+};
+
+/**
+ * @brief Возвращает смещение пикселей атласа внутри данных шрифта.
+ *
+ * @param glyphCount Количество символов.
+ */
+constexpr size_t FontAtlasOffset(uint32_t glyphCount) {
+    return (glyphCount * (sizeof(PackedGlyph) + sizeof(PackedRect)) + assetPackAlignment - 1) /
+           assetPackAlignment * assetPackAlignment;
+}
+
+/**
+ * @class AssetPack
+ * @brief Архив ресурсов, отображенный в память только для чтения.
+ */
+class AssetPack {
+public:
+    /**
+     * @brief Конструктор класса AssetPack. Создает закрытый архив.
+     */
+    AssetPack();
+
+    /**
+     * @brief Деструктор класса AssetPack. Закрывает архив.
+     */
+    ~AssetPack();
+
+    AssetPack(const AssetPack &) = delete;
+    AssetPack &operator=(const AssetPack &) = delete;
+
+    /**
+     * @brief Отображает архив в память и проверяет заголовок и каталог.
+     *
+     * @param fileName Путь к архиву.
+     * @return false, если файл не открыт или поврежден.
+     */
+    bool Open(const char *fileName);
+
+    /**
+     * @brief Закрывает архив. Указатели на его данные становятся недействительными.
+     */
+    void Close();
+
+    /**
+     * @brief Ищет ресурс по имени.
+     *
+     * @param name Путь ресурса относительно корня игры.
+     * @return Запись каталога или nullptr.
+     */
+    const AssetEntry *Find(const char *name) const;
+
+    /**
+     * @brief Возвращает данные ресурса.
+     *
+     * @param entry Запись каталога этого архива.
+     */
+    const uint8_t *Data(const AssetEntry &entry) const;
+
+    /**
+     * @brief Проверяет, указывает ли указатель внутрь архива.
+     */
+    bool Contains(const void *pointer) const;
+
+    /**
+     * @brief Возвращает количество ресурсов.
+     */
+    int EntryCount() const;
+
+    /**
+     * @brief Возвращает запись каталога по номеру.
+     */
+    const AssetEntry &Entry(int index) const;
+
+private:
+    /**
+     * @brief Начало отображения или буфера с архивом.
+     */
+    const uint8_t *base;
+    /**
+     * @brief Размер архива.
+     */
+    size_t size;
+    /**
+     * @brief Каталог.
+     */
+    const AssetEntry *entries;
+    /**
+     * @brief Количество записей каталога.
+     */
+    uint32_t entryCount;
+};
+
+/**
+ * @class AssetPackWriter
+ * @brief Построитель архива ресурсов.
+ */
+class AssetPackWriter {
+public:
+    /**
+     * @brief Добавляет ресурс.
+     *
+     * @param name Путь ресурса относительно корня игры (короче assetNameSize).
+     * @param type Тип ресурса.
+     * @param params Параметры ресурса (до 7 значений, остальные нули).
+     * @param data Данные.
+     * @param size Размер данных.
+     * @return false, если имя слишком длинное или уже добавлено.
+     */
+    bool Add(const char *name, AssetType type, std::vector<uint32_t> params, const void *data, size_t size);
+
+    /**
+     * @brief Записывает архив в файл.
+     *
+     * @param fileName Путь к архиву.
+     * @return false при ошибке записи.
+     */
+    bool Write(const char *fileName) const;
+
+    /**
+     * @brief Возвращает архив в виде байтов.
+     */
+    std::vector<uint8_t> Build() const;
+
+private:
+    /**
+     * @brief Записи каталога без смещений.
+     */
+    std::vector<AssetEntry> entries;
+    /**
+     * @brief Данные ресурсов.
+     */
+    std::vector<std::vector<uint8_t>> blobs;
+};
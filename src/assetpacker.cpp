@@ -0,0 +1,184 @@
+/**
+ * @file assetpacker.cpp
+ * @brief Программа сборки архива ресурсов игры (см. assetpack.hpp).
+ *
+ * Запуск: invaders_assetpack [ROOT] [OUT]
+ *
+ * ROOT - корень игры с каталогами Graphics, Sounds и Font (по умолчанию ".."), OUT - путь
+ * архива (по умолчанию assets.pak). Игра ищет архив рядом со своим исполняемым файлом.
+ */
+
+#include "assetpack.hpp"
+#include <cstdio>
+#include <cstring>
+#include <raylib.h>
+#include <string>
+
+// Списки файлов повторены в PACKED_ASSETS в CMakeLists.txt, чтобы архив пересобирался при их изменении
+
+/**
+ * @brief Изображения игры.
+ */
+static const char *imageAssets[] = {"Graphics/alien_1.png", "Graphics/alien_2.png", "Graphics/alien_3.png",
+                                    "Graphics/mystery.png", "Graphics/spaceship.png"};
+
+/**
+ * @brief Звуковые эффекты, которые хранятся в PCM.
+ */
+static const char *waveAssets[] = {"Sounds/explosion.ogg", "Sounds/laser.ogg"};
+
+/**
+ * @brief Музыка, которая проигрывается потоком и хранится сжатой.
+ */
+static const char *musicAssets[] = {"Sounds/music.ogg"};
+
+/**
+ * @brief Шрифт интерфейса.
+ */
+static const char *fontAsset = "Font/monogram.ttf";
+
+/**
+ * @brief Размер шрифта интерфейса (как в LoadGameFont в main.cpp).
+ */
+static const int fontSize = 64;
+
+/**
+ * @brief Количество символов шрифта (ASCII 32..126, как у LoadFontEx по умолчанию).
+ */
+static const int fontGlyphCount = 95;
+
+/**
+ * @brief Отступ символов в атласе (FONT_TTF_DEFAULT_CHARS_PADDING в raylib).
+ */
+static const int fontGlyphPadding = 4;
+
+/**
+ * @brief Добавляет изображение в формате RGBA.
+ */
+
+static bool PackImage(AssetPackWriter &writer, const std::string &root, const char *name) {
+    Image image = LoadImage((root + "/" + name).c_str());
+    if (image.data == nullptr) {
+        return false;
+    }
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    bool added = writer.Add(name, ASSET_IMAGE,
+                            {(uint32_t) image.width, (uint32_t) image.height, 1, (uint32_t) image.format},
+                            image.data, GetPixelDataSize(image.width, image.height, image.format));
+    UnloadImage(image);
+    return added;
+}
+
+/**
+ * @brief Добавляет звук, декодированный в 16-битный PCM.
+ */
+
+static bool PackWave(AssetPackWriter &writer, const std::string &root, const char *name) {
+    Wave wave = LoadWave((root + "/" + name).c_str());
+    if (wave.data == nullptr) {
+        return false;
+    }
+    WaveFormat(&wave, wave.sampleRate, 16, wave.channels);
+    bool added = writer.Add(name, ASSET_WAVE, {wave.frameCount, wave.sampleRate, wave.sampleSize, wave.channels},
+                            wave.data, (size_t) wave.frameCount * wave.channels * wave.sampleSize / 8);
+    UnloadWave(wave);
+    return added;
+}
+
+/**
+ * @brief Добавляет файл без изменений.
+ */
+
+static bool PackFile(AssetPackWriter &writer, const std::string &root, const char *name, AssetType type) {
+    unsigned int size = 0;
+    unsigned char *data = LoadFileData((root + "/" + name).c_str(), &size);
+    if (data == nullptr) {
+        return false;
+    }
+    bool added = writer.Add(name, type, {}, data, size);
+    UnloadFileData(data);
+    return added;
+}
+
+/**
+ * @brief Добавляет шрифт с построенным атласом, как его строит LoadFontEx.
+ */
+
+static bool PackFont(AssetPackWriter &writer, const std::string &root, const char *name) {
+    unsigned int fileSize = 0;
+    unsigned char *fileData = LoadFileData((root + "/" + name).c_str(), &fileSize);
+    if (fileData == nullptr) {
+        return false;
+    }
+    GlyphInfo *glyphs = LoadFontData(fileData, fileSize, fontSize, nullptr, fontGlyphCount, FONT_DEFAULT);
+    UnloadFileData(fileData);
+    if (glyphs == nullptr) {
+        return false;
+    }
+    Rectangle *recs = nullptr;
+    Image atlas = GenImageFontAtlas(glyphs, &recs, fontGlyphCount, fontSize, fontGlyphPadding, 0);
+
+    size_t atlasSize = GetPixelDataSize(atlas.width, atlas.height, atlas.format);
+    std::vector<uint8_t> data(FontAtlasOffset(fontGlyphCount) + atlasSize, 0);
+    PackedGlyph *packedGlyphs = (PackedGlyph *) data.data();
+    PackedRect *packedRects = (PackedRect *) (data.data() + fontGlyphCount * sizeof(PackedGlyph));
+    for (int i = 0; i < fontGlyphCount; ++i) {
+        packedGlyphs[i] = {glyphs[i].value, glyphs[i].offsetX, glyphs[i].offsetY, glyphs[i].advanceX};
+        packedRects[i] = {recs[i].x, recs[i].y, recs[i].width, recs[i].height};
+    }
+    memcpy(data.data() + FontAtlasOffset(fontGlyphCount), atlas.data, atlasSize);
+
+    bool added = writer.Add(name, ASSET_FONT,
+                            {(uint32_t) fontSize, (uint32_t) fontGlyphCount, (uint32_t) fontGlyphPadding,
+                             (uint32_t) atlas.width, (uint32_t) atlas.height, (uint32_t) atlas.format},
+                            data.data(), data.size());
+    UnloadImage(atlas);
+    MemFree(recs);
+    UnloadFontData(glyphs, fontGlyphCount);
+    return added;
+}
+
+/**
+ * @brief Главная функция программы сборки архива.
+ *
+ * @param argc Количество аргументов командной строки.
+ * @param argv Аргументы командной строки.
+ * @return 0 при успешной сборке, 1 при ошибке.
+ */
+
+int main(int argc, char **argv) {
+    std::string root = argc > 1 ? argv[1] : "..";
+    const char *output = argc > 2 ? argv[2] : "assets.pak";
+    SetTraceLogLevel(LOG_WARNING);
+
+    AssetPackWriter writer;
+    bool ok = true;
+    for (const char *name: imageAssets) {
+        ok = PackImage(writer, root, name) && ok;
+    }
+    for (const char *name: waveAssets) {
+        ok = PackWave(writer, root, name) && ok;
+    }
+    for (const char *name: musicAssets) {
+        ok = PackFile(writer, root, name, ASSET_MUSIC) && ok;
+    }
+    ok = PackFont(writer, root, fontAsset) && ok;
+    if (!ok) {
+        fprintf(stderr, "failed to pack assets from %s\n", root.c_str());
+        return 1;
+    }
+    if (!writer.Write(output)) {
+        perror(output);
+        return 1;
+    }
+
+    AssetPack pack;
+    if (!pack.Open(output)) {
+        fprintf(stderr, "written pack %s does not verify\n", output);
+        return 1;
+    }
+    for (int i = 0; i < pack.EntryCount(); ++i) {
+        printf("%-24s %8llu bytes\n", pack.Entry(i).name, (unsigned long long) pack.Entry(i).size);
+    }
+    return 0;
+}
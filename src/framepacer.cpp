@@ -0,0 +1,319 @@
+/**
+ * @file framepacer.cpp
+ * @brief Файл реализации классов FramePacer, LatencyHistogram и StepAccumulator.
+ */
+
+#include "framepacer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+/**
+ * @brief Время активного ожидания в конце ожидания кадра в секундах.
+ *
+ * Сон ОС может длиться дольше заказанного примерно на миллисекунду, поэтому последние
+ * 2 мс поток не спит, а проверяет часы.
+ */
+static const double spinThreshold = 0.002;
+
+/**
+ * @brief Запас времени до показа в режиме низкой задержки в секундах.
+ */
+static const double latencyMargin = 0.002;
+
+/**
+ * @brief Скорость, с которой оценка времени работы кадра снижается к измеренному значению.
+ */
+static const double workDecay = 0.05;
+
+/**
+ * @brief Конструктор класса LatencyHistogram.
+ *
+ * @param bucketWidth Ширина корзины в секундах.
+ * @param bucketCount Количество корзин.
+ */
+
+LatencyHistogram::LatencyHistogram(double bucketWidth, int bucketCount) {
+    this->bucketWidth = bucketWidth;
+    buckets.assign(bucketCount, 0);
+    count = 0;
+    sum = 0.0;
+    max = 0.0;
+}
+
+/**
+ * @brief Добавляет значение.
+ *
+ * @param seconds Задержка в секундах.
+ */
+
+void LatencyHistogram::Add(double seconds) {
+    int bucket = seconds > 0 ? (int) std::min(seconds / bucketWidth, (double) buckets.size() - 1) : 0;
+    buckets[bucket]++;
+    count++;
+    sum += seconds;
+    max = std::max(max, seconds);
+}
+
+/**
+ * @brief Удаляет все значения.
+ */
+
+void LatencyHistogram::Reset() {
+    std::fill(buckets.begin(), buckets.end(), 0);
+    count = 0;
+    sum = 0.0;
+    max = 0.0;
+}
+
+/**
+ * @brief Возвращает значение, не превышаемое заданной долей значений.
+ *
+ * @param fraction Доля от 0 до 1.
+ * @return Верхняя граница корзины в секундах или 0, если значений нет.
+ */
+
+double LatencyHistogram::Percentile(double fraction) const {
+    if (count == 0) {
+        return 0.0;
+    }
+    long long seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= fraction * count) {
+            return (i + 1) * bucketWidth;
+        }
+    }
+    return buckets.size() * bucketWidth;
+}
+
+/**
+ * @brief Возвращает количество значений.
+ */
+
+long long LatencyHistogram::Count() const {
+    return count;
+}
+
+/**
+ * @brief Возвращает среднее значение в секундах.
+ */
+
+double LatencyHistogram::Mean() const {
+    return count > 0 ? sum / count : 0.0;
+}
+
+/**
+ * @brief Возвращает наибольшее значение в секундах.
+ */
+
+double LatencyHistogram::Max() const {
+    return max;
+}
+
+/**
+ * @brief Возвращает ширину корзины в секундах.
+ */
+
+double LatencyHistogram::BucketWidth() const {
+    return bucketWidth;
+}
+
+/**
+ * @brief Возвращает количество значений в каждой корзине.
+ */
+
+const std::vector<long long> &LatencyHistogram::Buckets() const {
+    return buckets;
+}
+
+/**
+ * @brief Конструктор класса FramePacer.
+ *
+ * @param period Период кадров в секундах.
+ */
+
+FramePacer::FramePacer(double period) {
+    this->period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(period));
+    lowLatency = false;
+    started = false;
+    workEstimate = 0.0;
+    missedFrames = 0;
+}
+
+/**
+ * @brief Включает или выключает режим низкой задержки.
+ */
+
+void FramePacer::SetLowLatency(bool lowLatency) {
+    this->lowLatency = lowLatency;
+}
+
+/**
+ * @brief Проверяет, включен ли режим низкой задержки.
+ */
+
+bool FramePacer::LowLatency() const {
+    return lowLatency;
+}
+
+/**
+ * @brief Начинает отсчет кадров заново (например, после паузы).
+ */
+
+void FramePacer::Reset() {
+    started = false;
+}
+
+/**
+ * @brief Ждет начала следующего кадра.
+ *
+ * Если кадр опоздал больше чем на период, отсчет начинается заново от текущего момента,
+ * а не пытается догнать пропущенные границы.
+ */
+
+void FramePacer::WaitForFrame() {
+    Clock::time_point now = Clock::now();
+    if (!started) {
+        started = true;
+        nextFrame = now + period;
+        presentDeadline = now;
+        lastPresent = now;
+        return;
+    }
+
+    Clock::time_point target = nextFrame;
+    if (lowLatency) {
+        // Следующий показ - через период после запланированного или, если кадр опоздал, после фактического
+        Clock::time_point previous = presentDeadline;
+        presentDeadline = std::max(presentDeadline, lastPresent) + period;
+        if (lastPresent > previous + period / 2) {
+            missedFrames++;
+        }
+        double lead = workEstimate + latencyMargin;
+        target = presentDeadline - std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(lead));
+    }
+    WaitUntil(target);
+    now = Clock::now();
+    pacingError.Add(std::max(0.0, Seconds(now - target)));
+
+    if (!lowLatency) {
+        if (now > nextFrame + period) {
+            missedFrames++;
+            nextFrame = now + period;
+        } else {
+            nextFrame += period;
+        }
+    }
+}
+
+/**
+ * @brief Отмечает момент опроса ввода.
+ */
+
+void FramePacer::MarkSample() {
+    sampleTime = Clock::now();
+}
+
+/**
+ * @brief Отмечает конец работы кадра перед показом.
+ */
+
+void FramePacer::MarkSubmit() {
+    submitTime = Clock::now();
+}
+
+/**
+ * @brief Отмечает показ кадра и записывает задержку от опроса ввода.
+ *
+ * Оценка времени работы растет сразу до измеренного значения и снижается медленно, чтобы
+ * режим низкой задержки не опаздывал к показу после одного быстрого кадра.
+ */
+
+void FramePacer::MarkPresent() {
+    lastPresent = Clock::now();
+    latency.Add(Seconds(lastPresent - sampleTime));
+    double work = Seconds(submitTime - sampleTime);
+    workEstimate = work > workEstimate ? work : workEstimate + (work - workEstimate) * workDecay;
+}
+
+/**
+ * @brief Ждет момента deadline: спит до deadline - spinThreshold, затем ждет активно.
+ */
+
+void FramePacer::WaitUntil(Clock::time_point deadline) {
+    Clock::time_point wake = deadline - std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(spinThreshold));
+    if (Clock::now() < wake) {
+        std::this_thread::sleep_until(wake);
+    }
+    while (Clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+/**
+ * @brief Возвращает длительность в секундах.
+ */
+
+double FramePacer::Seconds(Clock::duration duration) {
+    return std::chrono::duration<double>(duration).count();
+}
+
+/**
+ * @brief Конструктор класса StepAccumulator.
+ *
+ * @param step Длина шага в секундах.
+ * @param maxSteps Наибольшее количество шагов за кадр.
+ */
+
+StepAccumulator::StepAccumulator(double step, int maxSteps) {
+    this->step = step;
+    this->maxSteps = std::max(maxSteps, 1);
+    catchUpFrames = 0;
+    droppedSteps = 0;
+    started = false;
+    last = 0.0;
+    accumulator = 0.0;
+}
+
+/**
+ * @brief Начинает отсчет заново: следующий кадр выполняет один шаг.
+ */
+
+void StepAccumulator::Reset() {
+    started = false;
+    accumulator = 0.0;
+}
+
+/**
+ * @brief Возвращает количество шагов, которые нужно выполнить в кадре.
+ *
+ * @param now Время начала кадра в секундах.
+ */
+
+int StepAccumulator::Advance(double now) {
+    if (!started) {
+        started = true;
+        last = now;
+        accumulator = 0.0;
+        return 1;
+    }
+    accumulator += std::max(now - last, 0.0);
+    last = now;
+
+    double steps = std::round(accumulator / step);
+    if (steps >= 1 && std::fabs(accumulator - steps * step) < step * snapShare) {
+        accumulator = steps * step;
+    }
+    int count = (int) std::floor(accumulator / step);
+    accumulator -= count * step;
+    if (count > maxSteps) {
+        droppedSteps += count - maxSteps;
+        count = maxSteps;
+    }
+    if (count > 1) {
+        catchUpFrames++;
+    }
+    return count;
+}
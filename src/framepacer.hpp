@@ -0,0 +1,293 @@
+/**
+ * @file framepacer.hpp
+ * @brief Заголовочный файл, содержащий классы FramePacer, LatencyHistogram и StepAccumulator.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+/**
+ * @class LatencyHistogram
+ * @brief Гистограмма задержек с корзинами фиксированной ширины.
+ *
+ * Значения больше последней корзины попадают в последнюю корзину.
+ */
+
+class LatencyHistogram {
+public:
+    /**
+     * @brief Конструктор класса LatencyHistogram.
+     *
+     * @param bucketWidth Ширина корзины в секундах.
+     * @param bucketCount Количество корзин.
+     */
+    LatencyHistogram(double bucketWidth = 0.00025, int bucketCount = 128);
+
+    /**
+     * @brief Добавляет значение.
+     *
+     * @param seconds Задержка в секундах.
+     */
+    void Add(double seconds);
+
+    /**
+     * @brief Удаляет все значения.
+     */
+    void Reset();
+
+    /**
+     * @brief Возвращает значение, не превышаемое заданной долей значений.
+     *
+     * @param fraction Доля от 0 до 1.
+     * @return Верхняя граница корзины в секундах или 0, если значений нет.
+     */
+    double Percentile(double fraction) const;
+
+    /**
+     * @brief Возвращает количество значений.
+     */
+    long long Count() const;
+
+    /**
+     * @brief Возвращает среднее значение в секундах.
+     */
+    double Mean() const;
+
+    /**
+     * @brief Возвращает наибольшее значение в секундах.
+     */
+    double Max() const;
+
+    /**
+     * @brief Возвращает ширину корзины в секундах.
+     */
+    double BucketWidth() const;
+
+    /**
+     * @brief Возвращает количество значений в каждой корзине.
+     */
+    const std::vector<long long> &Buckets() const;
+
+private:
+    /**
+     * @brief Ширина корзины.
+     */
+    double bucketWidth;
+    /**
+     * @brief Количество значений в корзинах.
+     */
+    std::vector<long long> buckets;
+    /**
+     * @brief Количество значений.
+     */
+    long long count;
+    /**
+     * @brief Сумма значений.
+     */
+    double sum;
+    /**
+     * @brief Наибольшее значение.
+     */
+    double max;
+};
+
+/**
+ * @class FramePacer
+ * @brief Ограничитель частоты кадров с поздним опросом ввода и измерением задержки.
+ *
+ * Порядок вызовов в кадре: WaitForFrame, опрос ввода, MarkSample, симуляция и отрисовка,
+ * MarkSubmit, EndDrawing, MarkPresent. Ожидание делится на сон и досрочное пробуждение с активным
+ * ожиданием последних spinThreshold секунд: сон ОС неточен, а активное ожидание всего кадра
+ * занимает ядро.
+ *
+ * В обычном режиме кадр начинается на границе периода, и ввод опрашивается сразу после ожидания.
+ * В режиме низкой задержки (вместе с вертикальной синхронизацией, при которой EndDrawing ждет
+ * обратный ход луча) кадр начинается как можно позже: за оценку времени работы кадра и запас
+ * до следующего показа. Тогда ввод не ждет в очереди показа.
+ *
+ * Задержка от опроса ввода до показа кадра (MarkSample - MarkPresent) собирается в гистограмму.
+ */
+
+class FramePacer {
+public:
+    /**
+     * @brief Конструктор класса FramePacer.
+     *
+     * @param period Период кадров в секундах.
+     */
+    explicit FramePacer(double period = 1.0 / 60.0);
+
+    /**
+     * @brief Включает или выключает режим низкой задержки.
+     */
+    void SetLowLatency(bool lowLatency);
+
+    /**
+     * @brief Проверяет, включен ли режим низкой задержки.
+     */
+    bool LowLatency() const;
+
+    /**
+     * @brief Начинает отсчет кадров заново (например, после паузы).
+     */
+    void Reset();
+
+    /**
+     * @brief Ждет начала следующего кадра.
+     */
+    void WaitForFrame();
+
+    /**
+     * @brief Отмечает момент опроса ввода.
+     */
+    void MarkSample();
+
+    /**
+     * @brief Отмечает конец работы кадра перед показом.
+     */
+    void MarkSubmit();
+
+    /**
+     * @brief Отмечает показ кадра и записывает задержку от опроса ввода.
+     */
+    void MarkPresent();
+
+    /**
+     * @brief Задержка от опроса ввода до показа кадра.
+     */
+    LatencyHistogram latency;
+
+    /**
+     * @brief Отклонение начала кадра от запланированного момента.
+     */
+    LatencyHistogram pacingError;
+
+    /**
+     * @brief Оценка времени работы кадра в секундах (от опроса ввода до MarkSubmit).
+     */
+    double workEstimate;
+
+    /**
+     * @brief Количество кадров, начатых позже следующего периода (пропущенных границ).
+     */
+    long long missedFrames;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Ждет момента deadline: спит до deadline - spinThreshold, затем ждет активно.
+     */
+    static void WaitUntil(Clock::time_point deadline);
+
+    /**
+     * @brief Возвращает длительность в секундах.
+     */
+    static double Seconds(Clock::duration duration);
+
+    /**
+     * @brief Период кадров.
+     */
+    Clock::duration period;
+    /**
+     * @brief Флаг режима низкой задержки.
+     */
+    bool lowLatency;
+    /**
+     * @brief Флаг наличия отсчета (после Reset первый кадр начинается сразу).
+     */
+    bool started;
+    /**
+     * @brief Запланированное начало следующего кадра в обычном режиме.
+     */
+    Clock::time_point nextFrame;
+    /**
+     * @brief Запланированный момент показа текущего кадра в режиме низкой задержки.
+     */
+    Clock::time_point presentDeadline;
+    /**
+     * @brief Момент последнего показа.
+     */
+    Clock::time_point lastPresent;
+    /**
+     * @brief Момент опроса ввода текущего кадра.
+     */
+    Clock::time_point sampleTime;
+    /**
+     * @brief Момент конца работы текущего кадра.
+     */
+    Clock::time_point submitTime;
+};
+
+/**
+ * @class StepAccumulator
+ * @brief Накопитель времени для шагов симуляции фиксированной длины.
+ *
+ * Время между кадрами накапливается, и кадр выполняет столько шагов, сколько целых шагов
+ * накопилось, поэтому медленный кадр не замедляет игру: следующий кадр догоняет ее несколькими
+ * шагами. Время, отличающееся от целого числа шагов меньше чем на snapShare шага, округляется
+ * до него, иначе колебания начала кадров давали бы то 0, то 2 шага на кадр. Больше maxSteps
+ * шагов за кадр не выполняется, остаток отбрасывается, чтобы долгие шаги не копили отставание.
+ */
+
+class StepAccumulator {
+public:
+    /**
+     * @brief Конструктор класса StepAccumulator.
+     *
+     * @param step Длина шага в секундах.
+     * @param maxSteps Наибольшее количество шагов за кадр.
+     */
+    explicit StepAccumulator(double step = 1.0 / 60.0, int maxSteps = 4);
+
+    /**
+     * @brief Начинает отсчет заново: следующий кадр выполняет один шаг.
+     */
+    void Reset();
+
+    /**
+     * @brief Возвращает количество шагов, которые нужно выполнить в кадре.
+     *
+     * @param now Время начала кадра в секундах.
+     */
+    int Advance(double now);
+
+    /**
+     * @brief Доля шага, в пределах которой время округляется до целого числа шагов.
+     */
+    constexpr static double snapShare = 0.1;
+
+    /**
+     * @brief Количество кадров, выполнивших больше одного шага.
+     */
+    long long catchUpFrames;
+
+    /**
+     * @brief Количество отброшенных шагов сверх maxSteps.
+     */
+    long long droppedSteps;
+
+private:
+    /**
+     * @brief Длина шага.
+     */
+    double step;
+    /**
+     * @brief Наибольшее количество шагов за кадр.
+     */
+    int maxSteps;
+    /**
+     * @brief Флаг наличия отсчета.
+     */
+    bool started;
+    /**
+     * @brief Время начала предыдущего кадра.
+     */
+    double last;
+    /**
+     * @brief Накопленное и еще не выполненное время.
+     */
+    double accumulator;
+};
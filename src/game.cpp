@@ -4,20 +4,63 @@
  */
 
 #include "game.hpp"
+#include "platform.hpp"
 #include <iostream>
 #include <fstream>
+#include <ctime>
+#include <cmath>
+#include <algorithm>
 
 /**
  * @brief Конструктор класса Game.
  *
  * Инициализирует игровой объект, загружает ресурсы и устанавливает начальные параметры.
+ *
+ * @param headless true, если игра работает без окна и не пишет таблицу рекордов.
+ * @param player Имя игрока в таблице рекордов.
  */
 
-Game::Game() {
-    music = LoadMusicStream("../Sounds/music.ogg");
-    explosionSound = LoadSound("../Sounds/explosion.ogg");
+Game::Game(bool headless, const std::string &player) {
+    this->headless = headless;
+    this->player = player;
+    formationRows = alienRows;
+    formationColumns = alienColumns;
+    formationSpacing = alienSpacing;
+    stressShields = 0;
+    stressFireTicks = 0;
+    alienVolley = 1;
+    jobs.reset(new JobSystem(1));
+    // Частицы только рисуются, поэтому без окна пул не создается
+    if (!headless) {
+        particles.reset(new ParticlePool(particleCapacity));
+    }
+    spawnTimer = 0;
+    alienFireTimer = 0;
+    scriptEvents = 0;
+    highscore = 0;
+    // GetRandomValue(0, INT_MAX) переполняет int при вычислении длины отрезка
+    rng.seed(std::random_device()());
+    music = LoadGameMusic("../Sounds/music.ogg");
+    explosionSound = LoadGameSound("../Sounds/explosion.ogg");
     PlayMusicStream(music);
     InitGame();
+    // Результаты игр пишутся в таблицу рекордов в отдельном потоке; до его запуска таблица
+    // используется только здесь
+    if (!headless) {
+        leaderboard.reset(new Leaderboard());
+        if (leaderboard->Open("leaderboard")) {
+            ImportHighscoreFile();
+            highscore = leaderboard->BestScore();
+        } else {
+            std::cerr << "Failed to open leaderboard." << std::endl;
+            leaderboard.reset();
+        }
+        recordWorker.reset(new GameEventWorker(recordEventCapacity, [this](const GameEvent *events, int count) {
+            for (int i = 0; leaderboard && i < count; ++i) {
+                leaderboard->Add(this->player.c_str(), events[i].score, events[i].value, time(nullptr));
+            }
+        }));
+    }
 }
 
 /**
@@ -27,49 +70,80 @@ Game::Game() {
  */
 
 Game::~Game() {
-    Alien::UnloadImages();
-    UnloadMusicStream(music);
-    UnloadSound(explosionSound);
+    // Поток рекорда успевает сохранить оставшиеся события
+    recordWorker.reset();
+    // Незаконченная игра тоже попадает в таблицу рекордов
+    if (leaderboard && run && score > 0) {
+        leaderboard->Add(player.c_str(), score, level, time(nullptr));
+    }
+    // Без окна изображения инопланетян общие для всех экземпляров и не занимают видеопамять
+    if (!headless) {
+        Alien::UnloadImages();
+    }
+    UnloadGameMusic(music);
+    UnloadGameSound(explosionSound);
 }
 
 /**
  * @brief Обновляет состояние игры.
  *
  * Вызывается в основном игровом цикле для обновления состояния всех игровых элементов.
+ * Каждый вызов продвигает время симуляции на один тик. События тика доступны через Events()
+ * и при present == false.
+ *
+ * @param present false при повторной симуляции уже показанных тиков (перемотка, откат):
+ *                звуки, частицы и запись результата игры пропускаются.
  */
 
-void Game::Update() {
+void Game::Update(bool present) {
+    events.clear();
+    simulationTime += tickDuration;
+    if (particles && present) {
+        particles->Update();
+    }
     if (run) {
 
-        double currentTime = GetTime();
-        if (currentTime - timeLastSpawn > mysteryShipSpawnInterval) {
-            mysteryship.Spawn();
-            timeLastSpawn = GetTime();
-            mysteryShipSpawnInterval = GetRandomValue(10, 20);
+        // Игровые события приходят из колеса таймеров, а не проверкой прошедшего времени в каждом тике
+        bool alienFireDue = false;
+        script.Tick(scriptActions);
+        ApplyScriptActions();
+        timers.Advance(firedTimers);
+        for (const TimerEvent &event: firedTimers) {
+            if (event.kind == TIMER_MYSTERY_SHIP) {
+                mysteryship.Spawn(RandomValue(0, 1));
+                timeLastSpawn = simulationTime;
+                mysteryShipSpawnInterval = RandomValue(10, 20);
+                spawnTimer = timers.Schedule(TickAt(mysteryShipSpawnInterval), TIMER_MYSTERY_SHIP);
+            } else if (event.kind == TIMER_ALIEN_FIRE) {
+                alienFireDue = true;
+            }
         }
 
-        for (auto &laser: spaceship.lasers) {
-            laser.Update();
+        UpdateLasers(spaceship.lasers);
+        if (partner) {
+            UpdateLasers(partner->lasers);
         }
 
         MoveAliens();
 
-        AlienShootLaser();
-
-        for (auto &laser: alienLasers) {
-            laser.Update();
+        if (alienFireDue) {
+            AlienShootLaser();
         }
 
+        UpdateLasers(alienLasers);
+
         DeleteInactiveLasers();
 
         mysteryship.Update();
 
         CheckForCollisions();
-    } else {
-        if (IsKeyDown(KEY_ENTER)) {
-            Reset();
-            InitGame();
-        }
+
+        ScoreEvents();
+
+        SignalScriptEvents();
+    }
+    if (present) {
+        PresentEvents();
     }
 }
 
@@ -84,6 +158,13 @@ void Game::Draw() {
         laser.Draw();
     }
 
+    if (partner) {
+        partner->Draw(SKYBLUE);
+        for (auto &laser: partner->lasers) {
+            laser.Draw();
+        }
+    }
+
     for (auto &obstacle: obstacles) {
         obstacle.Draw();
     }
@@ -97,6 +178,10 @@ void Game::Draw() {
     }
 
     mysteryship.Draw();
+
+    if (particles) {
+        particles->Draw();
+    }
 }
 
 /**
@@ -106,15 +191,206 @@ void Game::Draw() {
  */
 
 void Game::HandleInput() {
-    if (run) {
-        if (IsKeyDown(KEY_LEFT)) {
-            spaceship.MoveLeft();
-        } else if (IsKeyDown(KEY_RIGHT)) {
-            spaceship.MoveRight();
-        } else if (IsKeyDown(KEY_SPACE)) {
-            spaceship.FireLaser();
+    ApplyInput(KeyboardInput());
+}
+
+/**
+ * @brief Возвращает команды, заданные клавиатурой.
+ *
+ * @return Комбинация флагов InputFlags.
+ */
+
+int Game::KeyboardInput() {
+    int input = 0;
+    if (IsKeyDown(KEY_LEFT)) {
+        input |= INPUT_LEFT;
+    }
+    if (IsKeyDown(KEY_RIGHT)) {
+        input |= INPUT_RIGHT;
+    }
+    if (IsKeyDown(KEY_SPACE)) {
+        input |= INPUT_FIRE;
+    }
+    if (IsKeyDown(KEY_ENTER)) {
+        input |= INPUT_RESTART;
+    }
+    return input;
+}
+
+/**
+ * @brief Клавиши игрока и соответствующие им команды.
+ */
+
+static const int keyboardKeys[][2] = {{KEY_LEFT, INPUT_LEFT}, {KEY_RIGHT, INPUT_RIGHT}, {KEY_SPACE, INPUT_FIRE},
+                                      {KEY_ENTER, INPUT_RESTART}};
+
+/**
+ * @brief Переносит нажатия и отпускания клавиш из последнего опроса событий окна в очередь ввода.
+ *
+ * Вызывается после каждого опроса (EndDrawing, PollInputEvents). Нажатия берутся из очереди
+ * нажатий raylib в порядке их прихода, поэтому нажатие, отпущенное до опроса, тоже попадает в очередь.
+ *
+ * @param queue Очередь ввода.
+ * @param time Время опроса.
+ * @param player Номер игрока, которому принадлежит клавиатура.
+ */
+
+void Game::CaptureKeyboard(InputQueue &queue, double time, int player) {
+    int pressed = 0;
+    int key;
+    while ((key = GetKeyPressed()) != 0) {
+        for (auto &binding: keyboardKeys) {
+            if (binding[0] == key) {
+                queue.Push({time, player, binding[1], true});
+                pressed |= binding[1];
+            }
         }
     }
+    for (auto &binding: keyboardKeys) {
+        // Нажатие и отпускание между двумя опросами видны только как нажатие в очереди и отпущенная клавиша
+        if (IsKeyReleased(binding[0]) || ((pressed & binding[1]) && IsKeyUp(binding[0]))) {
+            queue.Push({time, player, binding[1], false});
+        }
+    }
+}
+
+/**
+ * @brief Применяет команды игрока.
+ *
+ * Движение и выстрел выполняются в одном тике; одновременные влево и вправо гасят друг друга
+ * (очередь ввода заранее оставляет только последнее нажатое направление). После окончания игры
+ * команда INPUT_RESTART начинает новую игру.
+ *
+ * @param input Комбинация флагов InputFlags.
+ * @param player Номер игрока (1 - второй игрок совместного режима).
+ */
+
+void Game::ApplyInput(int input, int player) {
+    if (!run) {
+        if (input & INPUT_RESTART) {
+            Reset();
+            InitGame();
+        }
+        return;
+    }
+    if (player == 1 && !partner) {
+        return;
+    }
+    Spaceship &ship = player == 1 ? *partner : spaceship;
+    int direction = input & (INPUT_LEFT | INPUT_RIGHT);
+    if (direction == INPUT_LEFT) {
+        ship.MoveLeft();
+    } else if (direction == INPUT_RIGHT) {
+        ship.MoveRight();
+    }
+    if (input & INPUT_FIRE) {
+        ship.FireLaser(simulationTime);
+    }
+}
+
+/**
+ * @brief Включает совместный режим: на поле появляется корабль второго игрока.
+ *
+ * Жизни и счет у игроков общие.
+ */
+
+void Game::EnableCoop() {
+    if (!partner) {
+        partner.reset(new Spaceship());
+    }
+    PlaceCoopShips();
+}
+
+/**
+ * @brief Включает нагрузочный режим и начинает игру заново.
+ *
+ * Формация из заданного количества инопланетян сжимается по ширине экрана, щиты ставятся
+ * в несколько рядов, инопланетяне стреляют залпами. Сценарий уровня остается прежним.
+ * Столбцов примерно вдвое больше, чем рядов, поэтому формация остается над щитами.
+ *
+ * @param aliens Количество инопланетян (не больше ShooterIndex::maxRows рядов).
+ * @param shields Количество щитов.
+ * @param fireTicks Интервал залпов инопланетян в тиках.
+ * @param volley Количество выстрелов в залпе.
+ */
+
+void Game::EnableStress(int aliens, int shields, int fireTicks, int volley) {
+    aliens = std::max(aliens, 1);
+    int columns = std::max(alienColumns, (int) std::ceil(std::sqrt(aliens * 2.0)));
+    formationRows = std::min((aliens + columns - 1) / columns, ShooterIndex::maxRows);
+    formationColumns = (aliens + formationRows - 1) / formationRows;
+    formationSpacing = std::max(1, std::min(alienSpacing, (ScreenWidth() - 150) / formationColumns));
+    stressShields = std::max(shields, 0);
+    stressFireTicks = std::max(fireTicks, 1);
+    alienVolley = std::max(volley, 1);
+    InitGame();
+}
+
+/**
+ * @brief Задает количество потоков для параллельных частей тика.
+ *
+ * Результаты параллельных частей сводятся в том же порядке, что и при одном потоке, поэтому
+ * игра проходит одинаково при любом количестве потоков.
+ *
+ * @param threads Количество потоков вместе с вызывающим (1 - без дополнительных потоков).
+ */
+
+void Game::SetThreads(int threads) {
+    if (threads != jobs->Threads()) {
+        jobs.reset(new JobSystem(threads));
+    }
+}
+
+/**
+ * @brief Задает долю выпускаемых частиц взрывов и обломков.
+ *
+ * @param density Доля от 0 до 1; без окна частиц нет, и вызов ничего не делает.
+ */
+
+void Game::SetParticleDensity(float density) {
+    if (particles) {
+        particles->SetDensity(density);
+    }
+}
+
+/**
+ * @brief Возвращает события последнего тика в порядке, в котором они произошли.
+ */
+
+const std::vector<GameEvent> &Game::Events() const {
+    return events;
+}
+
+/**
+ * @brief Расставляет корабли совместного режима по обе стороны от центра.
+ */
+
+void Game::PlaceCoopShips() {
+    float width = spaceship.getRect().width;
+    spaceship.SetX(ScreenWidth() / 3.0f - width / 2);
+    partner->SetX(ScreenWidth() * 2 / 3.0f - width / 2);
+}
+
+/**
+ * @brief Задает начальное значение генератора случайных чисел игры.
+ *
+ * @param seed Начальное значение.
+ */
+
+void Game::Seed(unsigned int seed) {
+    rng.seed(seed);
+}
+
+/**
+ * @brief Возвращает случайное целое число из генератора игры.
+ *
+ * @param min Нижняя граница (включительно).
+ * @param max Верхняя граница (включительно).
+ * @return Случайное число из отрезка [min, max].
+ */
+
+int Game::RandomValue(int min, int max) {
+    return std::uniform_int_distribution<int>(min, max)(rng);
 }
 
 /**
@@ -130,6 +406,16 @@ void Game::DeleteInactiveLasers() {
         }
     }
 
+    if (partner) {
+        for (auto it = partner->lasers.begin(); it != partner->lasers.end();) {
+            if (!it->active) {
+                it = partner->lasers.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
     for (auto it = alienLasers.begin(); it != alienLasers.end();) {
         if (!it->active) {
             it = alienLasers.erase(it);
@@ -142,16 +428,27 @@ void Game::DeleteInactiveLasers() {
 /**
  * @brief Создает вектор препятствий для игры.
  *
+ * Препятствия расставляются с равными промежутками.
+ *
+ * @param count Количество препятствий.
  * @return Вектор препятствий.
  */
 
-std::vector <Obstacle> Game::CreateObstacles() {
+std::vector <Obstacle> Game::CreateObstacles(int count) {
+    std::vector <Obstacle> obstacles;
     int obstacleWidth = Obstacle::grid[0].size() * 3;
-    float gap = (GetScreenWidth() - (4 * obstacleWidth)) / 5;
-
-    for (int i = 0; i < 4; i++) {
-        float offsetX = (i + 1) * gap + i * obstacleWidth;
-        obstacles.push_back(Obstacle({offsetX, float(GetScreenHeight() - 200)}));
+    int obstacleHeight = Obstacle::grid.size() * 3;
+    // Больше 4 препятствий ставятся рядами по 8 снизу вверх
+    int perRow = count <= 4 ? count : 8;
+
+    for (int first = 0; first < count; first += perRow) {
+        int inRow = std::min(perRow, count - first);
+        float gap = (ScreenWidth() - (inRow * obstacleWidth)) / (inRow + 1);
+        float offsetY = ScreenHeight() - 200 - (first / perRow) * (obstacleHeight + 10);
+        for (int i = 0; i < inRow; i++) {
+            float offsetX = (i + 1) * gap + i * obstacleWidth;
+            obstacles.push_back(Obstacle({offsetX, offsetY}));
+        }
     }
     return obstacles;
 }
@@ -159,48 +456,94 @@ std::vector <Obstacle> Game::CreateObstacles() {
 /**
  * @brief Создает вектор инопланетян для игры.
  *
+ * @param pattern Шаблон заполнения ячеек формации (FormationPattern).
  * @return Вектор инопланетян.
  */
 
-std::vector <Alien> Game::CreateAliens() {
+std::vector <Alien> Game::CreateAliens(int pattern) {
     std::vector <Alien> aliens;
-    for (int row = 0; row < 5; row++) {
-        for (int column = 0; column < 11; column++) {
-
-            int alienType;
-            if (row == 0) {
-                alienType = 3;
-            } else if (row == 1 || row == 2) {
-                alienType = 2;
-            } else {
-                alienType = 1;
+    formationOrigin = {75, 110};
+    for (int row = 0; row < formationRows; row++) {
+        for (int column = 0; column < formationColumns; column++) {
+            if (!FormationCell(pattern, row, column, formationColumns)) {
+                continue;
             }
 
-            float x = 75 + column * 55;
-            float y = 110 + row * 55;
-            aliens.push_back(Alien(alienType, {x, y}));
+            float x = formationOrigin.x + column * formationSpacing;
+            float y = formationOrigin.y + row * formationSpacing;
+            aliens.push_back(Alien(AlienTypeForRow(row), {x, y}, row, column));
         }
     }
     return aliens;
 }
 
+/**
+ * @brief Заполняет пустые ячейки ряда формации новыми инопланетянами.
+ *
+ * Новые инопланетяне встают в ячейки текущей позиции формации.
+ *
+ * @param row Ряд формации.
+ */
+
+void Game::ReinforceRow(int row) {
+    if (row < 0 || row >= formationRows) {
+        return;
+    }
+    int alienType = AlienTypeForRow(row);
+    for (int column = 0; column < formationColumns; column++) {
+        if (alienSlots[row * formationColumns + column] < 0) {
+            float x = formationOrigin.x + column * formationSpacing;
+            float y = formationOrigin.y + row * formationSpacing;
+            aliens.push_back(Alien(alienType, {x, y}, row, column));
+        }
+    }
+    IndexAliens();
+}
+
+/**
+ * @brief Возвращает тип инопланетян ряда формации.
+ *
+ * Общий для создания формации, подкреплений и зрителя потока состояния, чтобы они не расходились.
+ *
+ * @param row Ряд формации.
+ * @return Тип инопланетянина (1-3).
+ */
+
+int Game::AlienTypeForRow(int row) {
+    if (row == 0) {
+        return 3;
+    } else if (row == 1 || row == 2) {
+        return 2;
+    }
+    return 1;
+}
+
 /**
  * @brief Перемещает всех инопланетян в текущем направлении.
  */
 
 void Game::MoveAliens() {
+    int edgeHits = 0;
     for (auto &alien: aliens) {
-        if (alien.position.x + alien.alienImages[alien.type - 1].width > GetScreenWidth() - 25) {
+        if (alien.position.x + alien.alienImages[alien.type - 1].width > ScreenWidth() - 25) {
             aliensDirection = -1;
-            MoveDownAliens(4);
+            edgeHits++;
         }
         if (alien.position.x < 25) {
             aliensDirection = 1;
-            MoveDownAliens(4);
+            edgeHits++;
         }
+    }
 
+    // Формация сдвигается целиком, чтобы ячейки оставались на сетке formationOrigin; высокая формация
+    // нагрузочного режима опускается за отскок так же, как обычная
+    if (edgeHits > 0) {
+        MoveDownAliens(std::max(1, 4 * edgeHits * alienRows / formationRows));
+    }
+    for (auto &alien: aliens) {
         alien.Update(aliensDirection);
     }
+    formationOrigin.x += aliensDirection;
 }
 
 /**
@@ -213,6 +556,7 @@ void Game::MoveDownAliens(int distance) {
     for (auto &alien: aliens) {
         alien.position.y += distance;
     }
+    formationOrigin.y += distance;
 }
 
 /**
@@ -220,114 +564,408 @@ void Game::MoveDownAliens(int distance) {
  */
 
 void Game::AlienShootLaser() {
-    double currentTime = GetTime();
-    if (currentTime - timeLastAlienFired >= alienLaserShootInterval && !aliens.empty()) {
-        int randomIndex = GetRandomValue(0, aliens.size() - 1);
-        Alien &alien = aliens[randomIndex];
+    if (shooters.ActiveColumnCount() == 0) {
+        return;
+    }
+    for (int shot = 0; shot < alienVolley; ++shot) {
+        int column = -1;
+        if (alienShotCount % 3 == 2) {
+            // В совместном режиме прицельные выстрелы достаются кораблям по очереди
+            Spaceship &target = partner && (alienShotCount / 3) % 2 == 1 ? *partner : spaceship;
+            Rectangle ship = target.getRect();
+            column = ColumnAt(ship.x + ship.width / 2);
+        }
+        if (shooters.BottomRow(column) < 0) {
+            column = shooters.ActiveColumn(RandomValue(0, shooters.ActiveColumnCount() - 1));
+        }
+        Alien &alien = *BottomAlien(column);
         alienLasers.push_back(Laser({alien.position.x + alien.alienImages[alien.type - 1].width / 2,
                                      alien.position.y + alien.alienImages[alien.type - 1].height}, 6));
-        timeLastAlienFired = GetTime();
+        alienShotCount++;
+    }
+    timeLastAlienFired = simulationTime;
+    alienFireTimer = timers.Schedule(AlienFireTicks(), TIMER_ALIEN_FIRE);
+}
+
+/**
+ * @brief Перестраивает индекс столбцов формации по текущему вектору инопланетян.
+ */
+
+void Game::IndexAliens() {
+    shooters.Reset(formationRows, formationColumns);
+    alienSlots.assign(formationRows * formationColumns, -1);
+    for (int i = 0; i < (int) aliens.size(); i++) {
+        shooters.Add(aliens[i].row, aliens[i].column);
+        alienSlots[aliens[i].row * formationColumns + aliens[i].column] = i;
+    }
+}
+
+/**
+ * @brief Удаляет инопланетянина из вектора за O(1).
+ *
+ * Последний инопланетянин переносится на место удаленного, индекс столбцов обновляется.
+ *
+ * @param index Индекс инопланетянина в векторе aliens.
+ */
+
+void Game::RemoveAlien(int index) {
+    Alien &alien = aliens[index];
+    shooters.Remove(alien.row, alien.column);
+    alienSlots[alien.row * formationColumns + alien.column] = -1;
+
+    int last = aliens.size() - 1;
+    if (index != last) {
+        aliens[index] = aliens[last];
+        alienSlots[aliens[index].row * formationColumns + aliens[index].column] = index;
+    }
+    aliens.pop_back();
+    if (aliens.empty()) {
+        scriptEvents |= 1 << SCRIPT_EVENT_WAVE_CLEARED;
+    }
+}
+
+/**
+ * @brief Возвращает самого нижнего живого инопланетянина в столбце.
+ *
+ * @param column Столбец формации.
+ * @return Указатель на инопланетянина или nullptr, если столбец пуст.
+ */
+
+Alien *Game::BottomAlien(int column) {
+    int row = shooters.BottomRow(column);
+    if (row < 0) {
+        return nullptr;
+    }
+    return &aliens[alienSlots[row * formationColumns + column]];
+}
+
+/**
+ * @brief Возвращает столбец формации, находящийся над координатой x.
+ *
+ * @param x Координата по оси X.
+ * @return Номер столбца или -1, если координата вне формации.
+ */
+
+int Game::ColumnAt(float x) {
+    float offset = x - formationOrigin.x;
+    if (offset < 0) {
+        return -1;
     }
+    int column = offset / formationSpacing;
+    return column < formationColumns ? column : -1;
+}
+
+/**
+ * @brief Возвращает нижнюю границу формации инопланетян.
+ *
+ * @return Координата Y нижнего края самого нижнего живого ряда или 0, если формация пуста.
+ */
+
+float Game::FormationBottom() {
+    int row = shooters.BottomRow();
+    if (row < 0) {
+        return 0;
+    }
+    int alienType = AlienTypeForRow(row);
+    return formationOrigin.y + row * formationSpacing + Alien::alienImages[alienType - 1].height;
 }
 
 /**
  * @brief Проверяет столкновения между игровыми объектами.
+ *
+ * Широкая фаза и запросы к ней выполняются параллельно, а попадания применяются по порядку
+ * лазеров и инопланетян, поэтому результат не зависит от количества потоков.
  */
 
 void Game::CheckForCollisions() {
     // Лазеры космического корабля
 
-    for (auto &laser: spaceship.lasers) {
-        auto it = aliens.begin();
-        while (it != aliens.end()) {
-            if (CheckCollisionRecs(it->getRect(), laser.getRect())) {
-                PlaySound(explosionSound);
-                if (it->type == 1) {
-                    score += 100;
-                } else if (it->type == 2) {
-                    score += 200;
-                } else if (it->type == 3) {
-                    score += 300;
-                }
-                checkForHighscore();
-
-                it = aliens.erase(it);
-                laser.active = false;
-            } else {
-                ++it;
-            }
+    int alienCount = aliens.size();
+    alienBatch.Resize(alienCount);
+    alienBatchSlots.resize(alienCount);
+    jobs->ParallelFor(alienCount, alienJobGrain, [this](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            Rectangle rect = aliens[i].getRect();
+            alienBatch.Set(i, rect.x, rect.y, rect.width, rect.height);
+            alienBatchSlots[i] = aliens[i].row * formationColumns + aliens[i].column;
         }
+    });
+
+    CheckPlayerLasers(spaceship.lasers);
+    if (partner) {
+        CheckPlayerLasers(partner->lasers);
+    }
 
-        for (auto &obstacle: obstacles) {
-            auto it = obstacle.blocks.begin();
-            while (it != obstacle.blocks.end()) {
-                if (CheckCollisionRecs(it->getRect(), laser.getRect())) {
-                    it = obstacle.blocks.erase(it);
-                    laser.active = false;
-                } else {
-                    ++it;
+    // Инопланетные лазеры и столкновение инопланетян с кораблем
+
+    CheckShipHits(spaceship);
+    if (partner) {
+        CheckShipHits(*partner);
+    }
+
+    // Лазеры и инопланетяне против препятствий
+
+    EraseShieldBlocks();
+}
+
+/**
+ * @brief Проверяет попадания лазеров игрока в инопланетян и загадочный корабль.
+ *
+ * Использует прямоугольники инопланетян, собранные в alienBatch в начале CheckForCollisions.
+ * Каждый лазер проверяется против формации в своей задаче; сбитые инопланетяне удаляются
+ * после этого по порядку лазеров, и ячейка, уже опустевшая от предыдущего лазера, пропускается.
+ *
+ * @param lasers Лазеры одного из кораблей.
+ */
+
+void Game::CheckPlayerLasers(std::vector<Laser> &lasers) {
+    int laserCount = lasers.size();
+    if (laserHits.size() < lasers.size()) {
+        laserHits.resize(laserCount);
+    }
+    // Один лазер проверяется против всей формации, поэтому задача - один лазер
+    jobs->ParallelFor(laserCount, 1, [this, &lasers](int begin, int end) {
+        std::vector<uint64_t> mask;
+        for (int i = begin; i < end; ++i) {
+            Rectangle laserRect = lasers[i].getRect();
+            std::vector<int> &hits = laserHits[i];
+            hits.clear();
+            if (alienBatch.Collide(laserRect.x, laserRect.y, laserRect.width, laserRect.height, mask) == 0) {
+                continue;
+            }
+            for (unsigned int word = 0; word < mask.size(); ++word) {
+                for (uint64_t bits = mask[word]; bits != 0; bits &= bits - 1) {
+                    int slot = alienBatchSlots[word * 64 + __builtin_ctzll(bits)];
+                    int index = alienSlots[slot];
+                    if (index >= 0 && aliens[index].CollidesWith(laserRect)) {
+                        hits.push_back(slot);
+                    }
                 }
             }
         }
+    });
+
+    for (int i = 0; i < laserCount; ++i) {
+        Laser &laser = lasers[i];
+        for (int slot: laserHits[i]) {
+            int index = alienSlots[slot];
+            if (index < 0) {
+                continue;
+            }
+            int type = aliens[index].type;
+            int points = type == 1 ? 100 : type == 2 ? 200 : type == 3 ? 300 : 0;
+            PushEvent(EVENT_ALIEN_KILLED, type, points, aliens[index].getRect());
+            RemoveAlien(index);
+            laser.active = false;
+        }
 
-        if (CheckCollisionRecs(mysteryship.getRect(), laser.getRect())) {
+        if (mysteryship.CollidesWith(laser.getRect())) {
+            PushEvent(EVENT_MYSTERY_SHIP_KILLED, 0, 500, mysteryship.getRect());
             mysteryship.alive = false;
             laser.active = false;
-            score += 500;
-            checkForHighscore();
-            PlaySound(explosionSound);
         }
     }
+}
 
-    // Инопланетные лазеры
+/**
+ * @brief Проверяет попадания лазеров инопланетян и столкновения формации с кораблем.
+ *
+ * Проверки выполняются параллельно в флаги hitFlags, а жизни снимаются по порядку лазеров.
+ *
+ * @param ship Корабль игрока.
+ */
 
-    for (auto &laser: alienLasers) {
-        if (CheckCollisionRecs(laser.getRect(), spaceship.getRect())) {
+void Game::CheckShipHits(Spaceship &ship) {
+    int laserCount = alienLasers.size();
+    hitFlags.resize(laserCount);
+    jobs->ParallelFor(laserCount, laserJobGrain, [this, &ship](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            hitFlags[i] = ship.CollidesWith(alienLasers[i].getRect());
+        }
+    });
+    for (int i = 0; i < laserCount; ++i) {
+        Laser &laser = alienLasers[i];
+        if (laser.active && hitFlags[i]) {
             laser.active = false;
             lives--;
+            PushEvent(EVENT_PLAYER_HIT, &ship == &spaceship ? 0 : 1, lives, laser.getRect());
+            scriptEvents |= 1 << SCRIPT_EVENT_SHIP_HIT;
             if (lives == 0) {
                 GameOver();
             }
         }
+    }
 
-        for (auto &obstacle: obstacles) {
-            auto it = obstacle.blocks.begin();
-            while (it != obstacle.blocks.end()) {
-                if (CheckCollisionRecs(it->getRect(), laser.getRect())) {
-                    it = obstacle.blocks.erase(it);
-                    laser.active = false;
-                } else {
-                    ++it;
-                }
-            }
+    int alienCount = aliens.size();
+    Rectangle shipRect = ship.getRect();
+    const SpriteMask &shipMask = ship.getMask();
+    hitFlags.resize(alienCount);
+    jobs->ParallelFor(alienCount, alienJobGrain, [this, shipRect, &shipMask](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            hitFlags[i] = aliens[i].CollidesWith(shipRect, shipMask);
         }
+    });
+    if (std::find(hitFlags.begin(), hitFlags.end(), 1) != hitFlags.end()) {
+        GameOver();
     }
+}
 
-    // Столкновение инопланетян с препятствием
+/**
+ * @brief Стирает блоки щитов, задетые лазерами и инопланетянами.
+ *
+ * Щит стирается прямоугольниками в том же порядке, что и при последовательной проверке: лазеры
+ * кораблей, лазеры инопланетян, затем оставшиеся инопланетяне. Щиты не зависят друг от друга,
+ * поэтому обрабатываются параллельно, а лазер гаснет, если стер блоки хотя бы одного щита.
+ */
 
+void Game::EraseShieldBlocks() {
+    shieldLasers.clear();
+    for (auto &laser: spaceship.lasers) {
+        shieldLasers.push_back(&laser);
+    }
+    if (partner) {
+        for (auto &laser: partner->lasers) {
+            shieldLasers.push_back(&laser);
+        }
+    }
+    for (auto &laser: alienLasers) {
+        shieldLasers.push_back(&laser);
+    }
+    shieldRects.clear();
+    for (Laser *laser: shieldLasers) {
+        shieldRects.push_back(laser->getRect());
+    }
     for (auto &alien: aliens) {
-        for (auto &obstacle: obstacles) {
-            auto it = obstacle.blocks.begin();
-            while (it != obstacle.blocks.end()) {
-                if (CheckCollisionRecs(it->getRect(), alien.getRect())) {
-                    it = obstacle.blocks.erase(it);
-                } else {
-                    it++;
+        shieldRects.push_back(alien.getRect());
+    }
+
+    int shieldCount = obstacles.size();
+    int laserCount = shieldLasers.size();
+    shieldHits.assign(shieldCount * laserCount, 0);
+    jobs->ParallelFor(shieldCount, 1, [this, laserCount](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            for (int j = 0; j < (int) shieldRects.size(); ++j) {
+                if (obstacles[i].EraseBlocks(shieldRects[j]) && j < laserCount) {
+                    shieldHits[i * laserCount + j] = 1;
                 }
             }
         }
+    });
+
+    for (int i = 0; i < shieldCount; ++i) {
+        for (int j = 0; j < laserCount; ++j) {
+            if (shieldHits[i * laserCount + j]) {
+                PushEvent(EVENT_BLOCK_DESTROYED, i, 0, shieldLasers[j]->getRect());
+                shieldLasers[j]->active = false;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Добавляет событие тика с местом в центре прямоугольника.
+ *
+ * Счет в событии отмечает ScoreEvents после проверки столкновений.
+ *
+ * @param type Вид события (GameEventType).
+ * @param detail Уточнение, зависящее от вида события.
+ * @param value Значение, зависящее от вида события.
+ * @param rect Прямоугольник объекта события.
+ */
+
+void Game::PushEvent(int type, int detail, int value, Rectangle rect) {
+    GameEvent event;
+    event.tick = (uint32_t) TickAt(simulationTime);
+    event.type = type;
+    event.detail = std::min(std::max(detail, 0), 255);
+    event.value = value;
+    event.x = (int16_t) (rect.x + rect.width / 2);
+    event.y = (int16_t) (rect.y + rect.height / 2);
+    event.score = score;
+    events.push_back(event);
+}
+
+/**
+ * @brief Начисляет очки за события тика и отмечает в событиях счет после них.
+ *
+ * Проверка столкновений только записывает события, а счет и рекорд меняются здесь одним проходом.
+ */
+
+void Game::ScoreEvents() {
+    for (GameEvent &event: events) {
+        if (event.type == EVENT_ALIEN_KILLED || event.type == EVENT_MYSTERY_SHIP_KILLED) {
+            score += event.value;
+        }
+        event.score = score;
+    }
+    checkForHighscore();
+}
 
-        if (CheckCollisionRecs(alien.getRect(), spaceship.getRect())) {
-            GameOver();
+/**
+ * @brief Проигрывает звуки и выпускает частицы событий тика и отдает окончания игр потоку рекорда.
+ *
+ * Вызывается после шага симуляции, поэтому звуки, частицы и запись в таблицу рекордов не задерживают
+ * проверку столкновений.
+ */
+
+void Game::PresentEvents() {
+    for (const GameEvent &event: events) {
+        if (event.type == EVENT_ALIEN_KILLED) {
+            PlaySound(explosionSound);
+            EmitParticles(event.x, event.y, 24, 2.5f, 0xF3D83F);
+        } else if (event.type == EVENT_MYSTERY_SHIP_KILLED) {
+            EmitParticles(event.x, event.y, 64, 3.5f, 0xE62937);
+            PlaySound(explosionSound);
+        } else if (event.type == EVENT_PLAYER_HIT) {
+            EmitParticles(event.x, event.y, 32, 2.0f, 0xFFFFFF);
+        } else if (event.type == EVENT_BLOCK_DESTROYED) {
+            // Обломки щита разлетаются от места попадания
+            EmitParticles(event.x, event.y, 6, 1.2f, 0xF3D83F);
+        }
+        if (recordWorker && event.type == EVENT_GAME_OVER) {
+            recordWorker->Post(event);
         }
     }
 }
 
+/**
+ * @brief Выпускает частицы из точки; без окна ничего не делает.
+ *
+ * Частицы живут около 40 тиков.
+ *
+ * @param x Координата X точки.
+ * @param y Координата Y точки.
+ * @param count Количество частиц.
+ * @param speed Наибольшая скорость частицы в пикселях за тик.
+ * @param color Цвет в виде 0xRRGGBB.
+ */
+
+void Game::EmitParticles(float x, float y, int count, float speed, uint32_t color) {
+    if (particles) {
+        particles->Burst(x, y, count, speed, 40, color);
+    }
+}
+
+/**
+ * @brief Перемещает лазеры; лазеры обновляются параллельно диапазонами по laserJobGrain.
+ */
+
+void Game::UpdateLasers(std::vector<Laser> &lasers) {
+    jobs->ParallelFor(lasers.size(), laserJobGrain, [&lasers](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            lasers[i].Update();
+        }
+    });
+}
+
 /**
  * @brief Завершает игру, обрабатывая ситуацию "Game Over".
  */
 
 void Game::GameOver() {
+    if (run) {
+        PushEvent(EVENT_GAME_OVER, 0, level, spaceship.getRect());
+    }
     run = false;
 }
 
@@ -336,61 +974,186 @@ void Game::GameOver() {
  */
 
 void Game::InitGame() {
-    obstacles = CreateObstacles();
-    aliens = CreateAliens();
+    obstacles.clear();
+    aliens.clear();
+    IndexAliens();
+    alienLasers.clear();
+    if (particles) {
+        particles->Clear();
+    }
+    scriptEvents = 0;
+    alienShotCount = 0;
     aliensDirection = 1;
+    simulationTime = 0.0;
     timeLastAlienFired = 0.0;
     timeLastSpawn = 0.0;
     lives = 3;
     score = 0;
-    highscore = loadHighscoreFromFile();
+    // Рекорд загружается из таблицы рекордов один раз при создании игры и дальше ведется в памяти
+    if (headless) {
+        highscore = 0;
+    }
     run = true;
-    mysteryShipSpawnInterval = GetRandomValue(10, 20);
+    mysteryShipSpawnInterval = RandomValue(10, 20);
+    if (partner) {
+        PlaceCoopShips();
+    }
+    StartLevel(1);
+    ScheduleTimers();
 }
 
 /**
- * @brief Проверяет и обновляет рекордный счет.
+ * @brief Ставит таймеры появления загадочного корабля и выстрела инопланетян заново.
+ *
+ * Сроки считаются в целых тиках: событие наступает ровно через свой интервал после предыдущего,
+ * без накопления ошибки сравнения времени в числах с плавающей точкой. Если стрелять некому,
+ * таймер выстрела не ставится: живые инопланетяне появляются только в новой игре или из снимка,
+ * а тогда таймеры ставятся заново.
  */
 
-void Game::checkForHighscore() {
-    if (score > highscore) {
-        highscore = score;
-        saveHighscoreToFile(highscore);
+void Game::ScheduleTimers() {
+    uint64_t now = TickAt(simulationTime);
+    timers.Reset(now);
+    uint64_t spawnTick = TickAt(timeLastSpawn) + TickAt(mysteryShipSpawnInterval);
+    spawnTimer = timers.Schedule(spawnTick > now ? spawnTick - now : 1, TIMER_MYSTERY_SHIP);
+    alienFireTimer = 0;
+    if (shooters.ActiveColumnCount() > 0) {
+        uint64_t fireTick = TickAt(timeLastAlienFired) + AlienFireTicks();
+        alienFireTimer = timers.Schedule(fireTick > now ? fireTick - now : 1, TIMER_ALIEN_FIRE);
     }
 }
 
 /**
- * @brief Сохраняет рекордный счет в файл.
+ * @brief Возвращает номер тика для момента времени симуляции.
+ */
+
+uint64_t Game::TickAt(double time) {
+    return (uint64_t) llround(time / tickDuration);
+}
+
+/**
+ * @brief Возвращает интервал выстрелов инопланетян на текущем уровне в тиках.
  *
- * @param highscore Рекордный счет для сохранения.
+ * На первом уровне интервал равен alienLaserShootInterval, с каждым уровнем он сокращается
+ * на 3 тика, но не меньше чем до 12 тиков. В нагрузочном режиме интервал задан явно.
  */
 
-void Game::saveHighscoreToFile(int highscore) {
-    std::ofstream highscoreFile("highscore.txt");
-    if (highscoreFile.is_open()) {
-        highscoreFile << highscore;
-        highscoreFile.close();
-    } else {
-        std::cerr << "Failed to save highscore to file" << std::endl;
+int Game::AlienFireTicks() const {
+    if (stressFireTicks > 0) {
+        return stressFireTicks;
     }
+    return std::max(12, (int) TickAt(alienLaserShootInterval) - 3 * (level - 1));
 }
 
 /**
- * @brief Загружает рекордный счет из файла.
+ * @brief Ставит таймер выстрела инопланетян, если он не стоит, а стрелять уже есть кому.
  *
- * @return Загруженный рекордный счет.
+ * Отсчет начинается с текущего тика; он записывается в timeLastAlienFired, чтобы
+ * ScheduleTimers после восстановления из снимка поставил таймер на тот же тик.
+ */
+
+void Game::ArmAlienFire() {
+    if (timers.Pending(alienFireTimer) || shooters.ActiveColumnCount() == 0) {
+        return;
+    }
+    timeLastAlienFired = simulationTime;
+    alienFireTimer = timers.Schedule(AlienFireTicks(), TIMER_ALIEN_FIRE);
+}
+
+/**
+ * @brief Начинает уровень: запускает его сценарий и выполняет первые действия сценария.
+ *
+ * @param number Номер уровня.
+ */
+
+void Game::StartLevel(int number) {
+    level = number;
+    script.Start(LevelProgram(level), levelScriptFibers, scriptActions);
+    ApplyScriptActions();
+}
+
+/**
+ * @brief Выполняет действия, выданные сценарием уровня.
+ *
+ * Переход на следующий уровень выполняется после остальных действий, потому что новый сценарий
+ * выдает свои действия в тот же вектор.
+ */
+
+void Game::ApplyScriptActions() {
+    bool nextLevel = false;
+    for (const ScriptCommand &action: scriptActions) {
+        switch (action.op) {
+            case SCRIPT_FORMATION:
+                aliens = CreateAliens(action.a);
+                aliensDirection = 1;
+                IndexAliens();
+                ArmAlienFire();
+                break;
+            case SCRIPT_REINFORCE:
+                ReinforceRow(action.a);
+                ArmAlienFire();
+                break;
+            case SCRIPT_SHIELDS:
+                obstacles = CreateObstacles(stressShields > 0 ? stressShields : action.a);
+                break;
+            case SCRIPT_BOSS:
+                if (!mysteryship.alive) {
+                    mysteryship.Spawn(RandomValue(0, 1));
+                }
+                break;
+            case SCRIPT_NEXT_LEVEL:
+                nextLevel = true;
+                break;
+            default:
+                break;
+        }
+    }
+    if (nextLevel) {
+        StartLevel(level + 1);
+    }
+}
+
+/**
+ * @brief Передает сценарию события, накопленные за тик.
  */
 
-int Game::loadHighscoreFromFile() {
+void Game::SignalScriptEvents() {
+    for (int event = 0; event < scriptEventCount; ++event) {
+        if (scriptEvents & (1 << event)) {
+            script.Signal(event, scriptActions);
+            ApplyScriptActions();
+        }
+    }
+    scriptEvents = 0;
+}
+
+/**
+ * @brief Проверяет и обновляет рекордный счет в памяти; результат игры в таблицу рекордов записывает поток событий.
+ */
+
+void Game::checkForHighscore() {
+    if (score > highscore) {
+        highscore = score;
+    }
+}
+
+/**
+ * @brief Переносит рекорд из файла highscore.txt прежних версий в пустую таблицу рекордов.
+ */
+
+void Game::ImportHighscoreFile() {
+    if (leaderboard->Count() > 0) {
+        return;
+    }
     int loadedHighscore = 0;
     std::ifstream highscoreFile("highscore.txt");
     if (highscoreFile.is_open()) {
         highscoreFile >> loadedHighscore;
         highscoreFile.close();
-    } else {
-        std::cerr << "Failed to load highscore from file." << std::endl;
     }
-    return loadedHighscore;
+    if (loadedHighscore > 0) {
+        leaderboard->Add(player.c_str(), loadedHighscore, 0, time(nullptr));
+    }
 }
 
 /**
@@ -399,6 +1162,10 @@ int Game::loadHighscoreFromFile() {
 
 void Game::Reset() {
     spaceship.Reset();
+    if (partner) {
+        partner->Reset();
+    }
+    mysteryship.alive = false;
     aliens.clear();
     alienLasers.clear();
     obstacles.clear();
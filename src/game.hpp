@@ -9,6 +9,18 @@
 #include "obstacle.hpp"
 #include "alien.hpp"
 #include "mysteryship.hpp"
+#include "shooterindex.hpp"
+#include "aabbbatch.hpp"
+#include "inputqueue.hpp"
+#include "timerwheel.hpp"
+#include "levelscript.hpp"
+#include "jobsystem.hpp"
+#include "particlepool.hpp"
+#include "gameevents.hpp"
+#include "leaderboard.hpp"
+#include <memory>
+#include <random>
+#include <string>
 
 /**
  * @class Game
@@ -21,8 +33,11 @@ public:
      * @brief Конструктор класса Game.
      *
      * Инициализирует игровой объект, загружает ресурсы и устанавливает начальные параметры.
+     *
+     * @param headless true, если игра работает без окна и не пишет таблицу рекордов.
+     * @param player Имя игрока в таблице рекордов.
      */
-    Game();
+    explicit Game(bool headless = false, const std::string &player = "PLAYER");
 
     /**
     * @brief Деструктор класса Game.
@@ -40,8 +55,11 @@ public:
      * @brief Обновляет состояние игры.
      *
      * Вызывается в основном игровом цикле для обновления состояния всех игровых элементов.
+     *
+     * @param present false при повторной симуляции уже показанных тиков (перемотка, откат):
+     *                звуки, частицы и запись результата игры пропускаются.
      */
-    void Update();
+    void Update(bool present = true);
 
     /**
      * @brief Обрабатывает ввод пользователя.
@@ -50,10 +68,111 @@ public:
      */
     void HandleInput();
 
+    /**
+     * @brief Возвращает команды, заданные клавиатурой.
+     *
+     * @return Комбинация флагов InputFlags.
+     */
+    static int KeyboardInput();
+
+    /**
+     * @brief Переносит нажатия и отпускания клавиш из последнего опроса событий окна в очередь ввода.
+     *
+     * Вызывается после каждого опроса (EndDrawing, PollInputEvents). Нажатия берутся из очереди
+     * нажатий raylib в порядке их прихода, поэтому нажатие, отпущенное до опроса, тоже попадает в очередь.
+     *
+     * @param queue Очередь ввода.
+     * @param time Время опроса.
+     * @param player Номер игрока, которому принадлежит клавиатура.
+     */
+    static void CaptureKeyboard(InputQueue &queue, double time, int player = 0);
+
+    /**
+     * @brief Применяет команды игрока.
+     *
+     * Движение и выстрел выполняются в одном тике; одновременные влево и вправо гасят друг друга
+     * (очередь ввода заранее оставляет только последнее нажатое направление). После окончания игры
+     * команда INPUT_RESTART начинает новую игру.
+     *
+     * @param input Комбинация флагов InputFlags.
+     * @param player Номер игрока (1 - второй игрок совместного режима).
+     */
+    void ApplyInput(int input, int player = 0);
+
+    /**
+     * @brief Включает совместный режим: на поле появляется корабль второго игрока.
+     *
+     * Жизни и счет у игроков общие.
+     */
+    void EnableCoop();
+
+    /**
+     * @brief Включает нагрузочный режим и начинает игру заново.
+     *
+     * Формация из заданного количества инопланетян сжимается по ширине экрана, щиты ставятся
+     * в несколько рядов, инопланетяне стреляют залпами. Сценарий уровня остается прежним.
+     *
+     * @param aliens Количество инопланетян (не больше ShooterIndex::maxRows рядов).
+     * @param shields Количество щитов.
+     * @param fireTicks Интервал залпов инопланетян в тиках.
+     * @param volley Количество выстрелов в залпе.
+     */
+    void EnableStress(int aliens, int shields, int fireTicks, int volley);
+
+    /**
+     * @brief Задает количество потоков для параллельных частей тика.
+     *
+     * Результаты параллельных частей сводятся в том же порядке, что и при одном потоке, поэтому
+     * игра проходит одинаково при любом количестве потоков.
+     *
+     * @param threads Количество потоков вместе с вызывающим (1 - без дополнительных потоков).
+     */
+    void SetThreads(int threads);
+
+    /**
+     * @brief Задает долю выпускаемых частиц взрывов и обломков.
+     *
+     * @param density Доля от 0 до 1; без окна частиц нет, и вызов ничего не делает.
+     */
+    void SetParticleDensity(float density);
+
+    /**
+     * @brief Возвращает события последнего тика в порядке, в котором они произошли.
+     */
+    const std::vector<GameEvent> &Events() const;
+
+    /**
+     * @brief Задает начальное значение генератора случайных чисел игры.
+     *
+     * @param seed Начальное значение.
+     */
+    void Seed(unsigned int seed);
+
+    /**
+     * @brief Возвращает случайное целое число из генератора игры.
+     *
+     * @param min Нижняя граница (включительно).
+     * @param max Верхняя граница (включительно).
+     * @return Случайное число из отрезка [min, max].
+     */
+    int RandomValue(int min, int max);
+
     /**
      * @brief Флаг, указывающий, запущена ли игра.
      */
     bool run;
+    /**
+     * @brief Флаг работы без окна.
+     */
+    bool headless;
+    /**
+     * @brief Длительность одного тика симуляции в секундах.
+     */
+    constexpr static double tickDuration = 1.0 / 60.0;
+    /**
+     * @brief Время симуляции в секундах с начала игры.
+     */
+    double simulationTime;
     /**
      * @brief Количество жизней игрока.
      */
@@ -66,6 +185,14 @@ public:
      * @brief Рекордный счет.
      */
     int highscore;
+    /**
+     * @brief Номер текущего уровня, начиная с 1.
+     */
+    int level;
+    /**
+     * @brief Сценарий текущего уровня.
+     */
+    LevelScript script;
     /**
      * @brief Музыкальный трек, воспроизводимый во время игры.
      */
@@ -79,16 +206,35 @@ public:
     /**
      * @brief Создает вектор препятствий для игры.
      *
+     * @param count Количество препятствий.
      * @return Вектор препятствий.
      */
-    std::vector <Obstacle> CreateObstacles();
+    std::vector <Obstacle> CreateObstacles(int count = 4);
 
     /**
      * @brief Создает вектор инопланетян для игры.
      *
+     * @param pattern Шаблон заполнения ячеек формации (FormationPattern).
      * @return Вектор инопланетян.
      */
-    std::vector <Alien> CreateAliens();
+    std::vector <Alien> CreateAliens(int pattern = FORMATION_GRID);
+
+    /**
+     * @brief Заполняет пустые ячейки ряда формации новыми инопланетянами.
+     *
+     * @param row Ряд формации.
+     */
+    void ReinforceRow(int row);
+
+    /**
+     * @brief Возвращает тип инопланетян ряда формации.
+     *
+     * Общий для создания формации, подкреплений и зрителя потока состояния, чтобы они не расходились.
+     *
+     * @param row Ряд формации.
+     * @return Тип инопланетянина (1-3).
+     */
+    static int AlienTypeForRow(int row);
 
     /**
      * @brief Перемещает всех инопланетян в текущем направлении.
@@ -104,14 +250,73 @@ public:
 
     /**
      * @brief Инопланетяне стреляют лазерами.
+     *
+     * Стреляет самый нижний инопланетянин случайного непустого столбца, а каждый третий выстрел
+     * делается из столбца над кораблем игрока, если в нем есть инопланетяне.
      */
     void AlienShootLaser();
 
+    /**
+     * @brief Перестраивает индекс столбцов формации по текущему вектору инопланетян.
+     */
+    void IndexAliens();
+
+    /**
+     * @brief Удаляет инопланетянина из вектора за O(1).
+     *
+     * Последний инопланетянин переносится на место удаленного, индекс столбцов обновляется.
+     *
+     * @param index Индекс инопланетянина в векторе aliens.
+     */
+    void RemoveAlien(int index);
+
+    /**
+     * @brief Возвращает самого нижнего живого инопланетянина в столбце.
+     *
+     * @param column Столбец формации.
+     * @return Указатель на инопланетянина или nullptr, если столбец пуст.
+     */
+    Alien *BottomAlien(int column);
+
+    /**
+     * @brief Возвращает столбец формации, находящийся над координатой x.
+     *
+     * @param x Координата по оси X.
+     * @return Номер столбца или -1, если координата вне формации.
+     */
+    int ColumnAt(float x);
+
+    /**
+     * @brief Возвращает нижнюю границу формации инопланетян.
+     *
+     * @return Координата Y нижнего края самого нижнего живого ряда или 0, если формация пуста.
+     */
+    float FormationBottom();
+
     /**
      * @brief Проверяет столкновения между игровыми объектами.
      */
     void CheckForCollisions();
 
+    /**
+     * @brief Проверяет попадания лазеров игрока в инопланетян и загадочный корабль.
+     *
+     * @param lasers Лазеры одного из кораблей.
+     */
+    void CheckPlayerLasers(std::vector<Laser> &lasers);
+
+    /**
+     * @brief Проверяет попадания лазеров инопланетян и столкновения формации с кораблем.
+     *
+     * @param ship Корабль игрока.
+     */
+    void CheckShipHits(Spaceship &ship);
+
+    /**
+     * @brief Расставляет корабли совместного режима по обе стороны от центра.
+     */
+    void PlaceCoopShips();
+
     /**
      * @brief Завершает игру, обрабатывая ситуацию "Game Over".
      */
@@ -128,26 +333,38 @@ public:
     void InitGame();
 
     /**
-     * @brief Проверяет и обновляет рекордный счет.
+     * @brief Ставит таймеры появления загадочного корабля и выстрела инопланетян заново.
+     *
+     * Сроки считаются по времени симуляции и сохраненным в игре моментам последних событий,
+     * поэтому вызывается после InitGame и после восстановления состояния из снимка.
      */
-    void checkForHighscore();
+    void ScheduleTimers();
 
     /**
-     * @brief Сохраняет рекордный счет в файл.
+     * @brief Начинает уровень: запускает его сценарий и выполняет первые действия сценария.
      *
-     * @param highscore Рекордный счет для сохранения.
+     * @param number Номер уровня.
      */
-    void saveHighscoreToFile(int highscore);/**
-     * @brief Загружает рекордный счет из файла.
-     *
-     * @return Загруженный рекордный счет.
+    void StartLevel(int number);
+
+    /**
+     * @brief Проверяет и обновляет рекордный счет в памяти; результат игры в таблицу рекордов записывает поток событий.
      */
-    int loadHighscoreFromFile();
+    void checkForHighscore();
+
+    /**
+     * @brief Переносит рекорд из файла highscore.txt прежних версий в пустую таблицу рекордов.
+     */
+    void ImportHighscoreFile();
 
     /**
      * @brief Космический корабль игрока.
      */
     Spaceship spaceship;
+    /**
+     * @brief Корабль второго игрока в совместном режиме или nullptr.
+     */
+    std::unique_ptr<Spaceship> partner;
     /**
      * @brief Вектор препятствий.
      */
@@ -156,6 +373,46 @@ public:
      * @brief Вектор инопланетян.
      */
     std::vector <Alien> aliens;
+    /**
+     * @brief Индекс самых нижних живых инопланетян по столбцам.
+     */
+    ShooterIndex shooters;
+    /**
+     * @brief Индексы инопланетян в векторе aliens по ячейкам формации (-1 для пустых ячеек).
+     */
+    std::vector<int> alienSlots;
+    /**
+     * @brief Позиция ячейки (0, 0) формации инопланетян.
+     */
+    Vector2 formationOrigin;
+    /**
+     * @brief Количество рядов обычной формации.
+     */
+    constexpr static int alienRows = 5;
+    /**
+     * @brief Количество столбцов обычной формации.
+     */
+    constexpr static int alienColumns = 11;
+    /**
+     * @brief Расстояние между соседними ячейками обычной формации.
+     */
+    constexpr static int alienSpacing = 55;
+    /**
+     * @brief Количество рядов формации этой игры.
+     */
+    int formationRows;
+    /**
+     * @brief Количество столбцов формации этой игры.
+     */
+    int formationColumns;
+    /**
+     * @brief Расстояние между соседними ячейками формации этой игры.
+     */
+    float formationSpacing;
+    /**
+     * @brief Количество выстрелов инопланетян с начала игры.
+     */
+    int alienShotCount;
     /**
      * @brief Направление движения инопланетян.
      */
@@ -169,7 +426,7 @@ public:
      */
     constexpr static float alienLaserShootInterval = 0.35;
     /**
-     * @brief Время последнего выстрела инопланетянина.
+     * @brief Время последнего выстрела инопланетян или появления формации.
      */
     float timeLastAlienFired;
     /**
@@ -188,6 +445,204 @@ public:
      * @brief Звук взрыва.
      */
     Sound explosionSound;
+    /**
+     * @brief Генератор случайных чисел игры.
+     *
+     * У каждого экземпляра свой генератор, поэтому игры с одинаковым начальным значением
+     * и одинаковыми командами проходят одинаково.
+     */
+    std::mt19937 rng;
 private:
+    /**
+     * @brief Прямоугольники инопланетян на начало проверки столкновений.
+     */
+    AabbBatch alienBatch;
+    /**
+     * @brief Ячейки формации для элементов alienBatch.
+     */
+    std::vector<int> alienBatchSlots;
+    /**
+     * @brief Маска попаданий последней пакетной проверки.
+     */
+    std::vector<uint64_t> hitMask;
+
+    /**
+     * @enum GameTimer
+     * @brief Виды событий колеса таймеров игры.
+     */
+    enum GameTimer {
+        TIMER_MYSTERY_SHIP, ///< Появление загадочного корабля.
+        TIMER_ALIEN_FIRE    ///< Выстрел инопланетян.
+    };
+
+    /**
+     * @brief Возвращает номер тика для момента времени симуляции.
+     */
+    static uint64_t TickAt(double time);
 
+    /**
+     * @brief Возвращает интервал выстрелов инопланетян на текущем уровне в тиках.
+     */
+    int AlienFireTicks() const;
+
+    /**
+     * @brief Ставит таймер выстрела инопланетян, если он не стоит, а стрелять уже есть кому.
+     */
+    void ArmAlienFire();
+
+    /**
+     * @brief Выполняет действия, выданные сценарием уровня.
+     */
+    void ApplyScriptActions();
+
+    /**
+     * @brief Передает сценарию события, накопленные за тик.
+     */
+    void SignalScriptEvents();
+
+    /**
+     * @brief Перемещает лазеры; лазеры обновляются параллельно диапазонами по laserJobGrain.
+     */
+    void UpdateLasers(std::vector<Laser> &lasers);
+
+    /**
+     * @brief Стирает блоки щитов, задетые лазерами и инопланетянами.
+     *
+     * Щиты обрабатываются параллельно, каждый щит - прямоугольниками в порядке последовательной
+     * проверки, после чего лазеры, стершие блоки, гасятся.
+     */
+    void EraseShieldBlocks();
+
+    /**
+     * @brief Добавляет событие тика с местом в центре прямоугольника.
+     *
+     * @param type Вид события (GameEventType).
+     * @param detail Уточнение, зависящее от вида события.
+     * @param value Значение, зависящее от вида события.
+     * @param rect Прямоугольник объекта события.
+     */
+    void PushEvent(int type, int detail, int value, Rectangle rect);
+
+    /**
+     * @brief Начисляет очки за события тика и отмечает в событиях счет после них.
+     */
+    void ScoreEvents();
+
+    /**
+     * @brief Проигрывает звуки и выпускает частицы событий тика и отдает окончания игр потоку рекорда.
+     */
+    void PresentEvents();
+
+    /**
+     * @brief Выпускает частицы из точки; без окна ничего не делает.
+     *
+     * @param x Координата X точки.
+     * @param y Координата Y точки.
+     * @param count Количество частиц.
+     * @param speed Наибольшая скорость частицы в пикселях за тик.
+     * @param color Цвет в виде 0xRRGGBB.
+     */
+    void EmitParticles(float x, float y, int count, float speed, uint32_t color);
+
+    /**
+     * @brief События текущего тика.
+     */
+    std::vector<GameEvent> events;
+    /**
+     * @brief Таблица рекордов или nullptr без окна и при ошибке открытия.
+     */
+    std::unique_ptr<Leaderboard> leaderboard;
+    /**
+     * @brief Имя игрока в таблице рекордов.
+     */
+    std::string player;
+    /**
+     * @brief Поток, записывающий результаты игр в таблицу рекордов, или nullptr без окна.
+     */
+    std::unique_ptr<GameEventWorker> recordWorker;
+    /**
+     * @brief Емкость буфера событий потока рекорда.
+     */
+    constexpr static int recordEventCapacity = 1024;
+
+    /**
+     * @brief Частицы взрывов и обломков или nullptr без окна.
+     */
+    std::unique_ptr<ParticlePool> particles;
+    /**
+     * @brief Емкость пула частиц.
+     */
+    constexpr static int particleCapacity = 50000;
+    /**
+     * @brief Потоки для параллельных частей тика.
+     */
+    std::unique_ptr<JobSystem> jobs;
+    /**
+     * @brief Наибольшее количество лазеров в одной задаче обновления или проверки попаданий в корабль.
+     */
+    constexpr static int laserJobGrain = 256;
+    /**
+     * @brief Наибольшее количество инопланетян в одной задаче построения широкой фазы или проверки столкновений.
+     */
+    constexpr static int alienJobGrain = 512;
+    /**
+     * @brief Ячейки формации, в которые попал каждый лазер игрока, в порядке проверки.
+     */
+    std::vector<std::vector<int>> laserHits;
+    /**
+     * @brief Флаги попаданий по элементам последней параллельной проверки.
+     */
+    std::vector<unsigned char> hitFlags;
+    /**
+     * @brief Лазеры, которые проверяются против щитов, в порядке последовательной проверки.
+     */
+    std::vector<Laser *> shieldLasers;
+    /**
+     * @brief Прямоугольники лазеров shieldLasers, за которыми идут прямоугольники инопланетян.
+     */
+    std::vector<Rectangle> shieldRects;
+    /**
+     * @brief Флаги стирания блоков: щит i, лазер j - элемент i * shieldLasers.size() + j.
+     */
+    std::vector<unsigned char> shieldHits;
+    /**
+     * @brief Колесо таймеров игровых событий; тикает вместе с симуляцией, пока идет игра.
+     */
+    TimerWheel timers;
+    /**
+     * @brief Сработавшие в текущем тике таймеры.
+     */
+    std::vector<TimerEvent> firedTimers;
+    /**
+     * @brief Таймер появления загадочного корабля.
+     */
+    TimerId spawnTimer;
+    /**
+     * @brief Таймер выстрела инопланетян.
+     */
+    TimerId alienFireTimer;
+    /**
+     * @brief Количество щитов нагрузочного режима или 0, если щиты задает сценарий.
+     */
+    int stressShields;
+    /**
+     * @brief Интервал залпов нагрузочного режима в тиках или 0, если интервал задает уровень.
+     */
+    int stressFireTicks;
+    /**
+     * @brief Количество выстрелов инопланетян в залпе.
+     */
+    int alienVolley;
+    /**
+     * @brief Емкость арены нитей сценария уровня.
+     */
+    constexpr static int levelScriptFibers = 64;
+    /**
+     * @brief Действия, выданные сценарием уровня.
+     */
+    std::vector<ScriptCommand> scriptActions;
+    /**
+     * @brief Маска событий сценария (биты ScriptEvent), произошедших в текущем тике.
+     */
+    int scriptEvents;
 };
\ No newline at end of file
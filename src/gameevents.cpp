@@ -0,0 +1,184 @@
+/**
+ * @file gameevents.cpp
+ * @brief Файл реализации, содержащий методы классов GameEventRing и GameEventWorker.
+ */
+
+#include "gameevents.hpp"
+#include <algorithm>
+
+/**
+ * @brief Конструктор класса GameEventRing.
+ *
+ * @param capacity Емкость; округляется вверх до степени двойки.
+ */
+
+GameEventRing::GameEventRing(int capacity) {
+    uint32_t size = 1;
+    while (size < (uint32_t) std::max(capacity, 1)) {
+        size <<= 1;
+    }
+    slots.resize(size);
+    mask = size - 1;
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Добавляет событие. Вызывается только потоком-писателем.
+ *
+ * Событие записывается в ячейку до публикации новой головы, поэтому читатель, увидевший голову,
+ * видит и событие. Индексы растут без ограничения и переполняются вместе, так что разность
+ * головы и хвоста остается количеством событий в буфере.
+ *
+ * @return false, если буфер заполнен и событие не добавлено.
+ */
+
+bool GameEventRing::Push(const GameEvent &event) {
+    uint32_t position = head.load(std::memory_order_relaxed);
+    if (position - tail.load(std::memory_order_acquire) > mask) {
+        return false;
+    }
+    slots[position & mask] = event;
+    head.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Забирает события в порядке добавления. Вызывается только потоком-читателем.
+ *
+ * @param events Массив для событий.
+ * @param maxCount Наибольшее количество событий.
+ * @return Количество забранных событий.
+ */
+
+int GameEventRing::Pop(GameEvent *events, int maxCount) {
+    uint32_t position = tail.load(std::memory_order_relaxed);
+    uint32_t available = head.load(std::memory_order_acquire) - position;
+    int count = (int) std::min<uint32_t>(available, std::max(maxCount, 0));
+    for (int i = 0; i < count; ++i) {
+        events[i] = slots[(position + i) & mask];
+    }
+    // Ячейки освобождаются для писателя только после копирования
+    tail.store(position + count, std::memory_order_release);
+    return count;
+}
+
+/**
+ * @brief Проверяет, пуст ли буфер. Вызывается только потоком-читателем.
+ */
+
+bool GameEventRing::Empty() const {
+    return head.load(std::memory_order_acquire) == tail.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Возвращает емкость буфера.
+ */
+
+int GameEventRing::Capacity() const {
+    return slots.size();
+}
+
+/**
+ * @brief Конструктор класса GameEventWorker. Запускает поток обработки.
+ *
+ * @param capacity Емкость буфера событий.
+ * @param handler Обработчик пачки событий.
+ */
+
+GameEventWorker::GameEventWorker(int capacity, Handler handler) : ring(capacity) {
+    this->handler = handler;
+    stopping.store(false);
+    sleeping.store(false);
+    sleeps.store(0);
+    dropped = 0;
+    thread = std::thread(&GameEventWorker::Run, this);
+}
+
+/**
+ * @brief Деструктор класса GameEventWorker. Обрабатывает оставшиеся события и останавливает поток.
+ */
+
+GameEventWorker::~GameEventWorker() {
+    stopping.store(true);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        sleeping.store(false);
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+/**
+ * @brief Отдает событие потоку обработки. Вызывается только одним потоком.
+ *
+ * Мьютекс запирается, только если поток обработки уснул. Барьер между записью события и чтением
+ * флага сна парный барьеру в Run: либо Post видит флаг и будит поток, либо поток перед сном
+ * видит событие.
+ *
+ * @return false, если буфер заполнен и событие потеряно.
+ */
+
+bool GameEventWorker::Post(const GameEvent &event) {
+    if (!ring.Push(event)) {
+        dropped++;
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping.load(std::memory_order_relaxed)) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            sleeping.store(false);
+        }
+        wake.notify_one();
+    }
+    return true;
+}
+
+/**
+ * @brief Возвращает количество событий, потерянных из-за заполненного буфера.
+ */
+
+long long GameEventWorker::Dropped() const {
+    return dropped;
+}
+
+/**
+ * @brief Возвращает, сколько раз поток обработки засыпал без событий.
+ */
+
+long long GameEventWorker::Sleeps() const {
+    return sleeps.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Цикл потока обработки.
+ *
+ * Флаг остановки читается до попытки забрать события: если он уже поднят, а буфер пуст,
+ * все события, отданные до остановки, обработаны. Без событий поток поднимает флаг сна,
+ * еще раз проверяет буфер после барьера и ждет, пока флаг не снимет Post или деструктор.
+ */
+
+void GameEventWorker::Run() {
+    GameEvent batch[batchSize];
+    while (true) {
+        bool stop = stopping.load();
+        int count = ring.Pop(batch, batchSize);
+        if (count > 0) {
+            handler(batch, count);
+            continue;
+        }
+        if (stop) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!ring.Empty() || stopping.load()) {
+            sleeping.store(false, std::memory_order_relaxed);
+            continue;
+        }
+        sleeps.fetch_add(1, std::memory_order_relaxed);
+        wake.wait(lock, [this] { return !sleeping.load(std::memory_order_relaxed); });
+    }
+}
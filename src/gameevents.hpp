@@ -0,0 +1,208 @@
+/**
+ * @file gameevents.hpp
+ * @brief Заголовочный файл, содержащий игровые события, кольцевой буфер событий и поток их обработки.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @enum GameEventType
+ * @brief Виды игровых событий.
+ */
+enum GameEventType {
+    EVENT_ALIEN_KILLED,        ///< Сбит инопланетянин; detail - тип инопланетянина, value - очки.
+    EVENT_BLOCK_DESTROYED,     ///< Лазер стер блоки щита; detail - номер щита.
+    EVENT_PLAYER_HIT,          ///< В корабль попал лазер; detail - номер игрока, value - оставшиеся жизни.
+    EVENT_MYSTERY_SHIP_KILLED, ///< Сбит загадочный корабль; value - очки.
+    EVENT_GAME_OVER            ///< Игра окончена; value - достигнутый уровень.
+};
+
+/**
+ * @struct GameEvent
+ * @brief Игровое событие тика (16 байт).
+ */
+struct GameEvent {
+    uint32_t tick;  ///< Номер тика симуляции.
+    uint8_t type;   ///< Вид события (GameEventType).
+    uint8_t detail; ///< Уточнение, зависящее от вида события.
+    int16_t value;  ///< Значение, зависящее от вида события.
+    int16_t x;      ///< Координата X места события.
+    int16_t y;      ///< Координата Y места события.
+    int32_t score;  ///< Счет после события.
+};
+
+static_assert(sizeof(GameEvent) == 16, "GameEvent must stay compact");
+
+/**
+ * @class GameEventRing
+ * @brief Кольцевой буфер событий без блокировок для одного писателя и одного читателя.
+ *
+ * Писатель двигает только голову, читатель - только хвост, поэтому хватает атомарных индексов
+ * с порядком release/acquire. Индексы лежат в разных строках кэша, чтобы потоки не мешали друг
+ * другу. Заполненный буфер не ждет читателя: Push возвращает false.
+ */
+
+class GameEventRing {
+public:
+    /**
+     * @brief Конструктор класса GameEventRing.
+     *
+     * @param capacity Емкость; округляется вверх до степени двойки.
+     */
+    explicit GameEventRing(int capacity);
+
+    GameEventRing(const GameEventRing &) = delete;
+    GameEventRing &operator=(const GameEventRing &) = delete;
+
+    /**
+     * @brief Добавляет событие. Вызывается только потоком-писателем.
+     *
+     * @return false, если буфер заполнен и событие не добавлено.
+     */
+    bool Push(const GameEvent &event);
+
+    /**
+     * @brief Забирает события в порядке добавления. Вызывается только потоком-читателем.
+     *
+     * @param events Массив для событий.
+     * @param maxCount Наибольшее количество событий.
+     * @return Количество забранных событий.
+     */
+    int Pop(GameEvent *events, int maxCount);
+
+    /**
+     * @brief Проверяет, пуст ли буфер. Вызывается только потоком-читателем.
+     */
+    bool Empty() const;
+
+    /**
+     * @brief Возвращает емкость буфера.
+     */
+    int Capacity() const;
+
+private:
+    /**
+     * @brief Ячейки буфера.
+     */
+    std::vector<GameEvent> slots;
+    /**
+     * @brief Маска индекса ячейки (емкость - 1).
+     */
+    uint32_t mask;
+    /**
+     * @brief Количество добавленных событий; пишет только писатель.
+     */
+    alignas(64) std::atomic<uint32_t> head;
+    /**
+     * @brief Количество забранных событий; пишет только читатель.
+     */
+    alignas(64) std::atomic<uint32_t> tail;
+};
+
+/**
+ * @class GameEventWorker
+ * @brief Поток, обрабатывающий игровые события из кольцевого буфера.
+ *
+ * Поток симуляции отдает события через Post и не ждет обработчика. Поток забирает события
+ * пачками и вызывает для каждой пачки обработчик; пока событий нет, он ждет на условной
+ * переменной и не просыпается. Post запирает мьютекс и будит поток, только если тот отметил,
+ * что уснул, поэтому запись события остается без блокировок. Деструктор обрабатывает оставшиеся
+ * события и останавливает поток.
+ */
+
+class GameEventWorker {
+public:
+    /**
+     * @brief Обработчик пачки событий; вызывается в потоке обработки.
+     */
+    using Handler = std::function<void(const GameEvent *events, int count)>;
+
+    /**
+     * @brief Конструктор класса GameEventWorker. Запускает поток обработки.
+     *
+     * @param capacity Емкость буфера событий.
+     * @param handler Обработчик пачки событий.
+     */
+    GameEventWorker(int capacity, Handler handler);
+
+    /**
+     * @brief Деструктор класса GameEventWorker. Обрабатывает оставшиеся события и останавливает поток.
+     */
+    ~GameEventWorker();
+
+    GameEventWorker(const GameEventWorker &) = delete;
+    GameEventWorker &operator=(const GameEventWorker &) = delete;
+
+    /**
+     * @brief Отдает событие потоку обработки. Вызывается только одним потоком.
+     *
+     * @return false, если буфер заполнен и событие потеряно.
+     */
+    bool Post(const GameEvent &event);
+
+    /**
+     * @brief Возвращает количество событий, потерянных из-за заполненного буфера.
+     */
+    long long Dropped() const;
+
+    /**
+     * @brief Возвращает, сколько раз поток обработки засыпал без событий.
+     */
+    long long Sleeps() const;
+
+    /**
+     * @brief Наибольшее количество событий в одной пачке.
+     */
+    constexpr static int batchSize = 64;
+
+private:
+    /**
+     * @brief Цикл потока обработки.
+     */
+    void Run();
+
+    /**
+     * @brief Буфер событий.
+     */
+    GameEventRing ring;
+    /**
+     * @brief Обработчик пачки событий.
+     */
+    Handler handler;
+    /**
+     * @brief Флаг остановки потока.
+     */
+    std::atomic<bool> stopping;
+    /**
+     * @brief Флаг, поднятый потоком обработки перед сном; его снимает тот, кто будит поток.
+     */
+    std::atomic<bool> sleeping;
+    /**
+     * @brief Мьютекс сна потока обработки.
+     */
+    std::mutex mutex;
+    /**
+     * @brief Условная переменная, на которой спит поток обработки.
+     */
+    std::condition_variable wake;
+    /**
+     * @brief Количество засыпаний потока обработки.
+     */
+    std::atomic<long long> sleeps;
+    /**
+     * @brief Количество потерянных событий.
+     */
+    long long dropped;
+    /**
+     * @brief Поток обработки.
+     */
+    std::thread thread;
+};
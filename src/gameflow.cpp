@@ -0,0 +1,145 @@
+/**
+ * @file gameflow.cpp
+ * @brief Файл реализации конечного автомата состояний окна игры.
+ */
+
+#include "gameflow.hpp"
+#include <cmath>
+
+/**
+ * @brief Конструктор класса GameFlow. Начальное состояние - FLOW_PLAYING.
+ *
+ * @param attractDelay Время бездействия на экране окончания игры до заставки в секундах.
+ * @param blinkPeriod Период мигания надписи заставки в секундах.
+ */
+
+GameFlow::GameFlow(double attractDelay, double blinkPeriod) {
+    this->attractDelay = attractDelay;
+    this->blinkPeriod = blinkPeriod;
+    state = FLOW_PLAYING;
+    enteredAt = 0.0;
+    blinkPhase = 0;
+}
+
+/**
+ * @brief Обрабатывает события ввода и состояние игры.
+ *
+ * Переходы: игра -> пауза по клавише паузы и обратно; игра -> окончание игры, когда Game::run
+ * сбрасывается; окончание игры -> заставка после attractDelay без ввода; заставка -> окончание
+ * игры по любой клавише; окончание игры или заставка -> игра, когда игра перезапущена.
+ *
+ * @param events Комбинация флагов FlowEvents.
+ * @param gameRunning Значение Game::run.
+ * @param now Текущее время в секундах.
+ * @return true, если изображение нужно перерисовать (сменилось состояние или фаза мигания).
+ */
+
+bool GameFlow::Update(int events, bool gameRunning, double now) {
+    FlowState previous = state;
+    switch (state) {
+        case FLOW_PLAYING:
+            if (!gameRunning) {
+                Enter(FLOW_GAME_OVER, now);
+            } else if (events & FLOW_EVENT_PAUSE) {
+                Enter(FLOW_PAUSED, now);
+            }
+            break;
+        case FLOW_PAUSED:
+            if (events & FLOW_EVENT_PAUSE) {
+                Enter(FLOW_PLAYING, now);
+            }
+            break;
+        case FLOW_GAME_OVER:
+            if (gameRunning) {
+                Enter(FLOW_PLAYING, now);
+            } else if (events & FLOW_EVENT_INPUT) {
+                enteredAt = now;
+            } else if (now - enteredAt >= attractDelay) {
+                Enter(FLOW_ATTRACT, now);
+            }
+            break;
+        case FLOW_ATTRACT:
+            if (gameRunning) {
+                Enter(FLOW_PLAYING, now);
+            } else if (events & FLOW_EVENT_INPUT) {
+                Enter(FLOW_GAME_OVER, now);
+            }
+            break;
+    }
+    if (state != previous) {
+        return true;
+    }
+    if (state == FLOW_ATTRACT && BlinkPhase(now) != blinkPhase) {
+        blinkPhase = BlinkPhase(now);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Возвращает текущее состояние.
+ */
+
+FlowState GameFlow::State() const {
+    return state;
+}
+
+/**
+ * @brief Проверяет, стоит ли симуляция (любое состояние, кроме FLOW_PLAYING).
+ */
+
+bool GameFlow::Idle() const {
+    return state != FLOW_PLAYING;
+}
+
+/**
+ * @brief Возвращает время, которое можно ждать ввод до следующего изменения по таймеру.
+ *
+ * На паузе таймеров нет, поэтому время ожидания не ограничено (возвращается большое значение).
+ *
+ * @param now Текущее время в секундах.
+ * @return Время в секундах (не меньше 0).
+ */
+
+double GameFlow::WaitTimeout(double now) const {
+    double due;
+    switch (state) {
+        case FLOW_GAME_OVER:
+            due = enteredAt + attractDelay;
+            break;
+        case FLOW_ATTRACT:
+            due = enteredAt + (blinkPhase + 1) * blinkPeriod;
+            break;
+        case FLOW_PAUSED:
+            return 3600.0;
+        default:
+            return 0.0;
+    }
+    return due > now ? due - now : 0.0;
+}
+
+/**
+ * @brief Возвращает, видна ли мигающая надпись заставки.
+ */
+
+bool GameFlow::BlinkVisible() const {
+    return blinkPhase % 2 == 0;
+}
+
+/**
+ * @brief Возвращает номер фазы мигания заставки в момент now.
+ */
+
+long long GameFlow::BlinkPhase(double now) const {
+    return (long long) std::floor((now - enteredAt) / blinkPeriod);
+}
+
+/**
+ * @brief Переходит в состояние и запоминает время перехода.
+ */
+
+void GameFlow::Enter(FlowState state, double now) {
+    this->state = state;
+    enteredAt = now;
+    blinkPhase = 0;
+}
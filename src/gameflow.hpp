@@ -0,0 +1,111 @@
+/**
+ * @file gameflow.hpp
+ * @brief Заголовочный файл, содержащий конечный автомат состояний окна игры.
+ */
+
+#pragma once
+
+/**
+ * @enum FlowState
+ * @brief Состояния окна игры.
+ */
+enum FlowState {
+    FLOW_PLAYING,   ///< Идет игра; кадры рисуются с целевой частотой.
+    FLOW_PAUSED,    ///< Игра приостановлена.
+    FLOW_GAME_OVER, ///< Игра окончена, ожидается новая игра.
+    FLOW_ATTRACT    ///< Заставка после долгого бездействия на экране окончания игры.
+};
+
+/**
+ * @enum FlowEvents
+ * @brief Флаги событий ввода для GameFlow::Update.
+ */
+enum FlowEvents {
+    FLOW_EVENT_PAUSE = 1, ///< Нажата клавиша паузы.
+    FLOW_EVENT_INPUT = 2  ///< Нажата любая клавиша.
+};
+
+/**
+ * @class GameFlow
+ * @brief Конечный автомат состояний окна игры: игра, пауза, окончание игры и заставка.
+ *
+ * В состояниях, кроме FLOW_PLAYING, симуляция стоит, и главный цикл ждет ввод не дольше
+ * WaitTimeout, а кадр рисует только при изменении (Update вернул true или пришел ввод).
+ * Новая игра начинается самой игрой (INPUT_RESTART), автомат видит это по флагу Game::run.
+ */
+
+class GameFlow {
+public:
+    /**
+     * @brief Конструктор класса GameFlow. Начальное состояние - FLOW_PLAYING.
+     *
+     * @param attractDelay Время бездействия на экране окончания игры до заставки в секундах.
+     * @param blinkPeriod Период мигания надписи заставки в секундах.
+     */
+    explicit GameFlow(double attractDelay = 30.0, double blinkPeriod = 1.0);
+
+    /**
+     * @brief Обрабатывает события ввода и состояние игры.
+     *
+     * @param events Комбинация флагов FlowEvents.
+     * @param gameRunning Значение Game::run.
+     * @param now Текущее время в секундах.
+     * @return true, если изображение нужно перерисовать (сменилось состояние или фаза мигания).
+     */
+    bool Update(int events, bool gameRunning, double now);
+
+    /**
+     * @brief Возвращает текущее состояние.
+     */
+    FlowState State() const;
+
+    /**
+     * @brief Проверяет, стоит ли симуляция (любое состояние, кроме FLOW_PLAYING).
+     */
+    bool Idle() const;
+
+    /**
+     * @brief Возвращает время, которое можно ждать ввод до следующего изменения по таймеру.
+     *
+     * @param now Текущее время в секундах.
+     * @return Время в секундах (не меньше 0).
+     */
+    double WaitTimeout(double now) const;
+
+    /**
+     * @brief Возвращает, видна ли мигающая надпись заставки.
+     */
+    bool BlinkVisible() const;
+
+private:
+    /**
+     * @brief Возвращает номер фазы мигания заставки в момент now.
+     */
+    long long BlinkPhase(double now) const;
+
+    /**
+     * @brief Переходит в состояние и запоминает время перехода.
+     */
+    void Enter(FlowState state, double now);
+
+    /**
+     * @brief Текущее состояние.
+     */
+    FlowState state;
+    /**
+     * @brief Время перехода в текущее состояние или последнего ввода на экране окончания игры.
+     */
+    double enteredAt;
+    /**
+     * @brief Время бездействия до заставки.
+     */
+    double attractDelay;
+    /**
+     * @brief Период мигания надписи заставки.
+     */
+    double blinkPeriod;
+    /**
+     * @brief Последняя нарисованная фаза мигания.
+     */
+    long long blinkPhase;
+};
@@ -0,0 +1,268 @@
+/**
+ * @file gamesnapshot.cpp
+ * @brief Файл реализации снимков состояния симуляции и их контрольных сумм.
+ */
+
+#include "gamesnapshot.hpp"
+#include "statebytes.hpp"
+#include <algorithm>
+#include <cstring>
+
+/**
+ * @brief Сохраняет состояние корабля.
+ */
+
+static void SaveShip(Spaceship &ship, ShipSnapshot &snapshot) {
+    snapshot.x = ship.getRect().x;
+    snapshot.lastFireTime = ship.getLastFireTime();
+    snapshot.lasers = ship.lasers;
+}
+
+/**
+ * @brief Восстанавливает состояние корабля.
+ */
+
+static void RestoreShip(const ShipSnapshot &snapshot, Spaceship &ship) {
+    ship.Restore(snapshot.x, snapshot.lastFireTime);
+    ship.lasers = snapshot.lasers;
+}
+
+/**
+ * @brief Сохраняет состояние симуляции игры в снимок.
+ *
+ * @param game Игра.
+ * @param snapshot Снимок.
+ */
+
+void SaveSnapshot(Game &game, GameSnapshot &snapshot) {
+    snapshot.run = game.run;
+    snapshot.simulationTime = game.simulationTime;
+    snapshot.lives = game.lives;
+    snapshot.score = game.score;
+    snapshot.highscore = game.highscore;
+    snapshot.formationOrigin = game.formationOrigin;
+    snapshot.alienShotCount = game.alienShotCount;
+    snapshot.aliensDirection = game.aliensDirection;
+    snapshot.timeLastAlienFired = game.timeLastAlienFired;
+    snapshot.mysteryShipSpawnInterval = game.mysteryShipSpawnInterval;
+    snapshot.timeLastSpawn = game.timeLastSpawn;
+    snapshot.mysteryAlive = game.mysteryship.alive;
+    snapshot.mysteryX = game.mysteryship.getRect().x;
+    snapshot.mysterySpeed = game.mysteryship.getSpeed();
+    snapshot.aliens = game.aliens;
+    snapshot.alienLasers = game.alienLasers;
+    SaveShip(game.spaceship, snapshot.ships[0]);
+    if (game.partner) {
+        SaveShip(*game.partner, snapshot.ships[1]);
+    } else {
+        snapshot.ships[1].x = 0;
+        snapshot.ships[1].lastFireTime = 0;
+        snapshot.ships[1].lasers.clear();
+    }
+    // Сохраняются все щиты: в нагрузочном режиме их больше четырех
+    snapshot.shieldCount = game.obstacles.size();
+    snapshot.shields.resize(snapshot.shieldCount * snapshotShieldRows);
+    for (int i = 0; i < snapshot.shieldCount; ++i) {
+        game.obstacles[i].GetCells(&snapshot.shields[i * snapshotShieldRows]);
+    }
+    snapshot.level = game.level;
+    snapshot.script = game.script;
+    snapshot.rng = game.rng;
+}
+
+/**
+ * @brief Восстанавливает состояние симуляции игры из снимка.
+ *
+ * @param snapshot Снимок.
+ * @param game Игра.
+ */
+
+void RestoreSnapshot(const GameSnapshot &snapshot, Game &game) {
+    game.run = snapshot.run;
+    game.simulationTime = snapshot.simulationTime;
+    game.lives = snapshot.lives;
+    game.score = snapshot.score;
+    game.highscore = snapshot.highscore;
+    game.formationOrigin = snapshot.formationOrigin;
+    game.alienShotCount = snapshot.alienShotCount;
+    game.aliensDirection = snapshot.aliensDirection;
+    game.timeLastAlienFired = snapshot.timeLastAlienFired;
+    game.mysteryShipSpawnInterval = snapshot.mysteryShipSpawnInterval;
+    game.timeLastSpawn = snapshot.timeLastSpawn;
+    game.mysteryship.Restore(snapshot.mysteryAlive, snapshot.mysteryX, snapshot.mysterySpeed);
+    game.aliens = snapshot.aliens;
+    game.IndexAliens();
+    game.alienLasers = snapshot.alienLasers;
+    RestoreShip(snapshot.ships[0], game.spaceship);
+    if (game.partner) {
+        RestoreShip(snapshot.ships[1], *game.partner);
+    }
+    // Количество щитов зависит от уровня, поэтому при откате через границу уровня щиты ставятся заново
+    if ((int) game.obstacles.size() != snapshot.shieldCount) {
+        game.obstacles = game.CreateObstacles(snapshot.shieldCount);
+    }
+    for (int i = 0; i < snapshot.shieldCount; ++i) {
+        game.obstacles[i].SetCells(&snapshot.shields[i * snapshotShieldRows]);
+    }
+    game.level = snapshot.level;
+    game.script = snapshot.script;
+    game.rng = snapshot.rng;
+    game.ScheduleTimers();
+}
+
+/**
+ * @brief Записывает снимок в байты для хранения в памяти процесса (см. statebytes.hpp).
+ *
+ * Поля идут в постоянном порядке, а векторы - в конце корабля или снимка, поэтому байты соседних
+ * тиков в основном совпадают и хорошо сжимаются разностью (см. RewindBuffer).
+ *
+ * @param snapshot Снимок.
+ * @param bytes Байты (старое содержимое удаляется, память переиспользуется).
+ */
+
+void WriteSnapshot(const GameSnapshot &snapshot, std::vector<uint8_t> &bytes) {
+    bytes.clear();
+    PutState(bytes, snapshot.run);
+    PutState(bytes, snapshot.simulationTime);
+    PutState(bytes, snapshot.lives);
+    PutState(bytes, snapshot.score);
+    PutState(bytes, snapshot.highscore);
+    PutState(bytes, snapshot.formationOrigin);
+    PutState(bytes, snapshot.alienShotCount);
+    PutState(bytes, snapshot.aliensDirection);
+    PutState(bytes, snapshot.timeLastAlienFired);
+    PutState(bytes, snapshot.mysteryShipSpawnInterval);
+    PutState(bytes, snapshot.timeLastSpawn);
+    PutState(bytes, snapshot.mysteryAlive);
+    PutState(bytes, snapshot.mysteryX);
+    PutState(bytes, snapshot.mysterySpeed);
+    PutState(bytes, snapshot.shieldCount);
+    PutState(bytes, snapshot.level);
+    PutState(bytes, snapshot.rng);
+    for (const ShipSnapshot &ship: snapshot.ships) {
+        PutState(bytes, ship.x);
+        PutState(bytes, ship.lastFireTime);
+        PutState(bytes, ship.lasers);
+    }
+    snapshot.script.Save(bytes);
+    PutState(bytes, snapshot.shields);
+    PutState(bytes, snapshot.aliens);
+    PutState(bytes, snapshot.alienLasers);
+}
+
+/**
+ * @brief Читает снимок из байтов WriteSnapshot.
+ *
+ * @param bytes Байты.
+ * @param snapshot Снимок.
+ * @return false, если байты повреждены.
+ */
+
+bool ReadSnapshot(const std::vector<uint8_t> &bytes, GameSnapshot &snapshot) {
+    StateReader reader(bytes.data(), bytes.size());
+    reader.Get(snapshot.run);
+    reader.Get(snapshot.simulationTime);
+    reader.Get(snapshot.lives);
+    reader.Get(snapshot.score);
+    reader.Get(snapshot.highscore);
+    reader.Get(snapshot.formationOrigin);
+    reader.Get(snapshot.alienShotCount);
+    reader.Get(snapshot.aliensDirection);
+    reader.Get(snapshot.timeLastAlienFired);
+    reader.Get(snapshot.mysteryShipSpawnInterval);
+    reader.Get(snapshot.timeLastSpawn);
+    reader.Get(snapshot.mysteryAlive);
+    reader.Get(snapshot.mysteryX);
+    reader.Get(snapshot.mysterySpeed);
+    reader.Get(snapshot.shieldCount);
+    reader.Get(snapshot.level);
+    reader.Get(snapshot.rng);
+    for (ShipSnapshot &ship: snapshot.ships) {
+        reader.Get(ship.x);
+        reader.Get(ship.lastFireTime);
+        reader.Get(ship.lasers);
+    }
+    // Сценарий уровня определяется номером уровня, прочитанным выше
+    if (!reader.ok || !snapshot.script.Load(reader, LevelProgram(snapshot.level))) {
+        return false;
+    }
+    reader.Get(snapshot.shields);
+    reader.Get(snapshot.aliens);
+    reader.Get(snapshot.alienLasers);
+    return reader.ok && reader.data == reader.end &&
+           snapshot.shields.size() == (size_t) snapshot.shieldCount * snapshotShieldRows;
+}
+
+/**
+ * @brief Добавляет байты значения к контрольной сумме FNV-1a.
+ */
+
+template<typename T>
+static void Mix(uint64_t &hash, const T &value) {
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(&value);
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+}
+
+/**
+ * @brief Добавляет лазеры к контрольной сумме.
+ */
+
+static void MixLasers(uint64_t &hash, const std::vector<Laser> &lasers) {
+    Mix(hash, lasers.size());
+    for (auto &laser: lasers) {
+        Mix(hash, laser.position.x);
+        Mix(hash, laser.position.y);
+        Mix(hash, laser.speed);
+        Mix(hash, laser.active);
+    }
+}
+
+/**
+ * @brief Возвращает контрольную сумму снимка (FNV-1a) для обнаружения расхождений.
+ *
+ * Генератор случайных чисел не учитывается: его расхождение быстро проявляется в остальном состоянии.
+ *
+ * @param snapshot Снимок.
+ * @return Контрольная сумма.
+ */
+
+uint64_t HashSnapshot(const GameSnapshot &snapshot) {
+    uint64_t hash = 14695981039346656037ull;
+    Mix(hash, snapshot.run);
+    Mix(hash, snapshot.simulationTime);
+    Mix(hash, snapshot.lives);
+    Mix(hash, snapshot.score);
+    Mix(hash, snapshot.formationOrigin.x);
+    Mix(hash, snapshot.formationOrigin.y);
+    Mix(hash, snapshot.alienShotCount);
+    Mix(hash, snapshot.aliensDirection);
+    Mix(hash, snapshot.timeLastAlienFired);
+    Mix(hash, snapshot.mysteryShipSpawnInterval);
+    Mix(hash, snapshot.timeLastSpawn);
+    Mix(hash, snapshot.mysteryAlive);
+    Mix(hash, snapshot.mysteryX);
+    Mix(hash, snapshot.mysterySpeed);
+    Mix(hash, snapshot.aliens.size());
+    for (auto &alien: snapshot.aliens) {
+        Mix(hash, alien.row);
+        Mix(hash, alien.column);
+        Mix(hash, alien.position.x);
+        Mix(hash, alien.position.y);
+    }
+    MixLasers(hash, snapshot.alienLasers);
+    for (auto &ship: snapshot.ships) {
+        Mix(hash, ship.x);
+        Mix(hash, ship.lastFireTime);
+        MixLasers(hash, ship.lasers);
+    }
+    // Первые четыре щита смешиваются блоком 4 x snapshotShieldRows, как до хранения всех щитов,
+    // поэтому контрольные суммы обычной игры не изменились
+    for (int i = 0; i < std::max(snapshot.shieldCount, 4) * snapshotShieldRows; ++i) {
+        Mix(hash, i < (int) snapshot.shields.size() ? snapshot.shields[i] : 0u);
+    }
+    Mix(hash, snapshot.shieldCount);
+    Mix(hash, snapshot.level);
+    return hash;
+}
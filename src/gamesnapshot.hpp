@@ -0,0 +1,175 @@
+/**
+ * @file gamesnapshot.hpp
+ * @brief Заголовочный файл, содержащий снимок состояния симуляции для отката и его контрольную сумму.
+ */
+
+#pragma once
+
+#include "game.hpp"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Количество рядов клеток щита в снимке.
+ */
+constexpr int snapshotShieldRows = 13;
+
+/**
+ * @struct ShipSnapshot
+ * @brief Состояние корабля игрока в снимке.
+ */
+struct ShipSnapshot {
+    /**
+     * @brief Координата X левого края корабля.
+     */
+    float x;
+    /**
+     * @brief Время последнего выстрела.
+     */
+    double lastFireTime;
+    /**
+     * @brief Лазеры корабля.
+     */
+    std::vector<Laser> lasers;
+};
+
+/**
+ * @struct GameSnapshot
+ * @brief Все изменяемое состояние симуляции Game, кроме ресурсов.
+ *
+ * Векторы переиспользуют память между сохранениями, поэтому снимки в кольцевом буфере
+ * после первых тиков сохраняются без выделения памяти. Щиты хранятся масками клеток.
+ */
+struct GameSnapshot {
+    /**
+     * @brief Флаг, указывающий, запущена ли игра.
+     */
+    bool run;
+    /**
+     * @brief Время симуляции в секундах.
+     */
+    double simulationTime;
+    /**
+     * @brief Количество жизней.
+     */
+    int lives;
+    /**
+     * @brief Счет.
+     */
+    int score;
+    /**
+     * @brief Рекорд.
+     */
+    int highscore;
+    /**
+     * @brief Позиция ячейки (0, 0) формации.
+     */
+    Vector2 formationOrigin;
+    /**
+     * @brief Количество выстрелов инопланетян.
+     */
+    int alienShotCount;
+    /**
+     * @brief Направление движения инопланетян.
+     */
+    int aliensDirection;
+    /**
+     * @brief Время последнего выстрела инопланетянина.
+     */
+    float timeLastAlienFired;
+    /**
+     * @brief Интервал появления загадочного корабля.
+     */
+    float mysteryShipSpawnInterval;
+    /**
+     * @brief Время последнего появления загадочного корабля.
+     */
+    float timeLastSpawn;
+    /**
+     * @brief Флаг живого загадочного корабля.
+     */
+    bool mysteryAlive;
+    /**
+     * @brief Координата X загадочного корабля.
+     */
+    float mysteryX;
+    /**
+     * @brief Скорость загадочного корабля.
+     */
+    int mysterySpeed;
+    /**
+     * @brief Инопланетяне в порядке вектора Game::aliens (от порядка зависит выбор стреляющих).
+     */
+    std::vector<Alien> aliens;
+    /**
+     * @brief Лазеры инопланетян.
+     */
+    std::vector<Laser> alienLasers;
+    /**
+     * @brief Корабли игроков; второй используется в совместном режиме.
+     */
+    ShipSnapshot ships[2];
+    /**
+     * @brief Клетки щитов: по маске столбцов на каждый ряд, snapshotShieldRows рядов на щит.
+     */
+    std::vector<uint32_t> shields;
+    /**
+     * @brief Количество щитов.
+     */
+    int shieldCount;
+    /**
+     * @brief Номер уровня.
+     */
+    int level;
+    /**
+     * @brief Сценарий уровня вместе с ожиданиями нитей.
+     */
+    LevelScript script;
+    /**
+     * @brief Генератор случайных чисел игры.
+     */
+    std::mt19937 rng;
+};
+
+/**
+ * @brief Сохраняет состояние симуляции игры в снимок.
+ *
+ * @param game Игра.
+ * @param snapshot Снимок.
+ */
+void SaveSnapshot(Game &game, GameSnapshot &snapshot);
+
+/**
+ * @brief Восстанавливает состояние симуляции игры из снимка.
+ *
+ * @param snapshot Снимок.
+ * @param game Игра.
+ */
+void RestoreSnapshot(const GameSnapshot &snapshot, Game &game);
+
+/**
+ * @brief Записывает снимок в байты для хранения в памяти процесса (см. statebytes.hpp).
+ *
+ * @param snapshot Снимок.
+ * @param bytes Байты (старое содержимое удаляется, память переиспользуется).
+ */
+void WriteSnapshot(const GameSnapshot &snapshot, std::vector<uint8_t> &bytes);
+
+/**
+ * @brief Читает снимок из байтов WriteSnapshot.
+ *
+ * @param bytes Байты.
+ * @param snapshot Снимок.
+ * @return false, если байты повреждены.
+ */
+bool ReadSnapshot(const std::vector<uint8_t> &bytes, GameSnapshot &snapshot);
+
+/**
+ * @brief Возвращает контрольную сумму снимка (FNV-1a) для обнаружения расхождений.
+ *
+ * Генератор случайных чисел не учитывается: его расхождение быстро проявляется в остальном состоянии.
+ *
+ * @param snapshot Снимок.
+ * @return Контрольная сумма.
+ */
+uint64_t HashSnapshot(const GameSnapshot &snapshot);
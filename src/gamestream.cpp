@@ -0,0 +1,123 @@
+/**
+ * @file gamestream.cpp
+ * @brief Файл реализации функций перевода состояния игры в состояние потока зрителя и обратно.
+ */
+
+#include "gamestream.hpp"
+#include <cmath>
+#include <cstring>
+
+/**
+ * @brief Переводит координату в половины пикселя.
+ */
+
+static int32_t HalfPixels(float value) {
+    return (int32_t) lroundf(value * 2);
+}
+
+/**
+ * @brief Дописывает активные лазеры в список снарядов.
+ */
+
+static void CaptureLasers(std::vector<Laser> &lasers, std::vector<StreamProjectile> &projectiles) {
+    projectiles.clear();
+    for (auto &laser: lasers) {
+        if (laser.active) {
+            projectiles.push_back({HalfPixels(laser.position.x), HalfPixels(laser.position.y), laser.speed});
+        }
+    }
+}
+
+/**
+ * @brief Заменяет лазеры списком снарядов.
+ */
+
+static void ApplyLasers(const std::vector<StreamProjectile> &projectiles, std::vector<Laser> &lasers) {
+    lasers.clear();
+    for (auto &projectile: projectiles) {
+        lasers.push_back(Laser({projectile.x / 2.0f, projectile.y / 2.0f}, projectile.speed));
+    }
+}
+
+/**
+ * @brief Снимает состояние игры для потока зрителя.
+ *
+ * Учитываются только активные лазеры; буферы состояния переиспользуются.
+ *
+ * @param game Игра.
+ * @param state Состояние для заполнения.
+ */
+
+void CaptureStreamState(Game &game, StreamState &state) {
+    state.tick = (uint32_t) lround(game.simulationTime / Game::tickDuration);
+    state.score = game.score;
+    state.highscore = game.highscore;
+    state.lives = game.lives;
+    state.run = game.run ? 1 : 0;
+    state.shipX = HalfPixels(game.spaceship.getRect().x);
+    state.formationX = HalfPixels(game.formationOrigin.x);
+    state.formationY = HalfPixels(game.formationOrigin.y);
+    state.direction = game.aliensDirection;
+
+    state.alive = 0;
+    for (int row = 0; row < Game::alienRows; ++row) {
+        for (int column = 0; column < Game::alienColumns; ++column) {
+            if (game.shooters.IsAlive(row, column)) {
+                state.alive |= 1ull << (row * Game::alienColumns + column);
+            }
+        }
+    }
+
+    state.mysteryAlive = game.mysteryship.alive ? 1 : 0;
+    state.mysteryX = game.mysteryship.alive ? HalfPixels(game.mysteryship.getRect().x) : 0;
+    state.mysterySpeed = game.mysteryship.alive ? game.mysteryship.getSpeed() : 0;
+
+    memset(state.shields, 0, sizeof(state.shields));
+    for (int i = 0; i < streamShieldCount && i < (int) game.obstacles.size(); ++i) {
+        game.obstacles[i].GetCells(state.shields[i]);
+    }
+
+    CaptureLasers(game.spaceship.lasers, state.playerLasers);
+    CaptureLasers(game.alienLasers, state.alienLasers);
+}
+
+/**
+ * @brief Переносит состояние потока в игру, чтобы отрисовать его методом Game::Draw.
+ *
+ * Игра используется только для отрисовки: таймеры, генератор и рекорд в файле не меняются.
+ *
+ * @param state Состояние потока.
+ * @param game Игра-зеркало.
+ */
+
+void ApplyStreamState(const StreamState &state, Game &game) {
+    game.simulationTime = state.tick * Game::tickDuration;
+    game.score = state.score;
+    game.highscore = state.highscore;
+    game.lives = state.lives;
+    game.run = state.run != 0;
+    game.spaceship.SetX(state.shipX / 2.0f);
+    game.formationOrigin = {state.formationX / 2.0f, state.formationY / 2.0f};
+    game.aliensDirection = state.direction;
+
+    game.aliens.clear();
+    for (int row = 0; row < Game::alienRows; ++row) {
+        int alienType = Game::AlienTypeForRow(row);
+        for (int column = 0; column < Game::alienColumns; ++column) {
+            if (state.alive & (1ull << (row * Game::alienColumns + column))) {
+                float x = game.formationOrigin.x + column * Game::alienSpacing;
+                float y = game.formationOrigin.y + row * Game::alienSpacing;
+                game.aliens.push_back(Alien(alienType, {x, y}, row, column));
+            }
+        }
+    }
+    game.IndexAliens();
+
+    for (int i = 0; i < streamShieldCount && i < (int) game.obstacles.size(); ++i) {
+        game.obstacles[i].SetCells(state.shields[i]);
+    }
+
+    game.mysteryship.Restore(state.mysteryAlive != 0, state.mysteryX / 2.0f, state.mysterySpeed);
+    ApplyLasers(state.playerLasers, game.spaceship.lasers);
+    ApplyLasers(state.alienLasers, game.alienLasers);
+}
@@ -0,0 +1,29 @@
+/**
+ * @file gamestream.hpp
+ * @brief Заголовочный файл, содержащий функции перевода состояния игры в состояние потока зрителя и обратно.
+ */
+
+#pragma once
+
+#include "game.hpp"
+#include "streamcodec.hpp"
+
+/**
+ * @brief Снимает состояние игры для потока зрителя.
+ *
+ * Учитываются только активные лазеры; буферы состояния переиспользуются.
+ *
+ * @param game Игра.
+ * @param state Состояние для заполнения.
+ */
+void CaptureStreamState(Game &game, StreamState &state);
+
+/**
+ * @brief Переносит состояние потока в игру, чтобы отрисовать его методом Game::Draw.
+ *
+ * Игра используется только для отрисовки: таймеры, генератор и рекорд в файле не меняются.
+ *
+ * @param state Состояние потока.
+ * @param game Игра-зеркало.
+ */
+void ApplyStreamState(const StreamState &state, Game &game);
@@ -0,0 +1,155 @@
+/**
+ * @file hud.cpp
+ * @brief Файл реализации функций отрисовки интерфейса игры.
+ */
+
+#include "hud.hpp"
+#include <algorithm>
+
+/**
+ * @brief Форматирует число с ведущими нулями.
+ *
+ * @param number Число для форматирования.
+ * @param width Ширина форматируемой строки (количество символов).
+ * @return Отформатированная строка с ведущими нулями.
+ */
+
+std::string FormatWithLeadingZeros(int number, int width) {
+    std::string numberText = std::to_string(number);
+    int leadingZeros = width - numberText.length();
+    return numberText = std::string(leadingZeros, '0') + numberText;
+}
+
+/**
+ * @brief Отрисовывает неизменную часть интерфейса: рамку, линию и подписи счета и рекорда.
+ *
+ * @param font Шрифт интерфейса.
+ */
+
+void DrawHudFrame(Font font) {
+    Color yellow = {243, 216, 63, 255};
+    // Отрисовка рамки и линии
+    DrawRectangleRoundedLines({10, 10, 780, 780}, 0.18f, 20, 2, yellow);
+    DrawLineEx({25, 730}, {775, 730}, 3, yellow);
+    // Подписи счета и рекорда
+    DrawTextEx(font, "SCORE", {50, 15}, 34, 2, yellow);
+    DrawTextEx(font, "HIGH-SCORE", {570, 15}, 34, 2, yellow);
+}
+
+/**
+ * @brief Отрисовывает изменяемую часть интерфейса: уровень, оставшиеся жизни, счет и рекорд.
+ *
+ * @param game Игра, состояние которой отображается.
+ * @param font Шрифт интерфейса.
+ * @param livesImage Изображение корабля для отображения жизней.
+ */
+
+void DrawHudValues(Game &game, Font font, Texture2D livesImage) {
+    Color yellow = {243, 216, 63, 255};
+    // Отображение текущего состояния игры (уровень или конец игры)
+    if (game.run) {
+        DrawTextEx(font, TextFormat("LEVEL %02d", game.level), {570, 740}, 34, 2, yellow);
+    } else {
+        DrawTextEx(font, "GAME OVER", {570, 740}, 34, 2, yellow);
+    }
+    // Отрисовка оставшихся жизней (космических кораблей)
+    float x = 50.0;
+    for (int i = 0; i < game.lives; i++) {
+        DrawTextureV(livesImage, {x, 745}, WHITE);
+        x += 50;
+    }
+    // Отрисовка текущего счета
+    std::string scoreText = FormatWithLeadingZeros(game.score, 5);
+    DrawTextEx(font, scoreText.c_str(), {50, 40}, 34, 2, yellow);
+    // Отрисовка рекорда
+    std::string highscoreText = FormatWithLeadingZeros(game.highscore, 5);
+    DrawTextEx(font, highscoreText.c_str(), {655, 40}, 34, 2, yellow);
+}
+
+/**
+ * @brief Отрисовывает рамку, уровень, оставшиеся жизни, счет и рекорд.
+ *
+ * @param game Игра, состояние которой отображается.
+ * @param font Шрифт интерфейса.
+ * @param livesImage Изображение корабля для отображения жизней.
+ */
+
+void DrawHud(Game &game, Font font, Texture2D livesImage) {
+    DrawHudFrame(font);
+    DrawHudValues(game, font, livesImage);
+}
+
+/**
+ * @brief Отрисовывает строку по центру экрана по горизонтали.
+ */
+
+static void DrawCenteredText(Font font, const char *text, float y, float size, Color color) {
+    Vector2 measure = MeasureTextEx(font, text, size, 2);
+    DrawTextEx(font, text, {(GetScreenWidth() - measure.x) / 2, y}, size, 2, color);
+}
+
+/**
+ * @brief Отрисовывает надпись паузы поверх кадра.
+ *
+ * @param font Шрифт интерфейса.
+ */
+
+void DrawPauseOverlay(Font font) {
+    Color yellow = {243, 216, 63, 255};
+    DrawRectangle(0, 0, GetScreenWidth(), GetScreenHeight(), {0, 0, 0, 120});
+    DrawCenteredText(font, "PAUSED", 360, 64, yellow);
+    DrawCenteredText(font, "PRESS P TO CONTINUE", 430, 34, yellow);
+}
+
+/**
+ * @brief Отрисовывает заставку поверх кадра: название, рекорд и мигающее приглашение.
+ *
+ * @param font Шрифт интерфейса.
+ * @param highscore Рекорд.
+ * @param showPrompt true, если приглашение в текущей фазе мигания видно.
+ */
+
+void DrawAttractOverlay(Font font, int highscore, bool showPrompt) {
+    Color yellow = {243, 216, 63, 255};
+    DrawRectangle(0, 0, GetScreenWidth(), GetScreenHeight(), {0, 0, 0, 200});
+    DrawCenteredText(font, "SPACE INVADERS", 280, 64, yellow);
+    std::string highscoreText = "HIGH-SCORE " + FormatWithLeadingZeros(highscore, 5);
+    DrawCenteredText(font, highscoreText.c_str(), 370, 34, yellow);
+    if (showPrompt) {
+        DrawCenteredText(font, "PRESS ENTER TO PLAY", 460, 34, yellow);
+    }
+}
+
+/**
+ * @brief Отрисовывает панель измерений (F3): частоту кадров, задержку от ввода до показа и ее гистограмму.
+ *
+ * @param pacer Ограничитель частоты кадров с измерениями.
+ */
+
+void DrawPacerOverlay(const FramePacer &pacer) {
+    Color green = {0, 228, 48, 255};
+    int x = 40;
+    int y = 90;
+    DrawRectangle(x - 10, y - 10, 290, 150, {0, 0, 0, 170});
+    DrawText(TextFormat("%d FPS  %s", GetFPS(), pacer.LowLatency() ? "low latency" : "normal"), x, y, 10, green);
+    const LatencyHistogram &latency = pacer.latency;
+    DrawText(TextFormat("input-to-present p50 %.2f  p99 %.2f  max %.2f ms", latency.Percentile(0.5) * 1000,
+                        latency.Percentile(0.99) * 1000, latency.Max() * 1000), x, y + 14, 10, green);
+    DrawText(TextFormat("work %.2f ms  pacing p99 %.2f ms  missed %lld", pacer.workEstimate * 1000,
+                        pacer.pacingError.Percentile(0.99) * 1000, pacer.missedFrames), x, y + 28, 10, green);
+
+    // Гистограмма задержки: первые 64 корзины, высота столбца относительно самой полной корзины
+    const std::vector<long long> &buckets = latency.Buckets();
+    int shown = std::min((int) buckets.size(), 64);
+    long long highest = 1;
+    for (int i = 0; i < shown; ++i) {
+        highest = std::max(highest, buckets[i]);
+    }
+    int baseline = y + 120;
+    for (int i = 0; i < shown; ++i) {
+        int height = (int) (buckets[i] * 70 / highest);
+        DrawRectangle(x + i * 4, baseline - height, 3, height, green);
+    }
+    DrawText(TextFormat("0 .. %.0f ms", shown * latency.BucketWidth() * 1000), x, baseline + 4, 10, green);
+}
+
@@ -0,0 +1,68 @@
+/**
+ * @file hud.hpp
+ * @brief Заголовочный файл, содержащий функции отрисовки интерфейса игры (рамка, счет, жизни).
+ */
+
+#pragma once
+
+#include "framepacer.hpp"
+#include "game.hpp"
+#include <string>
+#include <raylib.h>
+
+/**
+ * @brief Форматирует число с ведущими нулями.
+ *
+ * @param number Число для форматирования.
+ * @param width Ширина форматируемой строки (количество символов).
+ * @return Отформатированная строка с ведущими нулями.
+ */
+std::string FormatWithLeadingZeros(int number, int width);
+
+/**
+ * @brief Отрисовывает неизменную часть интерфейса: рамку, линию и подписи счета и рекорда.
+ *
+ * @param font Шрифт интерфейса.
+ */
+void DrawHudFrame(Font font);
+
+/**
+ * @brief Отрисовывает изменяемую часть интерфейса: уровень, оставшиеся жизни, счет и рекорд.
+ *
+ * @param game Игра, состояние которой отображается.
+ * @param font Шрифт интерфейса.
+ * @param livesImage Изображение корабля для отображения жизней.
+ */
+void DrawHudValues(Game &game, Font font, Texture2D livesImage);
+
+/**
+ * @brief Отрисовывает рамку, уровень, оставшиеся жизни, счет и рекорд.
+ *
+ * @param game Игра, состояние которой отображается.
+ * @param font Шрифт интерфейса.
+ * @param livesImage Изображение корабля для отображения жизней.
+ */
+void DrawHud(Game &game, Font font, Texture2D livesImage);
+
+/**
+ * @brief Отрисовывает надпись паузы поверх кадра.
+ *
+ * @param font Шрифт интерфейса.
+ */
+void DrawPauseOverlay(Font font);
+
+/**
+ * @brief Отрисовывает заставку поверх кадра: название, рекорд и мигающее приглашение.
+ *
+ * @param font Шрифт интерфейса.
+ * @param highscore Рекорд.
+ * @param showPrompt true, если приглашение в текущей фазе мигания видно.
+ */
+void DrawAttractOverlay(Font font, int highscore, bool showPrompt);
+
+/**
+ * @brief Отрисовывает панель измерений (F3): частоту кадров, задержку от ввода до показа и ее гистограмму.
+ *
+ * @param pacer Ограничитель частоты кадров с измерениями.
+ */
+void DrawPacerOverlay(const FramePacer &pacer);
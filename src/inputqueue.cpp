@@ -0,0 +1,119 @@
+/**
+ * @file inputqueue.cpp
+ * @brief Файл реализации очереди событий ввода.
+ */
+
+#include "inputqueue.hpp"
+
+/**
+ * @brief Конструктор класса InputQueue. Создает пустую очередь.
+ */
+
+InputQueue::InputQueue() {
+    Clear();
+}
+
+/**
+ * @brief Добавляет событие.
+ *
+ * События упорядочиваются по времени; события с одинаковым временем остаются в порядке добавления.
+ * Обычно события приходят по возрастанию времени, поэтому место ищется с конца очереди.
+ *
+ * @param event Событие.
+ */
+
+void InputQueue::Push(const InputEvent &event) {
+    if (event.player < 0 || event.player >= inputQueuePlayers || event.flags == 0) {
+        return;
+    }
+    auto position = events.end();
+    while (position != events.begin() && (position - 1)->time > event.time) {
+        --position;
+    }
+    events.insert(position, event);
+
+    PlayerState &state = players[event.player];
+    state.pushed = event.pressed ? state.pushed | event.flags : state.pushed & ~event.flags;
+}
+
+/**
+ * @brief Добавляет события, переводящие удерживаемые команды игрока в заданную маску.
+ *
+ * Подходит для источников, которые выдают маску на каждый тик: бота, записи, сетевого соперника.
+ *
+ * @param time Время события.
+ * @param player Номер игрока.
+ * @param flags Маска удерживаемых команд.
+ */
+
+void InputQueue::PushState(double time, int player, int flags) {
+    if (player < 0 || player >= inputQueuePlayers) {
+        return;
+    }
+    int released = players[player].pushed & ~flags;
+    int pressed = flags & ~players[player].pushed;
+    Push({time, player, released, false});
+    Push({time, player, pressed, true});
+}
+
+/**
+ * @brief Забирает события до границы тика включительно и считает маски команд тика.
+ *
+ * @param tickEnd Время конца тика.
+ */
+
+void InputQueue::Tick(double tickEnd) {
+    int latched[inputQueuePlayers] = {};
+    while (!events.empty() && events.front().time <= tickEnd) {
+        const InputEvent &event = events.front();
+        PlayerState &state = players[event.player];
+        if (event.pressed) {
+            state.held |= event.flags;
+            latched[event.player] |= event.flags;
+            if (event.flags & (INPUT_LEFT | INPUT_RIGHT)) {
+                state.lastDirection = event.flags & INPUT_RIGHT ? INPUT_RIGHT : INPUT_LEFT;
+            }
+        } else {
+            state.held &= ~event.flags;
+        }
+        events.pop_front();
+    }
+
+    for (int i = 0; i < inputQueuePlayers; ++i) {
+        PlayerState &state = players[i];
+        int input = state.held | latched[i];
+        if ((input & INPUT_LEFT) && (input & INPUT_RIGHT)) {
+            input = (input & ~(INPUT_LEFT | INPUT_RIGHT)) | state.lastDirection;
+        }
+        state.input = input;
+    }
+}
+
+/**
+ * @brief Возвращает маску команд игрока, посчитанную последним вызовом Tick.
+ *
+ * @param player Номер игрока.
+ */
+
+int InputQueue::Input(int player) const {
+    return player >= 0 && player < inputQueuePlayers ? players[player].input : 0;
+}
+
+/**
+ * @brief Возвращает количество событий, ожидающих своего тика.
+ */
+
+int InputQueue::Pending() const {
+    return events.size();
+}
+
+/**
+ * @brief Удаляет события и сбрасывает удерживаемые команды всех игроков.
+ */
+
+void InputQueue::Clear() {
+    events.clear();
+    for (auto &state: players) {
+        state = {0, 0, INPUT_LEFT, 0};
+    }
+}
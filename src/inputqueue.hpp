@@ -0,0 +1,131 @@
+/**
+ * @file inputqueue.hpp
+ * @brief Заголовочный файл, содержащий флаги команд игрока и очередь событий ввода с метками времени.
+ */
+
+#pragma once
+
+#include <deque>
+
+/**
+ * @enum InputFlags
+ * @brief Флаги команд игрока.
+ */
+enum InputFlags {
+    INPUT_LEFT = 1,  ///< Движение влево.
+    INPUT_RIGHT = 2, ///< Движение вправо.
+    INPUT_FIRE = 4,  ///< Выстрел.
+    INPUT_RESTART = 8 ///< Новая игра после окончания предыдущей.
+};
+
+/**
+ * @brief Количество игроков, для которых очередь ведет состояние.
+ */
+constexpr int inputQueuePlayers = 2;
+
+/**
+ * @struct InputEvent
+ * @brief Нажатие или отпускание команды игрока.
+ */
+struct InputEvent {
+    /**
+     * @brief Время события в секундах (в тех же единицах, что и границы тиков).
+     */
+    double time;
+    /**
+     * @brief Номер игрока.
+     */
+    int player;
+    /**
+     * @brief Флаги InputFlags, которых касается событие.
+     */
+    int flags;
+    /**
+     * @brief true - нажатие, false - отпускание.
+     */
+    bool pressed;
+};
+
+/**
+ * @class InputQueue
+ * @brief Очередь событий ввода, которая превращается в маску команд для каждого тика симуляции.
+ *
+ * Источники (клавиатура, бот, повтор записи, сетевой соперник) кладут события нажатия и
+ * отпускания с метками времени или целые маски удерживаемых команд (PushState). Tick забирает
+ * события до границы тика и для каждого игрока считает маску: удерживаемые к концу тика команды
+ * плюс команды, нажатые и отпущенные внутри тика, поэтому короткое нажатие не теряется. Если в
+ * маске оказались оба направления, остается то, которое нажато последним.
+ */
+
+class InputQueue {
+public:
+    /**
+     * @brief Конструктор класса InputQueue. Создает пустую очередь.
+     */
+    InputQueue();
+
+    /**
+     * @brief Добавляет событие.
+     *
+     * События упорядочиваются по времени; события с одинаковым временем остаются в порядке добавления.
+     *
+     * @param event Событие.
+     */
+    void Push(const InputEvent &event);
+
+    /**
+     * @brief Добавляет события, переводящие удерживаемые команды игрока в заданную маску.
+     *
+     * Подходит для источников, которые выдают маску на каждый тик: бота, записи, сетевого соперника.
+     *
+     * @param time Время события.
+     * @param player Номер игрока.
+     * @param flags Маска удерживаемых команд.
+     */
+    void PushState(double time, int player, int flags);
+
+    /**
+     * @brief Забирает события до границы тика включительно и считает маски команд тика.
+     *
+     * @param tickEnd Время конца тика.
+     */
+    void Tick(double tickEnd);
+
+    /**
+     * @brief Возвращает маску команд игрока, посчитанную последним вызовом Tick.
+     *
+     * @param player Номер игрока.
+     */
+    int Input(int player) const;
+
+    /**
+     * @brief Возвращает количество событий, ожидающих своего тика.
+     */
+    int Pending() const;
+
+    /**
+     * @brief Удаляет события и сбрасывает удерживаемые команды всех игроков.
+     */
+    void Clear();
+
+private:
+    /**
+     * @struct PlayerState
+     * @brief Состояние команд одного игрока.
+     */
+    struct PlayerState {
+        int held;          ///< Команды, удерживаемые после обработанных событий.
+        int pushed;        ///< Команды, удерживаемые после всех добавленных событий (для PushState).
+        int lastDirection; ///< Направление, нажатое последним (INPUT_LEFT или INPUT_RIGHT).
+        int input;         ///< Маска команд последнего тика.
+    };
+
+    /**
+     * @brief События, упорядоченные по времени.
+     */
+    std::deque<InputEvent> events;
+    /**
+     * @brief Состояния игроков.
+     */
+    PlayerState players[inputQueuePlayers];
+};
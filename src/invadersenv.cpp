@@ -0,0 +1,195 @@
+/**
+ * @file invadersenv.cpp
+ * @brief Реализация C API набора игр без окна.
+ */
+
+#include "invadersenv.h"
+#include "game.hpp"
+#include "observation.hpp"
+#include "softwarerenderer.hpp"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+/**
+ * @struct InvadersEnv
+ * @brief Набор игр без окна и общий программный растеризатор.
+ */
+
+struct InvadersEnv {
+    /**
+     * @brief Игры набора.
+     */
+    std::vector<std::unique_ptr<Game>> games;
+    /**
+     * @brief Растеризатор для наблюдений INVADERS_OBS_PIXELS.
+     */
+    std::unique_ptr<SoftwareRenderer> renderer;
+    /**
+     * @brief Тип наблюдения.
+     */
+    int observationType;
+    /**
+     * @brief Ширина кадра.
+     */
+    int width;
+    /**
+     * @brief Высота кадра.
+     */
+    int height;
+    /**
+     * @brief Количество кадров в стопке.
+     */
+    int stack;
+    /**
+     * @brief Флаг автоматического перезапуска закончившихся игр.
+     */
+    bool autoReset;
+};
+
+/**
+ * @brief Возвращает размер одного элемента наблюдения в байтах.
+ *
+ * @param env Набор игр.
+ */
+
+static size_t ElementSize(const InvadersEnv *env) {
+    return env->observationType == INVADERS_OBS_PIXELS ? sizeof(uint8_t) : sizeof(float);
+}
+
+/**
+ * @brief Возвращает указатель на наблюдение игры в общем буфере.
+ *
+ * @param env Набор игр.
+ * @param observations Буфер наблюдений всех игр подряд.
+ * @param index Номер игры.
+ */
+
+static void *ObservationAt(const InvadersEnv *env, void *observations, int index) {
+    return (unsigned char *) observations + (size_t) index * invaders_env_observation_size(env) * ElementSize(env);
+}
+
+/**
+ * @brief Записывает наблюдение игры.
+ *
+ * @param env Набор игр.
+ * @param game Игра.
+ * @param observation Буфер наблюдения одной игры.
+ * @param firstFrame true после перезапуска: вся стопка кадров заполняется первым кадром.
+ */
+
+static void Observe(InvadersEnv *env, Game &game, void *observation, bool firstFrame) {
+    if (env->observationType == INVADERS_OBS_FEATURES) {
+        FillObservation(game, (float *) observation);
+        return;
+    }
+
+    uint8_t *frames = (uint8_t *) observation;
+    size_t frameSize = (size_t) env->width * env->height;
+    env->renderer->RenderGrayStack(game, frames, env->width, env->height, env->stack);
+    if (firstFrame) {
+        for (int i = 0; i < env->stack - 1; ++i) {
+            std::copy(frames + frameSize * (env->stack - 1), frames + frameSize * env->stack, frames + frameSize * i);
+        }
+    }
+}
+
+/**
+ * @brief Начинает игру заново без записи наблюдения.
+ *
+ * @param game Игра.
+ * @param seed Новое начальное значение генератора или 0.
+ */
+
+static void Restart(Game &game, uint32_t seed) {
+    if (seed != 0) {
+        game.Seed(seed);
+    }
+    game.Reset();
+    game.InitGame();
+}
+
+int invaders_env_api_version(void) {
+    return INVADERS_ENV_API_VERSION;
+}
+
+InvadersEnv *invaders_env_create(int num_envs, int observation_type, int width, int height, int stack,
+                                 int auto_reset, uint32_t seed) {
+    if (num_envs <= 0) {
+        return nullptr;
+    }
+    if (observation_type != INVADERS_OBS_FEATURES && observation_type != INVADERS_OBS_PIXELS) {
+        return nullptr;
+    }
+    if (observation_type == INVADERS_OBS_PIXELS && (width <= 0 || height <= 0 || stack <= 0)) {
+        return nullptr;
+    }
+
+    SetTraceLogLevel(LOG_WARNING);
+    InvadersEnv *env = new InvadersEnv();
+    env->observationType = observation_type;
+    env->width = width;
+    env->height = height;
+    env->stack = stack;
+    env->autoReset = auto_reset != 0;
+    if (observation_type == INVADERS_OBS_PIXELS) {
+        env->renderer.reset(new SoftwareRenderer());
+    }
+    for (int i = 0; i < num_envs; ++i) {
+        env->games.emplace_back(new Game(true));
+        // Значение 0 здесь обычное начальное значение, а не просьба продолжить последовательность
+        env->games.back()->Seed(seed + i);
+        Restart(*env->games.back(), 0);
+    }
+    return env;
+}
+
+void invaders_env_destroy(InvadersEnv *env) {
+    delete env;
+}
+
+int invaders_env_num_envs(const InvadersEnv *env) {
+    return env->games.size();
+}
+
+int invaders_env_observation_size(const InvadersEnv *env) {
+    if (env->observationType == INVADERS_OBS_PIXELS) {
+        return env->width * env->height * env->stack;
+    }
+    return ObservationLayout::size;
+}
+
+void invaders_env_reset(InvadersEnv *env, int index, uint32_t seed, void *observation) {
+    Game &game = *env->games[index];
+    Restart(game, seed);
+    Observe(env, game, observation, true);
+}
+
+void invaders_env_reset_all(InvadersEnv *env, void *observations) {
+    for (int i = 0; i < (int) env->games.size(); ++i) {
+        invaders_env_reset(env, i, 0, ObservationAt(env, observations, i));
+    }
+}
+
+void invaders_env_step(InvadersEnv *env, int index, int32_t action, void *observation, float *reward, uint8_t *done) {
+    Game &game = *env->games[index];
+    int score = game.score;
+    game.ApplyInput(action);
+    game.Update();
+    *reward = float(game.score - score);
+    *done = game.run ? 0 : 1;
+
+    if (*done && env->autoReset) {
+        Restart(game, 0);
+        Observe(env, game, observation, true);
+    } else {
+        Observe(env, game, observation, false);
+    }
+}
+
+void invaders_env_step_all(InvadersEnv *env, const int32_t *actions, void *observations, float *rewards,
+                           uint8_t *dones) {
+    for (int i = 0; i < (int) env->games.size(); ++i) {
+        invaders_env_step(env, i, actions[i], ObservationAt(env, observations, i), &rewards[i], &dones[i]);
+    }
+}
@@ -0,0 +1,153 @@
+/**
+ * @file invadersenv.h
+ * @brief Стабильный C API для обучения агентов: набор игр без окна с пошаговым управлением.
+ *
+ * Все буферы наблюдений, наград и флагов окончания принадлежат вызывающей стороне; функции пишут
+ * прямо в них и не выделяют память на шаге. Наблюдение одной игры занимает
+ * invaders_env_observation_size() элементов: float32 для INVADERS_OBS_FEATURES и uint8 для
+ * INVADERS_OBS_PIXELS (stack кадров height x width в оттенках серого).
+ *
+ * Действие - комбинация флагов INVADERS_ACTION_*. Награда - прирост счета за шаг.
+ */
+
+#ifndef INVADERS_ENV_H
+#define INVADERS_ENV_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+#define INVADERS_ENV_API __declspec(dllexport)
+#else
+#define INVADERS_ENV_API __attribute__((visibility("default")))
+#endif
+
+/**
+ * @brief Версия C API. Увеличивается при несовместимых изменениях.
+ */
+#define INVADERS_ENV_API_VERSION 1
+
+/**
+ * @brief Наблюдение - вектор признаков float32 (см. observation.hpp).
+ */
+#define INVADERS_OBS_FEATURES 0
+/**
+ * @brief Наблюдение - стопка уменьшенных кадров uint8 в оттенках серого.
+ */
+#define INVADERS_OBS_PIXELS 1
+
+/**
+ * @brief Действие: движение влево.
+ */
+#define INVADERS_ACTION_LEFT 1
+/**
+ * @brief Действие: движение вправо.
+ */
+#define INVADERS_ACTION_RIGHT 2
+/**
+ * @brief Действие: выстрел.
+ */
+#define INVADERS_ACTION_FIRE 4
+
+/**
+ * @brief Непрозрачный набор игр.
+ */
+typedef struct InvadersEnv InvadersEnv;
+
+/**
+ * @brief Возвращает версию C API библиотеки.
+ *
+ * @return INVADERS_ENV_API_VERSION, с которой собрана библиотека.
+ */
+INVADERS_ENV_API int invaders_env_api_version(void);
+
+/**
+ * @brief Создает набор игр.
+ *
+ * @param num_envs Количество игр.
+ * @param observation_type INVADERS_OBS_FEATURES или INVADERS_OBS_PIXELS.
+ * @param width Ширина кадра для INVADERS_OBS_PIXELS.
+ * @param height Высота кадра для INVADERS_OBS_PIXELS.
+ * @param stack Количество кадров в стопке для INVADERS_OBS_PIXELS.
+ * @param auto_reset Ненулевое значение, если закончившиеся игры начинаются заново внутри шага.
+ * @param seed Начальное значение генераторов; игра i получает seed + i (в том числе при seed = 0).
+ * @return Набор игр или NULL при неверных параметрах.
+ */
+INVADERS_ENV_API InvadersEnv *invaders_env_create(int num_envs, int observation_type, int width, int height,
+                                                  int stack, int auto_reset, uint32_t seed);
+
+/**
+ * @brief Уничтожает набор игр.
+ *
+ * @param env Набор игр.
+ */
+INVADERS_ENV_API void invaders_env_destroy(InvadersEnv *env);
+
+/**
+ * @brief Возвращает количество игр в наборе.
+ *
+ * @param env Набор игр.
+ */
+INVADERS_ENV_API int invaders_env_num_envs(const InvadersEnv *env);
+
+/**
+ * @brief Возвращает количество элементов наблюдения одной игры.
+ *
+ * @param env Набор игр.
+ */
+INVADERS_ENV_API int invaders_env_observation_size(const InvadersEnv *env);
+
+/**
+ * @brief Начинает игру заново.
+ *
+ * @param env Набор игр.
+ * @param index Номер игры.
+ * @param seed Новое начальное значение генератора или 0, чтобы продолжить текущую последовательность.
+ * @param observation Буфер наблюдения одной игры.
+ */
+INVADERS_ENV_API void invaders_env_reset(InvadersEnv *env, int index, uint32_t seed, void *observation);
+
+/**
+ * @brief Начинает заново все игры набора.
+ *
+ * @param env Набор игр.
+ * @param observations Буфер наблюдений всех игр подряд.
+ */
+INVADERS_ENV_API void invaders_env_reset_all(InvadersEnv *env, void *observations);
+
+/**
+ * @brief Выполняет один тик одной игры.
+ *
+ * @param env Набор игр.
+ * @param index Номер игры.
+ * @param action Комбинация флагов INVADERS_ACTION_*.
+ * @param observation Буфер наблюдения одной игры.
+ * @param reward Награда за шаг.
+ * @param done 1, если игра закончилась на этом шаге.
+ */
+INVADERS_ENV_API void invaders_env_step(InvadersEnv *env, int index, int32_t action, void *observation,
+                                        float *reward, uint8_t *done);
+
+/**
+ * @brief Выполняет один тик во всех играх набора.
+ *
+ * Если включен auto_reset, закончившиеся игры начинаются заново, и в буфер записывается
+ * первое наблюдение новой игры, а done остается равным 1.
+ *
+ * @param env Набор игр.
+ * @param actions Действия для каждой игры.
+ * @param observations Буфер наблюдений всех игр подряд.
+ * @param rewards Награды для каждой игры.
+ * @param dones Флаги окончания для каждой игры.
+ */
+INVADERS_ENV_API void invaders_env_step_all(InvadersEnv *env, const int32_t *actions, void *observations,
+                                            float *rewards, uint8_t *dones);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
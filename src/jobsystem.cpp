@@ -0,0 +1,195 @@
+/**
+ * @file jobsystem.cpp
+ * @brief Файл реализации класса JobSystem.
+ */
+
+#include "jobsystem.hpp"
+#include <algorithm>
+
+/**
+ * @brief Конструктор класса JobSystem. Запускает threads - 1 рабочих потоков.
+ *
+ * @param threads Количество потоков вместе с вызывающим (1 - циклы выполняются без потоков).
+ */
+
+JobSystem::JobSystem(int threads) {
+    body = nullptr;
+    grain = 1;
+    remaining = 0;
+    generation = 0;
+    stopping = false;
+    threads = std::max(1, threads);
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back(new Worker());
+    }
+    for (int i = 1; i < threads; ++i) {
+        workers[i]->thread = std::thread(&JobSystem::WorkerLoop, this, i);
+    }
+}
+
+/**
+ * @brief Деструктор класса JobSystem. Останавливает рабочие потоки.
+ */
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> guard(wakeLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &worker: workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+/**
+ * @brief Выполняет body для всех индексов [0, count) диапазонами не больше grain индексов.
+ *
+ * Весь диапазон кладется в очередь вызывающего потока, рабочие потоки получают его части кражей.
+ * Вызывающий поток возвращается, когда выполнены все индексы, поэтому после возврата результаты
+ * тела цикла видны ему целиком.
+ *
+ * @param count Количество индексов.
+ * @param grain Наибольший размер диапазона одного вызова body.
+ * @param body Тело цикла; получает начало и конец диапазона.
+ */
+
+void JobSystem::ParallelFor(int count, int grain, const std::function<void(int, int)> &body) {
+    if (count <= 0) {
+        return;
+    }
+    grain = std::max(1, grain);
+    if (workers.size() == 1 || count <= grain) {
+        body(0, count);
+        return;
+    }
+
+    this->body = &body;
+    this->grain = grain;
+    remaining.store(count, std::memory_order_relaxed);
+    Push(0, {0, count});
+    {
+        std::lock_guard<std::mutex> guard(wakeLock);
+        generation++;
+    }
+    wake.notify_all();
+
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        if (!RunOne(0)) {
+            std::this_thread::yield();
+        }
+    }
+    this->body = nullptr;
+}
+
+/**
+ * @brief Возвращает количество потоков вместе с вызывающим.
+ */
+
+int JobSystem::Threads() const {
+    return workers.size();
+}
+
+/**
+ * @brief Возвращает количество аппаратных потоков процессора (не меньше 1).
+ */
+
+int JobSystem::HardwareThreads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * @brief Цикл рабочего потока: ждет новый параллельный цикл и участвует в нем до конца.
+ *
+ * Между циклами поток спит на условной переменной, поэтому пул без работы не занимает процессор.
+ */
+
+void JobSystem::WorkerLoop(int worker) {
+    unsigned long long seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> guard(wakeLock);
+            wake.wait(guard, [&] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            if (!RunOne(worker)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+/**
+ * @brief Берет диапазон из своей или чужой очереди и выполняет его.
+ *
+ * Диапазон больше зерна делится пополам: верхняя половина возвращается в свою очередь, где ее
+ * могут украсть, нижняя делится дальше.
+ *
+ * @return false, если работы не нашлось.
+ */
+
+bool JobSystem::RunOne(int worker) {
+    Range range;
+    if (!Pop(worker, range) && !Steal(worker, range)) {
+        return false;
+    }
+    while (range.end - range.begin > grain) {
+        int middle = range.begin + (range.end - range.begin) / 2;
+        Push(worker, {middle, range.end});
+        range.end = middle;
+    }
+    (*body)(range.begin, range.end);
+    remaining.fetch_sub(range.end - range.begin, std::memory_order_acq_rel);
+    return true;
+}
+
+/**
+ * @brief Берет диапазон с конца своей очереди.
+ */
+
+bool JobSystem::Pop(int worker, Range &range) {
+    Worker &own = *workers[worker];
+    std::lock_guard<std::mutex> guard(own.lock);
+    if (own.queue.empty()) {
+        return false;
+    }
+    range = own.queue.back();
+    own.queue.pop_back();
+    return true;
+}
+
+/**
+ * @brief Крадет диапазон из начала очереди другого потока.
+ *
+ * Очереди перебираются начиная со следующего потока, чтобы воры не сходились на одной очереди.
+ */
+
+bool JobSystem::Steal(int thief, Range &range) {
+    int count = workers.size();
+    for (int offset = 1; offset < count; ++offset) {
+        Worker &victim = *workers[(thief + offset) % count];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.queue.empty()) {
+            range = victim.queue.front();
+            victim.queue.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Кладет диапазон в конец очереди потока.
+ */
+
+void JobSystem::Push(int worker, Range range) {
+    Worker &own = *workers[worker];
+    std::lock_guard<std::mutex> guard(own.lock);
+    own.queue.push_back(range);
+}
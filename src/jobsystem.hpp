@@ -0,0 +1,149 @@
+/**
+ * @file jobsystem.hpp
+ * @brief Заголовочный файл, содержащий класс JobSystem - пул потоков с кражей работы.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class JobSystem
+ * @brief Пул потоков для параллельных циклов внутри тика с кражей работы между потоками.
+ *
+ * У каждого потока своя очередь диапазонов. Поток берет диапазон с конца своей очереди, делит
+ * его пополам, пока он больше зерна, кладет верхние половины обратно и выполняет нижнюю. Поток
+ * без работы крадет диапазон из начала чужой очереди - самый крупный из оставшихся. Вызывающий
+ * поток работает наравне с остальными и возвращается, когда выполнен весь цикл.
+ *
+ * Пул не задает порядок выполнения диапазонов, поэтому тело цикла должно писать результаты
+ * только в ячейки своих индексов, а сводить их - вызывающий код после цикла по порядку индексов.
+ * Так результат не зависит от количества потоков.
+ */
+
+class JobSystem {
+public:
+    /**
+     * @brief Конструктор класса JobSystem. Запускает threads - 1 рабочих потоков.
+     *
+     * @param threads Количество потоков вместе с вызывающим (1 - циклы выполняются без потоков).
+     */
+    explicit JobSystem(int threads = 1);
+
+    /**
+     * @brief Деструктор класса JobSystem. Останавливает рабочие потоки.
+     */
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    /**
+     * @brief Выполняет body для всех индексов [0, count) диапазонами не больше grain индексов.
+     *
+     * Если count не больше grain или потоков нет, body вызывается один раз в вызывающем потоке.
+     * Вызов из тела цикла не поддерживается.
+     *
+     * @param count Количество индексов.
+     * @param grain Наибольший размер диапазона одного вызова body.
+     * @param body Тело цикла; получает начало и конец диапазона.
+     */
+    void ParallelFor(int count, int grain, const std::function<void(int, int)> &body);
+
+    /**
+     * @brief Возвращает количество потоков вместе с вызывающим.
+     */
+    int Threads() const;
+
+    /**
+     * @brief Возвращает количество аппаратных потоков процессора (не меньше 1).
+     */
+    static int HardwareThreads();
+
+private:
+    /**
+     * @struct Range
+     * @brief Диапазон индексов цикла.
+     */
+    struct Range {
+        int begin; ///< Первый индекс.
+        int end;   ///< Индекс за последним.
+    };
+
+    /**
+     * @struct Worker
+     * @brief Очередь диапазонов потока; поток 0 - вызывающий.
+     */
+    struct Worker {
+        std::mutex lock;         ///< Защищает очередь.
+        std::deque<Range> queue; ///< Диапазоны; владелец берет с конца, воры - из начала.
+        std::thread thread;      ///< Рабочий поток (пустой у вызывающего).
+    };
+
+    /**
+     * @brief Цикл рабочего потока: ждет новый параллельный цикл и участвует в нем до конца.
+     */
+    void WorkerLoop(int worker);
+
+    /**
+     * @brief Берет диапазон из своей или чужой очереди и выполняет его.
+     *
+     * @return false, если работы не нашлось.
+     */
+    bool RunOne(int worker);
+
+    /**
+     * @brief Берет диапазон с конца своей очереди.
+     */
+    bool Pop(int worker, Range &range);
+
+    /**
+     * @brief Крадет диапазон из начала очереди другого потока.
+     */
+    bool Steal(int thief, Range &range);
+
+    /**
+     * @brief Кладет диапазон в конец очереди потока.
+     */
+    void Push(int worker, Range range);
+
+    /**
+     * @brief Очереди потоков.
+     */
+    std::vector<std::unique_ptr<Worker>> workers;
+    /**
+     * @brief Тело текущего цикла.
+     */
+    const std::function<void(int, int)> *body;
+    /**
+     * @brief Зерно текущего цикла.
+     */
+    int grain;
+    /**
+     * @brief Количество еще не выполненных индексов текущего цикла.
+     */
+    std::atomic<int> remaining;
+    /**
+     * @brief Защищает generation и stopping.
+     */
+    std::mutex wakeLock;
+    /**
+     * @brief Будит рабочие потоки при новом цикле и остановке.
+     */
+    std::condition_variable wake;
+    /**
+     * @brief Номер последнего запущенного цикла.
+     */
+    unsigned long long generation;
+    /**
+     * @brief Флаг остановки рабочих потоков.
+     */
+    bool stopping;
+};
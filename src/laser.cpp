@@ -4,6 +4,7 @@
  */
 
 #include "laser.hpp"
+#include "platform.hpp"
 #include <iostream>
 
 /**
@@ -54,7 +55,7 @@ Rectangle Laser::getRect() {
 void Laser::Update() {
     position.y += speed;
     if (active) {
-        if (position.y > GetScreenHeight() - 100 || position.y < 25) {
+        if (position.y > ScreenHeight() - 100 || position.y < 25) {
             active = false;
         }
     }
@@ -0,0 +1,647 @@
+/**
+ * @file leaderboard.cpp
+ * @brief Файл реализации, содержащий методы класса Leaderboard.
+ */
+
+#include "leaderboard.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <cstdlib>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Сигнатура индекса таблицы рекордов.
+ */
+
+static const char leaderboardMagic[8] = {'I', 'N', 'V', 'S', 'C', 'O', 'R', 'E'};
+
+/**
+ * @brief Возвращает хеш FNV-1a байтов.
+ */
+
+static uint32_t Hash(const void *data, size_t size) {
+    const uint8_t *bytes = (const uint8_t *) data;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Возвращает контрольную сумму записи журнала.
+ */
+
+static uint32_t Checksum(const LeaderboardEntry &entry) {
+    return Hash(&entry, offsetof(LeaderboardEntry, checksum));
+}
+
+/**
+ * @brief Проверяет, стоит ли результат a выше результата b: больший счет или та же сумма раньше.
+ */
+
+static bool Better(int scoreA, uint32_t recordA, int scoreB, uint32_t recordB) {
+    return scoreA > scoreB || (scoreA == scoreB && recordA < recordB);
+}
+
+/**
+ * @brief Копирует имя игрока в поле фиксированного размера, дополняя нулями.
+ */
+
+static void CopyName(char *destination, const char *player) {
+    memset(destination, 0, leaderboardNameSize);
+    strncpy(destination, player, leaderboardNameSize - 1);
+}
+
+/**
+ * @brief Конструктор класса Leaderboard. Создает закрытую таблицу.
+ */
+
+Leaderboard::Leaderboard() {
+    log = nullptr;
+    indexFile = -1;
+    base = nullptr;
+    size = 0;
+    records = 0;
+    replayed = 0;
+    rebuilt = false;
+}
+
+/**
+ * @brief Деструктор класса Leaderboard. Закрывает таблицу.
+ */
+
+Leaderboard::~Leaderboard() {
+    Close();
+}
+
+/**
+ * @brief Открывает или создает таблицу и восстанавливает индекс после сбоя.
+ *
+ * Записи журнала, уже учтенные в индексе, не читаются. Записи после них проверяются
+ * контрольной суммой и учитываются; первая неполная или испорченная запись отрезается вместе
+ * со всем, что за ней. Индекс с другой емкостью, поднятым флагом изменения или учтенными
+ * записями, которых нет в журнале, строится заново.
+ *
+ * @param path Путь к файлам таблицы без расширения.
+ * @param topCapacity Количество хранимых лучших результатов.
+ * @return false, если файлы не открылись, таблица уже открыта другим объектом или индекс не удалось
+ *         дополнить записями журнала.
+ */
+
+bool Leaderboard::Open(const char *path, int topCapacity) {
+    Close();
+    logPath = std::string(path) + ".log";
+    indexPath = std::string(path) + ".idx";
+    uint32_t capacity = std::max(topCapacity, 1);
+
+    log = fopen(logPath.c_str(), "r+b");
+    if (log == nullptr) {
+        log = fopen(logPath.c_str(), "w+b");
+    }
+    if (log == nullptr) {
+        return false;
+    }
+    fseek(log, 0, SEEK_END);
+    long long bytes = ftell(log);
+    records = bytes / sizeof(LeaderboardEntry);
+
+#if defined(_WIN32)
+    FILE *file = fopen(indexPath.c_str(), "rb");
+    if (file != nullptr) {
+        fseek(file, 0, SEEK_END);
+        long length = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        if (length > 0 && MapIndex(length) && fread(base, 1, length, file) != (size_t) length) {
+            memset(base, 0, length);
+        }
+        fclose(file);
+    }
+#else
+    indexFile = open(indexPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    // Второй объект, открывший ту же таблицу, дописывал бы журнал поверх первого
+    if (indexFile < 0 || flock(indexFile, LOCK_EX | LOCK_NB) != 0) {
+        Close();
+        return false;
+    }
+    struct stat status;
+    if (fstat(indexFile, &status) == 0 && status.st_size > 0 && !MapIndex(status.st_size)) {
+        Close();
+        return false;
+    }
+#endif
+
+    rebuilt = !IndexValid(capacity) || Header()->logRecords > records;
+    if (rebuilt && !ResetIndex(capacity, initialPlayers)) {
+        Close();
+        return false;
+    }
+
+    uint32_t record = Header()->logRecords;
+    replayed = records - record;
+    fseek(log, (long) record * sizeof(LeaderboardEntry), SEEK_SET);
+    LeaderboardEntry entry;
+    for (; record < records; ++record) {
+        if (fread(&entry, sizeof(entry), 1, log) != 1 || entry.checksum != Checksum(entry)) {
+            break;
+        }
+        // Индекс не вырос (нет места на диске или памяти): журнал цел, и его нельзя обрезать
+        if (!Apply(entry, record)) {
+            Close();
+            return false;
+        }
+    }
+    if (record * sizeof(LeaderboardEntry) != (unsigned long long) bytes) {
+        // Отрезается запись, которую не успели дописать, и все, что за ней
+        fflush(log);
+#if defined(_WIN32)
+        _chsize_s(_fileno(log), (long long) record * sizeof(LeaderboardEntry));
+#else
+        if (ftruncate(fileno(log), (off_t) record * sizeof(LeaderboardEntry)) != 0) {
+            Close();
+            return false;
+        }
+#endif
+        replayed -= records - record;
+        records = record;
+    }
+    return true;
+}
+
+/**
+ * @brief Закрывает таблицу.
+ *
+ * В Windows индекс записывается в файл только здесь; после сбоя он восстанавливается из журнала.
+ */
+
+void Leaderboard::Close() {
+    if (base != nullptr) {
+#if defined(_WIN32)
+        FILE *file = fopen(indexPath.c_str(), "wb");
+        if (file != nullptr) {
+            fwrite(base, 1, size, file);
+            fclose(file);
+        }
+        free(base);
+#else
+        munmap((void *) base, size);
+#endif
+        base = nullptr;
+        size = 0;
+    }
+#if !defined(_WIN32)
+    if (indexFile >= 0) {
+        close(indexFile);
+        indexFile = -1;
+    }
+#endif
+    if (log != nullptr) {
+        fclose(log);
+        log = nullptr;
+    }
+    records = 0;
+}
+
+/**
+ * @brief Добавляет результат игры.
+ *
+ * Запись сначала дописывается в журнал и только потом учитывается в индексе, поэтому при сбое
+ * индекс не опережает журнал.
+ *
+ * @param player Имя игрока; обрезается до leaderboardNameSize - 1 символов.
+ * @param score Счет.
+ * @param level Достигнутый уровень.
+ * @param time Время окончания игры (секунды Unix).
+ * @return false, если таблица закрыта, имя пустое или запись в журнал не удалась.
+ */
+
+bool Leaderboard::Add(const char *player, int score, int level, uint32_t time) {
+    if (log == nullptr || base == nullptr || player == nullptr || player[0] == 0 || records == leaderboardNoRecord) {
+        return false;
+    }
+    LeaderboardEntry entry;
+    CopyName(entry.player, player);
+    entry.score = score;
+    entry.level = level;
+    entry.time = time;
+    const LeaderboardPlayer *slot = FindPlayer(entry.player);
+    entry.previous = slot->player[0] != 0 ? slot->latest : leaderboardNoRecord;
+    entry.checksum = Checksum(entry);
+
+    fseek(log, (long) records * sizeof(LeaderboardEntry), SEEK_SET);
+    if (fwrite(&entry, sizeof(entry), 1, log) != 1 || fflush(log) != 0) {
+        return false;
+    }
+    if (!Apply(entry, records)) {
+        return false;
+    }
+    records++;
+    return true;
+}
+
+/**
+ * @brief Возвращает лучшие результаты по убыванию счета; равные - в порядке игр.
+ *
+ * Результаты идут по нижнему уровню списка с пропусками, уже упорядоченному.
+ *
+ * @param count Наибольшее количество результатов.
+ * @param entries Результаты.
+ * @return Количество результатов.
+ */
+
+int Leaderboard::Top(int count, std::vector<LeaderboardEntry> &entries) const {
+    entries.clear();
+    if (base == nullptr) {
+        return 0;
+    }
+    const LeaderboardNode *nodes = Nodes();
+    for (uint32_t node = nodes[0].next[0]; node != 0 && (int) entries.size() < count; node = nodes[node].next[0]) {
+        entries.push_back(nodes[node].entry);
+    }
+    return entries.size();
+}
+
+/**
+ * @brief Возвращает игры игрока от последней к первой.
+ *
+ * @param player Имя игрока.
+ * @param count Наибольшее количество игр.
+ * @param entries Игры.
+ * @return Количество игр.
+ */
+
+int Leaderboard::History(const char *player, int count, std::vector<LeaderboardEntry> &entries) {
+    entries.clear();
+    if (base == nullptr) {
+        return 0;
+    }
+    char name[leaderboardNameSize];
+    CopyName(name, player);
+    const LeaderboardPlayer *slot = FindPlayer(name);
+    uint32_t record = slot->player[0] != 0 ? slot->latest : leaderboardNoRecord;
+    LeaderboardEntry entry;
+    while (record != leaderboardNoRecord && (int) entries.size() < count && ReadRecord(record, entry)) {
+        entries.push_back(entry);
+        record = entry.previous;
+    }
+    return entries.size();
+}
+
+/**
+ * @brief Возвращает лучший счет игрока или -1, если игрок не играл.
+ */
+
+int Leaderboard::Best(const char *player) const {
+    if (base == nullptr) {
+        return -1;
+    }
+    char name[leaderboardNameSize];
+    CopyName(name, player);
+    const LeaderboardPlayer *slot = FindPlayer(name);
+    return slot->player[0] != 0 ? slot->best : -1;
+}
+
+/**
+ * @brief Возвращает количество игр игрока.
+ */
+
+int Leaderboard::Runs(const char *player) const {
+    if (base == nullptr) {
+        return 0;
+    }
+    char name[leaderboardNameSize];
+    CopyName(name, player);
+    const LeaderboardPlayer *slot = FindPlayer(name);
+    return slot->player[0] != 0 ? slot->runs : 0;
+}
+
+/**
+ * @brief Возвращает лучший счет таблицы или 0, если она пуста.
+ */
+
+int Leaderboard::BestScore() const {
+    if (base == nullptr || Nodes()[0].next[0] == 0) {
+        return 0;
+    }
+    return Nodes()[Nodes()[0].next[0]].entry.score;
+}
+
+/**
+ * @brief Возвращает количество записей журнала.
+ */
+
+long long Leaderboard::Count() const {
+    return records;
+}
+
+/**
+ * @brief Возвращает количество игроков.
+ */
+
+int Leaderboard::Players() const {
+    return base != nullptr ? Header()->playerCount : 0;
+}
+
+/**
+ * @brief Возвращает количество записей журнала, учтенных в индексе при открытии.
+ */
+
+long long Leaderboard::Replayed() const {
+    return replayed;
+}
+
+/**
+ * @brief Проверяет, строился ли индекс при открытии заново.
+ */
+
+bool Leaderboard::Rebuilt() const {
+    return rebuilt;
+}
+
+/**
+ * @brief Возвращает размер индекса в байтах.
+ */
+
+size_t Leaderboard::IndexSize(uint32_t topCapacity, uint32_t playerCapacity) {
+    return sizeof(LeaderboardIndexHeader) + (size_t) (topCapacity + 1) * sizeof(LeaderboardNode) +
+           (size_t) playerCapacity * sizeof(LeaderboardPlayer);
+}
+
+/**
+ * @brief Отображает индекс в память с заданным размером, сохраняя содержимое.
+ *
+ * Новые байты заполнены нулями.
+ */
+
+bool Leaderboard::MapIndex(size_t size) {
+#if defined(_WIN32)
+    uint8_t *resized = (uint8_t *) realloc(base, size);
+    if (resized == nullptr) {
+        return false;
+    }
+    if (size > this->size) {
+        memset(resized + this->size, 0, size - this->size);
+    }
+    base = resized;
+#else
+    if (base != nullptr) {
+        munmap((void *) base, this->size);
+        base = nullptr;
+        this->size = 0;
+    }
+    struct stat status;
+    if (fstat(indexFile, &status) != 0 || ((size_t) status.st_size != size && ftruncate(indexFile, size) != 0)) {
+        return false;
+    }
+    void *mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, indexFile, 0);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    base = (uint8_t *) mapping;
+#endif
+    this->size = size;
+    return true;
+}
+
+/**
+ * @brief Создает пустой индекс.
+ */
+
+bool Leaderboard::ResetIndex(uint32_t topCapacity, uint32_t playerCapacity) {
+    if (!MapIndex(IndexSize(topCapacity, playerCapacity))) {
+        return false;
+    }
+    memset(base, 0, size);
+    LeaderboardIndexHeader *header = Header();
+    memcpy(header->magic, leaderboardMagic, 8);
+    header->version = leaderboardVersion;
+    header->topCapacity = topCapacity;
+    header->topLevel = 1;
+    header->playerCapacity = playerCapacity;
+    header->random = 0x9E3779B9u;
+    return true;
+}
+
+/**
+ * @brief Проверяет заголовок и размеры отображенного индекса.
+ */
+
+bool Leaderboard::IndexValid(uint32_t topCapacity) const {
+    if (base == nullptr || size < sizeof(LeaderboardIndexHeader)) {
+        return false;
+    }
+    const LeaderboardIndexHeader *header = Header();
+    uint32_t players = header->playerCapacity;
+    return memcmp(header->magic, leaderboardMagic, 8) == 0 && header->version == leaderboardVersion &&
+           header->dirty == 0 && header->topCapacity == topCapacity && header->topCount <= topCapacity &&
+           header->topLevel >= 1 && header->topLevel <= leaderboardMaxLevel && players > 0 &&
+           (players & (players - 1)) == 0 && header->playerCount * 2 <= players &&
+           size == IndexSize(topCapacity, players);
+}
+
+/**
+ * @brief Учитывает запись журнала в индексе.
+ *
+ * Пока индекс изменяется, в заголовке поднят флаг: индекс, брошенный на середине изменения,
+ * при следующем открытии строится заново.
+ */
+
+bool Leaderboard::Apply(const LeaderboardEntry &entry, uint32_t record) {
+    if ((Header()->playerCount + 1) * 2 > Header()->playerCapacity && !GrowPlayers()) {
+        return false;
+    }
+    LeaderboardIndexHeader *header = Header();
+    header->dirty = 1;
+    InsertTop(entry, record);
+    LeaderboardPlayer *slot = FindPlayer(entry.player);
+    if (slot->player[0] == 0) {
+        memcpy(slot->player, entry.player, leaderboardNameSize);
+        slot->best = entry.score;
+        slot->runs = 0;
+        header->playerCount++;
+    }
+    slot->latest = record;
+    slot->best = std::max(slot->best, entry.score);
+    slot->runs++;
+    header->logRecords = record + 1;
+    header->dirty = 0;
+    return true;
+}
+
+/**
+ * @brief Добавляет результат в список лучших, вытесняя худший, если список заполнен.
+ *
+ * Худший результат - последний узел нижнего уровня. Результат не лучше худшего в заполненный
+ * список не попадает; иначе узел худшего убирается со всех уровней и занимается новым.
+ */
+
+void Leaderboard::InsertTop(const LeaderboardEntry &entry, uint32_t record) {
+    LeaderboardIndexHeader *header = Header();
+    LeaderboardNode *nodes = Nodes();
+    uint32_t update[leaderboardMaxLevel];
+    uint32_t node;
+    if (header->topCount < header->topCapacity) {
+        node = ++header->topCount;
+    } else {
+        uint32_t last = 0;
+        for (int level = header->topLevel - 1; level >= 0; --level) {
+            while (nodes[last].next[level] != 0) {
+                last = nodes[last].next[level];
+            }
+        }
+        if (!Better(entry.score, record, nodes[last].entry.score, nodes[last].record)) {
+            return;
+        }
+        FindPredecessors(nodes[last].entry.score, nodes[last].record, update);
+        for (uint32_t level = 0; level < header->topLevel; ++level) {
+            if (nodes[update[level]].next[level] == last) {
+                nodes[update[level]].next[level] = nodes[last].next[level];
+            }
+        }
+        node = last;
+    }
+
+    FindPredecessors(entry.score, record, update);
+    int height = RandomLevel();
+    for (int level = header->topLevel; level < height; ++level) {
+        update[level] = 0;
+    }
+    header->topLevel = std::max<uint32_t>(header->topLevel, height);
+    nodes[node].entry = entry;
+    nodes[node].record = record;
+    for (int level = 0; level < leaderboardMaxLevel; ++level) {
+        if (level < height) {
+            nodes[node].next[level] = nodes[update[level]].next[level];
+            nodes[update[level]].next[level] = node;
+        } else {
+            nodes[node].next[level] = 0;
+        }
+    }
+}
+
+/**
+ * @brief Находит для каждого уровня последний узел, стоящий перед результатом.
+ *
+ * @param score Счет.
+ * @param record Номер записи.
+ * @param update Номера узлов по уровням до Header()->topLevel.
+ */
+
+void Leaderboard::FindPredecessors(int score, uint32_t record, uint32_t *update) const {
+    const LeaderboardNode *nodes = Nodes();
+    uint32_t node = 0;
+    for (int level = Header()->topLevel - 1; level >= 0; --level) {
+        uint32_t next;
+        while ((next = nodes[node].next[level]) != 0 &&
+               Better(nodes[next].entry.score, nodes[next].record, score, record)) {
+            node = next;
+        }
+        update[level] = node;
+    }
+}
+
+/**
+ * @brief Возвращает уровень нового узла списка с пропусками.
+ *
+ * Каждый следующий уровень получает четверть узлов предыдущего. Состояние генератора хранится
+ * в индексе, так что индекс, построенный заново из журнала, совпадает с исходным.
+ */
+
+int Leaderboard::RandomLevel() {
+    uint32_t &state = Header()->random;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    uint32_t bits = state;
+    int level = 1;
+    while (level < leaderboardMaxLevel && (bits & 3) == 0) {
+        level++;
+        bits >>= 2;
+    }
+    return level;
+}
+
+/**
+ * @brief Возвращает ячейку игрока или пустую ячейку, в которую его можно добавить.
+ *
+ * @param player Имя игрока, дополненное нулями до leaderboardNameSize.
+ */
+
+LeaderboardPlayer *Leaderboard::FindPlayer(const char *player) const {
+    LeaderboardPlayer *slots = PlayerSlots();
+    uint32_t mask = Header()->playerCapacity - 1;
+    uint32_t index = Hash(player, leaderboardNameSize) & mask;
+    while (slots[index].player[0] != 0 && memcmp(slots[index].player, player, leaderboardNameSize) != 0) {
+        index = (index + 1) & mask;
+    }
+    return &slots[index];
+}
+
+/**
+ * @brief Увеличивает хеш-таблицу игроков вдвое.
+ *
+ * Таблица лежит в конце индекса, поэтому файл удлиняется, а ячейки раскладываются заново.
+ */
+
+bool Leaderboard::GrowPlayers() {
+    LeaderboardIndexHeader *header = Header();
+    uint32_t capacity = header->playerCapacity;
+    std::vector<LeaderboardPlayer> players(PlayerSlots(), PlayerSlots() + capacity);
+    header->dirty = 1;
+    if (!MapIndex(IndexSize(header->topCapacity, capacity * 2))) {
+        return false;
+    }
+    header = Header();
+    header->playerCapacity = capacity * 2;
+    memset(PlayerSlots(), 0, (size_t) capacity * 2 * sizeof(LeaderboardPlayer));
+    for (const LeaderboardPlayer &player: players) {
+        if (player.player[0] != 0) {
+            *FindPlayer(player.player) = player;
+        }
+    }
+    header->dirty = 0;
+    return true;
+}
+
+/**
+ * @brief Читает запись журнала.
+ */
+
+bool Leaderboard::ReadRecord(uint32_t record, LeaderboardEntry &entry) {
+    return record < records && fseek(log, (long) record * sizeof(LeaderboardEntry), SEEK_SET) == 0 &&
+           fread(&entry, sizeof(entry), 1, log) == 1;
+}
+
+/**
+ * @brief Возвращает заголовок индекса.
+ */
+
+LeaderboardIndexHeader *Leaderboard::Header() const {
+    return (LeaderboardIndexHeader *) base;
+}
+
+/**
+ * @brief Возвращает узлы списка лучших результатов.
+ */
+
+LeaderboardNode *Leaderboard::Nodes() const {
+    return (LeaderboardNode *) (base + sizeof(LeaderboardIndexHeader));
+}
+
+/**
+ * @brief Возвращает хеш-таблицу игроков.
+ */
+
+LeaderboardPlayer *Leaderboard::PlayerSlots() const {
+    return (LeaderboardPlayer *) (base + sizeof(LeaderboardIndexHeader) +
+                                  (size_t) (Header()->topCapacity + 1) * sizeof(LeaderboardNode));
+}
@@ -0,0 +1,322 @@
+/**
+ * @file leaderboard.hpp
+ * @brief Заголовочный файл, содержащий формат таблицы рекордов и класс Leaderboard.
+ *
+ * Таблица рекордов - два файла. Журнал <путь>.log только дописывается записями LeaderboardEntry;
+ * каждая запись ссылается на предыдущую запись того же игрока, поэтому история игрока читается
+ * по цепочке. Индекс <путь>.idx отображается в память и содержит заголовок
+ * LeaderboardIndexHeader, список с пропусками из topCapacity лучших результатов (узлы
+ * LeaderboardNode, узел 0 - голова) и хеш-таблицу игроков LeaderboardPlayer с открытой адресацией.
+ * Формат little-endian.
+ *
+ * Индекс можно восстановить из журнала, поэтому он хранит количество уже учтенных записей журнала
+ * и флаг незаконченного изменения. При открытии учитываются только записи журнала после
+ * сохраненного количества; индекс, поврежденный или измененный не до конца, строится заново.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Версия формата таблицы рекордов.
+ */
+constexpr uint32_t leaderboardVersion = 1;
+
+/**
+ * @brief Наибольшая длина имени игрока с завершающим нулем.
+ */
+constexpr int leaderboardNameSize = 12;
+
+/**
+ * @brief Наибольшее количество уровней списка с пропусками.
+ */
+constexpr int leaderboardMaxLevel = 12;
+
+/**
+ * @brief Номер записи журнала, обозначающий ее отсутствие.
+ */
+constexpr uint32_t leaderboardNoRecord = 0xFFFFFFFF;
+
+/**
+ * @struct LeaderboardEntry
+ * @brief Запись журнала таблицы рекордов (32 байта).
+ */
+struct LeaderboardEntry {
+    char player[leaderboardNameSize]; ///< Имя игрока, дополненное нулями.
+    int32_t score;                    ///< Счет.
+    int32_t level;                    ///< Достигнутый уровень.
+    uint32_t time;                    ///< Время окончания игры (секунды Unix).
+    uint32_t previous;                ///< Номер предыдущей записи игрока или leaderboardNoRecord.
+    uint32_t checksum;                ///< Контрольная сумма предыдущих полей.
+};
+
+static_assert(sizeof(LeaderboardEntry) == 32, "LeaderboardEntry must stay 32 bytes");
+
+/**
+ * @struct LeaderboardIndexHeader
+ * @brief Заголовок индекса таблицы рекордов (64 байта).
+ */
+struct LeaderboardIndexHeader {
+    char magic[8];           ///< Сигнатура "INVSCORE".
+    uint32_t version;        ///< Версия формата (leaderboardVersion).
+    uint32_t dirty;          ///< 1, пока индекс изменяется.
+    uint32_t logRecords;     ///< Количество записей журнала, учтенных в индексе.
+    uint32_t topCapacity;    ///< Емкость списка лучших результатов.
+    uint32_t topCount;       ///< Количество лучших результатов.
+    uint32_t topLevel;       ///< Количество занятых уровней списка с пропусками.
+    uint32_t playerCapacity; ///< Емкость хеш-таблицы игроков (степень двойки).
+    uint32_t playerCount;    ///< Количество игроков.
+    uint32_t random;         ///< Состояние генератора уровней узлов.
+    uint32_t reserved[5];    ///< Не используется.
+};
+
+static_assert(sizeof(LeaderboardIndexHeader) == 64, "LeaderboardIndexHeader must stay 64 bytes");
+
+/**
+ * @struct LeaderboardNode
+ * @brief Узел списка лучших результатов.
+ */
+struct LeaderboardNode {
+    LeaderboardEntry entry;              ///< Копия записи журнала.
+    uint32_t record;                     ///< Номер записи в журнале.
+    uint32_t next[leaderboardMaxLevel]; ///< Следующие узлы по уровням; 0 - конец списка.
+};
+
+/**
+ * @struct LeaderboardPlayer
+ * @brief Ячейка хеш-таблицы игроков; пустая ячейка имеет пустое имя.
+ */
+struct LeaderboardPlayer {
+    char player[leaderboardNameSize]; ///< Имя игрока.
+    uint32_t latest;                  ///< Номер последней записи игрока в журнале.
+    int32_t best;                     ///< Лучший счет игрока.
+    uint32_t runs;                    ///< Количество игр игрока.
+};
+
+/**
+ * @class Leaderboard
+ * @brief Таблица рекордов: журнал всех игр и индекс лучших результатов и игроков.
+ *
+ * Add дописывает запись в журнал и обновляет индекс за O(log K) для списка лучших результатов
+ * и в среднем O(1) для игрока. Top читает K лучших результатов за O(K) прямо из индекса,
+ * History идет по цепочке записей игрока в журнале. Открытие не читает журнал целиком:
+ * отображается индекс и учитываются только записи, дописанные после его последнего изменения.
+ *
+ * Класс не потокобезопасен.
+ */
+
+class Leaderboard {
+public:
+    /**
+     * @brief Конструктор класса Leaderboard. Создает закрытую таблицу.
+     */
+    Leaderboard();
+
+    /**
+     * @brief Деструктор класса Leaderboard. Закрывает таблицу.
+     */
+    ~Leaderboard();
+
+    Leaderboard(const Leaderboard &) = delete;
+    Leaderboard &operator=(const Leaderboard &) = delete;
+
+    /**
+     * @brief Открывает или создает таблицу и восстанавливает индекс после сбоя.
+     *
+     * Неполная или испорченная запись в конце журнала (сбой во время записи) отрезается.
+     *
+     * @param path Путь к файлам таблицы без расширения.
+     * @param topCapacity Количество хранимых лучших результатов.
+     * @return false, если файлы не открылись, таблица уже открыта другим объектом или индекс не удалось
+     *         дополнить записями журнала.
+     */
+    bool Open(const char *path, int topCapacity = 100);
+
+    /**
+     * @brief Закрывает таблицу.
+     */
+    void Close();
+
+    /**
+     * @brief Добавляет результат игры.
+     *
+     * @param player Имя игрока; обрезается до leaderboardNameSize - 1 символов.
+     * @param score Счет.
+     * @param level Достигнутый уровень.
+     * @param time Время окончания игры (секунды Unix).
+     * @return false, если таблица закрыта, имя пустое или запись в журнал не удалась.
+     */
+    bool Add(const char *player, int score, int level, uint32_t time);
+
+    /**
+     * @brief Возвращает лучшие результаты по убыванию счета; равные - в порядке игр.
+     *
+     * @param count Наибольшее количество результатов.
+     * @param entries Результаты.
+     * @return Количество результатов.
+     */
+    int Top(int count, std::vector<LeaderboardEntry> &entries) const;
+
+    /**
+     * @brief Возвращает игры игрока от последней к первой.
+     *
+     * @param player Имя игрока.
+     * @param count Наибольшее количество игр.
+     * @param entries Игры.
+     * @return Количество игр.
+     */
+    int History(const char *player, int count, std::vector<LeaderboardEntry> &entries);
+
+    /**
+     * @brief Возвращает лучший счет игрока или -1, если игрок не играл.
+     */
+    int Best(const char *player) const;
+
+    /**
+     * @brief Возвращает количество игр игрока.
+     */
+    int Runs(const char *player) const;
+
+    /**
+     * @brief Возвращает лучший счет таблицы или 0, если она пуста.
+     */
+    int BestScore() const;
+
+    /**
+     * @brief Возвращает количество записей журнала.
+     */
+    long long Count() const;
+
+    /**
+     * @brief Возвращает количество игроков.
+     */
+    int Players() const;
+
+    /**
+     * @brief Возвращает количество записей журнала, учтенных в индексе при открытии.
+     */
+    long long Replayed() const;
+
+    /**
+     * @brief Проверяет, строился ли индекс при открытии заново.
+     */
+    bool Rebuilt() const;
+
+    /**
+     * @brief Начальная емкость хеш-таблицы игроков.
+     */
+    constexpr static uint32_t initialPlayers = 1024;
+
+private:
+    /**
+     * @brief Возвращает размер индекса в байтах.
+     */
+    static size_t IndexSize(uint32_t topCapacity, uint32_t playerCapacity);
+
+    /**
+     * @brief Отображает индекс в память с заданным размером, сохраняя содержимое.
+     */
+    bool MapIndex(size_t size);
+
+    /**
+     * @brief Создает пустой индекс.
+     */
+    bool ResetIndex(uint32_t topCapacity, uint32_t playerCapacity);
+
+    /**
+     * @brief Проверяет заголовок и размеры отображенного индекса.
+     */
+    bool IndexValid(uint32_t topCapacity) const;
+
+    /**
+     * @brief Учитывает запись журнала в индексе.
+     */
+    bool Apply(const LeaderboardEntry &entry, uint32_t record);
+
+    /**
+     * @brief Добавляет результат в список лучших, вытесняя худший, если список заполнен.
+     */
+    void InsertTop(const LeaderboardEntry &entry, uint32_t record);
+
+    /**
+     * @brief Находит для каждого уровня последний узел, стоящий перед результатом.
+     */
+    void FindPredecessors(int score, uint32_t record, uint32_t *update) const;
+
+    /**
+     * @brief Возвращает уровень нового узла списка с пропусками.
+     */
+    int RandomLevel();
+
+    /**
+     * @brief Возвращает ячейку игрока или пустую ячейку, в которую его можно добавить.
+     */
+    LeaderboardPlayer *FindPlayer(const char *player) const;
+
+    /**
+     * @brief Увеличивает хеш-таблицу игроков вдвое.
+     */
+    bool GrowPlayers();
+
+    /**
+     * @brief Читает запись журнала.
+     */
+    bool ReadRecord(uint32_t record, LeaderboardEntry &entry);
+
+    /**
+     * @brief Возвращает заголовок индекса.
+     */
+    LeaderboardIndexHeader *Header() const;
+
+    /**
+     * @brief Возвращает узлы списка лучших результатов.
+     */
+    LeaderboardNode *Nodes() const;
+
+    /**
+     * @brief Возвращает хеш-таблицу игроков.
+     */
+    LeaderboardPlayer *PlayerSlots() const;
+
+    /**
+     * @brief Путь к журналу.
+     */
+    std::string logPath;
+    /**
+     * @brief Путь к индексу.
+     */
+    std::string indexPath;
+    /**
+     * @brief Журнал или nullptr, если таблица закрыта.
+     */
+    FILE *log;
+    /**
+     * @brief Дескриптор файла индекса (-1 в Windows, где индекс читается в память целиком).
+     */
+    int indexFile;
+    /**
+     * @brief Начало отображения индекса.
+     */
+    uint8_t *base;
+    /**
+     * @brief Размер отображения индекса.
+     */
+    size_t size;
+    /**
+     * @brief Количество записей журнала.
+     */
+    uint32_t records;
+    /**
+     * @brief Количество записей, учтенных при открытии.
+     */
+    long long replayed;
+    /**
+     * @brief Флаг построения индекса заново при открытии.
+     */
+    bool rebuilt;
+};
@@ -0,0 +1,339 @@
+/**
+ * @file levelscript.cpp
+ * @brief Файл реализации сценариев уровней и класса LevelScript.
+ */
+
+#include "levelscript.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+/**
+ * @brief Наибольшее количество команд, которое нить выполняет без ожидания за одно пробуждение.
+ */
+static const int scriptStepLimit = 256;
+
+/**
+ * @brief Сценарии уровней.
+ *
+ * Уровень 1 повторяет прежнюю игру: полная формация и 4 укрытия. Дальше добавляются
+ * подкрепления, вторая волна, проходы загадочного корабля и меньше укрытий.
+ */
+static const std::vector<ScriptCommand> levelPrograms[] = {
+    {
+        {SCRIPT_FORMATION, FORMATION_GRID, 0},
+        {SCRIPT_SHIELDS, 4, 0},
+        {SCRIPT_WAIT_EVENT, SCRIPT_EVENT_WAVE_CLEARED, 0},
+        {SCRIPT_NEXT_LEVEL, 0, 0},
+    },
+    {
+        {SCRIPT_FORMATION, FORMATION_CHECKER, 0},
+        {SCRIPT_SHIELDS, 4, 0},
+        {SCRIPT_SPAWN, 5, 0},
+        {SCRIPT_WAIT_EVENT, SCRIPT_EVENT_WAVE_CLEARED, 0},
+        {SCRIPT_NEXT_LEVEL, 0, 0},
+        // Подкрепление в верхний ряд каждые 15 секунд, 3 раза
+        {SCRIPT_WAIT, 900, 0},
+        {SCRIPT_REINFORCE, 0, 0},
+        {SCRIPT_REPEAT, 5, 2},
+        {SCRIPT_END, 0, 0},
+    },
+    {
+        {SCRIPT_FORMATION, FORMATION_WEDGE, 0},
+        {SCRIPT_SHIELDS, 3, 0},
+        {SCRIPT_SPAWN, 8, 0},
+        {SCRIPT_WAIT_EVENT, SCRIPT_EVENT_WAVE_CLEARED, 0},
+        {SCRIPT_WAIT, 120, 0},
+        {SCRIPT_FORMATION, FORMATION_COLUMNS, 0},
+        {SCRIPT_WAIT_EVENT, SCRIPT_EVENT_WAVE_CLEARED, 0},
+        {SCRIPT_NEXT_LEVEL, 0, 0},
+        // Загадочный корабль каждые 10 секунд до конца уровня
+        {SCRIPT_WAIT, 600, 0},
+        {SCRIPT_BOSS, 0, 0},
+        {SCRIPT_REPEAT, 8, -1},
+    },
+    {
+        {SCRIPT_FORMATION, FORMATION_GRID, 0},
+        {SCRIPT_SHIELDS, 2, 0},
+        {SCRIPT_SPAWN, 6, 0},
+        {SCRIPT_SPAWN, 10, 0},
+        {SCRIPT_WAIT_EVENT, SCRIPT_EVENT_WAVE_CLEARED, 0},
+        {SCRIPT_NEXT_LEVEL, 0, 0},
+        // Подкрепление в два верхних ряда каждые 12 секунд
+        {SCRIPT_WAIT, 720, 0},
+        {SCRIPT_REINFORCE, 0, 0},
+        {SCRIPT_REINFORCE, 1, 0},
+        {SCRIPT_REPEAT, 6, -1},
+        // Загадочный корабль после каждой потерянной жизни
+        {SCRIPT_WAIT_EVENT, SCRIPT_EVENT_SHIP_HIT, 0},
+        {SCRIPT_BOSS, 0, 0},
+        {SCRIPT_REPEAT, 10, -1},
+    },
+};
+
+/**
+ * @brief Возвращает сценарий уровня.
+ *
+ * Уровни после последнего описанного повторяют последний сценарий.
+ *
+ * @param level Номер уровня, начиная с 1.
+ */
+
+const std::vector<ScriptCommand> &LevelProgram(int level) {
+    int count = sizeof(levelPrograms) / sizeof(levelPrograms[0]);
+    return levelPrograms[std::min(std::max(level, 1), count) - 1];
+}
+
+/**
+ * @brief Проверяет, есть ли в шаблоне формации ячейка.
+ *
+ * @param pattern Шаблон FormationPattern.
+ * @param row Ряд ячейки.
+ * @param column Столбец ячейки.
+ * @param columns Количество столбцов формации.
+ */
+
+bool FormationCell(int pattern, int row, int column, int columns) {
+    switch (pattern) {
+        case FORMATION_CHECKER:
+            return (row + column) % 2 == 0;
+        case FORMATION_WEDGE:
+            return std::abs(column - columns / 2) <= row + 1;
+        case FORMATION_COLUMNS:
+            return column % 3 != 2;
+        default:
+            return true;
+    }
+}
+
+/**
+ * @brief Конструктор класса LevelScript. Создает исполнитель без сценария.
+ */
+
+LevelScript::LevelScript() {
+    program = nullptr;
+    std::fill(waiting, waiting + scriptEventCount, -1);
+    freeList = -1;
+    running = 0;
+    dropped = 0;
+}
+
+/**
+ * @brief Запускает сценарий: первая нить начинает с команды 0 и выполняется до первого ожидания.
+ *
+ * Арена, очередь выполнения и колесо таймеров выделяются здесь под capacity нитей; при
+ * следующем уровне с той же емкостью память используется повторно.
+ *
+ * @param program Сценарий; должен жить, пока исполнитель им пользуется.
+ * @param capacity Наибольшее количество одновременных нитей.
+ * @param actions Вектор, в который записываются действия над игрой (старое содержимое удаляется).
+ */
+
+void LevelScript::Start(const std::vector<ScriptCommand> &program, int capacity, std::vector<ScriptCommand> &actions) {
+    this->program = &program;
+    fibers.assign(capacity, {-1, 0, -1});
+    freeList = -1;
+    for (int i = capacity - 1; i >= 0; --i) {
+        fibers[i].next = freeList;
+        freeList = i;
+    }
+    ready.clear();
+    ready.reserve(capacity);
+    std::fill(waiting, waiting + scriptEventCount, -1);
+    running = 0;
+    dropped = 0;
+    timers.Reset(0);
+    timers.Reserve(capacity);
+    fired.reserve(capacity);
+
+    actions.clear();
+    Launch(0);
+    RunReady(actions);
+}
+
+/**
+ * @brief Продвигает сценарий на один тик и выполняет нити, чье ожидание истекло.
+ *
+ * @param actions Вектор, в который записываются действия над игрой (старое содержимое удаляется).
+ */
+
+void LevelScript::Tick(std::vector<ScriptCommand> &actions) {
+    actions.clear();
+    timers.Advance(fired);
+    for (const TimerEvent &event: fired) {
+        ready.push_back(event.payload);
+    }
+    RunReady(actions);
+}
+
+/**
+ * @brief Будит нити, ждущие события, и выполняет их.
+ *
+ * Нити просыпаются в том порядке, в котором начали ждать.
+ *
+ * @param event Событие ScriptEvent.
+ * @param actions Вектор, в который записываются действия над игрой (старое содержимое удаляется).
+ */
+
+void LevelScript::Signal(int event, std::vector<ScriptCommand> &actions) {
+    actions.clear();
+    if (event < 0 || event >= scriptEventCount) {
+        return;
+    }
+    int fiber = waiting[event];
+    waiting[event] = -1;
+    size_t first = ready.size();
+    while (fiber >= 0) {
+        ready.push_back(fiber);
+        fiber = fibers[fiber].next;
+    }
+    // Список ожидания растет от головы, поэтому порядок ожидания обратный
+    std::reverse(ready.begin() + first, ready.end());
+    RunReady(actions);
+}
+
+/**
+ * @brief Возвращает количество живых нитей.
+ */
+
+int LevelScript::Running() const {
+    return running;
+}
+
+/**
+ * @brief Возвращает количество запусков нитей, не поместившихся в арену.
+ */
+
+int LevelScript::Dropped() const {
+    return dropped;
+}
+
+/**
+ * @brief Дописывает состояние исполнителя в байты (см. statebytes.hpp); сценарий не записывается.
+ */
+
+void LevelScript::Save(std::vector<uint8_t> &bytes) const {
+    PutState(bytes, (uint8_t) (program != nullptr));
+    PutState(bytes, fibers);
+    PutState(bytes, ready);
+    PutState(bytes, waiting);
+    PutState(bytes, freeList);
+    PutState(bytes, running);
+    PutState(bytes, dropped);
+    timers.Save(bytes);
+}
+
+/**
+ * @brief Восстанавливает состояние исполнителя из байтов Save.
+ *
+ * @param reader Чтение байтов.
+ * @param program Сценарий, который выполнялся при сохранении.
+ * @return false, если байты кончились или не подходят исполнителю.
+ */
+
+bool LevelScript::Load(StateReader &reader, const std::vector<ScriptCommand> &program) {
+    uint8_t started;
+    if (!reader.Get(started) || !reader.Get(fibers) || !reader.Get(ready) || !reader.Get(waiting) ||
+        !reader.Get(freeList) || !reader.Get(running) || !reader.Get(dropped) || !timers.Load(reader)) {
+        return false;
+    }
+    this->program = started ? &program : nullptr;
+    return true;
+}
+
+/**
+ * @brief Берет свободную нить из арены и ставит ее в очередь выполнения.
+ *
+ * @return false, если арена заполнена.
+ */
+
+bool LevelScript::Launch(int pc) {
+    if (freeList < 0) {
+        dropped++;
+        return false;
+    }
+    int fiber = freeList;
+    freeList = fibers[fiber].next;
+    fibers[fiber] = {pc, 0, -1};
+    running++;
+    ready.push_back(fiber);
+    return true;
+}
+
+/**
+ * @brief Выполняет нити из очереди выполнения до их ожиданий.
+ *
+ * Нити, запущенные во время выполнения, попадают в конец очереди и выполняются в этом же тике.
+ */
+
+void LevelScript::RunReady(std::vector<ScriptCommand> &actions) {
+    for (size_t i = 0; i < ready.size(); ++i) {
+        Resume(ready[i], actions);
+    }
+    ready.clear();
+}
+
+/**
+ * @brief Выполняет нить до ожидания или завершения.
+ *
+ * Управляющие команды выполняются здесь, действия над игрой передаются владельцу. Нить, которая
+ * выполнила scriptStepLimit команд без ожидания, откладывается на следующий тик.
+ */
+
+void LevelScript::Resume(int fiber, std::vector<ScriptCommand> &actions) {
+    const std::vector<ScriptCommand> &code = *program;
+    for (int step = 0; step < scriptStepLimit; ++step) {
+        Fiber &state = fibers[fiber];
+        if (state.pc < 0 || state.pc >= (int) code.size()) {
+            Finish(fiber);
+            return;
+        }
+        const ScriptCommand &command = code[state.pc++];
+        switch (command.op) {
+            case SCRIPT_WAIT:
+                timers.Schedule(command.a, SCRIPT_WAIT, fiber);
+                return;
+            case SCRIPT_WAIT_EVENT:
+                if (command.a >= 0 && command.a < scriptEventCount) {
+                    state.next = waiting[command.a];
+                    waiting[command.a] = fiber;
+                    return;
+                }
+                break;
+            case SCRIPT_SPAWN:
+                Launch(command.a);
+                break;
+            case SCRIPT_REPEAT:
+                if (command.b < 0) {
+                    state.pc = command.a;
+                } else if (state.repeats < command.b) {
+                    state.repeats++;
+                    state.pc = command.a;
+                } else {
+                    state.repeats = 0;
+                }
+                break;
+            case SCRIPT_END:
+                Finish(fiber);
+                return;
+            case SCRIPT_NEXT_LEVEL:
+                actions.push_back(command);
+                Finish(fiber);
+                return;
+            default:
+                actions.push_back(command);
+                break;
+        }
+    }
+    timers.Schedule(1, SCRIPT_WAIT, fiber);
+}
+
+/**
+ * @brief Возвращает нить в список свободных.
+ */
+
+void LevelScript::Finish(int fiber) {
+    fibers[fiber].pc = -1;
+    fibers[fiber].next = freeList;
+    freeList = fiber;
+    running--;
+}
@@ -0,0 +1,231 @@
+/**
+ * @file levelscript.hpp
+ * @brief Заголовочный файл, содержащий команды сценариев уровней и класс LevelScript.
+ */
+
+#pragma once
+
+#include "timerwheel.hpp"
+#include <vector>
+
+/**
+ * @enum ScriptOp
+ * @brief Команды сценария уровня.
+ *
+ * Команды до SCRIPT_END управляют нитями сценария и выполняются самим LevelScript. Остальные
+ * команды - действия над игрой: нить передает их владельцу и продолжает выполнение.
+ */
+enum ScriptOp {
+    SCRIPT_WAIT,        ///< Ждать a тиков.
+    SCRIPT_WAIT_EVENT,  ///< Ждать события a (ScriptEvent).
+    SCRIPT_SPAWN,       ///< Запустить новую нить с команды a.
+    SCRIPT_REPEAT,      ///< Перейти к команде a еще b раз (b < 0 - бесконечно).
+    SCRIPT_END,         ///< Завершить нить.
+    SCRIPT_FORMATION,   ///< Выставить новую формацию по шаблону a (FormationPattern).
+    SCRIPT_REINFORCE,   ///< Заполнить пустые ячейки ряда a формации.
+    SCRIPT_SHIELDS,     ///< Поставить a новых укрытий.
+    SCRIPT_BOSS,        ///< Пустить загадочный корабль.
+    SCRIPT_NEXT_LEVEL   ///< Закончить уровень и перейти к следующему; нить завершается.
+};
+
+/**
+ * @enum ScriptEvent
+ * @brief События игры, которых могут ждать нити сценария.
+ */
+enum ScriptEvent {
+    SCRIPT_EVENT_WAVE_CLEARED, ///< Уничтожен последний инопланетянин формации.
+    SCRIPT_EVENT_SHIP_HIT      ///< Корабль игрока потерял жизнь.
+};
+
+/**
+ * @brief Количество видов событий ScriptEvent.
+ */
+constexpr int scriptEventCount = 2;
+
+/**
+ * @enum FormationPattern
+ * @brief Шаблоны заполнения ячеек формации.
+ */
+enum FormationPattern {
+    FORMATION_GRID,    ///< Все ячейки.
+    FORMATION_CHECKER, ///< Ячейки в шахматном порядке.
+    FORMATION_WEDGE,   ///< Клин, расширяющийся книзу.
+    FORMATION_COLUMNS  ///< Пары столбцов через один пустой.
+};
+
+/**
+ * @struct ScriptCommand
+ * @brief Команда сценария с двумя аргументами.
+ */
+struct ScriptCommand {
+    /**
+     * @brief Код команды.
+     */
+    ScriptOp op;
+    /**
+     * @brief Первый аргумент.
+     */
+    int a;
+    /**
+     * @brief Второй аргумент.
+     */
+    int b;
+};
+
+/**
+ * @brief Возвращает сценарий уровня.
+ *
+ * Уровни после последнего описанного повторяют последний сценарий.
+ *
+ * @param level Номер уровня, начиная с 1.
+ */
+const std::vector<ScriptCommand> &LevelProgram(int level);
+
+/**
+ * @brief Проверяет, есть ли в шаблоне формации ячейка.
+ *
+ * @param pattern Шаблон FormationPattern.
+ * @param row Ряд ячейки.
+ * @param column Столбец ячейки.
+ * @param columns Количество столбцов формации.
+ */
+bool FormationCell(int pattern, int row, int column, int columns);
+
+/**
+ * @class LevelScript
+ * @brief Исполнитель сценария уровня в виде нитей без собственных стеков.
+ *
+ * Нить - это номер текущей команды, счетчик повторов и признак ожидания. Нити хранятся в
+ * арене фиксированной емкости, которая выделяется при старте уровня, поэтому запуск и
+ * завершение нитей не выделяют память. Нить, ждущая тики, стоит в колесе таймеров, нить,
+ * ждущая событие, - в списке ожидания события, и тик выполняет только разбуженные нити.
+ *
+ * Состояние - обычные значения без указателей на стек, поэтому исполнитель копируется в снимок
+ * игры и восстанавливается из него вместе с ожиданиями.
+ */
+
+class LevelScript {
+public:
+    /**
+     * @brief Конструктор класса LevelScript. Создает исполнитель без сценария.
+     */
+    LevelScript();
+
+    /**
+     * @brief Запускает сценарий: первая нить начинает с команды 0 и выполняется до первого ожидания.
+     *
+     * @param program Сценарий; должен жить, пока исполнитель им пользуется.
+     * @param capacity Наибольшее количество одновременных нитей.
+     * @param actions Вектор, в который записываются действия над игрой (старое содержимое удаляется).
+     */
+    void Start(const std::vector<ScriptCommand> &program, int capacity, std::vector<ScriptCommand> &actions);
+
+    /**
+     * @brief Продвигает сценарий на один тик и выполняет нити, чье ожидание истекло.
+     *
+     * @param actions Вектор, в который записываются действия над игрой (старое содержимое удаляется).
+     */
+    void Tick(std::vector<ScriptCommand> &actions);
+
+    /**
+     * @brief Будит нити, ждущие события, и выполняет их.
+     *
+     * @param event Событие ScriptEvent.
+     * @param actions Вектор, в который записываются действия над игрой (старое содержимое удаляется).
+     */
+    void Signal(int event, std::vector<ScriptCommand> &actions);
+
+    /**
+     * @brief Возвращает количество живых нитей.
+     */
+    int Running() const;
+
+    /**
+     * @brief Возвращает количество запусков нитей, не поместившихся в арену.
+     */
+    int Dropped() const;
+
+    /**
+     * @brief Дописывает состояние исполнителя в байты (см. statebytes.hpp); сценарий не записывается.
+     */
+    void Save(std::vector<uint8_t> &bytes) const;
+
+    /**
+     * @brief Восстанавливает состояние исполнителя из байтов Save.
+     *
+     * @param reader Чтение байтов.
+     * @param program Сценарий, который выполнялся при сохранении.
+     * @return false, если байты кончились или не подходят исполнителю.
+     */
+    bool Load(StateReader &reader, const std::vector<ScriptCommand> &program);
+
+private:
+    /**
+     * @struct Fiber
+     * @brief Нить сценария.
+     */
+    struct Fiber {
+        int pc;      ///< Номер следующей команды или -1, если нить свободна.
+        int repeats; ///< Количество уже выполненных переходов текущего SCRIPT_REPEAT.
+        int next;    ///< Следующая нить в списке ожидания события или в списке свободных нитей.
+    };
+
+    /**
+     * @brief Берет свободную нить из арены и ставит ее в очередь выполнения.
+     *
+     * @return false, если арена заполнена.
+     */
+    bool Launch(int pc);
+
+    /**
+     * @brief Выполняет нити из очереди выполнения до их ожиданий.
+     */
+    void RunReady(std::vector<ScriptCommand> &actions);
+
+    /**
+     * @brief Выполняет нить до ожидания или завершения.
+     */
+    void Resume(int fiber, std::vector<ScriptCommand> &actions);
+
+    /**
+     * @brief Возвращает нить в список свободных.
+     */
+    void Finish(int fiber);
+
+    /**
+     * @brief Сценарий.
+     */
+    const std::vector<ScriptCommand> *program;
+    /**
+     * @brief Арена нитей.
+     */
+    std::vector<Fiber> fibers;
+    /**
+     * @brief Нити, готовые к выполнению.
+     */
+    std::vector<int> ready;
+    /**
+     * @brief Первые нити списков ожидания событий или -1.
+     */
+    int waiting[scriptEventCount];
+    /**
+     * @brief Первая свободная нить или -1.
+     */
+    int freeList;
+    /**
+     * @brief Количество живых нитей.
+     */
+    int running;
+    /**
+     * @brief Количество запусков, не поместившихся в арену.
+     */
+    int dropped;
+    /**
+     * @brief Колесо таймеров ожиданий; значение таймера - номер нити.
+     */
+    TimerWheel timers;
+    /**
+     * @brief Сработавшие в текущем тике таймеры.
+     */
+    std::vector<TimerEvent> fired;
+};
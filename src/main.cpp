@@ -2,97 +2,299 @@
  * @file main.cpp
  * @brief Основной файл для игры Space Invaders на C++.
  */
+#include "framepacer.hpp"
 #include "game.hpp"
-#include <string>
+#include "gameflow.hpp"
+#include "gamesnapshot.hpp"
+#include "hud.hpp"
+#include "leaderboard.hpp"
+#include "platform.hpp"
+#include "qualitygovernor.hpp"
+#include "rewindbuffer.hpp"
+#include "scenerenderer.hpp"
+#include "stresstest.hpp"
+#include "telemetry.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <random>
 #include <raylib.h>
+#include <string>
 
 /**
- * @brief Форматирует число с ведущими нулями.
+ * @brief Печатает лучшие результаты таблицы рекордов.
  *
- * @param number Число для форматирования.
- * @param width Ширина форматируемой строки (количество символов).
- * @return Отформатированная строка с ведущими нулями.
+ * @param count Количество результатов.
+ * @return 0 в случае успеха, 1, если таблица не открылась.
  */
 
-std::string FormatWithLeadingZeros(int number, int width) {
-    std::string numberText = std::to_string(number);
-    int leadingZeros = width - numberText.length();
-    return numberText = std::string(leadingZeros, '0') + numberText;
+static int PrintLeaderboard(int count) {
+    Leaderboard leaderboard;
+    if (!leaderboard.Open("leaderboard")) {
+        fprintf(stderr, "failed to open leaderboard\n");
+        return 1;
+    }
+    std::vector<LeaderboardEntry> entries;
+    leaderboard.Top(count, entries);
+    printf("%lld games, %d players\n", leaderboard.Count(), leaderboard.Players());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        time_t time = entries[i].time;
+        char date[32];
+        strftime(date, sizeof(date), "%Y-%m-%d %H:%M", localtime(&time));
+        printf("%3zu. %-11s %8d  level %-3d %s\n", i + 1, entries[i].player, entries[i].score, entries[i].level,
+               date);
+    }
+    return 0;
 }
 
 /**
  * @brief Главная функция игры.
  *
  * Инициализирует окно, аудиоустройство, шрифты, текстуры и игровой объект. Запускает основной игровой цикл, в котором обрабатываются ввод, обновление состояния и отрисовка.
+ * Вне игры (пауза по клавише P, окончание игры, заставка) цикл ждет ввод и рисует кадр только при изменениях.
+ * Во время игры частоту кадров задает FramePacer, а ввод опрашивается непосредственно перед шагом симуляции.
+ * Симуляция идет шагами фиксированной длины (StepAccumulator), поэтому медленный кадр ее не замедляет.
+ * QualityGovernor по времени частей кадра снижает или восстанавливает качество необязательной работы
+ * (плотность частиц, частота перерисовки и вывод слоя интерфейса); каждая смена уровня пишется в журнал.
+ * Статистика игр, волн и времени работы кадров пишется в журнал телеметрии telemetry-*.bin.
+ * Клавиша Backspace перематывает игру на 5 секунд назад, не дальше 30 секунд (RewindBuffer).
+ * Клавиша F3 показывает панель измерений.
  * По завершении игры освобождает все ресурсы.
- * 
+ *
+ * Результаты игр пишутся в таблицу рекордов leaderboard.log/leaderboard.idx под именем игрока.
+ *
+ * Запуск: untitled [--low-latency] [--player ИМЯ] - режим низкой задержки с вертикальной синхронизацией
+ * и имя игрока в таблице рекордов;
+ * untitled --stress [параметры] - нагрузочный режим (см. RunStressTest);
+ * untitled --scores [N] - печать N лучших результатов таблицы рекордов.
+ *
+ * @param argc Количество аргументов командной строки.
+ * @param argv Аргументы командной строки.
  * @return 0 в случае успешного завершения программы.
  */
 
-int main() {
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "--stress") == 0) {
+        return RunStressTest(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--scores") == 0) {
+        return PrintLeaderboard(argc > 2 ? atoi(argv[2]) : 10);
+    }
+    bool lowLatency = false;
+    std::string player = "PLAYER";
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--low-latency") == 0) {
+            lowLatency = true;
+        } else if (strcmp(argv[i], "--player") == 0 && hasValue) {
+            player = argv[++i];
+        }
+    }
     // Цвета для отрисовки  
     Color grey = {29, 29, 27, 255};
-    Color yellow = {243, 216, 63, 255};
     // Отступы и размеры окна
     int offset = 50;
     int windowWidth = 750;
     int windowHeight = 700;
 
-    // Инициализация окна
+    // Инициализация окна; в режиме низкой задержки показ кадра ждет вертикальную синхронизацию
+    if (lowLatency) {
+        SetConfigFlags(FLAG_VSYNC_HINT);
+    }
     InitWindow(windowWidth + offset, windowHeight + 2 * offset, "C++ Space Invaders");
 
     // Инициализация аудиоустройства
     InitAudioDevice();
 
+    // Подключение архива ресурсов, если он собран рядом с игрой
+    MountAssetPack(TextFormat("%sassets.pak", GetApplicationDirectory()));
+
     // Загрузка шрифта и текстуры космического корабля
-    Font font = LoadFontEx("../Font/monogram.ttf", 64, 0, 0);
-    Texture2D spaceshipImage = LoadTexture("../Graphics/spaceship.png");
+    Font font = LoadGameFont("../Font/monogram.ttf", 64);
+    Texture2D spaceshipImage = LoadGameTexture("../Graphics/spaceship.png");
+
+    // Частоту кадров задает FramePacer, ограничитель raylib отключен
+    SetTargetFPS(0);
+    FramePacer pacer;
+    pacer.SetLowLatency(lowLatency);
+    bool showStats = false;
+    // Шаги симуляции фиксированной длины и регулятор качества с бюджетом в один период кадров
+    StepAccumulator clock(Game::tickDuration);
+    QualityGovernor governor(Game::tickDuration);
+    double phases[framePhaseCount] = {};
+    // Журнал телеметрии пишется в фоновом потоке; сбор статистики объявлен после журнала и дописывает
+    // незаконченные записи до его закрытия
+    TelemetryWriter telemetryLog("telemetry");
+    GameTelemetry telemetry(telemetryLog, std::random_device()(), Game::tickDuration);
 
-    // Установка целевого FPS
-    SetTargetFPS(60);
+    // Создание объекта игры и очереди событий ввода
+    Game game(false, player);
+    InputQueue input;
+    // Снимки каждые полсекунды и команды между ними для перемотки на 30 секунд назад
+    RewindBuffer rewind(30, 61);
+    GameSnapshot rewindSnapshot;
+    rewind.saveState = [&game, &rewindSnapshot](std::vector<uint8_t> &state) {
+        SaveSnapshot(game, rewindSnapshot);
+        WriteSnapshot(rewindSnapshot, state);
+    };
+    rewind.loadState = [&game, &rewindSnapshot](const std::vector<uint8_t> &state) {
+        if (!ReadSnapshot(state, rewindSnapshot)) {
+            return false;
+        }
+        RestoreSnapshot(rewindSnapshot, game);
+        return true;
+    };
+    // Тики до нужного уже были показаны, поэтому повторная симуляция идет без звуков и частиц
+    rewind.advance = [&game](const uint8_t *inputs) {
+        game.ApplyInput(inputs[0]);
+        game.Update(false);
+    };
+    const int rewindTicks = 5 * 60;
+    // Отрисовка сцены с кэшированием неизменных слоев
+    std::unique_ptr<SceneRenderer> scene(new SceneRenderer(font, spaceshipImage, grey));
 
-    // Создание объекта игры
-    Game game;
+    // Состояния окна: игра, пауза, окончание игры и заставка
+    GameFlow flow;
+    // Наибольшее время ожидания ввода, после которого проверяется закрытие окна
+    const double maxIdleWait = 0.25;
+    bool redraw = true;
 
     // Основной игровой цикл
     while (WindowShouldClose() == false) {
-        // Обновление музыки
-        UpdateMusicStream(game.music);
-        // Обработка ввода и обновление состояния игры
-        game.HandleInput();
-        game.Update();
+        int events = 0;
+        bool statsPressed = false;
+        bool rewindPressed = false;
+        if (flow.Idle()) {
+            // Вне игры кадры не рисуются, пока нет ввода или изменения по таймеру
+            if (WaitForInputEvent(std::min(flow.WaitTimeout(GetTime()), maxIdleWait))) {
+                events |= FLOW_EVENT_INPUT;
+                redraw = true;
+            }
+        } else {
+            // Нажатия, замеченные опросом в EndDrawing, запоминаются до позднего опроса
+            events |= IsKeyPressed(KEY_P) ? FLOW_EVENT_PAUSE : 0;
+            statsPressed = IsKeyPressed(KEY_F3);
+            rewindPressed = IsKeyPressed(KEY_BACKSPACE);
+            // Ожидание начала кадра и поздний опрос ввода прямо перед шагом симуляции
+            pacer.WaitForFrame();
+            PollInputEvents();
+            Game::CaptureKeyboard(input, GetTime());
+            pacer.MarkSample();
+        }
+        if (IsKeyPressed(KEY_P)) {
+            events |= FLOW_EVENT_PAUSE;
+        }
+        if (statsPressed || IsKeyPressed(KEY_F3)) {
+            showStats = !showStats;
+            redraw = true;
+        }
+
+        double frameStart = GetTime();
+        phases[PHASE_SIMULATION] = 0.0;
+        if (flow.State() == FLOW_PLAYING) {
+            // Обновление музыки
+            UpdateMusicStream(game.music);
+            // Перемотка восстанавливает ближайший снимок и повторяет тики до нужного в этом же кадре
+            if (rewindPressed || IsKeyPressed(KEY_BACKSPACE)) {
+                double rewindStart = GetTime();
+                long long target = std::max(rewind.OldestTick(), rewind.Tick() - rewindTicks);
+                if (rewind.Rewind(target)) {
+                    telemetry.Rewind(game.level, game.score);
+                    TraceLog(LOG_INFO, "REWIND: to tick %lld (%d ticks resimulated, %.2f ms)", target,
+                             rewind.LastResimulated(), (GetTime() - rewindStart) * 1000);
+                }
+            }
+            // Команды каждого шага из очереди ввода и обновление состояния игры; отстающие шаги
+            // забирают ввод до конца своего интервала
+            int steps = clock.Advance(frameStart);
+            for (int step = steps - 1; step >= 0; --step) {
+                input.Tick(frameStart - step * Game::tickDuration);
+                uint8_t command = input.Input(0);
+                rewind.Record(&command);
+                double lastFire = game.spaceship.getLastFireTime();
+                game.ApplyInput(command);
+                int shots = game.spaceship.getLastFireTime() > lastFire ? 1 : 0;
+                game.Update();
+                telemetry.Tick(game.level, shots, game.score, game.run, game.Events());
+            }
+            phases[PHASE_SIMULATION] = GetTime() - frameStart;
+        } else if (flow.State() != FLOW_PAUSED && (events & FLOW_EVENT_INPUT)) {
+            // После окончания игры ввод может начать новую игру; перемотка в прошлую игру невозможна
+            game.HandleInput();
+            if (game.run) {
+                rewind.Clear();
+            }
+        }
+
+        bool wasIdle = flow.Idle();
+        if (flow.Update(events, game.run, GetTime())) {
+            redraw = true;
+        }
+        if (wasIdle != flow.Idle()) {
+            if (flow.Idle()) {
+                PauseMusicStream(game.music);
+            } else {
+                ResumeMusicStream(game.music);
+                // После простоя отсчет кадров начинается заново, а очередь ввода - с удерживаемых клавиш
+                pacer.Reset();
+                clock.Reset();
+                input.Clear();
+                input.PushState(GetTime(), 0, Game::KeyboardInput());
+            }
+        }
+        if (flow.Idle() && !redraw) {
+            continue;
+        }
+
         // Начало рисования
         BeginDrawing();
-        // Очистка фона
-        ClearBackground(grey);
-        // Отрисовка рамки и линии
-        DrawRectangleRoundedLines({10, 10, 780, 780}, 0.18f, 20, 2, yellow);
-        DrawLineEx({25, 730}, {775, 730}, 3, yellow);
-        // Отображение текущего состояния игры (уровень или конец игры)
-        if (game.run) {
-            DrawTextEx(font, "LEVEL 01", {570, 740}, 34, 2, yellow);
-        } else {
-            DrawTextEx(font, "GAME OVER", {570, 740}, 34, 2, yellow);
+        // Отрисовка интерфейса и игровых объектов (остановленная игра показывается из кэша)
+        double sceneStart = GetTime();
+        scene->Draw(game, flow.State() == FLOW_PAUSED);
+        double overlayStart = GetTime();
+        phases[PHASE_SCENE] = overlayStart - sceneStart;
+        if (flow.State() == FLOW_PAUSED) {
+            DrawPauseOverlay(font);
+        } else if (flow.State() == FLOW_ATTRACT) {
+            DrawAttractOverlay(font, game.highscore, flow.BlinkVisible());
         }
-        // Отрисовка оставшихся жизней (космических кораблей)
-        float x = 50.0;
-        for (int i = 0; i < game.lives; i++) {
-            DrawTextureV(spaceshipImage, {x, 745}, WHITE);
-            x += 50;
+        if (showStats) {
+            DrawPacerOverlay(pacer);
+        }
+        // Конец рисования и показ кадра
+        bool measured = !wasIdle && !flow.Idle();
+        double presentStart = GetTime();
+        phases[PHASE_OVERLAY] = presentStart - overlayStart;
+        if (measured) {
+            pacer.MarkSubmit();
         }
-        // Отрисовка текущего счета
-        DrawTextEx(font, "SCORE", {50, 15}, 34, 2, yellow);
-        std::string scoreText = FormatWithLeadingZeros(game.score, 5);
-        DrawTextEx(font, scoreText.c_str(), {50, 40}, 34, 2, yellow);
-        // Отрисовка рекорда
-        DrawTextEx(font, "HIGH-SCORE", {570, 15}, 34, 2, yellow);
-        std::string highscoreText = FormatWithLeadingZeros(game.highscore, 5);
-        DrawTextEx(font, highscoreText.c_str(), {655, 40}, 34, 2, yellow);
-        // Отрисовка игровых объектов
-        game.Draw();
-        // Конец рисования
         EndDrawing();
+        if (measured) {
+            pacer.MarkPresent();
+            // С вертикальной синхронизацией EndDrawing ждет обратный ход луча, это не работа кадра
+            phases[PHASE_PRESENT] = lowLatency ? 0.0 : GetTime() - presentStart;
+            telemetry.Frame(phases[PHASE_SIMULATION] + phases[PHASE_SCENE] + phases[PHASE_OVERLAY] +
+                            phases[PHASE_PRESENT]);
+            if (governor.Frame(phases)) {
+                const QualityChange &change = governor.Changes().back();
+                TraceLog(LOG_INFO, "QUALITY: level %d -> %d (frame work %.2f ms, mostly %s)", change.from,
+                         change.to, change.average * 1000, QualityGovernor::PhaseName(change.phase));
+                const QualityLevel &settings = governor.Settings();
+                game.SetParticleDensity(settings.particleDensity);
+                scene->SetHudInterval(settings.hudInterval);
+                scene->SetFullBackground(settings.fullBackground);
+            }
+        }
+        if (!flow.Idle()) {
+            // События опроса в EndDrawing до следующего опроса
+            Game::CaptureKeyboard(input, GetTime());
+        }
+        redraw = false;
     }
+    // Слои сцены освобождаются, пока окно еще открыто
+    scene.reset();
     // Закрытие окна и освобождение аудиоустройства
     CloseWindow();
     CloseAudioDevice();
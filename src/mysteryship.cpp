@@ -4,6 +4,7 @@
  */
 
 #include "mysteryship.hpp"
+#include "platform.hpp"
 
 /**
  * @brief Конструктор класса MysteryShip.
@@ -13,8 +14,11 @@
 
 MysteryShip::MysteryShip()
 {
-    image = LoadTexture("../Graphics/mystery.png");
+    image = LoadGameTexture("../Graphics/mystery.png");
+    mask = SpriteMask::Load("../Graphics/mystery.png");
     alive = false;
+    position = {0, 0};
+    speed = 0;
 }
 
 /**
@@ -24,24 +28,25 @@ MysteryShip::MysteryShip()
  */
 
 MysteryShip::~MysteryShip() {
-    UnloadTexture(image);
+    UnloadGameTexture(image);
 }
 
 /**
  * @brief Появление загадочного корабля на экране.
  *
  * Устанавливает корабль в начальное положение и активирует его.
+ *
+ * @param side Сторона появления: 0 - слева, 1 - справа.
  */
 
-void MysteryShip::Spawn() {
+void MysteryShip::Spawn(int side) {
     position.y = 90;
-    int side = GetRandomValue(0, 1);
 
     if(side == 0) {
         position.x = 25;
         speed = 3;
     } else {
-        position.x = GetScreenWidth() - image.width - 25;
+        position.x = ScreenWidth() - image.width - 25;
         speed = -3;
     }
     alive = true;
@@ -62,6 +67,37 @@ Rectangle MysteryShip::getRect()
     }
 }
 
+/**
+ * @brief Проверяет попадание прямоугольника в непрозрачные пиксели загадочного корабля.
+ *
+ * Если маска не загружена, используется прямоугольник текстуры.
+ *
+ * @param rect Прямоугольник, например лазер.
+ * @return true, если корабль жив и прямоугольник его задевает.
+ */
+
+bool MysteryShip::CollidesWith(Rectangle rect)
+{
+    if (!alive) {
+        return false;
+    }
+    if (mask.Empty()) {
+        return CheckCollisionRecs(getRect(), rect);
+    }
+    return mask.OverlapsRect(position.x, position.y, rect.x, rect.y, rect.width, rect.height);
+}
+
+/**
+ * @brief Возвращает скорость загадочного корабля.
+ *
+ * @return Смещение по оси X за тик (знак задает направление).
+ */
+
+int MysteryShip::getSpeed()
+{
+    return speed;
+}
+
 /**
  * @brief Обновляет состояние загадочного корабля.
  *
@@ -71,12 +107,26 @@ Rectangle MysteryShip::getRect()
 void MysteryShip::Update() {
     if(alive) {
         position.x += speed;
-        if(position.x > GetScreenWidth() - image.width -25 || position.x < 25) {
+        if(position.x > ScreenWidth() - image.width -25 || position.x < 25) {
             alive = false;
         }
     }
 }
 
+/**
+ * @brief Восстанавливает состояние загадочного корабля, например из потока зрителя.
+ *
+ * @param alive Флаг активного корабля.
+ * @param x Координата левого края корабля.
+ * @param speed Смещение по оси X за тик.
+ */
+
+void MysteryShip::Restore(bool alive, float x, int speed) {
+    this->alive = alive;
+    this->position = {x, 90};
+    this->speed = speed;
+}
+
 /**
  * @brief Отрисовывает загадочный корабль на экране.
  */
@@ -5,6 +5,7 @@
 
 #pragma once
 #include <raylib.h>
+#include "spritemask.hpp"
 
 /**
  * @class MysteryShip
@@ -40,14 +41,37 @@ class MysteryShip {
      * @brief Появление загадочного корабля на экране.
      *
      * Устанавливает корабль в начальное положение и активирует его.
+     *
+     * @param side Сторона появления: 0 - слева, 1 - справа.
      */
-        void Spawn();
+        void Spawn(int side);
     /**
      * @brief Возвращает прямоугольник, определяющий положение и размер загадочного корабля.
      *
      * @return Прямоугольник с координатами и размерами загадочного корабля.
      */
         Rectangle getRect();
+    /**
+     * @brief Проверяет попадание прямоугольника в непрозрачные пиксели загадочного корабля.
+     *
+     * @param rect Прямоугольник, например лазер.
+     * @return true, если корабль жив и прямоугольник его задевает.
+     */
+        bool CollidesWith(Rectangle rect);
+    /**
+     * @brief Возвращает скорость загадочного корабля.
+     *
+     * @return Смещение по оси X за тик (знак задает направление).
+     */
+        int getSpeed();
+    /**
+     * @brief Восстанавливает состояние загадочного корабля, например из потока зрителя.
+     *
+     * @param alive Флаг активного корабля.
+     * @param x Координата левого края корабля.
+     * @param speed Смещение по оси X за тик.
+     */
+        void Restore(bool alive, float x, int speed);
     /**
      * @brief Состояние загадочного корабля.
      *
@@ -63,6 +87,10 @@ class MysteryShip {
      * @brief Текстура изображения загадочного корабля.
      */
         Texture2D image;
+    /**
+     * @brief Маска столкновений загадочного корабля.
+     */
+        SpriteMask mask;
     /**
      * @brief Скорость движения загадочного корабля.
      */
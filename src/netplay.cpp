@@ -0,0 +1,345 @@
+/**
+ * @file netplay.cpp
+ * @brief Совместная игра двух игроков по UDP с откатом состояния (см. RollbackSession).
+ *
+ * Запуск: invaders_netplay --player 0|1 --port PORT --peer HOST:PORT [--delay 2] [--bot]
+ *                          [--latency MS] [--jitter MS] [--loss 0.05] [--seed 1]
+ *         invaders_netplay --loopback [--seconds 10] [--delay 2] [--latency MS] [--jitter MS] [--loss 0.05]
+ *
+ * В первом режиме открывается окно; игрок управляет стрелками и пробелом (или ботом с --bot),
+ * второй игрок запускает такую же команду со своим номером и встречными портами.
+ * Режим --loopback без окна запускает обоих игроков-ботов в одном процессе на 127.0.0.1
+ * и печатает стоимость повторной симуляции по кадрам, количество откатов и проверенных
+ * контрольных сумм. Задержка, разброс и потери имитируются на отправке.
+ */
+
+#include "gamesnapshot.hpp"
+#include "hud.hpp"
+#include "platform.hpp"
+#include "rollback.hpp"
+#include "udplink.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <raylib.h>
+#include <time.h>
+
+/**
+ * @brief Возвращает текущее время CLOCK_MONOTONIC в наносекундах.
+ */
+
+static long long NowNs() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * @struct NetplayPeer
+ * @brief Игрок сетевой игры: своя копия игры, снимки, сессия и канал.
+ */
+struct NetplayPeer {
+    /**
+     * @brief Конструктор структуры NetplayPeer.
+     *
+     * @param player Номер игрока.
+     * @param delay Задержка ввода в тиках.
+     * @param conditions Имитируемые условия сети.
+     * @param seed Начальное значение игры (одинаковое у обоих игроков).
+     */
+    NetplayPeer(int player, int delay, LinkConditions conditions, unsigned int seed)
+            : game(true), snapshots(rollbackWindow), session(player, delay), link(conditions, seed + player + 1) {
+        this->player = player;
+        bot.seed(seed * 2 + player);
+        botInput = 0;
+        badPackets = 0;
+        game.Seed(seed);
+        game.EnableCoop();
+        game.Reset();
+        game.InitGame();
+
+        session.saveState = [this](int slot) { SaveSnapshot(game, snapshots[slot]); };
+        session.loadState = [this](int slot) { RestoreSnapshot(snapshots[slot], game); };
+        session.hashState = [this](int slot) { return HashSnapshot(snapshots[slot]); };
+        session.advance = [this](const uint8_t *inputs) {
+            game.ApplyInput(inputs[0], 0);
+            game.ApplyInput(inputs[1], 1);
+            game.Update();
+        };
+        session.resimulate = [this](const uint8_t *inputs) {
+            game.ApplyInput(inputs[0], 0);
+            game.ApplyInput(inputs[1], 1);
+            game.Update(false);
+        };
+    }
+
+    /**
+     * @brief Возвращает команду бота: случайную, удерживаемую несколько кадров.
+     */
+    uint8_t BotInput() {
+        if (bot() % 10 == 0) {
+            botInput = bot() % 8;
+        }
+        return botInput | INPUT_RESTART;
+    }
+
+    /**
+     * @brief Номер игрока.
+     */
+    int player;
+    /**
+     * @brief Копия игры.
+     */
+    Game game;
+    /**
+     * @brief Кольцевой буфер снимков по тикам.
+     */
+    std::vector<GameSnapshot> snapshots;
+    /**
+     * @brief Сессия с откатом.
+     */
+    RollbackSession session;
+    /**
+     * @brief Канал до соперника.
+     */
+    UdpLink link;
+    /**
+     * @brief Генератор бота.
+     */
+    std::mt19937 bot;
+    /**
+     * @brief Текущая команда бота.
+     */
+    uint8_t botInput;
+    /**
+     * @brief Количество отброшенных пакетов.
+     */
+    long long badPackets;
+    /**
+     * @brief Время AdvanceFrame по кадрам в наносекундах.
+     */
+    std::vector<long long> frameNs;
+    /**
+     * @brief Время AdvanceFrame в кадрах с откатом в наносекундах.
+     */
+    std::vector<long long> rollbackFrameNs;
+};
+
+/**
+ * @brief Выполняет кадр игрока: принимает пакеты, продвигает сессию и отправляет свои команды.
+ *
+ * @param peer Игрок.
+ * @param input Команды игрока в этом кадре.
+ */
+
+static void RunFrame(NetplayPeer &peer, uint8_t input) {
+    uint8_t packet[rollbackMaxPacket];
+    peer.link.Flush();
+    while (size_t size = peer.link.Receive(packet, sizeof(packet))) {
+        if (!peer.session.ReadPacket(packet, size)) {
+            peer.badPackets++;
+        }
+    }
+
+    long long start = NowNs();
+    peer.session.AdvanceFrame(input);
+    long long cost = NowNs() - start;
+    peer.frameNs.push_back(cost);
+    if (peer.session.LastRollback() > 0) {
+        peer.rollbackFrameNs.push_back(cost);
+    }
+
+    size_t size = peer.session.WritePacket(packet);
+    peer.link.Send(packet, size);
+}
+
+/**
+ * @brief Возвращает процентиль времени в микросекундах.
+ *
+ * @param values Значения в наносекундах (сортируются).
+ * @param fraction Доля (0..1).
+ */
+
+static double PercentileUs(std::vector<long long> &values, double fraction) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = std::min(values.size() - 1, (size_t) (values.size() * fraction));
+    return values[index] / 1000.0;
+}
+
+/**
+ * @brief Печатает счетчики игрока.
+ *
+ * @param peer Игрок.
+ * @param delay Задержка ввода в тиках.
+ */
+
+static void PrintReport(NetplayPeer &peer, int delay) {
+    const RollbackStats &stats = peer.session.stats;
+    printf("player %d\n", peer.player);
+    printf("  ticks/frames        %d / %lld (%lld stalled)\n", peer.session.Tick(), stats.frames, stats.stalledFrames);
+    printf("  rollbacks           %lld, %.2f ticks avg, %d max\n", stats.rollbacks,
+           stats.rollbacks > 0 ? (double) stats.resimulatedTicks / stats.rollbacks : 0.0, stats.maxRollback);
+    printf("  resim ticks/frame   %.2f\n", stats.frames > 0 ? (double) stats.resimulatedTicks / stats.frames : 0.0);
+    printf("  frame cost p50/p99  %.1f / %.1f us\n", PercentileUs(peer.frameNs, 0.5), PercentileUs(peer.frameNs, 0.99));
+    printf("  rollback frame p50/p99/max %.1f / %.1f / %.1f us\n", PercentileUs(peer.rollbackFrameNs, 0.5),
+           PercentileUs(peer.rollbackFrameNs, 0.99), PercentileUs(peer.rollbackFrameNs, 1.0));
+    printf("  felt input latency  %d ticks (%.0f ms)\n", delay, delay * Game::tickDuration * 1000);
+    printf("  hashes checked      %lld, ", stats.checkedHashes);
+    if (peer.session.DesyncTick() >= 0) {
+        printf("DESYNC at tick %d\n", peer.session.DesyncTick());
+    } else {
+        printf("no desync\n");
+    }
+    printf("  packets dropped     %lld by simulation, %lld rejected\n", peer.link.dropped, peer.badPackets);
+}
+
+/**
+ * @brief Запускает обоих игроков-ботов в одном процессе на 127.0.0.1 с частотой 60 кадров в секунду.
+ *
+ * @param seconds Длительность в секундах.
+ * @param delay Задержка ввода в тиках.
+ * @param conditions Имитируемые условия сети.
+ * @param port Порт первого игрока; второй использует port + 1.
+ * @param seed Начальное значение игры.
+ * @return 0, если расхождений не обнаружено.
+ */
+
+static int RunLoopback(int seconds, int delay, LinkConditions conditions, int port, unsigned int seed) {
+    SetTraceLogLevel(LOG_WARNING);
+    NetplayPeer first(0, delay, conditions, seed);
+    NetplayPeer second(1, delay, conditions, seed);
+    if (!first.link.Open(port, "127.0.0.1", port + 1) || !second.link.Open(port + 1, "127.0.0.1", port)) {
+        perror("bind");
+        return 1;
+    }
+
+    long long periodNs = (long long) (Game::tickDuration * 1e9);
+    long long next = NowNs();
+    for (int frame = 0; frame < seconds * 60; ++frame) {
+        RunFrame(first, first.BotInput());
+        RunFrame(second, second.BotInput());
+        next += periodNs;
+        timespec deadline = {(time_t) (next / 1000000000LL), (long) (next % 1000000000LL)};
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr);
+    }
+
+    PrintReport(first, delay);
+    PrintReport(second, delay);
+    return first.session.DesyncTick() < 0 && second.session.DesyncTick() < 0 ? 0 : 1;
+}
+
+/**
+ * @brief Главная функция сетевой игры.
+ *
+ * @param argc Количество аргументов командной строки.
+ * @param argv Аргументы командной строки.
+ * @return 0 при успешном завершении, 1 при ошибке или расхождении состояния.
+ */
+
+int main(int argc, char **argv) {
+    int player = 0;
+    int port = 7001;
+    char peerHost[64] = "127.0.0.1";
+    int peerPort = 7002;
+    int delay = 2;
+    int seconds = 10;
+    unsigned int seed = 1;
+    bool loopback = false;
+    bool useBot = false;
+    LinkConditions conditions = {0, 0, 0.0};
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--loopback") == 0) {
+            loopback = true;
+        } else if (strcmp(argv[i], "--bot") == 0) {
+            useBot = true;
+        } else if (strcmp(argv[i], "--player") == 0 && hasValue) {
+            player = atoi(argv[++i]) == 1 ? 1 : 0;
+        } else if (strcmp(argv[i], "--port") == 0 && hasValue) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--peer") == 0 && hasValue) {
+            const char *peer = argv[++i];
+            const char *colon = strrchr(peer, ':');
+            if (colon == nullptr || colon - peer >= (long) sizeof(peerHost)) {
+                fprintf(stderr, "--peer expects HOST:PORT\n");
+                return 1;
+            }
+            memcpy(peerHost, peer, colon - peer);
+            peerHost[colon - peer] = 0;
+            peerPort = atoi(colon + 1);
+        } else if (strcmp(argv[i], "--delay") == 0 && hasValue) {
+            delay = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seconds") == 0 && hasValue) {
+            seconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            seed = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--latency") == 0 && hasValue) {
+            conditions.latencyMs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--jitter") == 0 && hasValue) {
+            conditions.jitterMs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--loss") == 0 && hasValue) {
+            conditions.loss = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    MountAssetPack(TextFormat("%sassets.pak", GetApplicationDirectory()));
+    if (loopback) {
+        return RunLoopback(seconds, delay, conditions, port, seed);
+    }
+
+    Color grey = {29, 29, 27, 255};
+    Color yellow = {243, 216, 63, 255};
+    InitWindow(800, 800, TextFormat("C++ Space Invaders - Player %d", player + 1));
+    SetTargetFPS(60);
+    Font font = LoadGameFont("../Font/monogram.ttf", 64);
+    Texture2D spaceshipImage = LoadGameTexture("../Graphics/spaceship.png");
+
+    std::unique_ptr<NetplayPeer> peer(new NetplayPeer(player, delay, conditions, seed));
+    if (!peer->link.Open(port, peerHost, peerPort)) {
+        perror("bind");
+        CloseWindow();
+        return 1;
+    }
+
+    // Команды бота и клавиатуры проходят через одну очередь ввода
+    InputQueue input;
+    while (!WindowShouldClose()) {
+        double now = GetTime();
+        if (useBot) {
+            input.PushState(now, 0, peer->BotInput());
+        } else {
+            Game::CaptureKeyboard(input, now);
+        }
+        input.Tick(now);
+        RunFrame(*peer, input.Input(0));
+
+        BeginDrawing();
+        ClearBackground(grey);
+        DrawHud(peer->game, font, spaceshipImage);
+        peer->game.Draw();
+        DrawText(TextFormat("delay %d  rollback %d  predicted %d", delay, peer->session.LastRollback(),
+                            peer->session.PredictedTicks()), 300, 770, 10, yellow);
+        if (peer->session.DesyncTick() >= 0) {
+            DrawText(TextFormat("DESYNC at tick %d", peer->session.DesyncTick()), 300, 20, 20, RED);
+        }
+        EndDrawing();
+    }
+
+    PrintReport(*peer, delay);
+    int result = peer->session.DesyncTick() < 0 ? 0 : 1;
+    peer.reset();
+    Alien::UnloadImages();
+    UnloadGameTexture(spaceshipImage);
+    UnloadFont(font);
+    CloseWindow();
+    return result;
+}
@@ -0,0 +1,145 @@
+/**
+ * @file observation.cpp
+ * @brief Файл реализации функций построения вектора признаков состояния игры.
+ */
+
+#include "observation.hpp"
+#include "platform.hpp"
+#include <array>
+#include <cmath>
+#include <cstring>
+
+/**
+ * @brief Возвращает количество блоков в каждом столбце целого щита.
+ *
+ * @return Количество блоков по столбцам сетки Obstacle::grid.
+ */
+
+static std::array<int, ObservationLayout::shieldColumns> InitialColumnCounts() {
+    std::array<int, ObservationLayout::shieldColumns> counts = {};
+    for (auto &row: Obstacle::grid) {
+        for (int column = 0; column < ObservationLayout::shieldColumns && column < (int) row.size(); ++column) {
+            counts[column] += row[column];
+        }
+    }
+    return counts;
+}
+
+/**
+ * @brief Заполняет вектор признаков в формате float32.
+ *
+ * @param game Игра, состояние которой нужно описать.
+ * @param features Буфер размером ObservationLayout::size.
+ */
+
+void FillObservation(Game &game, float *features) {
+    typedef ObservationLayout L;
+    memset(features, 0, sizeof(float) * L::size);
+
+    const float width = ScreenWidth();
+    const float height = ScreenHeight();
+
+    Rectangle ship = game.spaceship.getRect();
+    float shipX = ship.x + ship.width / 2;
+    float shipY = ship.y + ship.height / 2;
+    features[L::ship] = shipX / width;
+    features[L::ship + 1] = game.lives / 3.0f;
+
+    features[L::formation] = game.formationOrigin.x / width;
+    features[L::formation + 1] = game.formationOrigin.y / height;
+    features[L::formation + 2] = game.aliensDirection;
+
+    for (int row = 0; row < Game::alienRows; ++row) {
+        for (int column = 0; column < Game::alienColumns; ++column) {
+            if (game.shooters.IsAlive(row, column)) {
+                features[L::aliveMask + row * Game::alienColumns + column] = 1;
+            }
+        }
+    }
+
+    // Частичная сортировка вставкой в массив фиксированного размера
+    float nearest[L::alienLaserCount][3];
+    float distances[L::alienLaserCount];
+    int found = 0;
+    for (auto &laser: game.alienLasers) {
+        if (!laser.active) {
+            continue;
+        }
+        float dx = (laser.position.x + 2 - shipX) / width;
+        float dy = (laser.position.y + 15 - shipY) / height;
+        float distance = dx * dx + dy * dy;
+        int i;
+        if (found < L::alienLaserCount) {
+            i = found++;
+        } else if (distance < distances[L::alienLaserCount - 1]) {
+            i = L::alienLaserCount - 1;
+        } else {
+            continue;
+        }
+        for (; i > 0 && distances[i - 1] > distance; --i) {
+            distances[i] = distances[i - 1];
+            memcpy(nearest[i], nearest[i - 1], sizeof(nearest[i]));
+        }
+        distances[i] = distance;
+        nearest[i][0] = dx;
+        nearest[i][1] = dy;
+        nearest[i][2] = 1;
+    }
+    memcpy(features + L::alienLasers, nearest, sizeof(float) * 3 * found);
+
+    int playerLasers = 0;
+    for (auto &laser: game.spaceship.lasers) {
+        if (!laser.active || playerLasers == L::playerLaserCount) {
+            continue;
+        }
+        float *slot = features + L::playerLasers + playerLasers * 3;
+        slot[0] = laser.position.x / width;
+        slot[1] = laser.position.y / height;
+        slot[2] = 1;
+        playerLasers++;
+    }
+
+    static const std::array<int, L::shieldColumns> initialCounts = InitialColumnCounts();
+    for (int i = 0; i < L::shieldCount && i < (int) game.obstacles.size(); ++i) {
+        const std::vector<int> &counts = game.obstacles[i].columnCounts;
+        for (int column = 0; column < L::shieldColumns && column < (int) counts.size(); ++column) {
+            if (initialCounts[column] > 0) {
+                features[L::shieldDamage + i * L::shieldColumns + column] =
+                        1.0f - float(counts[column]) / initialCounts[column];
+            }
+        }
+    }
+
+    if (game.mysteryship.alive) {
+        Rectangle mystery = game.mysteryship.getRect();
+        features[L::mysteryShip] = 1;
+        features[L::mysteryShip + 1] = (mystery.x + mystery.width / 2) / width;
+        features[L::mysteryShip + 2] = game.mysteryship.getSpeed() > 0 ? 1 : -1;
+    }
+
+    features[L::status] = game.score / 10000.0f;
+    features[L::status + 1] = game.run ? 0 : 1;
+}
+
+/**
+ * @brief Заполняет вектор признаков в формате int16.
+ *
+ * Значения совпадают с вариантом float32, умноженным на observationInt16Scale, с насыщением.
+ *
+ * @param game Игра, состояние которой нужно описать.
+ * @param features Буфер размером ObservationLayout::size.
+ */
+
+void FillObservation(Game &game, int16_t *features) {
+    float values[ObservationLayout::size];
+    FillObservation(game, values);
+    for (int i = 0; i < ObservationLayout::size; ++i) {
+        float scaled = std::nearbyint(values[i] * observationInt16Scale);
+        if (scaled > INT16_MAX) {
+            scaled = INT16_MAX;
+        } else if (scaled < INT16_MIN) {
+            scaled = INT16_MIN;
+        }
+        features[i] = (int16_t) scaled;
+    }
+}
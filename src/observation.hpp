@@ -0,0 +1,104 @@
+/**
+ * @file observation.hpp
+ * @brief Заголовочный файл, содержащий функции построения вектора признаков состояния игры.
+ *
+ * Вектор признаков имеет фиксированную раскладку, описанную в ObservationLayout, и версию
+ * observationVersion, которая увеличивается при любом изменении раскладки. Заполнение не выделяет
+ * память и рассчитано на вызов на каждом тике.
+ */
+
+#pragma once
+
+#include "game.hpp"
+#include <cstdint>
+
+/**
+ * @brief Версия раскладки вектора признаков.
+ */
+constexpr int observationVersion = 1;
+
+/**
+ * @struct ObservationLayout
+ * @brief Смещения групп признаков в векторе.
+ *
+ * Все координаты нормированы на размеры экрана, относительные координаты лазеров берутся
+ * от центра корабля игрока. Для отсутствующих объектов все признаки равны нулю.
+ */
+struct ObservationLayout {
+    /**
+     * @brief Количество учитываемых ближайших лазеров инопланетян.
+     */
+    static constexpr int alienLaserCount = 8;
+    /**
+     * @brief Количество учитываемых лазеров игрока.
+     */
+    static constexpr int playerLaserCount = 3;
+    /**
+     * @brief Количество щитов.
+     */
+    static constexpr int shieldCount = 4;
+    /**
+     * @brief Количество столбцов сетки щита.
+     */
+    static constexpr int shieldColumns = 23;
+
+    /**
+     * @brief Центр корабля по X, количество жизней / 3.
+     */
+    static constexpr int ship = 0;
+    /**
+     * @brief Позиция ячейки (0, 0) формации по X и Y, направление движения формации.
+     */
+    static constexpr int formation = ship + 2;
+    /**
+     * @brief Маска живых инопланетян 5x11 по рядам (1 - жив).
+     */
+    static constexpr int aliveMask = formation + 3;
+    /**
+     * @brief Ближайшие лазеры инопланетян: (dx, dy, 1) по возрастанию расстояния.
+     */
+    static constexpr int alienLasers = aliveMask + Game::alienRows * Game::alienColumns;
+    /**
+     * @brief Лазеры игрока: (x, y, 1) в порядке выстрела.
+     */
+    static constexpr int playerLasers = alienLasers + alienLaserCount * 3;
+    /**
+     * @brief Доля разрушенных блоков в каждом столбце каждого щита.
+     */
+    static constexpr int shieldDamage = playerLasers + playerLaserCount * 3;
+    /**
+     * @brief Загадочный корабль: жив, центр по X, направление.
+     */
+    static constexpr int mysteryShip = shieldDamage + shieldCount * shieldColumns;
+    /**
+     * @brief Счет / 10000, признак окончания игры.
+     */
+    static constexpr int status = mysteryShip + 3;
+    /**
+     * @brief Общее количество признаков.
+     */
+    static constexpr int size = status + 2;
+};
+
+/**
+ * @brief Масштаб представления признаков в формате int16 (число с фиксированной точкой Q13).
+ */
+constexpr int observationInt16Scale = 1 << 13;
+
+/**
+ * @brief Заполняет вектор признаков в формате float32.
+ *
+ * @param game Игра, состояние которой нужно описать.
+ * @param features Буфер размером ObservationLayout::size.
+ */
+void FillObservation(Game &game, float *features);
+
+/**
+ * @brief Заполняет вектор признаков в формате int16.
+ *
+ * Значения совпадают с вариантом float32, умноженным на observationInt16Scale, с насыщением.
+ *
+ * @param game Игра, состояние которой нужно описать.
+ * @param features Буфер размером ObservationLayout::size.
+ */
+void FillObservation(Game &game, int16_t *features);
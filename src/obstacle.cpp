@@ -35,6 +35,7 @@ std::vector <std::vector<int>> Obstacle::grid = {
 
 Obstacle::Obstacle(Vector2 position) {
     this->position = position;
+    columnCounts.assign(grid[0].size(), 0);
 
     for (unsigned int row = 0; row < grid.size(); ++row) {
         for (unsigned int column = 0; column < grid[0].size(); ++column) {
@@ -43,9 +44,11 @@ Obstacle::Obstacle(Vector2 position) {
                 float pos_y = position.y + row * 3;
                 Block block = Block({pos_x, pos_y});
                 blocks.push_back(block);
+                columnCounts[column]++;
             }
         }
     }
+    RebuildBatch();
 }
 
 /**
@@ -56,4 +59,79 @@ void Obstacle::Draw() {
     for (auto &block: blocks) {
         block.Draw();
     }
+}
+
+/**
+ * @brief Удаляет блоки, пересекающиеся с прямоугольником.
+ *
+ * @param rect Прямоугольник, например лазер или инопланетянин.
+ * @return true, если был удален хотя бы один блок.
+ */
+
+bool Obstacle::EraseBlocks(Rectangle rect) {
+    if (batch.Collide(rect.x, rect.y, rect.width, rect.height, hitMask) == 0) {
+        return false;
+    }
+
+    unsigned int kept = 0;
+    for (unsigned int i = 0; i < blocks.size(); ++i) {
+        if (((hitMask[i >> 6] >> (i & 63)) & 1) == 0) {
+            blocks[kept++] = blocks[i];
+        } else {
+            columnCounts[int(blocks[i].getRect().x - position.x) / 3]--;
+        }
+    }
+    blocks.erase(blocks.begin() + kept, blocks.end());
+    RebuildBatch();
+    return true;
+}
+
+/**
+ * @brief Заменяет блоки препятствия по маскам клеток сетки.
+ *
+ * @param rows Маски столбцов для каждого ряда сетки (бит column - клетка на месте).
+ */
+
+void Obstacle::SetCells(const uint32_t *rows) {
+    blocks.clear();
+    columnCounts.assign(grid[0].size(), 0);
+    for (unsigned int row = 0; row < grid.size(); ++row) {
+        for (unsigned int column = 0; column < grid[0].size(); ++column) {
+            if (rows[row] & (1u << column)) {
+                blocks.push_back(Block({position.x + column * 3, position.y + row * 3}));
+                columnCounts[column]++;
+            }
+        }
+    }
+    RebuildBatch();
+}
+
+/**
+ * @brief Записывает маски клеток сетки, на месте которых остались блоки.
+ *
+ * @param rows Массив масок по количеству рядов сетки.
+ */
+
+void Obstacle::GetCells(uint32_t *rows) {
+    for (unsigned int row = 0; row < grid.size(); ++row) {
+        rows[row] = 0;
+    }
+    for (auto &block: blocks) {
+        Rectangle rect = block.getRect();
+        int column = int(rect.x - position.x) / 3;
+        int row = int(rect.y - position.y) / 3;
+        rows[row] |= 1u << column;
+    }
+}
+
+/**
+ * @brief Перестраивает упакованный массив прямоугольников блоков.
+ */
+
+void Obstacle::RebuildBatch() {
+    batch.Clear();
+    for (auto &block: blocks) {
+        Rectangle rect = block.getRect();
+        batch.Add(rect.x, rect.y, rect.width, rect.height);
+    }
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 
 #include "block.hpp"
 #pragma once
+#include "aabbbatch.hpp"
 #include <vector>
 
 /**
@@ -26,6 +27,25 @@ class Obstacle {
      * @brief Отрисовывает препятствие на экране.
      */
         void Draw();
+    /**
+     * @brief Удаляет блоки, пересекающиеся с прямоугольником.
+     *
+     * @param rect Прямоугольник, например лазер или инопланетянин.
+     * @return true, если был удален хотя бы один блок.
+     */
+        bool EraseBlocks(Rectangle rect);
+    /**
+     * @brief Заменяет блоки препятствия по маскам клеток сетки.
+     *
+     * @param rows Маски столбцов для каждого ряда сетки (бит column - клетка на месте).
+     */
+        void SetCells(const uint32_t *rows);
+    /**
+     * @brief Записывает маски клеток сетки, на месте которых остались блоки.
+     *
+     * @param rows Массив масок по количеству рядов сетки.
+     */
+        void GetCells(uint32_t *rows);
     /**
      * @brief Позиция препятствия на экране.
      */
@@ -34,11 +54,26 @@ class Obstacle {
      * @brief Вектор, содержащий блоки, составляющие препятствие.
      */
         std::vector<Block> blocks;
+    /**
+     * @brief Количество оставшихся блоков в каждом столбце сетки.
+     */
+        std::vector<int> columnCounts;
     
     /**
      * @brief Статическая сетка, определяющая форму препятствия.
      */
         static std::vector<std::vector<int>> grid;
     private:
-    // Здесь могут быть добавлены приватные члены класса, если потребуется.
+    /**
+     * @brief Перестраивает упакованный массив прямоугольников блоков.
+     */
+        void RebuildBatch();
+    /**
+     * @brief Прямоугольники блоков в порядке вектора blocks.
+     */
+        AabbBatch batch;
+    /**
+     * @brief Маска попаданий последней проверки.
+     */
+        std::vector<uint64_t> hitMask;
 };
\ No newline at end of file
@@ -0,0 +1,270 @@
+/**
+ * @file particlepool.cpp
+ * @brief Файл реализации, содержащий методы класса ParticlePool.
+ */
+
+#include "particlepool.hpp"
+#include "raylib.h"
+#include "rlgl.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define PARTICLE_POOL_X86 1
+#endif
+
+/**
+ * @brief Количество частиц в одном блоке дополнения.
+ */
+
+static const int laneCount = 8;
+
+#ifdef PARTICLE_POOL_X86
+
+/**
+ * @brief Обновление частиц с помощью AVX (8 частиц за итерацию).
+ */
+
+__attribute__((target("avx")))
+static void UpdateAvx(float *x, float *y, float *vx, float *vy, float *life, int padded) {
+    const __m256 gravity = _mm256_set1_ps(ParticlePool::gravity);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    for (int i = 0; i < padded; i += 8) {
+        __m256 speedY = _mm256_loadu_ps(vy + i);
+        _mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(vx + i)));
+        _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), speedY));
+        _mm256_storeu_ps(vy + i, _mm256_add_ps(speedY, gravity));
+        _mm256_storeu_ps(life + i, _mm256_sub_ps(_mm256_loadu_ps(life + i), one));
+    }
+}
+
+#endif
+
+/**
+ * @brief Конструктор класса ParticlePool.
+ *
+ * @param capacity Наибольшее количество живых частиц.
+ * @param seed Начальное значение генератора направлений и времени жизни частиц.
+ */
+
+ParticlePool::ParticlePool(int capacity, uint32_t seed) {
+    this->capacity = std::max(capacity, 0);
+    int padded = (this->capacity + laneCount - 1) / laneCount * laneCount;
+    x.assign(padded, 0);
+    y.assign(padded, 0);
+    vx.assign(padded, 0);
+    vy.assign(padded, 0);
+    life.assign(padded, 0);
+    color.assign(padded, 0);
+    count = 0;
+    density = 1.0f;
+    dropped = 0;
+    state = seed != 0 ? seed : 1;
+}
+
+/**
+ * @brief Выпускает частицы из точки во все стороны.
+ *
+ * Направление каждой частицы случайно, скорость - от трети до полной, время жизни - от 3/4
+ * до 5/4 среднего. Частицы, не выпущенные из-за плотности, не считаются в Dropped().
+ *
+ * @param x Координата X точки.
+ * @param y Координата Y точки.
+ * @param count Количество частиц при полной плотности.
+ * @param speed Наибольшая скорость частицы в пикселях за тик.
+ * @param life Среднее время жизни в тиках.
+ * @param color Цвет в виде 0xRRGGBB.
+ * @return Количество выпущенных частиц (меньше count при пониженной плотности или заполненном пуле).
+ */
+
+int ParticlePool::Burst(float x, float y, int count, float speed, int life, uint32_t color) {
+    count = (int) std::lround(std::max(count, 0) * density);
+    int emitted = std::min(count, capacity - this->count);
+    dropped += count - emitted;
+    for (int i = 0; i < emitted; ++i) {
+        int index = this->count++;
+        float angle = Random() * 6.2831853f;
+        float velocity = speed * (1.0f + 2.0f * Random()) / 3.0f;
+        this->x[index] = x - size / 2;
+        this->y[index] = y - size / 2;
+        vx[index] = std::cos(angle) * velocity;
+        vy[index] = std::sin(angle) * velocity;
+        this->life[index] = std::floor(life * (0.75f + 0.5f * Random())) + 1;
+        this->color[index] = color;
+    }
+    return emitted;
+}
+
+/**
+ * @brief Задает плотность: долю частиц, которые выпускает Burst.
+ *
+ * @param density Доля от 0 (частицы не выпускаются) до 1.
+ */
+
+void ParticlePool::SetDensity(float density) {
+    this->density = std::min(std::max(density, 0.0f), 1.0f);
+}
+
+/**
+ * @brief Продвигает частицы на один тик и удаляет погибшие.
+ *
+ * Частица смещается на свою скорость, ее вертикальная скорость растет на gravity, а жизнь
+ * уменьшается на 1. Обрабатываются блоки по 8 частиц, включая дополнение за последней живой.
+ */
+
+void ParticlePool::Update() {
+#ifdef PARTICLE_POOL_X86
+    static const bool hasAvx = __builtin_cpu_supports("avx");
+    if (hasAvx) {
+        int padded = (count + laneCount - 1) / laneCount * laneCount;
+        UpdateAvx(x.data(), y.data(), vx.data(), vy.data(), life.data(), padded);
+        Compact();
+        return;
+    }
+#endif
+    UpdateScalar();
+}
+
+/**
+ * @brief Скалярная эталонная реализация метода Update.
+ */
+
+void ParticlePool::UpdateScalar() {
+    for (int i = 0; i < count; ++i) {
+        x[i] += vx[i];
+        y[i] += vy[i];
+        vy[i] += gravity;
+        life[i] -= 1.0f;
+    }
+    Compact();
+}
+
+/**
+ * @brief Отрисовывает живые частицы одним пакетом четырехугольников.
+ *
+ * Частицы передаются в пакет rlgl напрямую, без отдельного вызова рисования на каждую, и берут
+ * текстуру фигур raylib, чтобы попасть в один пакет с прямоугольниками. Частица гаснет за
+ * последние fadeTicks тиков жизни.
+ */
+
+void ParticlePool::Draw() const {
+    if (count == 0) {
+        return;
+    }
+    Texture2D shapes = GetShapesTexture();
+    Rectangle source = GetShapesTextureRec();
+    float left = source.x / shapes.width;
+    float top = source.y / shapes.height;
+    float right = (source.x + source.width) / shapes.width;
+    float bottom = (source.y + source.height) / shapes.height;
+
+    rlSetTexture(shapes.id);
+    rlBegin(RL_QUADS);
+    for (int i = 0; i < count; ++i) {
+        // Полный пакет отправляется на отрисовку, режим и текстура сохраняются
+        rlCheckRenderBatchLimit(4);
+        unsigned char alpha = (unsigned char) std::min(255.0f, life[i] * 255.0f / fadeTicks);
+        rlColor4ub(color[i] >> 16, (color[i] >> 8) & 0xFF, color[i] & 0xFF, alpha);
+        rlTexCoord2f(left, top);
+        rlVertex2f(x[i], y[i]);
+        rlTexCoord2f(left, bottom);
+        rlVertex2f(x[i], y[i] + size);
+        rlTexCoord2f(right, bottom);
+        rlVertex2f(x[i] + size, y[i] + size);
+        rlTexCoord2f(right, top);
+        rlVertex2f(x[i] + size, y[i]);
+    }
+    rlEnd();
+    rlSetTexture(0);
+}
+
+/**
+ * @brief Удаляет все частицы.
+ */
+
+void ParticlePool::Clear() {
+    count = 0;
+}
+
+/**
+ * @brief Возвращает количество живых частиц.
+ */
+
+int ParticlePool::Size() const {
+    return count;
+}
+
+/**
+ * @brief Возвращает емкость пула.
+ */
+
+int ParticlePool::Capacity() const {
+    return capacity;
+}
+
+/**
+ * @brief Возвращает количество частиц, не выпущенных из-за заполненного пула.
+ */
+
+long long ParticlePool::Dropped() const {
+    return dropped;
+}
+
+/**
+ * @brief Координата X частицы.
+ */
+
+float ParticlePool::X(int index) const {
+    return x[index];
+}
+
+/**
+ * @brief Координата Y частицы.
+ */
+
+float ParticlePool::Y(int index) const {
+    return y[index];
+}
+
+/**
+ * @brief Оставшееся время жизни частицы в тиках.
+ */
+
+float ParticlePool::Life(int index) const {
+    return life[index];
+}
+
+/**
+ * @brief Удаляет частицы с исчерпанной жизнью, перенося на их место последние.
+ */
+
+void ParticlePool::Compact() {
+    int i = 0;
+    while (i < count) {
+        if (life[i] > 0) {
+            i++;
+            continue;
+        }
+        int last = --count;
+        x[i] = x[last];
+        y[i] = y[last];
+        vx[i] = vx[last];
+        vy[i] = vy[last];
+        life[i] = life[last];
+        color[i] = color[last];
+    }
+}
+
+/**
+ * @brief Возвращает следующее случайное число от 0 до 1.
+ *
+ * У пула свой генератор, поэтому частицы не влияют на генератор игры и ее повторяемость.
+ */
+
+float ParticlePool::Random() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (state >> 8) * (1.0f / 16777216.0f);
+}
@@ -0,0 +1,172 @@
+/**
+ * @file particlepool.hpp
+ * @brief Заголовочный файл, содержащий класс ParticlePool.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class ParticlePool
+ * @brief Пул частиц взрывов и обломков фиксированной емкости.
+ *
+ * Частицы хранятся в виде структуры массивов (координаты, скорости, оставшаяся жизнь и цвет),
+ * дополненной до кратного 8 размера, поэтому обновление обрабатывает 8 частиц за итерацию AVX.
+ * Живые частицы лежат в начале массивов без пропусков: погибшая частица заменяется последней.
+ * Память выделяется один раз в конструкторе; частицы сверх емкости не появляются, поэтому
+ * время обновления и отрисовки ограничено емкостью.
+ */
+
+class ParticlePool {
+public:
+    /**
+     * @brief Конструктор класса ParticlePool.
+     *
+     * @param capacity Наибольшее количество живых частиц.
+     * @param seed Начальное значение генератора направлений и времени жизни частиц.
+     */
+    explicit ParticlePool(int capacity, uint32_t seed = 1);
+
+    /**
+     * @brief Выпускает частицы из точки во все стороны.
+     *
+     * @param x Координата X точки.
+     * @param y Координата Y точки.
+     * @param count Количество частиц при полной плотности.
+     * @param speed Наибольшая скорость частицы в пикселях за тик.
+     * @param life Среднее время жизни в тиках.
+     * @param color Цвет в виде 0xRRGGBB.
+     * @return Количество выпущенных частиц (меньше count при пониженной плотности или заполненном пуле).
+     */
+    int Burst(float x, float y, int count, float speed, int life, uint32_t color);
+
+    /**
+     * @brief Задает плотность: долю частиц, которые выпускает Burst.
+     *
+     * @param density Доля от 0 (частицы не выпускаются) до 1.
+     */
+    void SetDensity(float density);
+
+    /**
+     * @brief Продвигает частицы на один тик и удаляет погибшие.
+     *
+     * Использует AVX, если процессор его поддерживает, иначе скалярную реализацию.
+     */
+    void Update();
+
+    /**
+     * @brief Скалярная эталонная реализация метода Update.
+     */
+    void UpdateScalar();
+
+    /**
+     * @brief Отрисовывает живые частицы одним пакетом четырехугольников.
+     */
+    void Draw() const;
+
+    /**
+     * @brief Удаляет все частицы.
+     */
+    void Clear();
+
+    /**
+     * @brief Возвращает количество живых частиц.
+     */
+    int Size() const;
+
+    /**
+     * @brief Возвращает емкость пула.
+     */
+    int Capacity() const;
+
+    /**
+     * @brief Возвращает количество частиц, не выпущенных из-за заполненного пула.
+     */
+    long long Dropped() const;
+
+    /**
+     * @brief Координата X частицы.
+     */
+    float X(int index) const;
+
+    /**
+     * @brief Координата Y частицы.
+     */
+    float Y(int index) const;
+
+    /**
+     * @brief Оставшееся время жизни частицы в тиках.
+     */
+    float Life(int index) const;
+
+    /**
+     * @brief Ускорение свободного падения частиц в пикселях за тик в квадрате.
+     */
+    constexpr static float gravity = 0.05f;
+    /**
+     * @brief Размер частицы в пикселях.
+     */
+    constexpr static float size = 3.0f;
+    /**
+     * @brief Количество последних тиков жизни, за которые частица гаснет.
+     */
+    constexpr static float fadeTicks = 20.0f;
+
+private:
+    /**
+     * @brief Удаляет частицы с исчерпанной жизнью, перенося на их место последние.
+     */
+    void Compact();
+
+    /**
+     * @brief Возвращает следующее случайное число от 0 до 1.
+     */
+    float Random();
+
+    /**
+     * @brief Координаты X.
+     */
+    std::vector<float> x;
+    /**
+     * @brief Координаты Y.
+     */
+    std::vector<float> y;
+    /**
+     * @brief Скорости по оси X.
+     */
+    std::vector<float> vx;
+    /**
+     * @brief Скорости по оси Y.
+     */
+    std::vector<float> vy;
+    /**
+     * @brief Оставшееся время жизни в тиках.
+     */
+    std::vector<float> life;
+    /**
+     * @brief Цвета в виде 0xRRGGBB.
+     */
+    std::vector<uint32_t> color;
+    /**
+     * @brief Количество живых частиц.
+     */
+    int count;
+    /**
+     * @brief Емкость пула.
+     */
+    int capacity;
+    /**
+     * @brief Доля выпускаемых частиц.
+     */
+    float density;
+    /**
+     * @brief Количество невыпущенных частиц.
+     */
+    long long dropped;
+    /**
+     * @brief Состояние генератора xorshift32.
+     */
+    uint32_t state;
+};
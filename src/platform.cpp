@@ -0,0 +1,399 @@
+/**
+ * @file platform.cpp
+ * @brief Файл реализации функций доступа к окну и ресурсам с поддержкой работы без окна.
+ */
+
+#include "platform.hpp"
+#include <climits>
+#include <cstring>
+
+/**
+ * @brief Ширина виртуального экрана (совпадает с окном игры).
+ */
+
+static int headlessWidth = 800;
+
+/**
+ * @brief Высота виртуального экрана (совпадает с окном игры).
+ */
+
+static int headlessHeight = 800;
+
+/**
+ * @brief Подключенный архив ресурсов.
+ */
+
+static AssetPack assetPack;
+
+/**
+ * @brief Интервал опроса событий окна при ожидании ввода в секундах.
+ */
+
+static const double inputPollInterval = 0.02;
+
+/**
+ * @brief Возвращает ширину экрана.
+ *
+ * @return Ширина окна или виртуального экрана, если окно не создано.
+ */
+
+int ScreenWidth() {
+    return IsWindowReady() ? GetScreenWidth() : headlessWidth;
+}
+
+/**
+ * @brief Возвращает высоту экрана.
+ *
+ * @return Высота окна или виртуального экрана, если окно не создано.
+ */
+
+int ScreenHeight() {
+    return IsWindowReady() ? GetScreenHeight() : headlessHeight;
+}
+
+/**
+ * @brief Задает размеры виртуального экрана для работы без окна.
+ *
+ * @param width Ширина виртуального экрана.
+ * @param height Высота виртуального экрана.
+ */
+
+void SetHeadlessScreenSize(int width, int height) {
+    headlessWidth = width;
+    headlessHeight = height;
+}
+
+/**
+ * @brief Ждет ввод с клавиатуры или изменение размера окна, не рисуя кадров.
+ *
+ * Используется вместо цикла BeginDrawing/EndDrawing, когда изображение не меняется: события
+ * окна опрашиваются с интервалом inputPollInterval, а между опросами поток спит.
+ *
+ * @param timeout Наибольшее время ожидания в секундах.
+ * @return true, если пришел ввод; false, если время истекло.
+ */
+
+bool WaitForInputEvent(double timeout) {
+    double deadline = GetTime() + timeout;
+    while (true) {
+        // Сначала проверяются события последнего опроса (в том числе опроса в EndDrawing)
+        if (GetKeyPressed() != 0 || IsWindowResized()) {
+            return true;
+        }
+        double left = deadline - GetTime();
+        if (left <= 0) {
+            return false;
+        }
+        WaitTime(left < inputPollInterval ? left : inputPollInterval);
+        PollInputEvents();
+    }
+}
+
+/**
+ * @brief Подключает архив ресурсов, собранный invaders_assetpack.
+ *
+ * @param fileName Путь к архиву.
+ * @return false, если архив не найден или поврежден; тогда ресурсы загружаются из файлов.
+ */
+
+bool MountAssetPack(const char *fileName) {
+    return assetPack.Open(fileName);
+}
+
+/**
+ * @brief Ищет ресурс в подключенном архиве.
+ *
+ * @param fileName Путь к файлу ресурса; начальные "../" и "./" не учитываются.
+ * @param type Ожидаемый тип ресурса.
+ * @return Запись каталога или nullptr.
+ */
+
+const AssetEntry *FindGameAsset(const char *fileName, AssetType type) {
+    if (assetPack.EntryCount() == 0) {
+        return nullptr;
+    }
+    while (strncmp(fileName, "../", 3) == 0 || strncmp(fileName, "./", 2) == 0) {
+        fileName += fileName[1] == '.' ? 3 : 2;
+    }
+    const AssetEntry *entry = assetPack.Find(fileName);
+    return entry != nullptr && entry->type == type ? entry : nullptr;
+}
+
+/**
+ * @brief Возвращает данные ресурса подключенного архива.
+ *
+ * @param entry Запись, найденная FindGameAsset.
+ */
+
+const uint8_t *GameAssetData(const AssetEntry &entry) {
+    return assetPack.Data(entry);
+}
+
+/**
+ * @brief Проверяет, что пиксели с размерами и форматом из параметров записи умещаются в size байт.
+ *
+ * Каталог архива проверяется при открытии, а параметры записей нет: без этой проверки архив с
+ * несогласованными параметрами приводил бы к чтению за пределами отображения.
+ *
+ * @param width Ширина изображения.
+ * @param height Высота изображения.
+ * @param format Формат пикселей.
+ * @param size Доступный размер данных.
+ */
+
+static bool PackedPixelsFit(uint32_t width, uint32_t height, uint32_t format, uint64_t size) {
+    // GetPixelDataSize считает в int: до 2^24 пикселей при 128 битах на пиксель переполнения нет
+    if (width == 0 || height == 0 || (uint64_t) width * height > INT_MAX / 128) {
+        return false;
+    }
+    int bytes = GetPixelDataSize((int) width, (int) height, (int) format);
+    return bytes > 0 && (uint64_t) bytes <= size;
+}
+
+/**
+ * @brief Проверяет параметры изображения в архиве.
+ *
+ * @param entry Запись изображения.
+ * @return true, если изображение без мип-уровней и его пиксели умещаются в данных записи.
+ */
+
+static bool PackedImageValid(const AssetEntry &entry) {
+    return entry.params[2] == 1 && PackedPixelsFit(entry.params[0], entry.params[1], entry.params[3], entry.size);
+}
+
+/**
+ * @brief Создает изображение, ссылающееся на пиксели в архиве.
+ */
+
+static Image PackedImage(const AssetEntry &entry) {
+    Image image = {};
+    image.data = (void *) assetPack.Data(entry);
+    image.width = entry.params[0];
+    image.height = entry.params[1];
+    image.mipmaps = entry.params[2];
+    image.format = entry.params[3];
+    return image;
+}
+
+/**
+ * @brief Загружает изображение игры в формате RGBA.
+ *
+ * Изображение из архива ссылается на его данные и не должно изменяться.
+ *
+ * @param fileName Путь к изображению.
+ * @return Изображение с форматом PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 или пустое изображение.
+ */
+
+Image LoadGameImage(const char *fileName) {
+    const AssetEntry *entry = FindGameAsset(fileName, ASSET_IMAGE);
+    if (entry != nullptr && entry->params[3] == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 && PackedImageValid(*entry)) {
+        return PackedImage(*entry);
+    }
+    Image image = LoadImage(fileName);
+    if (image.data != nullptr) {
+        ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    }
+    return image;
+}
+
+/**
+ * @brief Выгружает изображение, загруженное LoadGameImage.
+ *
+ * @param image Изображение для выгрузки.
+ */
+
+void UnloadGameImage(Image image) {
+    if (!assetPack.Contains(image.data)) {
+        UnloadImage(image);
+    }
+}
+
+/**
+ * @brief Загружает шрифт игры.
+ *
+ * Из архива берутся готовые описания символов и атлас, который сразу загружается в видеопамять;
+ * без окна, без подходящего атласа или с параметрами, не согласованными с размером данных, шрифт
+ * загружается из файла.
+ *
+ * @param fileName Путь к файлу шрифта.
+ * @param fontSize Размер шрифта; атлас из архива используется, если он построен для этого размера.
+ * @return Шрифт, который выгружается UnloadFont.
+ */
+
+Font LoadGameFont(const char *fileName, int fontSize) {
+    const AssetEntry *entry = FindGameAsset(fileName, ASSET_FONT);
+    if (entry == nullptr || (int) entry->params[0] != fontSize || !IsWindowReady()) {
+        return LoadFontEx(fileName, fontSize, 0, 0);
+    }
+    uint32_t packedGlyphCount = entry->params[1];
+    size_t atlasOffset = FontAtlasOffset(packedGlyphCount);
+    if (packedGlyphCount > (uint32_t) INT_MAX / sizeof(GlyphInfo) || atlasOffset > entry->size ||
+        !PackedPixelsFit(entry->params[3], entry->params[4], entry->params[5], entry->size - atlasOffset)) {
+        return LoadFontEx(fileName, fontSize, 0, 0);
+    }
+
+    const uint8_t *data = assetPack.Data(*entry);
+    int glyphCount = (int) packedGlyphCount;
+    const PackedGlyph *packedGlyphs = (const PackedGlyph *) data;
+    const PackedRect *packedRects = (const PackedRect *) (data + glyphCount * sizeof(PackedGlyph));
+
+    Font font = {};
+    font.baseSize = fontSize;
+    font.glyphCount = glyphCount;
+    font.glyphPadding = entry->params[2];
+    // Память выделяется функциями raylib, потому что UnloadFont освобождает ее сама
+    font.glyphs = (GlyphInfo *) MemAlloc(glyphCount * sizeof(GlyphInfo));
+    font.recs = (Rectangle *) MemAlloc(glyphCount * sizeof(Rectangle));
+    for (int i = 0; i < glyphCount; ++i) {
+        font.glyphs[i].value = packedGlyphs[i].value;
+        font.glyphs[i].offsetX = packedGlyphs[i].offsetX;
+        font.glyphs[i].offsetY = packedGlyphs[i].offsetY;
+        font.glyphs[i].advanceX = packedGlyphs[i].advanceX;
+        font.recs[i] = {packedRects[i].x, packedRects[i].y, packedRects[i].width, packedRects[i].height};
+    }
+
+    Image atlas = {};
+    atlas.data = (void *) (data + atlasOffset);
+    atlas.width = entry->params[3];
+    atlas.height = entry->params[4];
+    atlas.mipmaps = 1;
+    atlas.format = entry->params[5];
+    font.texture = LoadTextureFromImage(atlas);
+    return font;
+}
+
+/**
+ * @brief Загружает текстуру игры.
+ *
+ * Без окна загружает только изображение, чтобы узнать его размеры; идентификатор текстуры равен 0.
+ * Текстура из архива загружается в видеопамять прямо из отображенных байтов.
+ *
+ * @param fileName Путь к изображению.
+ * @return Загруженная текстура.
+ */
+
+Texture2D LoadGameTexture(const char *fileName) {
+    const AssetEntry *entry = FindGameAsset(fileName, ASSET_IMAGE);
+    if (entry != nullptr && PackedImageValid(*entry)) {
+        Image image = PackedImage(*entry);
+        if (IsWindowReady()) {
+            return LoadTextureFromImage(image);
+        }
+        Texture2D texture = {};
+        texture.width = image.width;
+        texture.height = image.height;
+        texture.mipmaps = image.mipmaps;
+        texture.format = image.format;
+        return texture;
+    }
+
+    if (IsWindowReady()) {
+        return LoadTexture(fileName);
+    }
+
+    Texture2D texture = {};
+    Image image = LoadImage(fileName);
+    texture.width = image.width;
+    texture.height = image.height;
+    texture.mipmaps = image.mipmaps;
+    texture.format = image.format;
+    UnloadImage(image);
+    return texture;
+}
+
+/**
+ * @brief Выгружает текстуру, загруженную LoadGameTexture.
+ *
+ * @param texture Текстура для выгрузки.
+ */
+
+void UnloadGameTexture(Texture2D texture) {
+    if (texture.id != 0) {
+        UnloadTexture(texture);
+    }
+}
+
+/**
+ * @brief Проверяет параметры звука в архиве.
+ *
+ * @param entry Запись звука.
+ * @return true, если формат отсчетов поддерживается и все кадры умещаются в данных записи.
+ */
+
+static bool PackedWaveValid(const AssetEntry &entry) {
+    uint32_t sampleSize = entry.params[2];
+    uint32_t channels = entry.params[3];
+    if ((sampleSize != 8 && sampleSize != 16 && sampleSize != 32) || channels == 0 || channels > 2) {
+        return false;
+    }
+    return (uint64_t) entry.params[0] * channels * sampleSize / 8 <= entry.size;
+}
+
+/**
+ * @brief Загружает звук игры.
+ *
+ * Звук из архива с параметрами, не согласованными с размером данных, загружается из файла.
+ *
+ * @param fileName Путь к звуковому файлу.
+ * @return Загруженный звук или пустой звук, если аудиоустройство не инициализировано.
+ */
+
+Sound LoadGameSound(const char *fileName) {
+    if (!IsAudioDeviceReady()) {
+        return Sound{};
+    }
+    const AssetEntry *entry = FindGameAsset(fileName, ASSET_WAVE);
+    if (entry != nullptr && PackedWaveValid(*entry)) {
+        Wave wave = {};
+        wave.frameCount = entry->params[0];
+        wave.sampleRate = entry->params[1];
+        wave.sampleSize = entry->params[2];
+        wave.channels = entry->params[3];
+        wave.data = (void *) assetPack.Data(*entry);
+        return LoadSoundFromWave(wave);
+    }
+    return LoadSound(fileName);
+}
+
+/**
+ * @brief Выгружает звук, загруженный LoadGameSound.
+ *
+ * @param sound Звук для выгрузки.
+ */
+
+void UnloadGameSound(Sound sound) {
+    if (sound.stream.buffer != nullptr) {
+        UnloadSound(sound);
+    }
+}
+
+/**
+ * @brief Загружает музыкальный поток игры.
+ *
+ * @param fileName Путь к музыкальному файлу.
+ * @return Музыкальный поток или пустой поток, если аудиоустройство не инициализировано.
+ */
+
+Music LoadGameMusic(const char *fileName) {
+    if (!IsAudioDeviceReady()) {
+        return Music{};
+    }
+    // Музыка остается сжатой и декодируется потоком прямо из отображенного архива
+    const AssetEntry *entry = FindGameAsset(fileName, ASSET_MUSIC);
+    if (entry != nullptr) {
+        return LoadMusicStreamFromMemory(GetFileExtension(entry->name), assetPack.Data(*entry), entry->size);
+    }
+    return LoadMusicStream(fileName);
+}
+
+/**
+ * @brief Выгружает музыкальный поток, загруженный LoadGameMusic.
+ *
+ * @param music Музыкальный поток для выгрузки.
+ */
+
+void UnloadGameMusic(Music music) {
+    if (music.stream.buffer != nullptr) {
+        UnloadMusicStream(music);
+    }
+}
@@ -0,0 +1,151 @@
+/**
+ * @file platform.hpp
+ * @brief Заголовочный файл, содержащий функции доступа к окну и ресурсам с поддержкой работы без окна.
+ *
+ * Игровая логика использует эти функции вместо GetScreenWidth, LoadTexture и LoadSound, чтобы
+ * игра могла работать на машинах без дисплея и звуковой карты: размеры экрана берутся из
+ * виртуального экрана, у текстур загружаются только размеры, а звук отключается.
+ *
+ * Если подключен архив ресурсов (MountAssetPack), ресурсы с тем же путем относительно корня
+ * игры создаются из архива, остальные загружаются из файлов.
+ */
+
+#pragma once
+
+#include "assetpack.hpp"
+#include <raylib.h>
+
+/**
+ * @brief Возвращает ширину экрана.
+ *
+ * @return Ширина окна или виртуального экрана, если окно не создано.
+ */
+int ScreenWidth();
+
+/**
+ * @brief Возвращает высоту экрана.
+ *
+ * @return Высота окна или виртуального экрана, если окно не создано.
+ */
+int ScreenHeight();
+
+/**
+ * @brief Задает размеры виртуального экрана для работы без окна.
+ *
+ * @param width Ширина виртуального экрана.
+ * @param height Высота виртуального экрана.
+ */
+void SetHeadlessScreenSize(int width, int height);
+
+/**
+ * @brief Ждет ввод с клавиатуры или изменение размера окна, не рисуя кадров.
+ *
+ * Используется вместо цикла BeginDrawing/EndDrawing, когда изображение не меняется: события
+ * окна опрашиваются с интервалом inputPollInterval, а между опросами поток спит.
+ *
+ * @param timeout Наибольшее время ожидания в секундах.
+ * @return true, если пришел ввод; false, если время истекло.
+ */
+bool WaitForInputEvent(double timeout);
+
+/**
+ * @brief Подключает архив ресурсов, собранный invaders_assetpack.
+ *
+ * @param fileName Путь к архиву.
+ * @return false, если архив не найден или поврежден; тогда ресурсы загружаются из файлов.
+ */
+bool MountAssetPack(const char *fileName);
+
+/**
+ * @brief Ищет ресурс в подключенном архиве.
+ *
+ * @param fileName Путь к файлу ресурса; начальные "../" и "./" не учитываются.
+ * @param type Ожидаемый тип ресурса.
+ * @return Запись каталога или nullptr.
+ */
+const AssetEntry *FindGameAsset(const char *fileName, AssetType type);
+
+/**
+ * @brief Возвращает данные ресурса подключенного архива.
+ *
+ * @param entry Запись, найденная FindGameAsset.
+ */
+const uint8_t *GameAssetData(const AssetEntry &entry);
+
+/**
+ * @brief Загружает изображение игры в формате RGBA.
+ *
+ * Изображение из архива ссылается на его данные и не должно изменяться.
+ *
+ * @param fileName Путь к изображению.
+ * @return Изображение с форматом PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 или пустое изображение.
+ */
+Image LoadGameImage(const char *fileName);
+
+/**
+ * @brief Выгружает изображение, загруженное LoadGameImage.
+ *
+ * @param image Изображение для выгрузки.
+ */
+void UnloadGameImage(Image image);
+
+/**
+ * @brief Загружает шрифт игры.
+ *
+ * Атлас из архива с параметрами, не согласованными с размером данных, не используется.
+ *
+ * @param fileName Путь к файлу шрифта.
+ * @param fontSize Размер шрифта; атлас из архива используется, если он построен для этого размера.
+ * @return Шрифт, который выгружается UnloadFont.
+ */
+Font LoadGameFont(const char *fileName, int fontSize);
+
+/**
+ * @brief Загружает текстуру игры.
+ *
+ * Без окна загружает только изображение, чтобы узнать его размеры; идентификатор текстуры равен 0.
+ * Текстура из архива загружается в видеопамять прямо из отображенных байтов.
+ *
+ * @param fileName Путь к изображению.
+ * @return Загруженная текстура.
+ */
+Texture2D LoadGameTexture(const char *fileName);
+
+/**
+ * @brief Выгружает текстуру, загруженную LoadGameTexture.
+ *
+ * @param texture Текстура для выгрузки.
+ */
+void UnloadGameTexture(Texture2D texture);
+
+/**
+ * @brief Загружает звук игры.
+ *
+ * Звук из архива с параметрами, не согласованными с размером данных, загружается из файла.
+ *
+ * @param fileName Путь к звуковому файлу.
+ * @return Загруженный звук или пустой звук, если аудиоустройство не инициализировано.
+ */
+Sound LoadGameSound(const char *fileName);
+
+/**
+ * @brief Выгружает звук, загруженный LoadGameSound.
+ *
+ * @param sound Звук для выгрузки.
+ */
+void UnloadGameSound(Sound sound);
+
+/**
+ * @brief Загружает музыкальный поток игры.
+ *
+ * @param fileName Путь к музыкальному файлу.
+ * @return Музыкальный поток или пустой поток, если аудиоустройство не инициализировано.
+ */
+Music LoadGameMusic(const char *fileName);
+
+/**
+ * @brief Выгружает музыкальный поток, загруженный LoadGameMusic.
+ *
+ * @param music Музыкальный поток для выгрузки.
+ */
+void UnloadGameMusic(Music music);
@@ -0,0 +1,162 @@
+/**
+ * @file qualitygovernor.cpp
+ * @brief Файл реализации класса QualityGovernor.
+ */
+
+#include "qualitygovernor.hpp"
+#include <algorithm>
+
+/**
+ * @brief Уровни качества от полного до наименьшего.
+ *
+ * Сначала становится меньше частиц, затем слой интерфейса перерисовывается реже, затем
+ * вместо всего слоя интерфейса выводятся только полосы с рамкой и надписями, и наконец
+ * частицы выключаются.
+ */
+
+static const QualityLevel qualityLevels[] = {
+    {1.0f, 1, true},
+    {0.5f, 1, true},
+    {0.5f, 4, true},
+    {0.25f, 8, false},
+    {0.0f, 15, false},
+};
+
+/**
+ * @brief Вес нового значения в сглаженном времени кадра.
+ */
+
+static const double smoothing = 0.1;
+
+/**
+ * @brief Конструктор класса QualityGovernor. Начинает с полного качества.
+ *
+ * @param budget Бюджет времени работы кадра в секундах.
+ */
+
+QualityGovernor::QualityGovernor(double budget) {
+    this->budget = budget;
+    level = 0;
+    frame = 0;
+    average = 0.0;
+    std::fill(phaseAverages, phaseAverages + framePhaseCount, 0.0);
+    overFrames = 0;
+    underFrames = 0;
+    settling = 0;
+}
+
+/**
+ * @brief Учитывает время частей кадра и при необходимости меняет уровень качества.
+ *
+ * Первый кадр задает средние значения целиком, дальше они сглаживаются.
+ *
+ * @param phases Время частей кадра в секундах по индексам FramePhase.
+ * @return true, если уровень изменился (запись добавлена в Changes()).
+ */
+
+bool QualityGovernor::Frame(const double *phases) {
+    double total = 0.0;
+    for (int phase = 0; phase < framePhaseCount; ++phase) {
+        total += phases[phase];
+        phaseAverages[phase] = frame == 0 ? phases[phase] :
+                               phaseAverages[phase] + (phases[phase] - phaseAverages[phase]) * smoothing;
+    }
+    average = frame == 0 ? total : average + (total - average) * smoothing;
+    frame++;
+
+    if (settling > 0) {
+        settling--;
+        return false;
+    }
+    overFrames = average > budget * pressureShare ? overFrames + 1 : 0;
+    underFrames = average < budget * headroomShare ? underFrames + 1 : 0;
+    if (overFrames >= pressureFrames && level < LevelCount() - 1) {
+        ChangeLevel(level + 1);
+        return true;
+    }
+    if (underFrames >= headroomFrames && level > 0) {
+        ChangeLevel(level - 1);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Возвращает текущий уровень качества.
+ */
+
+int QualityGovernor::Level() const {
+    return level;
+}
+
+/**
+ * @brief Возвращает настройки текущего уровня качества.
+ */
+
+const QualityLevel &QualityGovernor::Settings() const {
+    return qualityLevels[level];
+}
+
+/**
+ * @brief Возвращает настройки уровня качества.
+ *
+ * @param level Уровень от 0 до LevelCount() - 1.
+ */
+
+const QualityLevel &QualityGovernor::Settings(int level) {
+    return qualityLevels[std::min(std::max(level, 0), LevelCount() - 1)];
+}
+
+/**
+ * @brief Возвращает количество уровней качества.
+ */
+
+int QualityGovernor::LevelCount() {
+    return sizeof(qualityLevels) / sizeof(qualityLevels[0]);
+}
+
+/**
+ * @brief Возвращает название части кадра для журнала.
+ */
+
+const char *QualityGovernor::PhaseName(int phase) {
+    static const char *names[framePhaseCount] = {"simulation", "scene", "overlay", "present"};
+    return phase >= 0 && phase < framePhaseCount ? names[phase] : "unknown";
+}
+
+/**
+ * @brief Возвращает сглаженное время работы кадра в секундах.
+ */
+
+double QualityGovernor::Average() const {
+    return average;
+}
+
+/**
+ * @brief Возвращает сглаженное время части кадра в секундах.
+ */
+
+double QualityGovernor::PhaseAverage(int phase) const {
+    return phaseAverages[phase];
+}
+
+/**
+ * @brief Возвращает журнал смен уровня качества.
+ */
+
+const std::vector<QualityChange> &QualityGovernor::Changes() const {
+    return changes;
+}
+
+/**
+ * @brief Меняет уровень и записывает смену в журнал.
+ */
+
+void QualityGovernor::ChangeLevel(int level) {
+    int phase = std::max_element(phaseAverages, phaseAverages + framePhaseCount) - phaseAverages;
+    changes.push_back({frame, this->level, level, average, phase});
+    this->level = level;
+    overFrames = 0;
+    underFrames = 0;
+    settling = settleFrames;
+}
@@ -0,0 +1,182 @@
+/**
+ * @file qualitygovernor.hpp
+ * @brief Заголовочный файл, содержащий уровни качества отрисовки и класс QualityGovernor.
+ */
+
+#pragma once
+
+#include <vector>
+
+/**
+ * @enum FramePhase
+ * @brief Части кадра, время которых измеряется.
+ */
+enum FramePhase {
+    PHASE_SIMULATION, ///< Шаги симуляции.
+    PHASE_SCENE,      ///< Отрисовка сцены: слои интерфейса, игровые объекты и частицы.
+    PHASE_OVERLAY,    ///< Надписи поверх сцены и панель измерений.
+    PHASE_PRESENT     ///< Отправка кадра на показ (EndDrawing) без ожидания синхронизации.
+};
+
+/**
+ * @brief Количество частей кадра FramePhase.
+ */
+constexpr int framePhaseCount = 4;
+
+/**
+ * @struct QualityLevel
+ * @brief Настройки необязательной работы кадра на одном уровне качества.
+ */
+struct QualityLevel {
+    float particleDensity; ///< Доля выпускаемых частиц взрывов и обломков.
+    int hudInterval;       ///< Наименьшее количество кадров между перерисовками слоя интерфейса.
+    bool fullBackground;   ///< Выводить слой интерфейса целиком, а не только полосы по краям экрана.
+};
+
+/**
+ * @struct QualityChange
+ * @brief Запись журнала смены уровня качества.
+ */
+struct QualityChange {
+    long long frame; ///< Номер кадра.
+    int from;        ///< Прежний уровень.
+    int to;          ///< Новый уровень.
+    double average;  ///< Сглаженное время работы кадра в секундах.
+    int phase;       ///< Самая долгая часть кадра (FramePhase).
+};
+
+/**
+ * @class QualityGovernor
+ * @brief Регулятор качества отрисовки, удерживающий время работы кадра в бюджете.
+ *
+ * В каждом кадре получает время частей кадра и сглаживает их сумму. Если сглаженное время
+ * несколько кадров подряд выше pressureShare бюджета, уровень качества понижается на ступень;
+ * если несколько секунд подряд ниже headroomShare бюджета, повышается. После смены уровня
+ * регулятор ждет, пока новое время работы кадра попадет в среднее. Уровень 0 - полное качество.
+ *
+ * Регулятор только выбирает настройки необязательной работы; симуляцию он не замедляет.
+ */
+
+class QualityGovernor {
+public:
+    /**
+     * @brief Конструктор класса QualityGovernor. Начинает с полного качества.
+     *
+     * @param budget Бюджет времени работы кадра в секундах.
+     */
+    explicit QualityGovernor(double budget = 1.0 / 60.0);
+
+    /**
+     * @brief Учитывает время частей кадра и при необходимости меняет уровень качества.
+     *
+     * @param phases Время частей кадра в секундах по индексам FramePhase.
+     * @return true, если уровень изменился (запись добавлена в Changes()).
+     */
+    bool Frame(const double *phases);
+
+    /**
+     * @brief Возвращает текущий уровень качества.
+     */
+    int Level() const;
+
+    /**
+     * @brief Возвращает настройки текущего уровня качества.
+     */
+    const QualityLevel &Settings() const;
+
+    /**
+     * @brief Возвращает настройки уровня качества.
+     *
+     * @param level Уровень от 0 до LevelCount() - 1.
+     */
+    static const QualityLevel &Settings(int level);
+
+    /**
+     * @brief Возвращает количество уровней качества.
+     */
+    static int LevelCount();
+
+    /**
+     * @brief Возвращает название части кадра для журнала.
+     */
+    static const char *PhaseName(int phase);
+
+    /**
+     * @brief Возвращает сглаженное время работы кадра в секундах.
+     */
+    double Average() const;
+
+    /**
+     * @brief Возвращает сглаженное время части кадра в секундах.
+     */
+    double PhaseAverage(int phase) const;
+
+    /**
+     * @brief Возвращает журнал смен уровня качества.
+     */
+    const std::vector<QualityChange> &Changes() const;
+
+    /**
+     * @brief Доля бюджета, выше которой кадр считается перегруженным.
+     */
+    constexpr static double pressureShare = 0.9;
+    /**
+     * @brief Доля бюджета, ниже которой у кадра есть запас.
+     */
+    constexpr static double headroomShare = 0.6;
+    /**
+     * @brief Количество перегруженных кадров подряд, после которого качество понижается.
+     */
+    constexpr static int pressureFrames = 8;
+    /**
+     * @brief Количество кадров с запасом подряд, после которого качество повышается.
+     */
+    constexpr static int headroomFrames = 180;
+    /**
+     * @brief Количество кадров после смены уровня, в которые уровень не меняется.
+     */
+    constexpr static int settleFrames = 30;
+
+private:
+    /**
+     * @brief Меняет уровень и записывает смену в журнал.
+     */
+    void ChangeLevel(int level);
+
+    /**
+     * @brief Бюджет времени работы кадра.
+     */
+    double budget;
+    /**
+     * @brief Текущий уровень.
+     */
+    int level;
+    /**
+     * @brief Номер кадра.
+     */
+    long long frame;
+    /**
+     * @brief Сглаженное время работы кадра.
+     */
+    double average;
+    /**
+     * @brief Сглаженное время частей кадра.
+     */
+    double phaseAverages[framePhaseCount];
+    /**
+     * @brief Количество перегруженных кадров подряд.
+     */
+    int overFrames;
+    /**
+     * @brief Количество кадров с запасом подряд.
+     */
+    int underFrames;
+    /**
+     * @brief Количество кадров до конца ожидания после смены уровня.
+     */
+    int settling;
+    /**
+     * @brief Журнал смен уровня.
+     */
+    std::vector<QualityChange> changes;
+};
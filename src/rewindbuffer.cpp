@@ -0,0 +1,282 @@
+/**
+ * @file rewindbuffer.cpp
+ * @brief Файл реализации, содержащий методы класса RewindBuffer и разности снимков.
+ */
+
+#include "rewindbuffer.hpp"
+#include <algorithm>
+
+/**
+ * @brief Наименьший совпадающий участок, который выгоднее записать длиной, чем байтами.
+ */
+
+static const size_t minSameRun = 4;
+
+/**
+ * @brief Дописывает число в формате varint.
+ */
+
+static void PutVarint(std::vector<uint8_t> &out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back((uint8_t) (value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t) value);
+}
+
+/**
+ * @brief Читает число в формате varint.
+ */
+
+static uint64_t GetVarint(const uint8_t *&data) {
+    uint64_t value = 0;
+    for (int shift = 0;; shift += 7) {
+        uint8_t byte = *data++;
+        value |= (uint64_t) (byte & 0x7F) << shift;
+        if (byte < 0x80) {
+            return value;
+        }
+    }
+}
+
+/**
+ * @brief Возвращает байт или 0 за концом байтов.
+ */
+
+static uint8_t ByteAt(const std::vector<uint8_t> &bytes, size_t index) {
+    return index < bytes.size() ? bytes[index] : 0;
+}
+
+/**
+ * @brief Записывает разность двух снимков.
+ *
+ * Формат: размеры from и to, затем пары (длина совпадающего участка, длина различающегося участка)
+ * с XOR байтов различающегося участка. Снимки сравниваются на длине большего, короткий дополняется
+ * нулями, поэтому разность восстанавливает и to из from, и from из to.
+ */
+
+static void EncodeDelta(const std::vector<uint8_t> &from, const std::vector<uint8_t> &to, std::vector<uint8_t> &out) {
+    out.clear();
+    PutVarint(out, from.size());
+    PutVarint(out, to.size());
+    size_t size = std::max(from.size(), to.size());
+    size_t position = 0;
+    while (position < size) {
+        size_t start = position;
+        while (start < size && ByteAt(from, start) == ByteAt(to, start)) {
+            start++;
+        }
+        // Различающийся участок включает короткие совпадения внутри себя
+        size_t end = start;
+        size_t same = 0;
+        while (end + same < size && same < minSameRun) {
+            if (ByteAt(from, end + same) == ByteAt(to, end + same)) {
+                same++;
+            } else {
+                end += same + 1;
+                same = 0;
+            }
+        }
+        PutVarint(out, start - position);
+        PutVarint(out, end - start);
+        for (size_t i = start; i < end; ++i) {
+            out.push_back(ByteAt(from, i) ^ ByteAt(to, i));
+        }
+        position = end;
+    }
+}
+
+/**
+ * @brief Применяет разность к снимку.
+ *
+ * @param delta Разность EncodeDelta(a, b).
+ * @param from Снимок a при forward, иначе b.
+ * @param to Снимок b при forward, иначе a.
+ * @param forward Направление.
+ */
+
+static void ApplyDelta(const std::vector<uint8_t> &delta, const std::vector<uint8_t> &from, std::vector<uint8_t> &to,
+                       bool forward) {
+    const uint8_t *data = delta.data();
+    const uint8_t *end = data + delta.size();
+    size_t fromSize = GetVarint(data);
+    size_t toSize = GetVarint(data);
+    size_t size = std::max(fromSize, toSize);
+    to.resize(size);
+    size_t position = 0;
+    while (data < end) {
+        size_t same = GetVarint(data);
+        size_t changed = GetVarint(data);
+        for (size_t i = 0; i < same; ++i, ++position) {
+            to[position] = ByteAt(from, position);
+        }
+        for (size_t i = 0; i < changed; ++i, ++position) {
+            to[position] = ByteAt(from, position) ^ *data++;
+        }
+    }
+    to.resize(forward ? toSize : fromSize);
+}
+
+/**
+ * @brief Конструктор класса RewindBuffer.
+ *
+ * @param interval Количество тиков между снимками.
+ * @param capacity Количество хранимых снимков; глубина перемотки - (capacity - 1) * interval тиков.
+ * @param players Количество байтов команд в тике.
+ */
+
+RewindBuffer::RewindBuffer(int interval, int capacity, int players) {
+    this->interval = std::max(interval, 1);
+    this->players = std::max(players, 1);
+    // Команды нужны от самого старого снимка до текущего тика
+    deltas.resize(std::max(capacity, 2));
+    inputs.resize((size_t) deltas.size() * this->interval * this->players);
+    Clear();
+}
+
+/**
+ * @brief Запоминает команды тика, сохраняя перед ним снимок, если пора. Вызывается перед шагом.
+ *
+ * @param inputs Команды тика: players байтов.
+ */
+
+void RewindBuffer::Record(const uint8_t *inputs) {
+    if (count == 0 || tick == firstTick + (long long) count * interval) {
+        TakeSnapshot();
+    }
+    size_t ticks = this->inputs.size() / players;
+    std::copy(inputs, inputs + players, this->inputs.begin() + (tick % ticks) * players);
+    tick++;
+}
+
+/**
+ * @brief Возвращает состояние к началу тика.
+ *
+ * Снимок собирается от самого старого или самого нового снимка, смотря что ближе, и затем
+ * продвигается запомненными командами до нужного тика.
+ *
+ * @param tick Тик от OldestTick() до Tick().
+ * @return false, если тик вне буфера или снимок не восстановился.
+ */
+
+bool RewindBuffer::Rewind(long long tick) {
+    if (count == 0 || tick < firstTick || tick > this->tick) {
+        return false;
+    }
+    int index = std::min<long long>((tick - firstTick) / interval, count - 1);
+    int capacity = deltas.size();
+    if (index <= (count - 1) / 2) {
+        work = oldest;
+        for (int i = 1; i <= index; ++i) {
+            ApplyDelta(deltas[(first + i) % capacity], work, scratch, true);
+            work.swap(scratch);
+        }
+    } else {
+        work = newest;
+        for (int i = count - 1; i > index; --i) {
+            ApplyDelta(deltas[(first + i) % capacity], work, scratch, false);
+            work.swap(scratch);
+        }
+    }
+    if (!loadState(work)) {
+        return false;
+    }
+    // Снимки после восстановленного принадлежат отброшенной истории
+    count = index + 1;
+    newest.swap(work);
+
+    long long snapshotTick = firstTick + (long long) index * interval;
+    size_t ticks = inputs.size() / players;
+    for (long long t = snapshotTick; t < tick; ++t) {
+        advance(&inputs[(t % ticks) * players]);
+    }
+    lastResimulated = tick - snapshotTick;
+    this->tick = tick;
+    return true;
+}
+
+/**
+ * @brief Удаляет историю; следующий Record начинает ее с тика 0.
+ */
+
+void RewindBuffer::Clear() {
+    first = 0;
+    count = 0;
+    firstTick = 0;
+    tick = 0;
+    lastResimulated = 0;
+}
+
+/**
+ * @brief Возвращает номер следующего тика.
+ */
+
+long long RewindBuffer::Tick() const {
+    return tick;
+}
+
+/**
+ * @brief Возвращает самый ранний тик, на который возможна перемотка, или Tick(), если буфер пуст.
+ */
+
+long long RewindBuffer::OldestTick() const {
+    return count > 0 ? firstTick : tick;
+}
+
+/**
+ * @brief Возвращает количество хранимых снимков.
+ */
+
+int RewindBuffer::Snapshots() const {
+    return count;
+}
+
+/**
+ * @brief Возвращает память, занятую снимками и командами, в байтах.
+ */
+
+size_t RewindBuffer::Bytes() const {
+    size_t bytes = oldest.capacity() + newest.capacity() + work.capacity() + scratch.capacity() + inputs.size();
+    for (const std::vector<uint8_t> &delta: deltas) {
+        bytes += delta.capacity();
+    }
+    return bytes;
+}
+
+/**
+ * @brief Возвращает количество тиков, заново симулированных последней перемоткой.
+ */
+
+int RewindBuffer::LastResimulated() const {
+    return lastResimulated;
+}
+
+/**
+ * @brief Сохраняет снимок текущего тика, вытесняя самый старый при заполненном буфере.
+ *
+ * Самый старый снимок заменяется следующим, собранным одной разностью, а новый снимок
+ * записывается разностью с прежним самым новым.
+ */
+
+void RewindBuffer::TakeSnapshot() {
+    saveState(scratch);
+    int capacity = deltas.size();
+    if (count == 0) {
+        first = 0;
+        count = 1;
+        firstTick = tick;
+        oldest = scratch;
+        newest.swap(scratch);
+        return;
+    }
+    if (count == capacity) {
+        first = (first + 1) % capacity;
+        count--;
+        firstTick += interval;
+        ApplyDelta(deltas[first], oldest, work, true);
+        oldest.swap(work);
+    }
+    EncodeDelta(newest, scratch, deltas[(first + count) % capacity]);
+    count++;
+    newest.swap(scratch);
+}
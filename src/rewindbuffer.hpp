@@ -0,0 +1,158 @@
+/**
+ * @file rewindbuffer.hpp
+ * @brief Заголовочный файл, содержащий класс RewindBuffer для перемотки игры назад.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * @class RewindBuffer
+ * @brief Кольцевой буфер снимков состояния и команд для перемотки игры на любой недавний тик.
+ *
+ * Каждые interval тиков сохраняется снимок состояния в байтах, между снимками запоминаются
+ * команды тиков. Снимок хранится разностью с предыдущим: XOR байтов, в котором совпадающие
+ * участки заменены длиной. Полностью хранятся только самый старый и самый новый снимки, поэтому
+ * память ограничена capacity разностями, а при вытеснении старого снимка следующий восстанавливается
+ * одной разностью. XOR симметричен, и нужный снимок собирается от ближайшего из двух концов.
+ *
+ * Перемотка восстанавливает ближайший снимок не позже нужного тика и заново симулирует тики до него
+ * с запомненными командами: не больше capacity / 2 разностей и interval - 1 тиков. История после
+ * этого тика отбрасывается, и запись продолжается с него.
+ *
+ * Буфер не знает об игре: состояние сохраняется, восстанавливается и продвигается через функции
+ * обратного вызова (см. RollbackSession).
+ */
+
+class RewindBuffer {
+public:
+    /**
+     * @brief Конструктор класса RewindBuffer.
+     *
+     * @param interval Количество тиков между снимками.
+     * @param capacity Количество хранимых снимков; глубина перемотки - (capacity - 1) * interval тиков.
+     * @param players Количество байтов команд в тике.
+     */
+    RewindBuffer(int interval, int capacity, int players = 1);
+
+    /**
+     * @brief Сохраняет текущее состояние в байты (старое содержимое удаляется).
+     */
+    std::function<void(std::vector<uint8_t> &state)> saveState;
+    /**
+     * @brief Восстанавливает состояние из байтов; false, если байты не подошли.
+     */
+    std::function<bool(const std::vector<uint8_t> &state)> loadState;
+    /**
+     * @brief Продвигает состояние на один тик с командами тика.
+     */
+    std::function<void(const uint8_t *inputs)> advance;
+
+    /**
+     * @brief Запоминает команды тика, сохраняя перед ним снимок, если пора. Вызывается перед шагом.
+     *
+     * @param inputs Команды тика: players байтов.
+     */
+    void Record(const uint8_t *inputs);
+
+    /**
+     * @brief Возвращает состояние к началу тика.
+     *
+     * @param tick Тик от OldestTick() до Tick().
+     * @return false, если тик вне буфера или снимок не восстановился.
+     */
+    bool Rewind(long long tick);
+
+    /**
+     * @brief Удаляет историю; следующий Record начинает ее с тика 0.
+     */
+    void Clear();
+
+    /**
+     * @brief Возвращает номер следующего тика.
+     */
+    long long Tick() const;
+
+    /**
+     * @brief Возвращает самый ранний тик, на который возможна перемотка, или Tick(), если буфер пуст.
+     */
+    long long OldestTick() const;
+
+    /**
+     * @brief Возвращает количество хранимых снимков.
+     */
+    int Snapshots() const;
+
+    /**
+     * @brief Возвращает память, занятую снимками и командами, в байтах.
+     */
+    size_t Bytes() const;
+
+    /**
+     * @brief Возвращает количество тиков, заново симулированных последней перемоткой.
+     */
+    int LastResimulated() const;
+
+private:
+    /**
+     * @brief Сохраняет снимок текущего тика, вытесняя самый старый при заполненном буфере.
+     */
+    void TakeSnapshot();
+
+    /**
+     * @brief Количество тиков между снимками.
+     */
+    int interval;
+    /**
+     * @brief Количество байтов команд в тике.
+     */
+    int players;
+    /**
+     * @brief Разности снимков с предыдущими; у самого старого не используется.
+     */
+    std::vector<std::vector<uint8_t>> deltas;
+    /**
+     * @brief Номер самого старого снимка в deltas.
+     */
+    int first;
+    /**
+     * @brief Количество снимков.
+     */
+    int count;
+    /**
+     * @brief Тик самого старого снимка.
+     */
+    long long firstTick;
+    /**
+     * @brief Байты самого старого снимка.
+     */
+    std::vector<uint8_t> oldest;
+    /**
+     * @brief Байты самого нового снимка.
+     */
+    std::vector<uint8_t> newest;
+    /**
+     * @brief Рабочие байты сборки снимка.
+     */
+    std::vector<uint8_t> work;
+    /**
+     * @brief Рабочие байты сохранения и сборки снимка.
+     */
+    std::vector<uint8_t> scratch;
+    /**
+     * @brief Команды тиков по кругу: players байтов на тик.
+     */
+    std::vector<uint8_t> inputs;
+    /**
+     * @brief Номер следующего тика.
+     */
+    long long tick;
+    /**
+     * @brief Тиков, заново симулированных последней перемоткой.
+     */
+    int lastResimulated;
+};
@@ -0,0 +1,250 @@
+/**
+ * @file rollback.cpp
+ * @brief Файл реализации сессии сетевой игры двух игроков с откатом состояния.
+ */
+
+#include "rollback.hpp"
+#include <algorithm>
+#include <cstring>
+
+/**
+ * @brief Записывает 32-битное число в порядке little-endian.
+ */
+
+static void Put32(uint8_t *out, uint32_t value) {
+    out[0] = value & 0xff;
+    out[1] = (value >> 8) & 0xff;
+    out[2] = (value >> 16) & 0xff;
+    out[3] = (value >> 24) & 0xff;
+}
+
+/**
+ * @brief Читает 32-битное число в порядке little-endian.
+ */
+
+static uint32_t Get32(const uint8_t *data) {
+    return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t) data[3] << 24);
+}
+
+/**
+ * @brief Конструктор класса RollbackSession.
+ *
+ * Команды обоих игроков на первые inputDelay тиков пустые и считаются подтвержденными.
+ *
+ * @param localPlayer Номер локального игрока (0 или 1).
+ * @param inputDelay Задержка локального ввода в тиках.
+ * @param maxPrediction Наибольшее количество тиков, на которое игра может уйти вперед от
+ *                      подтвержденного ввода соперника; дальше AdvanceFrame ждет.
+ */
+
+RollbackSession::RollbackSession(int localPlayer, int inputDelay, int maxPrediction) {
+    this->localPlayer = localPlayer;
+    this->inputDelay = std::max(0, std::min(inputDelay, rollbackWindow / 4));
+    this->maxPrediction = std::max(1, std::min(maxPrediction, rollbackWindow / 4));
+    tick = 0;
+    localLatest = this->inputDelay - 1;
+    remoteConfirmed = this->inputDelay - 1;
+    remoteAcked = this->inputDelay - 1;
+    rollbackTo = 0;
+    lastRollback = 0;
+    remoteHashTick = -1;
+    remoteHash = 0;
+    desyncTick = -1;
+    memset(localInputs, 0, sizeof(localInputs));
+    memset(remoteInputs, 0, sizeof(remoteInputs));
+    memset(usedRemoteInputs, 0, sizeof(usedRemoteInputs));
+    memset(&stats, 0, sizeof(stats));
+}
+
+/**
+ * @brief Возвращает команду соперника для тика: подтвержденную или предсказанную.
+ *
+ * Предсказание - последняя подтвержденная команда: игроки обычно удерживают клавиши несколько тиков.
+ */
+
+uint8_t RollbackSession::RemoteInput(int tick) const {
+    if (tick <= remoteConfirmed) {
+        return remoteInputs[tick % rollbackWindow];
+    }
+    return remoteConfirmed >= 0 ? remoteInputs[remoteConfirmed % rollbackWindow] : 0;
+}
+
+/**
+ * @brief Выполняет тик с известными и предсказанными командами.
+ *
+ * @param tick Номер тика.
+ * @param save true, если перед тиком нужно сохранить снимок.
+ * @param replay true при повторной симуляции после отката.
+ */
+
+void RollbackSession::Simulate(int tick, bool save, bool replay) {
+    int slot = tick % rollbackWindow;
+    if (save) {
+        saveState(slot);
+    }
+    uint8_t inputs[2];
+    inputs[localPlayer] = localInputs[slot];
+    inputs[1 - localPlayer] = usedRemoteInputs[slot] = RemoteInput(tick);
+    if (replay && resimulate) {
+        resimulate(inputs);
+    } else {
+        advance(inputs);
+    }
+}
+
+/**
+ * @brief Выполняет кадр: исправляет предсказания при необходимости и продвигает игру на тик.
+ *
+ * @param localInput Команды локального игрока; применяются через inputDelay тиков.
+ * @return false, если игра ждет ввод соперника и тик не выполнен.
+ */
+
+bool RollbackSession::AdvanceFrame(uint8_t localInput) {
+    stats.frames++;
+
+    // Откат к первому неверно предсказанному тику и повторная симуляция до текущего
+    lastRollback = 0;
+    if (rollbackTo < tick) {
+        loadState(rollbackTo % rollbackWindow);
+        for (int t = rollbackTo; t < tick; ++t) {
+            Simulate(t, t != rollbackTo, true);
+        }
+        lastRollback = tick - rollbackTo;
+        stats.rollbacks++;
+        stats.resimulatedTicks += lastRollback;
+        stats.maxRollback = std::max(stats.maxRollback, lastRollback);
+    }
+    rollbackTo = tick;
+
+    // Сверка контрольной суммы соперника, когда у нас есть снимок на тот же тик с подтвержденным вводом
+    if (remoteHashTick >= 0 && remoteHashTick <= std::min(remoteConfirmed + 1, tick - 1)) {
+        if (remoteHashTick > tick - rollbackWindow) {
+            stats.checkedHashes++;
+            if (hashState(remoteHashTick % rollbackWindow) != remoteHash && desyncTick < 0) {
+                desyncTick = remoteHashTick;
+            }
+        }
+        remoteHashTick = -1;
+    }
+
+    if (tick - remoteConfirmed > maxPrediction) {
+        stats.stalledFrames++;
+        return false;
+    }
+    localLatest = tick + inputDelay;
+    localInputs[localLatest % rollbackWindow] = localInput;
+    Simulate(tick, true, false);
+    tick++;
+    rollbackTo = tick;
+    return true;
+}
+
+/**
+ * @brief Записывает пакет для соперника: неподтвержденные команды, подтверждение и контрольную сумму.
+ *
+ * Команды повторяются в каждом пакете, пока соперник их не подтвердит, поэтому потеря
+ * отдельных пакетов не требует повторной отправки.
+ *
+ * @param out Буфер размером не меньше rollbackMaxPacket.
+ * @return Размер пакета.
+ */
+
+size_t RollbackSession::WritePacket(uint8_t *out) {
+    int first = std::max(remoteAcked + 1, localLatest - rollbackWindow + 1);
+    int count = std::max(0, localLatest - first + 1);
+
+    // Контрольная сумма последнего снимка, все команды до которого подтверждены
+    int hashTick = std::min(remoteConfirmed + 1, tick - 1);
+    uint64_t hash = hashTick >= 0 ? hashState(hashTick % rollbackWindow) : 0;
+
+    out[0] = ROLLBACK_INPUT;
+    out[1] = inputDelay;
+    Put32(out + 2, first);
+    out[6] = count;
+    Put32(out + 7, remoteConfirmed + 1);
+    Put32(out + 11, (uint32_t) hashTick);
+    Put32(out + 15, (uint32_t) hash);
+    Put32(out + 19, (uint32_t) (hash >> 32));
+    for (int i = 0; i < count; ++i) {
+        out[rollbackHeaderSize + i] = localInputs[(first + i) % rollbackWindow];
+    }
+    return rollbackHeaderSize + count;
+}
+
+/**
+ * @brief Принимает пакет соперника.
+ *
+ * Команды подтверждаются только подряд; если подтвержденная команда отличается от той,
+ * с которой тик уже был симулирован, следующий AdvanceFrame откатит игру к этому тику.
+ *
+ * @param data Пакет.
+ * @param size Размер пакета.
+ * @return false, если пакет поврежден или задержка ввода соперника отличается.
+ */
+
+bool RollbackSession::ReadPacket(const uint8_t *data, size_t size) {
+    if (size < rollbackHeaderSize || data[0] != ROLLBACK_INPUT || data[1] != inputDelay ||
+        size != rollbackHeaderSize + data[6] || data[6] > rollbackWindow) {
+        return false;
+    }
+    int first = (int) Get32(data + 2);
+    int count = data[6];
+    int acked = (int) Get32(data + 7) - 1;
+    int hashTick = (int) Get32(data + 11);
+    uint64_t hash = Get32(data + 15) | ((uint64_t) Get32(data + 19) << 32);
+
+    remoteAcked = std::max(remoteAcked, std::min(acked, localLatest));
+    for (int i = 0; i < count; ++i) {
+        int t = first + i;
+        if (t != remoteConfirmed + 1) {
+            continue;
+        }
+        // Команды дальше окна затерли бы еще не пройденные тики
+        if (t - tick >= rollbackWindow - maxPrediction - 1) {
+            break;
+        }
+        uint8_t input = data[rollbackHeaderSize + i];
+        remoteInputs[t % rollbackWindow] = input;
+        remoteConfirmed = t;
+        if (t < tick && usedRemoteInputs[t % rollbackWindow] != input) {
+            rollbackTo = std::min(rollbackTo, t);
+        }
+    }
+    if (hashTick >= 0) {
+        remoteHashTick = hashTick;
+        remoteHash = hash;
+    }
+    return true;
+}
+
+/**
+ * @brief Возвращает номер следующего тика симуляции.
+ */
+
+int RollbackSession::Tick() const {
+    return tick;
+}
+
+/**
+ * @brief Возвращает количество тиков, на которое симуляция опережает подтвержденный ввод соперника.
+ */
+
+int RollbackSession::PredictedTicks() const {
+    return std::max(0, tick - remoteConfirmed - 1);
+}
+
+/**
+ * @brief Возвращает количество тиков, повторенных в последнем кадре.
+ */
+
+int RollbackSession::LastRollback() const {
+    return lastRollback;
+}
+
+/**
+ * @brief Возвращает тик первого расхождения контрольных сумм или -1.
+ */
+
+int RollbackSession::DesyncTick() const {
+    return desyncTick;
+}
@@ -0,0 +1,251 @@
+/**
+ * @file rollback.hpp
+ * @brief Заголовочный файл, содержащий сессию сетевой игры двух игроков с откатом состояния.
+ *
+ * Каждый игрок сразу применяет свой ввод, а ввод соперника предсказывает повтором последней
+ * подтвержденной команды. Когда приходит настоящий ввод, отличающийся от предсказанного,
+ * сессия восстанавливает снимок состояния на начало этого тика и заново симулирует тики до
+ * текущего в пределах одного кадра. Поэтому задержка ввода равна задержке inputDelay тиков,
+ * а не времени прохождения пакета туда и обратно.
+ *
+ * Сессия не знает ни об игре, ни о сети: состояние сохраняется, восстанавливается и продвигается
+ * через функции обратного вызова, а пакеты передаются вызывающим кодом (см. UdpLink).
+ *
+ * Пакет (little-endian):
+ *   0  u8  тип ROLLBACK_INPUT
+ *   1  u8  задержка ввода отправителя
+ *   2  u32 тик первой команды
+ *   6  u8  количество команд
+ *   7  u32 последний подтвержденный тик ввода получателя + 1 (подтверждение)
+ *   11 u32 тик контрольной суммы
+ *   15 u64 контрольная сумма состояния на начало этого тика
+ *   23 команды по одному байту
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/**
+ * @brief Количество тиков в кольцевых буферах ввода и снимков.
+ */
+constexpr int rollbackWindow = 64;
+
+/**
+ * @brief Размер заголовка пакета сессии.
+ */
+constexpr size_t rollbackHeaderSize = 23;
+
+/**
+ * @brief Наибольший размер пакета сессии.
+ */
+constexpr size_t rollbackMaxPacket = rollbackHeaderSize + rollbackWindow;
+
+/**
+ * @brief Тип пакета с командами игрока.
+ */
+constexpr uint8_t ROLLBACK_INPUT = 1;
+
+/**
+ * @struct RollbackStats
+ * @brief Счетчики сессии с откатом.
+ */
+struct RollbackStats {
+    /**
+     * @brief Количество вызовов AdvanceFrame.
+     */
+    long long frames;
+    /**
+     * @brief Количество кадров, в которых игра ждала ввод соперника.
+     */
+    long long stalledFrames;
+    /**
+     * @brief Количество откатов.
+     */
+    long long rollbacks;
+    /**
+     * @brief Количество повторно симулированных тиков.
+     */
+    long long resimulatedTicks;
+    /**
+     * @brief Наибольшее количество тиков, повторенных за один кадр.
+     */
+    int maxRollback;
+    /**
+     * @brief Количество сверенных контрольных сумм.
+     */
+    long long checkedHashes;
+};
+
+/**
+ * @class RollbackSession
+ * @brief Сессия сетевой игры двух игроков с предсказанием ввода соперника и откатом.
+ *
+ * Порядок вызовов в кадре: ReadPacket для всех полученных пакетов, AdvanceFrame, WritePacket.
+ * Оба игрока должны использовать одинаковую задержку ввода.
+ */
+class RollbackSession {
+public:
+    /**
+     * @brief Конструктор класса RollbackSession.
+     *
+     * @param localPlayer Номер локального игрока (0 или 1).
+     * @param inputDelay Задержка локального ввода в тиках.
+     * @param maxPrediction Наибольшее количество тиков, на которое игра может уйти вперед от
+     *                      подтвержденного ввода соперника; дальше AdvanceFrame ждет.
+     */
+    RollbackSession(int localPlayer, int inputDelay, int maxPrediction = 8);
+
+    /**
+     * @brief Сохраняет текущее состояние игры в снимок с заданным номером (0..rollbackWindow-1).
+     */
+    std::function<void(int slot)> saveState;
+    /**
+     * @brief Восстанавливает состояние игры из снимка.
+     */
+    std::function<void(int slot)> loadState;
+    /**
+     * @brief Продвигает игру на один тик с командами обоих игроков.
+     */
+    std::function<void(const uint8_t *inputs)> advance;
+    /**
+     * @brief Продвигает игру на один тик при повторной симуляции после отката; если не задана,
+     *        вызывается advance.
+     *
+     * Эти тики уже были показаны с предсказанными командами, поэтому здесь игра не должна
+     * повторять звуки и эффекты.
+     */
+    std::function<void(const uint8_t *inputs)> resimulate;
+    /**
+     * @brief Возвращает контрольную сумму снимка.
+     */
+    std::function<uint64_t(int slot)> hashState;
+
+    /**
+     * @brief Выполняет кадр: исправляет предсказания при необходимости и продвигает игру на тик.
+     *
+     * @param localInput Команды локального игрока; применяются через inputDelay тиков.
+     * @return false, если игра ждет ввод соперника и тик не выполнен.
+     */
+    bool AdvanceFrame(uint8_t localInput);
+
+    /**
+     * @brief Записывает пакет для соперника: неподтвержденные команды, подтверждение и контрольную сумму.
+     *
+     * @param out Буфер размером не меньше rollbackMaxPacket.
+     * @return Размер пакета.
+     */
+    size_t WritePacket(uint8_t *out);
+
+    /**
+     * @brief Принимает пакет соперника.
+     *
+     * @param data Пакет.
+     * @param size Размер пакета.
+     * @return false, если пакет поврежден или задержка ввода соперника отличается.
+     */
+    bool ReadPacket(const uint8_t *data, size_t size);
+
+    /**
+     * @brief Возвращает номер следующего тика симуляции.
+     */
+    int Tick() const;
+
+    /**
+     * @brief Возвращает количество тиков, на которое симуляция опережает подтвержденный ввод соперника.
+     */
+    int PredictedTicks() const;
+
+    /**
+     * @brief Возвращает количество тиков, повторенных в последнем кадре.
+     */
+    int LastRollback() const;
+
+    /**
+     * @brief Возвращает тик первого расхождения контрольных сумм или -1.
+     */
+    int DesyncTick() const;
+
+    /**
+     * @brief Счетчики сессии.
+     */
+    RollbackStats stats;
+
+private:
+    /**
+     * @brief Выполняет тик с известными и предсказанными командами.
+     *
+     * @param tick Номер тика.
+     * @param save true, если перед тиком нужно сохранить снимок.
+     * @param replay true при повторной симуляции после отката.
+     */
+    void Simulate(int tick, bool save, bool replay);
+
+    /**
+     * @brief Возвращает команду соперника для тика: подтвержденную или предсказанную.
+     */
+    uint8_t RemoteInput(int tick) const;
+
+    /**
+     * @brief Номер локального игрока.
+     */
+    int localPlayer;
+    /**
+     * @brief Задержка локального ввода в тиках.
+     */
+    int inputDelay;
+    /**
+     * @brief Наибольшее опережение подтвержденного ввода соперника.
+     */
+    int maxPrediction;
+    /**
+     * @brief Номер следующего тика симуляции.
+     */
+    int tick;
+    /**
+     * @brief Последний тик, для которого известна локальная команда.
+     */
+    int localLatest;
+    /**
+     * @brief Последний тик, до которого включительно получены все команды соперника.
+     */
+    int remoteConfirmed;
+    /**
+     * @brief Последний тик локальных команд, подтвержденный соперником.
+     */
+    int remoteAcked;
+    /**
+     * @brief Самый ранний тик, симулированный с неверным предсказанием, или tick.
+     */
+    int rollbackTo;
+    /**
+     * @brief Количество тиков, повторенных в последнем кадре.
+     */
+    int lastRollback;
+    /**
+     * @brief Тик контрольной суммы соперника, ожидающей сверки, или -1.
+     */
+    int remoteHashTick;
+    /**
+     * @brief Контрольная сумма соперника, ожидающая сверки.
+     */
+    uint64_t remoteHash;
+    /**
+     * @brief Тик первого расхождения или -1.
+     */
+    int desyncTick;
+    /**
+     * @brief Локальные команды по тикам.
+     */
+    uint8_t localInputs[rollbackWindow];
+    /**
+     * @brief Подтвержденные команды соперника по тикам.
+     */
+    uint8_t remoteInputs[rollbackWindow];
+    /**
+     * @brief Команды соперника, с которыми тики были симулированы.
+     */
+    uint8_t usedRemoteInputs[rollbackWindow];
+};
@@ -0,0 +1,198 @@
+/**
+ * @file scenerenderer.cpp
+ * @brief Файл реализации класса SceneRenderer.
+ */
+
+#include "scenerenderer.hpp"
+#include "hud.hpp"
+#include <algorithm>
+
+/**
+ * @brief Конструктор класса SceneRenderer. Создает слои и рисует статический слой.
+ *
+ * @param font Шрифт интерфейса.
+ * @param livesImage Изображение корабля для отображения жизней.
+ * @param background Цвет фона.
+ */
+
+SceneRenderer::SceneRenderer(Font font, Texture2D livesImage, Color background) {
+    this->font = font;
+    this->livesImage = livesImage;
+    this->background = background;
+    stats = {};
+    hudKey = {};
+    hudValid = false;
+    frameValid = false;
+    hudInterval = 1;
+    framesSinceHud = 0;
+    fullBackground = true;
+
+    int width = GetScreenWidth();
+    int height = GetScreenHeight();
+    staticLayer = LoadRenderTexture(width, height);
+    hudLayer = LoadRenderTexture(width, height);
+    frameLayer = LoadRenderTexture(width, height);
+
+    BeginTextureMode(staticLayer);
+    ClearBackground(background);
+    DrawHudFrame(font);
+    EndTextureMode();
+}
+
+/**
+ * @brief Деструктор класса SceneRenderer. Освобождает слои.
+ */
+
+SceneRenderer::~SceneRenderer() {
+    UnloadRenderTexture(staticLayer);
+    UnloadRenderTexture(hudLayer);
+    UnloadRenderTexture(frameLayer);
+}
+
+/**
+ * @brief Рисует кадр. Вызывается между BeginDrawing и EndDrawing.
+ *
+ * Во время игры кадр собирается из слоя интерфейса и игровых объектов. Оконченная или
+ * приостановленная игра не меняется между кадрами, поэтому ее сцена рисуется в текстуру кадра
+ * один раз. Во время игры измененный слой интерфейса перерисовывается не раньше, чем через
+ * hudInterval кадров после прошлой перерисовки.
+ *
+ * @param game Игра, состояние которой нужно нарисовать.
+ * @param paused true, если игра приостановлена и ее состояние не меняется.
+ */
+
+void SceneRenderer::Draw(Game &game, bool paused) {
+    stats.frames++;
+    framesSinceHud++;
+    bool playing = game.run && !paused;
+    if (!HudMatches(game) && (!playing || !hudValid || framesSinceHud >= hudInterval)) {
+        RedrawHud(game);
+    }
+
+    if (playing) {
+        frameValid = false;
+        ClearBackground(background);
+        if (fullBackground) {
+            DrawLayer(hudLayer);
+        } else {
+            DrawHudBorders();
+        }
+        game.Draw();
+        return;
+    }
+
+    if (!frameValid) {
+        BeginTextureMode(frameLayer);
+        ClearBackground(background);
+        DrawLayer(hudLayer);
+        game.Draw();
+        EndTextureMode();
+        frameValid = true;
+    } else {
+        stats.cachedFrames++;
+    }
+    ClearBackground(background);
+    DrawLayer(frameLayer);
+}
+
+/**
+ * @brief Сбрасывает кэш слоя интерфейса и кадра.
+ *
+ * Нужен, если состояние остановленной игры изменилось без изменения счета и жизней
+ * (например, после загрузки сохраненного состояния).
+ */
+
+void SceneRenderer::Invalidate() {
+    hudValid = false;
+    frameValid = false;
+}
+
+/**
+ * @brief Задает наименьшее количество кадров между перерисовками слоя интерфейса во время игры.
+ *
+ * @param frames Количество кадров; 1 - перерисовка в кадре изменения.
+ */
+
+void SceneRenderer::SetHudInterval(int frames) {
+    hudInterval = std::max(frames, 1);
+}
+
+/**
+ * @brief Выбирает, выводить ли во время игры слой интерфейса целиком или только полосы по краям.
+ */
+
+void SceneRenderer::SetFullBackground(bool fullBackground) {
+    this->fullBackground = fullBackground;
+}
+
+/**
+ * @brief Проверяет, совпадают ли значения интерфейса игры с нарисованными в слое.
+ */
+
+bool SceneRenderer::HudMatches(const Game &game) const {
+    return hudValid && hudKey.run == game.run && hudKey.lives == game.lives && hudKey.score == game.score &&
+           hudKey.highscore == game.highscore && hudKey.level == game.level;
+}
+
+/**
+ * @brief Перерисовывает слой интерфейса.
+ *
+ * Слой копируется из статического слоя, поэтому рамка и подписи заново не рисуются.
+ */
+
+void SceneRenderer::RedrawHud(Game &game) {
+    BeginTextureMode(hudLayer);
+    ClearBackground(background);
+    DrawLayer(staticLayer);
+    DrawHudValues(game, font, livesImage);
+    EndTextureMode();
+    hudKey = {game.run, game.lives, game.score, game.highscore, game.level};
+    hudValid = true;
+    frameValid = false;
+    framesSinceHud = 0;
+    stats.hudRedraws++;
+}
+
+/**
+ * @brief Выводит слой в текущую цель отрисовки.
+ *
+ * Текстуры отрисовки OpenGL хранятся перевернутыми, поэтому источник берется с отрицательной высотой.
+ * Края текста в слоях полупрозрачны, поэтому перед выводом слоя цель очищается цветом фона.
+ */
+
+void SceneRenderer::DrawLayer(const RenderTexture2D &layer) {
+    Rectangle source = {0, 0, (float) layer.texture.width, (float) -layer.texture.height};
+    DrawTextureRec(layer.texture, source, {0, 0}, WHITE);
+}
+
+/**
+ * @brief Выводит часть слоя в то же место текущей цели отрисовки.
+ *
+ * @param layer Слой.
+ * @param area Область экрана.
+ */
+
+void SceneRenderer::DrawLayerPart(const RenderTexture2D &layer, Rectangle area) {
+    // Строки перевернутой текстуры отсчитываются снизу
+    Rectangle source = {area.x, layer.texture.height - area.y - area.height, area.width, -area.height};
+    DrawTextureRec(layer.texture, source, {area.x, area.y}, WHITE);
+}
+
+/**
+ * @brief Выводит из слоя интерфейса полосы по краям экрана с рамкой и надписями.
+ *
+ * Верхняя полоса содержит счет и рекорд, нижняя - линию, жизни и уровень, боковые - стороны
+ * рамки. Между полосами в слое только цвет фона, которым цель уже очищена.
+ */
+
+void SceneRenderer::DrawHudBorders() const {
+    float width = (float) hudLayer.texture.width;
+    float height = (float) hudLayer.texture.height;
+    float top = 90;
+    float bottom = 715;
+    float side = 30;
+    DrawLayerPart(hudLayer, {0, 0, width, top});
+    DrawLayerPart(hudLayer, {0, bottom, width, height - bottom});
+    DrawLayerPart(hudLayer, {0, top, side, bottom - top});
+    DrawLayerPart(hudLayer, {width - side, top, side, bottom - top});
+}
@@ -0,0 +1,185 @@
+/**
+ * @file scenerenderer.hpp
+ * @brief Заголовочный файл, содержащий класс SceneRenderer.
+ */
+
+#pragma once
+
+#include "game.hpp"
+#include <raylib.h>
+
+/**
+ * @struct SceneRendererStats
+ * @brief Счетчики отрисовки сцены.
+ */
+struct SceneRendererStats {
+    /**
+     * @brief Количество нарисованных кадров.
+     */
+    long long frames;
+    /**
+     * @brief Количество кадров, показанных из кэша без отрисовки сцены.
+     */
+    long long cachedFrames;
+    /**
+     * @brief Количество перерисовок слоя интерфейса.
+     */
+    long long hudRedraws;
+};
+
+/**
+ * @class SceneRenderer
+ * @brief Отрисовка сцены игры в окне с кэшированием неизменных слоев.
+ *
+ * Фон, рамка, линия и подписи рисуются один раз в статический слой. Слой интерфейса (статический
+ * слой вместе с уровнем, жизнями, счетом и рекордом) перерисовывается только при изменении этих
+ * значений. Во время игры в каждом кадре поверх слоя интерфейса рисуются только игровые объекты.
+ * Когда игра окончена или приостановлена, сцена рисуется один раз в текстуру кадра, и дальше
+ * показывается только эта текстура, пока состояние не изменится.
+ *
+ * Для снижения нагрузки во время игры слой интерфейса можно перерисовывать не чаще заданного
+ * интервала (SetHudInterval) и выводить из него только полосы по краям экрана, где лежат рамка
+ * и надписи (SetFullBackground); середина экрана тогда только очищается цветом фона.
+ *
+ * Слои - текстуры в видеопамяти (RenderTexture2D), поэтому объект создается после InitWindow
+ * и уничтожается до CloseWindow.
+ */
+
+class SceneRenderer {
+public:
+    /**
+     * @brief Конструктор класса SceneRenderer. Создает слои и рисует статический слой.
+     *
+     * @param font Шрифт интерфейса.
+     * @param livesImage Изображение корабля для отображения жизней.
+     * @param background Цвет фона.
+     */
+    SceneRenderer(Font font, Texture2D livesImage, Color background);
+
+    /**
+     * @brief Деструктор класса SceneRenderer. Освобождает слои.
+     */
+    ~SceneRenderer();
+
+    SceneRenderer(const SceneRenderer &) = delete;
+    SceneRenderer &operator=(const SceneRenderer &) = delete;
+
+    /**
+     * @brief Рисует кадр. Вызывается между BeginDrawing и EndDrawing.
+     *
+     * @param game Игра, состояние которой нужно нарисовать.
+     * @param paused true, если игра приостановлена и ее состояние не меняется.
+     */
+    void Draw(Game &game, bool paused = false);
+
+    /**
+     * @brief Сбрасывает кэш слоя интерфейса и кадра.
+     *
+     * Нужен, если состояние остановленной игры изменилось без изменения счета и жизней
+     * (например, после загрузки сохраненного состояния).
+     */
+    void Invalidate();
+
+    /**
+     * @brief Задает наименьшее количество кадров между перерисовками слоя интерфейса во время игры.
+     *
+     * @param frames Количество кадров; 1 - перерисовка в кадре изменения.
+     */
+    void SetHudInterval(int frames);
+
+    /**
+     * @brief Выбирает, выводить ли во время игры слой интерфейса целиком или только полосы по краям.
+     */
+    void SetFullBackground(bool fullBackground);
+
+    /**
+     * @brief Счетчики отрисовки.
+     */
+    SceneRendererStats stats;
+
+private:
+    /**
+     * @brief Значения интерфейса, от которых зависит слой интерфейса.
+     */
+    struct HudKey {
+        bool run;      ///< Флаг Game::run.
+        int lives;     ///< Количество жизней.
+        int score;     ///< Счет.
+        int highscore; ///< Рекорд.
+        int level;     ///< Номер уровня.
+    };
+
+    /**
+     * @brief Проверяет, совпадают ли значения интерфейса игры с нарисованными в слое.
+     */
+    bool HudMatches(const Game &game) const;
+
+    /**
+     * @brief Перерисовывает слой интерфейса.
+     */
+    void RedrawHud(Game &game);
+
+    /**
+     * @brief Выводит слой в текущую цель отрисовки.
+     */
+    static void DrawLayer(const RenderTexture2D &layer);
+
+    /**
+     * @brief Выводит часть слоя в то же место текущей цели отрисовки.
+     */
+    static void DrawLayerPart(const RenderTexture2D &layer, Rectangle area);
+
+    /**
+     * @brief Выводит из слоя интерфейса полосы по краям экрана с рамкой и надписями.
+     */
+    void DrawHudBorders() const;
+
+    /**
+     * @brief Шрифт интерфейса.
+     */
+    Font font;
+    /**
+     * @brief Изображение корабля для отображения жизней.
+     */
+    Texture2D livesImage;
+    /**
+     * @brief Цвет фона.
+     */
+    Color background;
+    /**
+     * @brief Фон, рамка, линия и подписи.
+     */
+    RenderTexture2D staticLayer;
+    /**
+     * @brief Статический слой вместе с уровнем, жизнями, счетом и рекордом.
+     */
+    RenderTexture2D hudLayer;
+    /**
+     * @brief Последний кадр остановленной игры.
+     */
+    RenderTexture2D frameLayer;
+    /**
+     * @brief Значения, нарисованные в слое интерфейса.
+     */
+    HudKey hudKey;
+    /**
+     * @brief Флаг актуальности слоя интерфейса.
+     */
+    bool hudValid;
+    /**
+     * @brief Флаг актуальности кадра остановленной игры.
+     */
+    bool frameValid;
+    /**
+     * @brief Наименьшее количество кадров между перерисовками слоя интерфейса во время игры.
+     */
+    int hudInterval;
+    /**
+     * @brief Количество кадров с последней перерисовки слоя интерфейса.
+     */
+    int framesSinceHud;
+    /**
+     * @brief Флаг вывода слоя интерфейса целиком.
+     */
+    bool fullBackground;
+};
@@ -0,0 +1,293 @@
+/**
+ * @file sessionloadgen.cpp
+ * @brief Генератор нагрузки для сервера игровых сессий.
+ *
+ * Запуск: invaders_session_loadgen [--unix PATH | --port PORT] [--sessions 1000] [--seconds 10]
+ *
+ * Открывает заданное количество сессий, отправляет случайный ввод и измеряет интервалы между
+ * кадрами состояния каждой сессии. В конце печатает достигнутую частоту тиков, дрожание
+ * интервалов (отклонение от периода сервера) и количество сессий на поток сервера.
+ */
+
+#include "sessionprotocol.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <random>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @brief Количество корзин гистограммы дрожания (по 10 мкс).
+ */
+static constexpr int jitterBuckets = 1000;
+
+/**
+ * @struct ClientSession
+ * @brief Сессия на стороне генератора нагрузки.
+ */
+struct ClientSession {
+    /**
+     * @brief Сокет.
+     */
+    int fd;
+    /**
+     * @brief Последнее полученное состояние.
+     */
+    SessionState state;
+    /**
+     * @brief Момент получения предыдущего кадра состояния в наносекундах или 0.
+     */
+    long long lastFrameNs;
+    /**
+     * @brief Количество полученных кадров состояния.
+     */
+    long long frames;
+    /**
+     * @brief Количество байт в буфере.
+     */
+    size_t size;
+    /**
+     * @brief Буфер приема.
+     */
+    uint8_t buffer[4096];
+};
+
+/**
+ * @brief Возвращает текущее время CLOCK_MONOTONIC в наносекундах.
+ */
+
+static long long NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Подключается к серверу.
+ *
+ * @param unixPath Путь Unix-сокета или nullptr.
+ * @param port Порт TCP на адресе 127.0.0.1.
+ * @return Дескриптор сокета или -1.
+ */
+
+static int Connect(const char *unixPath, int port) {
+    int fd;
+    if (unixPath != nullptr) {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, unixPath, sizeof(address.sun_path) - 1);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0 || connect(fd, (sockaddr *) &address, sizeof(address)) != 0) {
+            return -1;
+        }
+    } else {
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0 || connect(fd, (sockaddr *) &address, sizeof(address)) != 0) {
+            return -1;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    if (fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0) {
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Разбирает полученные кадры сессии.
+ *
+ * @param session Сессия.
+ * @param now Момент получения в наносекундах.
+ * @param periodNs Период тиков сервера или 0, пока не получено приветствие.
+ * @param shards Количество потоков сервера из приветствия.
+ * @param histogram Гистограмма дрожания.
+ * @return false, если поток данных поврежден.
+ */
+
+static bool ParseFrames(ClientSession &session, long long now, long long &periodNs, int &shards,
+                        std::vector<long long> &histogram) {
+    size_t offset = 0;
+    while (offset + 2 <= session.size) {
+        size_t length = session.buffer[offset] | (session.buffer[offset + 1] << 8);
+        if (length == 0 || length > sizeof(session.buffer) - 2) {
+            return false;
+        }
+        if (offset + 2 + length > session.size) {
+            break;
+        }
+        const uint8_t *frame = session.buffer + offset + 2;
+        if (frame[0] == SESSION_HELLO && length >= sessionHelloFrame - 2) {
+            int rate = frame[2] | (frame[3] << 8);
+            shards = frame[6] | (frame[7] << 8);
+            periodNs = rate > 0 ? 1000000000LL / rate : 0;
+        } else if (frame[0] == SESSION_STATE) {
+            if (!DecodeStateDelta(session.state, frame + 1, length - 1)) {
+                return false;
+            }
+            if (session.lastFrameNs != 0 && periodNs != 0) {
+                long long deviation = llabs(now - session.lastFrameNs - periodNs) / 10000;
+                histogram[deviation < jitterBuckets ? deviation : jitterBuckets - 1]++;
+            }
+            session.lastFrameNs = now;
+            session.frames++;
+        }
+        offset += 2 + length;
+    }
+    memmove(session.buffer, session.buffer + offset, session.size - offset);
+    session.size -= offset;
+    return true;
+}
+
+/**
+ * @brief Возвращает значение процентиля гистограммы дрожания в микросекундах.
+ *
+ * @param histogram Гистограмма.
+ * @param total Количество измерений.
+ * @param fraction Доля измерений (0..1).
+ */
+
+static int Percentile(const std::vector<long long> &histogram, long long total, double fraction) {
+    long long target = std::min(total - 1, (long long) (total * fraction));
+    long long seen = 0;
+    for (int i = 0; i < jitterBuckets; ++i) {
+        seen += histogram[i];
+        if (seen > target) {
+            return i * 10;
+        }
+    }
+    return jitterBuckets * 10;
+}
+
+/**
+ * @brief Главная функция генератора нагрузки.
+ *
+ * @param argc Количество аргументов командной строки.
+ * @param argv Аргументы командной строки.
+ * @return 0 при успешном измерении, 1 при ошибке.
+ */
+
+int main(int argc, char **argv) {
+    const char *unixPath = nullptr;
+    int port = 7777;
+    int count = 1000;
+    int seconds = 10;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--unix") == 0) {
+            unixPath = argv[i + 1];
+        } else if (strcmp(argv[i], "--port") == 0) {
+            port = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--sessions") == 0) {
+            count = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--seconds") == 0) {
+            seconds = atoi(argv[i + 1]);
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    std::vector<ClientSession> sessions(count);
+    for (int i = 0; i < count; ++i) {
+        ClientSession &session = sessions[i];
+        session.fd = Connect(unixPath, port);
+        if (session.fd < 0) {
+            perror("connect");
+            return 1;
+        }
+        memset(&session.state, 0, sizeof(session.state));
+        session.lastFrameNs = 0;
+        session.frames = 0;
+        session.size = 0;
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.u32 = i;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, session.fd, &event);
+    }
+
+    std::mt19937 rng(1);
+    std::vector<long long> histogram(jitterBuckets);
+    long long periodNs = 0;
+    int shards = 0;
+    int closed = 0;
+    long long start = NowNs();
+    long long end = start + seconds * 1000000000LL;
+    epoll_event events[256];
+
+    while (NowNs() < end) {
+        int ready = epoll_wait(epollFd, events, 256, 100);
+        long long now = NowNs();
+        for (int i = 0; i < ready; ++i) {
+            ClientSession &session = sessions[events[i].data.u32];
+            if (session.fd < 0) {
+                continue;
+            }
+            ssize_t received = recv(session.fd, session.buffer + session.size, sizeof(session.buffer) - session.size, 0);
+            if (received <= 0) {
+                if (received == 0 || (errno != EAGAIN && errno != EINTR)) {
+                    close(session.fd);
+                    session.fd = -1;
+                    closed++;
+                }
+                continue;
+            }
+            session.size += received;
+            long long frames = session.frames;
+            if (!ParseFrames(session, now, periodNs, shards, histogram)) {
+                fprintf(stderr, "corrupt stream\n");
+                return 1;
+            }
+
+            // Примерно раз в десять кадров игрок меняет ввод, а после конца игры начинает заново
+            if (session.frames != frames && rng() % 10 == 0) {
+                uint8_t message[sessionInputSize] = {SESSION_INPUT, (uint8_t) (rng() % 8)};
+                if (!session.state.fields[FIELD_RUN]) {
+                    message[0] = SESSION_RESTART;
+                }
+                send(session.fd, message, sizeof(message), MSG_NOSIGNAL);
+            }
+        }
+    }
+
+    double elapsed = (NowNs() - start) / 1e9;
+    long long frames = 0;
+    for (auto &session: sessions) {
+        frames += session.frames;
+        if (session.fd >= 0) {
+            close(session.fd);
+        }
+    }
+    long long measured = 0;
+    for (long long value: histogram) {
+        measured += value;
+    }
+    close(epollFd);
+
+    printf("sessions           %d (%d closed by server)\n", count, closed);
+    printf("state frames       %lld\n", frames);
+    printf("tick rate/session  %.1f Hz\n", frames / elapsed / count);
+    if (measured > 0) {
+        printf("jitter p50/p99/max %d / %d / %d us\n", Percentile(histogram, measured, 0.5),
+               Percentile(histogram, measured, 0.99), Percentile(histogram, measured, 1.0));
+    }
+    if (shards > 0) {
+        printf("sessions per core  %.1f (%d server threads)\n", (double) count / shards, shards);
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file sessionprotocol.cpp
+ * @brief Файл реализации кодирования кадров протокола сервера игровых сессий.
+ */
+
+#include "sessionprotocol.hpp"
+
+/**
+ * @brief Записывает 16-битное число в порядке little-endian.
+ */
+
+static void Put16(uint8_t *out, uint32_t value) {
+    out[0] = value & 0xff;
+    out[1] = (value >> 8) & 0xff;
+}
+
+/**
+ * @brief Записывает 32-битное число в порядке little-endian.
+ */
+
+static void Put32(uint8_t *out, uint32_t value) {
+    Put16(out, value);
+    Put16(out + 2, value >> 16);
+}
+
+/**
+ * @brief Записывает кадр с разностью состояния.
+ *
+ * @param previous Предыдущее отправленное состояние.
+ * @param current Текущее состояние.
+ * @param out Буфер размером не меньше sessionMaxStateFrame.
+ * @return Размер кадра в байтах.
+ */
+
+size_t EncodeStateDelta(const SessionState &previous, const SessionState &current, uint8_t *out) {
+    uint32_t changed = 0;
+    size_t size = sessionFrameHeaderSize + 2;
+    for (int i = 0; i < FIELD_COUNT; ++i) {
+        if (current.fields[i] != previous.fields[i]) {
+            changed |= 1u << i;
+            Put32(out + size, (uint32_t) current.fields[i]);
+            size += 4;
+        }
+    }
+    Put16(out, size - 2);
+    out[2] = SESSION_STATE;
+    Put16(out + sessionFrameHeaderSize, changed);
+    return size;
+}
+
+/**
+ * @brief Применяет данные кадра SESSION_STATE к состоянию.
+ *
+ * @param state Предыдущее полученное состояние; обновляется на месте.
+ * @param data Данные кадра после заголовка.
+ * @param size Размер данных.
+ * @return false, если данные повреждены.
+ */
+
+bool DecodeStateDelta(SessionState &state, const uint8_t *data, size_t size) {
+    if (size < 2) {
+        return false;
+    }
+    uint32_t changed = data[0] | (data[1] << 8);
+    if (changed >> FIELD_COUNT) {
+        return false;
+    }
+    size_t offset = 2;
+    for (int i = 0; i < FIELD_COUNT; ++i) {
+        if (!(changed & (1u << i))) {
+            continue;
+        }
+        if (offset + 4 > size) {
+            return false;
+        }
+        state.fields[i] = (int32_t) (data[offset] | (data[offset + 1] << 8) | (data[offset + 2] << 16) |
+                                     ((uint32_t) data[offset + 3] << 24));
+        offset += 4;
+    }
+    return offset == size;
+}
+
+/**
+ * @brief Записывает кадр приветствия.
+ *
+ * @param tickRate Частота тиков сервера.
+ * @param shard Номер потока, обслуживающего сессию.
+ * @param shards Количество потоков сервера.
+ * @param out Буфер размером не меньше sessionHelloFrame.
+ * @return Размер кадра в байтах.
+ */
+
+size_t EncodeHello(int tickRate, int shard, int shards, uint8_t *out) {
+    Put16(out, sessionHelloFrame - 2);
+    out[2] = SESSION_HELLO;
+    out[3] = sessionProtocolVersion;
+    Put16(out + 4, tickRate);
+    Put16(out + 6, shard);
+    Put16(out + 8, shards);
+    return sessionHelloFrame;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file sessionprotocol.hpp
+ * @brief Заголовочный файл, описывающий сетевой протокол сервера игровых сессий.
+ *
+ * Клиент отправляет сообщения фиксированного размера sessionInputSize: тип (SessionInputType)
+ * и значение. Сервер отправляет кадры вида [длина uint16][тип uint8][данные], где длина
+ * включает тип и данные. Состояние сессии передается как разность с предыдущим отправленным
+ * состоянием: маска изменившихся полей и значения только этих полей. Все числа передаются
+ * в порядке байтов little-endian.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Версия протокола.
+ */
+constexpr uint8_t sessionProtocolVersion = 1;
+
+/**
+ * @brief Размер сообщения клиента в байтах.
+ */
+constexpr size_t sessionInputSize = 2;
+
+/**
+ * @brief Размер заголовка кадра сервера (длина и тип) в байтах.
+ */
+constexpr size_t sessionFrameHeaderSize = 3;
+
+/**
+ * @brief Типы сообщений клиента.
+ */
+enum SessionInputType : uint8_t {
+    /**
+     * @brief Значение - комбинация флагов InputFlags, действующая до следующего сообщения.
+     */
+    SESSION_INPUT = 1,
+    /**
+     * @brief Начать игру заново.
+     */
+    SESSION_RESTART = 2
+};
+
+/**
+ * @brief Типы кадров сервера.
+ */
+enum SessionFrameType : uint8_t {
+    /**
+     * @brief Приветствие: версия протокола, частота тиков, номер потока и количество потоков сервера.
+     */
+    SESSION_HELLO = 1,
+    /**
+     * @brief Разность состояния сессии.
+     */
+    SESSION_STATE = 2
+};
+
+/**
+ * @brief Поля состояния сессии.
+ */
+enum SessionField {
+    FIELD_TICK,
+    FIELD_SCORE,
+    FIELD_LIVES,
+    FIELD_RUN,
+    FIELD_SHIP_X,
+    FIELD_FORMATION_X,
+    FIELD_FORMATION_Y,
+    FIELD_ALIVE_LOW,
+    FIELD_ALIVE_HIGH,
+    FIELD_MYSTERY_X,
+    FIELD_ALIEN_LASERS,
+    FIELD_PLAYER_LASERS,
+    FIELD_COUNT
+};
+
+/**
+ * @struct SessionState
+ * @brief Краткое состояние сессии, передаваемое клиенту на каждом тике.
+ *
+ * Координаты округлены до пикселя, маска живых инопланетян разбита на две половины по 32 бита,
+ * FIELD_MYSTERY_X равно -1, если загадочного корабля нет.
+ */
+struct SessionState {
+    /**
+     * @brief Значения полей в порядке SessionField.
+     */
+    int32_t fields[FIELD_COUNT];
+};
+
+/**
+ * @brief Наибольший размер кадра состояния в байтах.
+ */
+constexpr size_t sessionMaxStateFrame = sessionFrameHeaderSize + 2 + FIELD_COUNT * 4;
+
+/**
+ * @brief Размер кадра приветствия в байтах.
+ */
+constexpr size_t sessionHelloFrame = sessionFrameHeaderSize + 1 + 2 + 2 + 2;
+
+/**
+ * @brief Записывает кадр с разностью состояния.
+ *
+ * @param previous Предыдущее отправленное состояние.
+ * @param current Текущее состояние.
+ * @param out Буфер размером не меньше sessionMaxStateFrame.
+ * @return Размер кадра в байтах.
+ */
+size_t EncodeStateDelta(const SessionState &previous, const SessionState &current, uint8_t *out);
+
+/**
+ * @brief Применяет данные кадра SESSION_STATE к состоянию.
+ *
+ * @param state Предыдущее полученное состояние; обновляется на месте.
+ * @param data Данные кадра после заголовка.
+ * @param size Размер данных.
+ * @return false, если данные повреждены.
+ */
+bool DecodeStateDelta(SessionState &state, const uint8_t *data, size_t size);
+
+/**
+ * @brief Записывает кадр приветствия.
+ *
+ * @param tickRate Частота тиков сервера.
+ * @param shard Номер потока, обслуживающего сессию.
+ * @param shards Количество потоков сервера.
+ * @param out Буфер размером не меньше sessionHelloFrame.
+ * @return Размер кадра в байтах.
+ */
+size_t EncodeHello(int tickRate, int shard, int shards, uint8_t *out);
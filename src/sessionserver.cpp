@@ -0,0 +1,180 @@
+/**
+ * @file sessionserver.cpp
+ * @brief Сервер игровых сессий без окна: тысячи независимых игр на фиксированном пуле потоков.
+ *
+ * Запуск: invaders_session_server [--unix PATH | --port PORT] [--threads N] [--rate 60] [--max-sessions 4096]
+ *
+ * Каждый поток обслуживает свою часть сессий (см. SessionShard); раз в секунду сервер печатает
+ * количество сессий, опоздания тиков и загрузку потоков.
+ */
+
+#include "sessionshard.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+/**
+ * @brief Флаг остановки сервера.
+ */
+static std::atomic<bool> stopRequested(false);
+
+/**
+ * @brief Обработчик SIGINT и SIGTERM.
+ *
+ * @param signal Номер сигнала.
+ */
+
+static void RequestStop(int signal) {
+    (void) signal;
+    stopRequested.store(true);
+}
+
+/**
+ * @brief Создает слушающий неблокирующий сокет.
+ *
+ * @param unixPath Путь Unix-сокета или nullptr.
+ * @param port Порт TCP на адресе 127.0.0.1, если unixPath не задан.
+ * @return Дескриптор сокета или -1.
+ */
+
+static int Listen(const char *unixPath, int port) {
+    int fd;
+    if (unixPath != nullptr) {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, unixPath, sizeof(address.sun_path) - 1);
+        unlink(unixPath);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0 || bind(fd, (sockaddr *) &address, sizeof(address)) != 0) {
+            return -1;
+        }
+    } else {
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (fd < 0 || bind(fd, (sockaddr *) &address, sizeof(address)) != 0) {
+            return -1;
+        }
+    }
+    if (listen(fd, SOMAXCONN) != 0) {
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Главная функция сервера.
+ *
+ * @param argc Количество аргументов командной строки.
+ * @param argv Аргументы командной строки.
+ * @return 0 при штатной остановке, 1 при ошибке.
+ */
+
+int main(int argc, char **argv) {
+    const char *unixPath = nullptr;
+    int port = 7777;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    int rate = 60;
+    int maxSessions = 4096;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--unix") == 0) {
+            unixPath = argv[i + 1];
+        } else if (strcmp(argv[i], "--port") == 0) {
+            port = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            threads = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--rate") == 0) {
+            rate = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--max-sessions") == 0) {
+            maxSessions = atoi(argv[i + 1]);
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (threads <= 0 || rate <= 0 || maxSessions <= 0) {
+        fprintf(stderr, "--threads, --rate and --max-sessions must be positive\n");
+        return 1;
+    }
+
+    int listenFd = Listen(unixPath, port);
+    if (listenFd < 0) {
+        perror("listen");
+        return 1;
+    }
+
+    SetTraceLogLevel(LOG_WARNING);
+    // Общие изображения инопланетян загружаются до запуска потоков
+    Game warmup(true);
+
+    TickSchedule schedule;
+    clock_gettime(CLOCK_MONOTONIC, &schedule.epoch);
+    schedule.periodNs = 1000000000LL / rate;
+    schedule.epoch.tv_sec += 1;
+
+    int perShard = (maxSessions + threads - 1) / threads;
+    std::vector<std::unique_ptr<SessionShard>> shards;
+    for (int i = 0; i < threads; ++i) {
+        shards.emplace_back(new SessionShard(i, threads, listenFd, schedule, perShard));
+    }
+
+    signal(SIGINT, RequestStop);
+    signal(SIGTERM, RequestStop);
+    signal(SIGPIPE, SIG_IGN);
+
+    std::vector<std::thread> workers;
+    for (auto &shard: shards) {
+        SessionShard *pointer = shard.get();
+        workers.emplace_back([pointer] { pointer->Run(stopRequested); });
+    }
+    printf("serving on %s with %d threads at %d Hz\n", unixPath != nullptr ? unixPath : "127.0.0.1", threads, rate);
+    fflush(stdout);
+
+    unsigned long long lastBusy = 0;
+    while (!stopRequested.load()) {
+        sleep(1);
+        int sessions = 0;
+        unsigned long long missed = 0;
+        unsigned long long lateness = 0;
+        unsigned long long busy = 0;
+        for (auto &shard: shards) {
+            sessions += shard->sessionCount.load();
+            missed += shard->missedTicks.load();
+            lateness = std::max(lateness, shard->maxLatenessUs.exchange(0));
+            busy += shard->busyNs.load();
+        }
+        // Загрузка - доля секунды, которую потоки провели в тиках, в пересчете на одно ядро
+        double load = (busy - lastBusy) / 1e9;
+        lastBusy = busy;
+        printf("sessions %d  missed ticks %llu  max lateness %llu us  cores busy %.2f", sessions, missed, lateness,
+               load);
+        if (load > 0.01) {
+            printf("  sessions per core %.0f", sessions / load);
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+
+    for (auto &worker: workers) {
+        worker.join();
+    }
+    shards.clear();
+    close(listenFd);
+    if (unixPath != nullptr) {
+        unlink(unixPath);
+    }
+    return 0;
+}
@@ -0,0 +1,342 @@
+/**
+ * @file sessionshard.cpp
+ * @brief Файл реализации класса SessionShard.
+ */
+
+#include "sessionshard.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+/**
+ * @brief Наибольшее количество тиков, выполняемых подряд после опоздания потока.
+ */
+static constexpr unsigned long long maxCatchUpTicks = 4;
+
+/**
+ * @brief Возвращает разность моментов времени в наносекундах.
+ */
+
+static long long ElapsedNs(const timespec &from, const timespec &to) {
+    return (to.tv_sec - from.tv_sec) * 1000000000LL + (to.tv_nsec - from.tv_nsec);
+}
+
+/**
+ * @brief Снимает краткое состояние игры.
+ *
+ * @param game Игра.
+ * @param tick Номер тика расписания.
+ * @param state Состояние для заполнения.
+ */
+
+static void CaptureState(Game &game, unsigned long long tick, SessionState &state) {
+    int32_t *f = state.fields;
+    f[FIELD_TICK] = (int32_t) tick;
+    f[FIELD_SCORE] = game.score;
+    f[FIELD_LIVES] = game.lives;
+    f[FIELD_RUN] = game.run ? 1 : 0;
+    f[FIELD_SHIP_X] = (int32_t) game.spaceship.getRect().x;
+    f[FIELD_FORMATION_X] = (int32_t) game.formationOrigin.x;
+    f[FIELD_FORMATION_Y] = (int32_t) game.formationOrigin.y;
+
+    uint64_t alive = 0;
+    for (int row = 0; row < Game::alienRows; ++row) {
+        for (int column = 0; column < Game::alienColumns; ++column) {
+            if (game.shooters.IsAlive(row, column)) {
+                alive |= 1ull << (row * Game::alienColumns + column);
+            }
+        }
+    }
+    f[FIELD_ALIVE_LOW] = (int32_t) (uint32_t) alive;
+    f[FIELD_ALIVE_HIGH] = (int32_t) (uint32_t) (alive >> 32);
+    f[FIELD_MYSTERY_X] = game.mysteryship.alive ? (int32_t) game.mysteryship.getRect().x : -1;
+
+    int alienLasers = 0;
+    for (auto &laser: game.alienLasers) {
+        alienLasers += laser.active;
+    }
+    int playerLasers = 0;
+    for (auto &laser: game.spaceship.lasers) {
+        playerLasers += laser.active;
+    }
+    f[FIELD_ALIEN_LASERS] = alienLasers;
+    f[FIELD_PLAYER_LASERS] = playerLasers;
+}
+
+/**
+ * @brief Конструктор класса SessionShard.
+ *
+ * @param index Номер потока.
+ * @param shards Количество потоков.
+ * @param listenFd Слушающий неблокирующий сокет.
+ * @param schedule Расписание тиков.
+ * @param maxSessions Наибольшее количество сессий потока.
+ */
+
+SessionShard::SessionShard(int index, int shards, int listenFd, const TickSchedule &schedule, int maxSessions)
+        : sessionCount(0), ticks(0), missedTicks(0), maxLatenessUs(0), busyNs(0) {
+    this->index = index;
+    this->shards = shards;
+    this->listenFd = listenFd;
+    this->schedule = schedule;
+    this->maxSessions = maxSessions;
+    tick = 0;
+    sessions.reserve(maxSessions);
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    itimerspec timer = {};
+    timer.it_interval.tv_sec = schedule.periodNs / 1000000000LL;
+    timer.it_interval.tv_nsec = schedule.periodNs % 1000000000LL;
+    timer.it_value = schedule.epoch;
+    timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &timer, nullptr);
+
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = &this->timerFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &event);
+
+    // EPOLLEXCLUSIVE будит только один из потоков, ждущих на общем сокете
+    event.events = EPOLLIN | EPOLLEXCLUSIVE;
+    event.data.ptr = &this->listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+}
+
+/**
+ * @brief Деструктор класса SessionShard. Закрывает сессии, epoll и таймер.
+ */
+
+SessionShard::~SessionShard() {
+    for (auto &session: sessions) {
+        close(session->fd);
+    }
+    close(timerFd);
+    close(epollFd);
+}
+
+/**
+ * @brief Обслуживает сессии, пока не установлен флаг остановки.
+ *
+ * @param stop Флаг остановки.
+ */
+
+void SessionShard::Run(const std::atomic<bool> &stop) {
+    epoll_event events[64];
+    while (!stop.load(std::memory_order_relaxed)) {
+        int count = epoll_wait(epollFd, events, 64, 100);
+        for (int i = 0; i < count; ++i) {
+            void *tag = events[i].data.ptr;
+            if (tag == &listenFd) {
+                Accept();
+            } else if (tag == &timerFd) {
+                Tick();
+            } else {
+                Session &session = *(Session *) tag;
+                if (session.fd < 0) {
+                    continue;
+                }
+                if (events[i].events & EPOLLIN) {
+                    Receive(session);
+                }
+                if (events[i].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) {
+                    Drop(session);
+                }
+            }
+        }
+        CloseDropped();
+    }
+}
+
+/**
+ * @brief Принимает все ожидающие подключения.
+ */
+
+void SessionShard::Accept() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        if ((int) sessions.size() >= maxSessions) {
+            close(fd);
+            continue;
+        }
+        int one = 1;
+        // Для Unix-сокетов вызов завершается ошибкой, которую можно игнорировать
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        std::unique_ptr<Session> session(new Session());
+        session->fd = fd;
+        session->index = sessions.size();
+        session->input = 0;
+        session->game.reset(new Game(true));
+        session->inSize = 0;
+        session->outSize = EncodeHello(int(1000000000LL / schedule.periodNs), index, shards, session->out);
+        CaptureState(*session->game, tick, session->sent);
+        // Первая разность после приветствия содержит все поля
+        for (auto &field: session->sent.fields) {
+            field = ~field;
+        }
+
+        epoll_event event = {};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.ptr = session.get();
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            continue;
+        }
+        Flush(*session);
+        sessions.push_back(std::move(session));
+        sessionCount.store(sessions.size(), std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Выполняет тик всех сессий и отправляет разности состояний.
+ */
+
+void SessionShard::Tick() {
+    uint64_t expirations = 0;
+    if (read(timerFd, &expirations, sizeof(expirations)) != sizeof(expirations) || expirations == 0) {
+        return;
+    }
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // Первое срабатывание таймера приходится на epoch, поэтому срок тика tick равен epoch + (tick - 1) * period
+    tick += expirations;
+    long long deadline = (long long) (tick - 1) * schedule.periodNs;
+    long long lateness = ElapsedNs(schedule.epoch, start) - deadline;
+    unsigned long long latenessUs = lateness > 0 ? lateness / 1000 : 0;
+    unsigned long long previous = maxLatenessUs.load(std::memory_order_relaxed);
+    while (latenessUs > previous && !maxLatenessUs.compare_exchange_weak(previous, latenessUs)) {
+    }
+    if (expirations > 1) {
+        missedTicks.fetch_add(expirations - 1, std::memory_order_relaxed);
+    }
+
+    unsigned long long steps = std::min<unsigned long long>(expirations, maxCatchUpTicks);
+    SessionState current;
+    for (auto &pointer: sessions) {
+        Session &session = *pointer;
+        if (session.fd < 0) {
+            continue;
+        }
+        for (unsigned long long step = 0; step < steps; ++step) {
+            session.game->ApplyInput(session.input);
+            session.game->Update();
+        }
+
+        // Медленный клиент пропускает кадры; разность всегда считается от последнего поставленного в очередь
+        if (session.outSize + sessionMaxStateFrame <= Session::outCapacity) {
+            CaptureState(*session.game, tick, current);
+            session.outSize += EncodeStateDelta(session.sent, current, session.out + session.outSize);
+            session.sent = current;
+        }
+        Flush(session);
+    }
+
+    timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    busyNs.fetch_add(ElapsedNs(start, end), std::memory_order_relaxed);
+    ticks.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Читает и применяет сообщения клиента.
+ *
+ * @param session Сессия.
+ */
+
+void SessionShard::Receive(Session &session) {
+    while (true) {
+        ssize_t received = recv(session.fd, session.in + session.inSize, Session::inCapacity - session.inSize, 0);
+        if (received == 0) {
+            Drop(session);
+            return;
+        }
+        if (received < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                Drop(session);
+            }
+            return;
+        }
+        session.inSize += received;
+
+        size_t offset = 0;
+        for (; offset + sessionInputSize <= session.inSize; offset += sessionInputSize) {
+            uint8_t type = session.in[offset];
+            uint8_t value = session.in[offset + 1];
+            if (type == SESSION_INPUT) {
+                session.input = value;
+            } else if (type == SESSION_RESTART) {
+                session.game->Reset();
+                session.game->InitGame();
+            } else {
+                Drop(session);
+                return;
+            }
+        }
+        memmove(session.in, session.in + offset, session.inSize - offset);
+        session.inSize -= offset;
+    }
+}
+
+/**
+ * @brief Отправляет содержимое буфера вывода, сколько примет сокет.
+ *
+ * @param session Сессия.
+ */
+
+void SessionShard::Flush(Session &session) {
+    if (session.outSize == 0) {
+        return;
+    }
+    ssize_t sent = send(session.fd, session.out, session.outSize, MSG_NOSIGNAL);
+    if (sent < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            Drop(session);
+        }
+        return;
+    }
+    memmove(session.out, session.out + sent, session.outSize - sent);
+    session.outSize -= sent;
+}
+
+/**
+ * @brief Помечает сессию для закрытия после обработки текущих событий.
+ *
+ * @param session Сессия.
+ */
+
+void SessionShard::Drop(Session &session) {
+    if (session.fd < 0) {
+        return;
+    }
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, session.fd, nullptr);
+    close(session.fd);
+    session.fd = -1;
+    dropped.push_back(&session);
+}
+
+/**
+ * @brief Закрывает помеченные сессии.
+ */
+
+void SessionShard::CloseDropped() {
+    for (Session *session: dropped) {
+        int position = session->index;
+        std::swap(sessions[position], sessions.back());
+        sessions[position]->index = position;
+        sessions.pop_back();
+    }
+    dropped.clear();
+    sessionCount.store(sessions.size(), std::memory_order_relaxed);
+}
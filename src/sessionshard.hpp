@@ -0,0 +1,219 @@
+/**
+ * @file sessionshard.hpp
+ * @brief Заголовочный файл, содержащий класс SessionShard - поток сервера игровых сессий.
+ */
+
+#pragma once
+
+#include "game.hpp"
+#include "sessionprotocol.hpp"
+#include <atomic>
+#include <ctime>
+#include <memory>
+#include <vector>
+
+/**
+ * @struct TickSchedule
+ * @brief Общее для всех потоков расписание тиков: тик k наступает в момент epoch + k * period.
+ */
+struct TickSchedule {
+    /**
+     * @brief Момент нулевого тика (CLOCK_MONOTONIC).
+     */
+    timespec epoch;
+    /**
+     * @brief Период тиков в наносекундах.
+     */
+    long long periodNs;
+};
+
+/**
+ * @struct Session
+ * @brief Игровая сессия одного клиента.
+ *
+ * Буферы ввода и вывода фиксированного размера выделяются вместе с сессией, поэтому обработка
+ * сообщений не выделяет память.
+ */
+struct Session {
+    /**
+     * @brief Емкость буфера вывода.
+     */
+    static constexpr size_t outCapacity = 4 * sessionMaxStateFrame;
+    /**
+     * @brief Емкость буфера ввода.
+     */
+    static constexpr size_t inCapacity = 64;
+
+    /**
+     * @brief Сокет клиента или -1 для закрываемой сессии.
+     */
+    int fd;
+    /**
+     * @brief Позиция сессии в списке потока.
+     */
+    int index;
+    /**
+     * @brief Текущая комбинация флагов InputFlags.
+     */
+    int input;
+    /**
+     * @brief Игра сессии.
+     */
+    std::unique_ptr<Game> game;
+    /**
+     * @brief Последнее поставленное в очередь состояние; разности считаются от него.
+     */
+    SessionState sent;
+    /**
+     * @brief Количество байт в буфере ввода.
+     */
+    size_t inSize;
+    /**
+     * @brief Количество неотправленных байт в буфере вывода.
+     */
+    size_t outSize;
+    /**
+     * @brief Буфер ввода.
+     */
+    uint8_t in[inCapacity];
+    /**
+     * @brief Буфер вывода.
+     */
+    uint8_t out[outCapacity];
+};
+
+/**
+ * @class SessionShard
+ * @brief Поток сервера, владеющий частью сессий.
+ *
+ * Каждый поток имеет свой epoll, таймер timerfd, настроенный по общему расписанию TickSchedule,
+ * и принимает подключения с общего слушающего сокета (EPOLLEXCLUSIVE распределяет их между
+ * потоками). Сессии не переходят между потоками, поэтому игры обновляются без блокировок.
+ */
+class SessionShard {
+public:
+    /**
+     * @brief Конструктор класса SessionShard.
+     *
+     * @param index Номер потока.
+     * @param shards Количество потоков.
+     * @param listenFd Слушающий неблокирующий сокет.
+     * @param schedule Расписание тиков.
+     * @param maxSessions Наибольшее количество сессий потока.
+     */
+    SessionShard(int index, int shards, int listenFd, const TickSchedule &schedule, int maxSessions);
+
+    /**
+     * @brief Деструктор класса SessionShard. Закрывает сессии, epoll и таймер.
+     */
+    ~SessionShard();
+
+    SessionShard(const SessionShard &) = delete;
+    SessionShard &operator=(const SessionShard &) = delete;
+
+    /**
+     * @brief Обслуживает сессии, пока не установлен флаг остановки.
+     *
+     * @param stop Флаг остановки.
+     */
+    void Run(const std::atomic<bool> &stop);
+
+    /**
+     * @brief Количество сессий потока.
+     */
+    std::atomic<int> sessionCount;
+    /**
+     * @brief Количество выполненных тиков расписания.
+     */
+    std::atomic<unsigned long long> ticks;
+    /**
+     * @brief Количество пропущенных срабатываний таймера (поток не успел к сроку).
+     */
+    std::atomic<unsigned long long> missedTicks;
+    /**
+     * @brief Наибольшее опоздание обработки тика в микросекундах с момента последнего сброса.
+     */
+    std::atomic<unsigned long long> maxLatenessUs;
+    /**
+     * @brief Суммарное время работы над тиками в наносекундах.
+     */
+    std::atomic<unsigned long long> busyNs;
+
+private:
+    /**
+     * @brief Принимает все ожидающие подключения.
+     */
+    void Accept();
+
+    /**
+     * @brief Выполняет тик всех сессий и отправляет разности состояний.
+     */
+    void Tick();
+
+    /**
+     * @brief Читает и применяет сообщения клиента.
+     *
+     * @param session Сессия.
+     */
+    void Receive(Session &session);
+
+    /**
+     * @brief Отправляет содержимое буфера вывода, сколько примет сокет.
+     *
+     * @param session Сессия.
+     */
+    void Flush(Session &session);
+
+    /**
+     * @brief Помечает сессию для закрытия после обработки текущих событий.
+     *
+     * @param session Сессия.
+     */
+    void Drop(Session &session);
+
+    /**
+     * @brief Закрывает помеченные сессии.
+     */
+    void CloseDropped();
+
+    /**
+     * @brief Номер потока.
+     */
+    int index;
+    /**
+     * @brief Количество потоков.
+     */
+    int shards;
+    /**
+     * @brief Слушающий сокет.
+     */
+    int listenFd;
+    /**
+     * @brief Дескриптор epoll.
+     */
+    int epollFd;
+    /**
+     * @brief Таймер тиков.
+     */
+    int timerFd;
+    /**
+     * @brief Наибольшее количество сессий.
+     */
+    int maxSessions;
+    /**
+     * @brief Номер последнего выполненного тика расписания.
+     */
+    unsigned long long tick;
+    /**
+     * @brief Расписание тиков.
+     */
+    TickSchedule schedule;
+    /**
+     * @brief Сессии потока.
+     */
+    std::vector<std::unique_ptr<Session>> sessions;
+    /**
+     * @brief Сессии, помеченные для закрытия.
+     */
+    std::vector<Session *> dropped;
+};
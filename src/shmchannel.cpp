@@ -0,0 +1,294 @@
+/**
+ * @file shmchannel.cpp
+ * @brief Файл реализации класса ShmChannel.
+ */
+
+#include "shmchannel.hpp"
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <new>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/**
+ * @brief Подсказка процессору, что поток крутится в цикле ожидания.
+ */
+
+static inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+/**
+ * @brief Проверяет, существует ли процесс.
+ *
+ * @param pid Идентификатор процесса.
+ */
+
+static bool ProcessAlive(uint32_t pid) {
+    return kill((pid_t) pid, 0) == 0 || errno != ESRCH;
+}
+
+/**
+ * @brief Конструктор класса ShmChannel. Создает закрытый канал.
+ */
+
+ShmChannel::ShmChannel() : layout(), memory(nullptr), size(0), owner(false), acquired(false) {
+}
+
+/**
+ * @brief Деструктор класса ShmChannel. Закрывает канал.
+ */
+
+ShmChannel::~ShmChannel() {
+    Close();
+}
+
+/**
+ * @brief Создает сегмент и заполняет заголовок.
+ *
+ * @param name Имя сегмента (например, "/invaders_env").
+ * @param numEnvs Количество игр.
+ * @param observationType Тип наблюдения.
+ * @param observationSize Количество элементов наблюдения одной игры.
+ * @param elementSize Размер элемента наблюдения в байтах.
+ * @param ringSlots Количество ячеек в кольце, степень двойки: 32-битный номер запроса переполняется,
+ *                  и только при делителе 2^32 соседние запросы не попадают в одну ячейку.
+ * @return true, если сегмент создан.
+ */
+
+bool ShmChannel::Create(const char *name, uint32_t numEnvs, uint32_t observationType, uint32_t observationSize,
+                        uint32_t elementSize, uint32_t ringSlots) {
+    Close();
+    if (!IsValidRingSize(ringSlots)) {
+        return false;
+    }
+    layout = ShmSlotLayout::For(numEnvs, (size_t) observationSize * elementSize);
+    size = shmHeaderSize + layout.size * ringSlots;
+
+    // Сегмент, оставшийся после аварийного завершения прошлого сервера, создается заново
+    shm_unlink(name);
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        return false;
+    }
+    if (ftruncate(fd, (off_t) size) != 0) {
+        close(fd);
+        shm_unlink(name);
+        return false;
+    }
+    void *address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) {
+        shm_unlink(name);
+        return false;
+    }
+
+    memory = (unsigned char *) address;
+    this->name = name;
+    owner = true;
+
+    ShmHeader *header = new(memory) ShmHeader();
+    header->version = shmVersion;
+    header->numEnvs = numEnvs;
+    header->observationType = observationType;
+    header->observationSize = observationSize;
+    header->elementSize = elementSize;
+    header->ringSlots = ringSlots;
+    header->slotSize = (uint32_t) layout.size;
+    header->clientPid.store(0);
+    header->requestSeq.store(0);
+    header->responseSeq.store(0);
+    header->serverPid.store((uint32_t) getpid());
+    // Сигнатура пишется последней: клиент не увидит наполовину заполненный заголовок
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = shmMagic;
+    return true;
+}
+
+/**
+ * @brief Подключается к существующему сегменту.
+ *
+ * @param name Имя сегмента.
+ * @return true, если сегмент найден и его версия совпадает с shmVersion.
+ */
+
+bool ShmChannel::Attach(const char *name) {
+    Close();
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t) info.st_size < shmHeaderSize) {
+        close(fd);
+        return false;
+    }
+    void *address = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) {
+        return false;
+    }
+
+    memory = (unsigned char *) address;
+    size = info.st_size;
+    this->name = name;
+    ShmHeader *header = Header();
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header->magic != shmMagic || header->version != shmVersion ||
+        !IsValidRingSize(header->ringSlots) || shmHeaderSize + (size_t) header->slotSize * header->ringSlots > size) {
+        Close();
+        return false;
+    }
+    layout = ShmSlotLayout::For(header->numEnvs, (size_t) header->observationSize * header->elementSize);
+    return true;
+}
+
+/**
+ * @brief Закрывает канал. Сервер помечает сегмент остановленным и удаляет его имя.
+ */
+
+void ShmChannel::Close() {
+    if (memory == nullptr) {
+        return;
+    }
+    if (acquired) {
+        Release();
+    }
+    if (owner) {
+        ShmHeader *header = Header();
+        header->serverPid.store(0);
+        Wake(header->responseSeq);
+        shm_unlink(name.c_str());
+        header->~ShmHeader();
+    }
+    munmap(memory, size);
+    memory = nullptr;
+    size = 0;
+    owner = false;
+}
+
+/**
+ * @brief Занимает сегмент для текущего процесса.
+ *
+ * Сегмент можно занять, если он свободен или занявший его процесс завершился. После захвата
+ * ждет, пока сервер выполнит запросы предыдущего клиента.
+ *
+ * @return true, если сегмент занят текущим процессом.
+ */
+
+bool ShmChannel::Acquire() {
+    ShmHeader *header = Header();
+    uint32_t pid = (uint32_t) getpid();
+    uint32_t current = header->clientPid.load();
+    while (current != pid) {
+        if (current != 0 && ProcessAlive(current)) {
+            return false;
+        }
+        if (header->clientPid.compare_exchange_weak(current, pid)) {
+            break;
+        }
+    }
+    acquired = true;
+
+    uint32_t request = header->requestSeq.load(std::memory_order_acquire);
+    uint32_t response;
+    while ((response = header->responseSeq.load(std::memory_order_acquire)) != request) {
+        if (header->serverPid.load() == 0) {
+            Release();
+            return false;
+        }
+        Wait(header->responseSeq, response, 1000, 100);
+    }
+    return true;
+}
+
+/**
+ * @brief Освобождает сегмент, занятый методом Acquire.
+ */
+
+void ShmChannel::Release() {
+    uint32_t pid = (uint32_t) getpid();
+    Header()->clientPid.compare_exchange_strong(pid, 0);
+    acquired = false;
+}
+
+/**
+ * @brief Освобождает сегмент, если занявший его процесс завершился.
+ *
+ * @return true, если сегмент был освобожден.
+ */
+
+bool ShmChannel::ReclaimDeadClient() {
+    ShmHeader *header = Header();
+    uint32_t pid = header->clientPid.load();
+    if (pid == 0 || ProcessAlive(pid)) {
+        return false;
+    }
+    return header->clientPid.compare_exchange_strong(pid, 0);
+}
+
+/**
+ * @brief Возвращает заголовок сегмента.
+ */
+
+ShmHeader *ShmChannel::Header() {
+    return (ShmHeader *) memory;
+}
+
+/**
+ * @brief Возвращает ячейку кольца для номера запроса.
+ *
+ * @param sequence Номер запроса.
+ */
+
+unsigned char *ShmChannel::Slot(uint32_t sequence) {
+    return memory + shmHeaderSize + (size_t) (sequence % Header()->ringSlots) * layout.size;
+}
+
+/**
+ * @brief Ждет, пока значение счетчика отличается от value.
+ *
+ * @param word Счетчик в сегменте.
+ * @param value Текущее значение счетчика.
+ * @param spins Количество проверок перед засыпанием.
+ * @param timeoutMs Наибольшее время сна в миллисекундах.
+ * @return true, если значение изменилось.
+ */
+
+bool ShmChannel::Wait(std::atomic<uint32_t> &word, uint32_t value, int spins, int timeoutMs) {
+    // На одном ядре вращение только отнимает время у процесса, которого мы ждем
+    static const bool singleCore = sysconf(_SC_NPROCESSORS_ONLN) <= 1;
+    if (singleCore) {
+        spins = 0;
+    }
+    for (int i = 0; i < spins; ++i) {
+        if (word.load(std::memory_order_acquire) != value) {
+            return true;
+        }
+        CpuRelax();
+    }
+    timespec timeout = {timeoutMs / 1000, (timeoutMs % 1000) * 1000000L};
+    // Не FUTEX_PRIVATE_FLAG: счетчик разделяется между процессами
+    syscall(SYS_futex, (uint32_t *) &word, FUTEX_WAIT, value, &timeout, nullptr, 0);
+    return word.load(std::memory_order_acquire) != value;
+}
+
+/**
+ * @brief Будит процессы, ждущие изменения счетчика.
+ *
+ * @param word Счетчик в сегменте.
+ */
+
+void ShmChannel::Wake(std::atomic<uint32_t> &word) {
+    syscall(SYS_futex, (uint32_t *) &word, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
@@ -0,0 +1,140 @@
+/**
+ * @file shmchannel.hpp
+ * @brief Заголовочный файл, содержащий класс ShmChannel - сегмент разделяемой памяти сервера игр.
+ */
+
+#pragma once
+
+#include "shmprotocol.hpp"
+#include <string>
+
+/**
+ * @class ShmChannel
+ * @brief Отображение сегмента POSIX разделяемой памяти с кольцом запросов (см. shmprotocol.hpp).
+ *
+ * Сервер создает сегмент методом Create и удаляет его при закрытии; клиент подключается
+ * методом Attach и занимает сегмент методом Acquire. Ожидание сначала крутится в цикле,
+ * а затем засыпает на futex, поэтому при частых шагах задержка не включает системные вызовы.
+ */
+class ShmChannel {
+public:
+    /**
+     * @brief Конструктор класса ShmChannel. Создает закрытый канал.
+     */
+    ShmChannel();
+
+    /**
+     * @brief Деструктор класса ShmChannel. Закрывает канал.
+     */
+    ~ShmChannel();
+
+    ShmChannel(const ShmChannel &) = delete;
+    ShmChannel &operator=(const ShmChannel &) = delete;
+
+    /**
+     * @brief Создает сегмент и заполняет заголовок.
+     *
+     * @param name Имя сегмента (например, "/invaders_env").
+     * @param numEnvs Количество игр.
+     * @param observationType Тип наблюдения.
+     * @param observationSize Количество элементов наблюдения одной игры.
+     * @param elementSize Размер элемента наблюдения в байтах.
+     * @param ringSlots Количество ячеек в кольце, степень двойки: 32-битный номер запроса переполняется,
+     *                  и только при делителе 2^32 соседние запросы не попадают в одну ячейку.
+     * @return true, если сегмент создан.
+     */
+    bool Create(const char *name, uint32_t numEnvs, uint32_t observationType, uint32_t observationSize,
+                uint32_t elementSize, uint32_t ringSlots);
+
+    /**
+     * @brief Подключается к существующему сегменту.
+     *
+     * @param name Имя сегмента.
+     * @return true, если сегмент найден и его версия совпадает с shmVersion.
+     */
+    bool Attach(const char *name);
+
+    /**
+     * @brief Закрывает канал. Сервер помечает сегмент остановленным и удаляет его имя.
+     */
+    void Close();
+
+    /**
+     * @brief Занимает сегмент для текущего процесса.
+     *
+     * Сегмент можно занять, если он свободен или занявший его процесс завершился. После захвата
+     * ждет, пока сервер выполнит запросы предыдущего клиента.
+     *
+     * @return true, если сегмент занят текущим процессом.
+     */
+    bool Acquire();
+
+    /**
+     * @brief Освобождает сегмент, занятый методом Acquire.
+     */
+    void Release();
+
+    /**
+     * @brief Освобождает сегмент, если занявший его процесс завершился.
+     *
+     * @return true, если сегмент был освобожден.
+     */
+    bool ReclaimDeadClient();
+
+    /**
+     * @brief Возвращает заголовок сегмента.
+     */
+    ShmHeader *Header();
+
+    /**
+     * @brief Возвращает ячейку кольца для номера запроса.
+     *
+     * @param sequence Номер запроса.
+     */
+    unsigned char *Slot(uint32_t sequence);
+
+    /**
+     * @brief Ждет, пока значение счетчика отличается от value.
+     *
+     * @param word Счетчик в сегменте.
+     * @param value Текущее значение счетчика.
+     * @param spins Количество проверок перед засыпанием.
+     * @param timeoutMs Наибольшее время сна в миллисекундах.
+     * @return true, если значение изменилось.
+     */
+    static bool Wait(std::atomic<uint32_t> &word, uint32_t value, int spins, int timeoutMs);
+
+    /**
+     * @brief Будит процессы, ждущие изменения счетчика.
+     *
+     * @param word Счетчик в сегменте.
+     */
+    static void Wake(std::atomic<uint32_t> &word);
+
+    /**
+     * @brief Раскладка ячейки.
+     */
+    ShmSlotLayout layout;
+
+private:
+    /**
+     * @brief Имя сегмента.
+     */
+    std::string name;
+    /**
+     * @brief Адрес отображения или nullptr.
+     */
+    unsigned char *memory;
+    /**
+     * @brief Размер отображения.
+     */
+    size_t size;
+    /**
+     * @brief Флаг создателя сегмента (сервера).
+     */
+    bool owner;
+    /**
+     * @brief Флаг захвата сегмента текущим процессом.
+     */
+    bool acquired;
+};
@@ -0,0 +1,184 @@
+/**
+ * @file shmprotocol.hpp
+ * @brief Заголовочный файл, описывающий раскладку сегмента разделяемой памяти сервера игр.
+ *
+ * Сегмент начинается с заголовка ShmHeader размером shmHeaderSize байт, за которым идут
+ * ringSlots ячеек по slotSize байт. Клиент пишет команду и действия в ячейку
+ * requestSeq % ringSlots и увеличивает requestSeq; сервер выполняет команду, пишет наблюдения,
+ * награды и флаги окончания прямо в ту же ячейку и увеличивает responseSeq. Оба счетчика
+ * только растут (с переполнением), а ожидание построено на futex по их адресам, поэтому
+ * клиент может держать в полете до ringSlots запросов. Количество ячеек является степенью
+ * двойки: иначе при переполнении requestSeq два запроса в полете попадают в одну ячейку.
+ *
+ * Раскладка сегмента является частью протокола: клиенты на других языках повторяют ее по
+ * смещениям, указанным в комментариях, и проверяют shmMagic и shmVersion.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Сигнатура сегмента ("INVS").
+ */
+constexpr uint32_t shmMagic = 0x53564e49;
+
+/**
+ * @brief Версия протокола. Увеличивается при любом изменении раскладки.
+ */
+constexpr uint32_t shmVersion = 1;
+
+/**
+ * @brief Размер заголовка сегмента в байтах.
+ */
+constexpr size_t shmHeaderSize = 256;
+
+/**
+ * @brief Выравнивание массивов внутри ячейки в байтах.
+ */
+constexpr size_t shmAlignment = 64;
+
+/**
+ * @brief Команды клиента.
+ */
+enum ShmCommand : uint32_t {
+    /**
+     * @brief Один тик во всех играх с действиями из ячейки.
+     */
+    SHM_STEP = 0,
+    /**
+     * @brief Перезапуск всех игр; игра i получает начальное значение seed + i, если seed не равен 0.
+     */
+    SHM_RESET = 1
+};
+
+/**
+ * @struct ShmHeader
+ * @brief Заголовок сегмента.
+ *
+ * Поля до serverPid записываются сервером один раз при создании сегмента. Счетчики лежат
+ * в разных строках кэша, чтобы запись клиента не сбрасывала строку, которую опрашивает сервер.
+ */
+struct ShmHeader {
+    /**
+     * @brief Смещение 0: shmMagic.
+     */
+    uint32_t magic;
+    /**
+     * @brief Смещение 4: shmVersion.
+     */
+    uint32_t version;
+    /**
+     * @brief Смещение 8: количество игр.
+     */
+    uint32_t numEnvs;
+    /**
+     * @brief Смещение 12: тип наблюдения (INVADERS_OBS_*).
+     */
+    uint32_t observationType;
+    /**
+     * @brief Смещение 16: количество элементов наблюдения одной игры.
+     */
+    uint32_t observationSize;
+    /**
+     * @brief Смещение 20: размер элемента наблюдения в байтах.
+     */
+    uint32_t elementSize;
+    /**
+     * @brief Смещение 24: количество ячеек в кольце (степень двойки).
+     */
+    uint32_t ringSlots;
+    /**
+     * @brief Смещение 28: размер ячейки в байтах.
+     */
+    uint32_t slotSize;
+    /**
+     * @brief Смещение 32: идентификатор процесса сервера или 0, если сервер остановлен.
+     */
+    std::atomic<uint32_t> serverPid;
+    /**
+     * @brief Смещение 36: идентификатор процесса подключенного клиента или 0.
+     */
+    std::atomic<uint32_t> clientPid;
+    /**
+     * @brief Смещение 64: количество отправленных запросов.
+     */
+    alignas(64) std::atomic<uint32_t> requestSeq;
+    /**
+     * @brief Смещение 128: количество выполненных запросов.
+     */
+    alignas(64) std::atomic<uint32_t> responseSeq;
+};
+
+static_assert(sizeof(ShmHeader) <= shmHeaderSize, "ShmHeader must fit into shmHeaderSize");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex words must be plain 32-bit integers");
+
+/**
+ * @brief Проверяет, что количество ячеек кольца допустимо.
+ *
+ * @param ringSlots Количество ячеек.
+ * @return true, если ringSlots является степенью двойки.
+ */
+inline bool IsValidRingSize(uint32_t ringSlots) {
+    return ringSlots != 0 && (ringSlots & (ringSlots - 1)) == 0;
+}
+
+/**
+ * @struct ShmSlotLayout
+ * @brief Смещения массивов внутри ячейки.
+ *
+ * Ячейка начинается со строки кэша с командой (uint32 по смещению 0) и начальным значением
+ * генератора (uint32 по смещению 4). Далее идут массивы, каждый выровнен на shmAlignment:
+ * действия int32[numEnvs], награды float32[numEnvs], флаги окончания uint8[numEnvs] и
+ * наблюдения всех игр подряд.
+ */
+struct ShmSlotLayout {
+    /**
+     * @brief Смещение действий.
+     */
+    size_t actions;
+    /**
+     * @brief Смещение наград.
+     */
+    size_t rewards;
+    /**
+     * @brief Смещение флагов окончания.
+     */
+    size_t dones;
+    /**
+     * @brief Смещение наблюдений.
+     */
+    size_t observations;
+    /**
+     * @brief Размер ячейки.
+     */
+    size_t size;
+
+    /**
+     * @brief Вычисляет раскладку ячейки.
+     *
+     * @param numEnvs Количество игр.
+     * @param observationBytes Размер наблюдения одной игры в байтах.
+     * @return Раскладка ячейки.
+     */
+    static ShmSlotLayout For(size_t numEnvs, size_t observationBytes) {
+        ShmSlotLayout layout;
+        layout.actions = shmAlignment;
+        layout.rewards = layout.actions + AlignUp(numEnvs * sizeof(int32_t));
+        layout.dones = layout.rewards + AlignUp(numEnvs * sizeof(float));
+        layout.observations = layout.dones + AlignUp(numEnvs);
+        layout.size = layout.observations + AlignUp(numEnvs * observationBytes);
+        return layout;
+    }
+
+    /**
+     * @brief Округляет размер вверх до shmAlignment.
+     *
+     * @param size Размер в байтах.
+     */
+    static size_t AlignUp(size_t size) {
+        return (size + shmAlignment - 1) / shmAlignment * shmAlignment;
+    }
+};
@@ -0,0 +1,148 @@
+/**
+ * @file shmserver.cpp
+ * @brief Сервер игр без окна для обучения агентов в отдельных процессах через разделяемую память.
+ *
+ * Запуск: invaders_shm_server [--name /invaders_env] [--envs 16] [--pixels WxHxS] [--slots 4] [--seed 1]
+ *
+ * Сервер создает сегмент (см. shmprotocol.hpp) и выполняет запросы клиента по порядку, записывая
+ * результаты прямо в ячейки кольца. Клиенты подключаются и отключаются без перезапуска сервера;
+ * сегмент процесса, завершившегося без отключения, освобождается автоматически.
+ */
+
+#include "invadersenv.h"
+#include "shmchannel.hpp"
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/**
+ * @brief Флаг остановки сервера по сигналу.
+ */
+static volatile sig_atomic_t stopRequested = 0;
+
+/**
+ * @brief Обработчик SIGINT и SIGTERM.
+ *
+ * @param signal Номер сигнала.
+ */
+
+static void RequestStop(int signal) {
+    (void) signal;
+    stopRequested = 1;
+}
+
+/**
+ * @brief Выполняет команду из ячейки кольца.
+ *
+ * @param env Набор игр.
+ * @param channel Канал сервера.
+ * @param slot Ячейка кольца.
+ */
+
+static void Execute(InvadersEnv *env, ShmChannel &channel, unsigned char *slot) {
+    uint32_t command;
+    uint32_t seed;
+    memcpy(&command, slot, sizeof(command));
+    memcpy(&seed, slot + sizeof(command), sizeof(seed));
+
+    const ShmSlotLayout &layout = channel.layout;
+    void *observations = slot + layout.observations;
+    float *rewards = (float *) (slot + layout.rewards);
+    uint8_t *dones = (uint8_t *) (slot + layout.dones);
+
+    if (command == SHM_RESET) {
+        int count = invaders_env_num_envs(env);
+        size_t observationBytes = (size_t) channel.Header()->observationSize * channel.Header()->elementSize;
+        for (int i = 0; i < count; ++i) {
+            invaders_env_reset(env, i, seed != 0 ? seed + i : 0, (unsigned char *) observations + i * observationBytes);
+        }
+        memset(rewards, 0, sizeof(float) * count);
+        memset(dones, 0, count);
+        return;
+    }
+    invaders_env_step_all(env, (const int32_t *) (slot + layout.actions), observations, rewards, dones);
+}
+
+/**
+ * @brief Главная функция сервера.
+ *
+ * @param argc Количество аргументов командной строки.
+ * @param argv Аргументы командной строки.
+ * @return 0 при штатной остановке, 1 при ошибке.
+ */
+
+int main(int argc, char **argv) {
+    const char *name = "/invaders_env";
+    int numEnvs = 16;
+    int observationType = INVADERS_OBS_FEATURES;
+    int width = 84;
+    int height = 84;
+    int stack = 4;
+    int slots = 4;
+    uint32_t seed = 1;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--name") == 0) {
+            name = argv[i + 1];
+        } else if (strcmp(argv[i], "--envs") == 0) {
+            numEnvs = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--pixels") == 0) {
+            observationType = INVADERS_OBS_PIXELS;
+            if (sscanf(argv[i + 1], "%dx%dx%d", &width, &height, &stack) != 3) {
+                fprintf(stderr, "--pixels expects WxHxS\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--slots") == 0) {
+            slots = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            seed = (uint32_t) strtoul(argv[i + 1], nullptr, 10);
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (slots <= 0 || !IsValidRingSize((uint32_t) slots)) {
+        fprintf(stderr, "--slots must be a power of two\n");
+        return 1;
+    }
+
+    InvadersEnv *env = invaders_env_create(numEnvs, observationType, width, height, stack, 1, seed);
+    if (env == nullptr) {
+        fprintf(stderr, "invalid environment parameters\n");
+        return 1;
+    }
+
+    ShmChannel channel;
+    uint32_t elementSize = observationType == INVADERS_OBS_PIXELS ? sizeof(uint8_t) : sizeof(float);
+    if (!channel.Create(name, numEnvs, observationType, invaders_env_observation_size(env), elementSize, slots)) {
+        perror("shm_open");
+        invaders_env_destroy(env);
+        return 1;
+    }
+
+    signal(SIGINT, RequestStop);
+    signal(SIGTERM, RequestStop);
+    printf("serving %d environments on %s\n", numEnvs, name);
+    fflush(stdout);
+
+    ShmHeader *header = channel.Header();
+    uint32_t processed = header->responseSeq.load();
+    while (!stopRequested) {
+        if (header->requestSeq.load(std::memory_order_acquire) == processed) {
+            // Таймаут нужен, чтобы замечать сигналы и клиентов, завершившихся без отключения
+            if (!ShmChannel::Wait(header->requestSeq, processed, 2000, 100)) {
+                channel.ReclaimDeadClient();
+                continue;
+            }
+        }
+        Execute(env, channel, channel.Slot(processed));
+        processed++;
+        header->responseSeq.store(processed, std::memory_order_release);
+        ShmChannel::Wake(header->responseSeq);
+    }
+
+    channel.Close();
+    invaders_env_destroy(env);
+    return 0;
+}
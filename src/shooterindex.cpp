@@ -0,0 +1,164 @@
+/**
+ * @file shooterindex.cpp
+ * @brief Файл реализации, содержащий методы класса ShooterIndex.
+ */
+
+#include "shooterindex.hpp"
+#include <algorithm>
+
+/**
+ * @brief Возвращает номер старшего установленного бита.
+ *
+ * @param mask Ненулевая маска.
+ * @return Номер старшего бита.
+ */
+
+static int HighestBit(uint64_t mask) {
+    return 63 - __builtin_clzll(mask);
+}
+
+/**
+ * @brief Конструктор класса ShooterIndex.
+ *
+ * Создает пустой индекс без рядов и столбцов.
+ */
+
+ShooterIndex::ShooterIndex() {
+    rowMask = 0;
+    rows = 0;
+}
+
+/**
+ * @brief Заполняет индекс для формации заданного размера.
+ *
+ * @param rows Количество рядов (не больше maxRows).
+ * @param columns Количество столбцов.
+ */
+
+void ShooterIndex::Reset(int rows, int columns) {
+    this->rows = rows < maxRows ? rows : maxRows;
+    columnMasks.assign(columns, 0);
+    rowCounts.assign(this->rows, 0);
+    rowMask = 0;
+    activeColumns.clear();
+    activeColumns.reserve(columns);
+}
+
+/**
+ * @brief Отмечает инопланетянина в ячейке как живого.
+ *
+ * @param row Ряд инопланетянина.
+ * @param column Столбец инопланетянина.
+ */
+
+void ShooterIndex::Add(int row, int column) {
+    if (row < 0 || row >= rows || column < 0 || column >= Columns() || IsAlive(row, column)) {
+        return;
+    }
+    if (columnMasks[column] == 0) {
+        activeColumns.insert(std::lower_bound(activeColumns.begin(), activeColumns.end(), column), column);
+    }
+    columnMasks[column] |= uint64_t(1) << row;
+    rowCounts[row]++;
+    rowMask |= uint64_t(1) << row;
+}
+
+/**
+ * @brief Отмечает инопланетянина в ячейке как уничтоженного.
+ *
+ * Опустевший столбец удаляется из списка непустых со сдвигом следующих, чтобы список оставался упорядоченным.
+ *
+ * @param row Ряд инопланетянина.
+ * @param column Столбец инопланетянина.
+ */
+
+void ShooterIndex::Remove(int row, int column) {
+    if (!IsAlive(row, column)) {
+        return;
+    }
+    columnMasks[column] &= ~(uint64_t(1) << row);
+    if (--rowCounts[row] == 0) {
+        rowMask &= ~(uint64_t(1) << row);
+    }
+    if (columnMasks[column] == 0) {
+        activeColumns.erase(std::lower_bound(activeColumns.begin(), activeColumns.end(), column));
+    }
+}
+
+/**
+ * @brief Проверяет, жив ли инопланетянин в ячейке.
+ *
+ * @param row Ряд ячейки.
+ * @param column Столбец ячейки.
+ * @return true, если инопланетянин жив.
+ */
+
+bool ShooterIndex::IsAlive(int row, int column) const {
+    if (row < 0 || row >= rows || column < 0 || column >= Columns()) {
+        return false;
+    }
+    return (columnMasks[column] >> row) & 1;
+}
+
+/**
+ * @brief Возвращает ряд самого нижнего живого инопланетянина в столбце.
+ *
+ * @param column Столбец формации.
+ * @return Номер ряда или -1, если столбец пуст.
+ */
+
+int ShooterIndex::BottomRow(int column) const {
+    if (column < 0 || column >= Columns() || columnMasks[column] == 0) {
+        return -1;
+    }
+    return HighestBit(columnMasks[column]);
+}
+
+/**
+ * @brief Возвращает самый нижний ряд, в котором есть живые инопланетяне.
+ *
+ * @return Номер ряда или -1, если формация пуста.
+ */
+
+int ShooterIndex::BottomRow() const {
+    return rowMask == 0 ? -1 : HighestBit(rowMask);
+}
+
+/**
+ * @brief Возвращает количество непустых столбцов.
+ *
+ * @return Количество столбцов, в которых есть хотя бы один живой инопланетянин.
+ */
+
+int ShooterIndex::ActiveColumnCount() const {
+    return activeColumns.size();
+}
+
+/**
+ * @brief Возвращает непустой столбец по его порядковому номеру.
+ *
+ * Непустые столбцы идут по возрастанию номера.
+ *
+ * @param i Номер от 0 до ActiveColumnCount() - 1.
+ * @return Номер столбца формации.
+ */
+
+int ShooterIndex::ActiveColumn(int i) const {
+    return activeColumns[i];
+}
+
+/**
+ * @brief Возвращает количество рядов формации.
+ */
+
+int ShooterIndex::Rows() const {
+    return rows;
+}
+
+/**
+ * @brief Возвращает количество столбцов формации.
+ */
+
+int ShooterIndex::Columns() const {
+    return columnMasks.size();
+}
@@ -0,0 +1,136 @@
+/**
+ * @file shooterindex.hpp
+ * @brief Заголовочный файл, содержащий класс ShooterIndex.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class ShooterIndex
+ * @brief Индекс живых инопланетян по столбцам формации.
+ *
+ * Для каждого столбца хранит битовую маску живых рядов, поэтому самый нижний живой инопланетянин
+ * столбца, случайный непустой столбец и нижний ряд всей формации находятся за O(1).
+ * Удаление инопланетянина также выполняется за O(1), кроме удаления последнего в столбце:
+ * тогда столбец за O(столбцов) убирается из списка непустых. Поддерживается до 64 рядов.
+ *
+ * Состояние индекса зависит только от набора живых инопланетян, но не от порядка их добавления
+ * и удаления, поэтому индекс, перестроенный после восстановления снимка, выбирает те же столбцы.
+ */
+
+class ShooterIndex {
+public:
+    /**
+     * @brief Максимальное количество рядов в формации.
+     */
+    constexpr static int maxRows = 64;
+
+    /**
+     * @brief Конструктор класса ShooterIndex.
+     *
+     * Создает пустой индекс без рядов и столбцов.
+     */
+    ShooterIndex();
+
+    /**
+     * @brief Заполняет индекс для формации заданного размера.
+     *
+     * Все ячейки формации считаются пустыми; живые инопланетяне добавляются методом Add.
+     *
+     * @param rows Количество рядов (не больше maxRows).
+     * @param columns Количество столбцов.
+     */
+    void Reset(int rows, int columns);
+
+    /**
+     * @brief Отмечает инопланетянина в ячейке как живого.
+     *
+     * @param row Ряд инопланетянина.
+     * @param column Столбец инопланетянина.
+     */
+    void Add(int row, int column);
+
+    /**
+     * @brief Отмечает инопланетянина в ячейке как уничтоженного.
+     *
+     * @param row Ряд инопланетянина.
+     * @param column Столбец инопланетянина.
+     */
+    void Remove(int row, int column);
+
+    /**
+     * @brief Проверяет, жив ли инопланетянин в ячейке.
+     *
+     * @param row Ряд ячейки.
+     * @param column Столбец ячейки.
+     * @return true, если инопланетянин жив.
+     */
+    bool IsAlive(int row, int column) const;
+
+    /**
+     * @brief Возвращает ряд самого нижнего живого инопланетянина в столбце.
+     *
+     * @param column Столбец формации.
+     * @return Номер ряда или -1, если столбец пуст.
+     */
+    int BottomRow(int column) const;
+
+    /**
+     * @brief Возвращает самый нижний ряд, в котором есть живые инопланетяне.
+     *
+     * @return Номер ряда или -1, если формация пуста.
+     */
+    int BottomRow() const;
+
+    /**
+     * @brief Возвращает количество непустых столбцов.
+     *
+     * @return Количество столбцов, в которых есть хотя бы один живой инопланетянин.
+     */
+    int ActiveColumnCount() const;
+
+    /**
+     * @brief Возвращает непустой столбец по его порядковому номеру.
+     *
+     * Непустые столбцы идут по возрастанию номера, что позволяет выбрать случайный столбец за O(1).
+     *
+     * @param i Номер от 0 до ActiveColumnCount() - 1.
+     * @return Номер столбца формации.
+     */
+    int ActiveColumn(int i) const;
+
+    /**
+     * @brief Возвращает количество рядов формации.
+     */
+    int Rows() const;
+
+    /**
+     * @brief Возвращает количество столбцов формации.
+     */
+    int Columns() const;
+
+private:
+    /**
+     * @brief Маски живых рядов для каждого столбца (бит r соответствует ряду r).
+     */
+    std::vector<uint64_t> columnMasks;
+    /**
+     * @brief Количество живых инопланетян в каждом ряду.
+     */
+    std::vector<int> rowCounts;
+    /**
+     * @brief Маска непустых рядов.
+     */
+    uint64_t rowMask;
+    /**
+     * @brief Плотный список непустых столбцов по возрастанию.
+     */
+    std::vector<int> activeColumns;
+    /**
+     * @brief Количество рядов формации.
+     */
+    int rows;
+};
@@ -0,0 +1,527 @@
+/**
+ * @file softwarerenderer.cpp
+ * @brief Файл реализации, содержащий методы класса SoftwareRenderer.
+ */
+
+#include "softwarerenderer.hpp"
+#include "platform.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+/**
+ * @brief Цвет фона (как в main.cpp).
+ */
+
+static const Color grey = {29, 29, 27, 255};
+
+/**
+ * @brief Цвет рамки, текста, лазеров и щитов (как в main.cpp).
+ */
+
+static const Color yellow = {243, 216, 63, 255};
+
+/**
+ * @brief Размер шрифта HUD.
+ */
+
+static const float fontSize = 34;
+
+/**
+ * @brief Межбуквенный интервал HUD.
+ */
+
+static const float fontSpacing = 2;
+
+/**
+ * @brief Возвращает яркость цвета.
+ *
+ * @param r Красная компонента.
+ * @param g Зеленая компонента.
+ * @param b Синяя компонента.
+ * @return Яркость по формуле ITU-R BT.601.
+ */
+
+static unsigned char Luminance(unsigned char r, unsigned char g, unsigned char b) {
+    return (77 * r + 150 * g + 29 * b + 128) >> 8;
+}
+
+/**
+ * @brief Смешивает компоненту цвета с учетом прозрачности.
+ *
+ * @param source Компонента рисуемого цвета.
+ * @param destination Компонента цвета в буфере.
+ * @param alpha Непрозрачность рисуемого цвета.
+ * @return Результат смешивания (как GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA).
+ */
+
+static unsigned char BlendChannel(int source, int destination, int alpha) {
+    return (source * alpha + destination * (255 - alpha) + 127) / 255;
+}
+
+/**
+ * @brief Возвращает первый пиксель, центр которого лежит не левее координаты.
+ *
+ * Так растеризатор OpenGL определяет пиксели, покрытые текстурой, нарисованной в позиции x.
+ *
+ * @param x Координата края.
+ * @return Номер пикселя.
+ */
+
+static int PixelAt(float x) {
+    return (int) std::ceil(x - 0.5f);
+}
+
+/**
+ * @brief Загружает изображение в оперативную память.
+ *
+ * @param fileName Путь к изображению.
+ * @return Спрайт с пикселями RGBA и их яркостью.
+ */
+
+static SoftwareRenderer::Sprite LoadSprite(const char *fileName) {
+    SoftwareRenderer::Sprite sprite;
+    Image image = LoadGameImage(fileName);
+    if (image.data == nullptr) {
+        return sprite;
+    }
+    sprite.width = image.width;
+    sprite.height = image.height;
+    const unsigned char *data = (const unsigned char *) image.data;
+    sprite.rgba.assign(data, data + image.width * image.height * 4);
+    sprite.gray.resize(image.width * image.height);
+    for (int i = 0; i < image.width * image.height; ++i) {
+        sprite.gray[i] = Luminance(data[i * 4], data[i * 4 + 1], data[i * 4 + 2]);
+    }
+    UnloadGameImage(image);
+    return sprite;
+}
+
+namespace {
+
+/**
+ * @struct RgbaCanvas
+ * @brief Буфер кадра в формате RGBA.
+ */
+
+struct RgbaCanvas {
+    unsigned char *pixels;
+    int width;
+    int height;
+
+    void Fill(int x0, int y0, int x1, int y1, Color color) {
+        x0 = std::max(x0, 0);
+        y0 = std::max(y0, 0);
+        x1 = std::min(x1, width);
+        y1 = std::min(y1, height);
+        for (int y = y0; y < y1; ++y) {
+            unsigned char *pixel = pixels + ((size_t) y * width + x0) * 4;
+            for (int x = x0; x < x1; ++x, pixel += 4) {
+                pixel[0] = color.r;
+                pixel[1] = color.g;
+                pixel[2] = color.b;
+                pixel[3] = 255;
+            }
+        }
+    }
+
+    void Blend(int x, int y, Color color, int alpha) {
+        unsigned char *pixel = pixels + ((size_t) y * width + x) * 4;
+        pixel[0] = BlendChannel(color.r, pixel[0], alpha);
+        pixel[1] = BlendChannel(color.g, pixel[1], alpha);
+        pixel[2] = BlendChannel(color.b, pixel[2], alpha);
+        pixel[3] = 255;
+    }
+
+    void Blit(const SoftwareRenderer::Sprite &sprite, float positionX, float positionY) {
+        int left = PixelAt(positionX);
+        int top = PixelAt(positionY);
+        int x0 = std::max(0, -left);
+        int y0 = std::max(0, -top);
+        int x1 = std::min(sprite.width, width - left);
+        int y1 = std::min(sprite.height, height - top);
+        for (int y = y0; y < y1; ++y) {
+            const unsigned char *source = sprite.rgba.data() + ((size_t) y * sprite.width + x0) * 4;
+            unsigned char *pixel = pixels + ((size_t) (top + y) * width + left + x0) * 4;
+            for (int x = x0; x < x1; ++x, source += 4, pixel += 4) {
+                int alpha = source[3];
+                if (alpha == 255) {
+                    pixel[0] = source[0];
+                    pixel[1] = source[1];
+                    pixel[2] = source[2];
+                    pixel[3] = 255;
+                } else if (alpha != 0) {
+                    pixel[0] = BlendChannel(source[0], pixel[0], alpha);
+                    pixel[1] = BlendChannel(source[1], pixel[1], alpha);
+                    pixel[2] = BlendChannel(source[2], pixel[2], alpha);
+                    pixel[3] = 255;
+                }
+            }
+        }
+    }
+};
+
+/**
+ * @struct GrayCanvas
+ * @brief Буфер кадра в оттенках серого.
+ */
+
+struct GrayCanvas {
+    unsigned char *pixels;
+    int width;
+    int height;
+
+    void Fill(int x0, int y0, int x1, int y1, Color color) {
+        x0 = std::max(x0, 0);
+        y0 = std::max(y0, 0);
+        x1 = std::min(x1, width);
+        y1 = std::min(y1, height);
+        unsigned char value = Luminance(color.r, color.g, color.b);
+        for (int y = y0; y < y1 && x0 < x1; ++y) {
+            memset(pixels + (size_t) y * width + x0, value, x1 - x0);
+        }
+    }
+
+    void Blend(int x, int y, Color color, int alpha) {
+        unsigned char *pixel = pixels + (size_t) y * width + x;
+        *pixel = BlendChannel(Luminance(color.r, color.g, color.b), *pixel, alpha);
+    }
+
+    void Blit(const SoftwareRenderer::Sprite &sprite, float positionX, float positionY) {
+        int left = PixelAt(positionX);
+        int top = PixelAt(positionY);
+        int x0 = std::max(0, -left);
+        int y0 = std::max(0, -top);
+        int x1 = std::min(sprite.width, width - left);
+        int y1 = std::min(sprite.height, height - top);
+        for (int y = y0; y < y1; ++y) {
+            const unsigned char *source = sprite.gray.data() + (size_t) y * sprite.width + x0;
+            const unsigned char *alpha = sprite.rgba.data() + ((size_t) y * sprite.width + x0) * 4 + 3;
+            unsigned char *pixel = pixels + (size_t) (top + y) * width + left + x0;
+            for (int x = x0; x < x1; ++x, ++source, alpha += 4, ++pixel) {
+                if (*alpha == 255) {
+                    *pixel = *source;
+                } else if (*alpha != 0) {
+                    *pixel = BlendChannel(*source, *pixel, *alpha);
+                }
+            }
+        }
+    }
+};
+
+}
+
+/**
+ * @brief Конструктор класса SoftwareRenderer.
+ *
+ * Загружает изображения спрайтов и глифы шрифта в оперативную память и растеризует
+ * неподвижный слой кадра размером ScreenWidth() x ScreenHeight().
+ */
+
+SoftwareRenderer::SoftwareRenderer() {
+    width = ScreenWidth();
+    height = ScreenHeight();
+
+    alienSprites[0] = LoadSprite("../Graphics/alien_1.png");
+    alienSprites[1] = LoadSprite("../Graphics/alien_2.png");
+    alienSprites[2] = LoadSprite("../Graphics/alien_3.png");
+    spaceshipSprite = LoadSprite("../Graphics/spaceship.png");
+    mysterySprite = LoadSprite("../Graphics/mystery.png");
+
+    // Те же параметры, что и у LoadFontEx("../Font/monogram.ttf", 64, 0, 0) в main.cpp
+    fontBaseSize = 64;
+    const AssetEntry *fontEntry = FindGameAsset("../Font/monogram.ttf", ASSET_FONT);
+    if (fontEntry != nullptr && (int) fontEntry->params[0] == fontBaseSize &&
+        fontEntry->params[5] == PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA) {
+        // Символы вырезаются из готового атласа архива: яркость - второй байт пикселя
+        const uint8_t *data = GameAssetData(*fontEntry);
+        int glyphCount = fontEntry->params[1];
+        int atlasWidth = fontEntry->params[3];
+        const PackedGlyph *packedGlyphs = (const PackedGlyph *) data;
+        const PackedRect *packedRects = (const PackedRect *) (data + glyphCount * sizeof(PackedGlyph));
+        const uint8_t *atlas = data + FontAtlasOffset(glyphCount);
+        glyphs.resize(glyphCount);
+        for (int i = 0; i < glyphCount; ++i) {
+            Glyph &glyph = glyphs[i];
+            glyph.offsetX = packedGlyphs[i].offsetX;
+            glyph.offsetY = packedGlyphs[i].offsetY;
+            glyph.advanceX = packedGlyphs[i].advanceX;
+            glyph.width = (int) packedRects[i].width;
+            glyph.height = (int) packedRects[i].height;
+            glyph.alpha.resize(glyph.width * glyph.height);
+            for (int y = 0; y < glyph.height; ++y) {
+                for (int x = 0; x < glyph.width; ++x) {
+                    int atlasX = (int) packedRects[i].x + x;
+                    int atlasY = (int) packedRects[i].y + y;
+                    glyph.alpha[y * glyph.width + x] = atlas[(atlasY * atlasWidth + atlasX) * 2 + 1];
+                }
+            }
+        }
+    }
+    unsigned int fileSize = 0;
+    unsigned char *fileData = glyphs.empty() ? LoadFileData("../Font/monogram.ttf", &fileSize) : nullptr;
+    if (fileData != nullptr) {
+        GlyphInfo *fontGlyphs = LoadFontData(fileData, fileSize, fontBaseSize, nullptr, 95, FONT_DEFAULT);
+        if (fontGlyphs != nullptr) {
+            glyphs.resize(95);
+            for (int i = 0; i < 95; ++i) {
+                Glyph &glyph = glyphs[i];
+                glyph.offsetX = fontGlyphs[i].offsetX;
+                glyph.offsetY = fontGlyphs[i].offsetY;
+                glyph.advanceX = fontGlyphs[i].advanceX;
+                glyph.width = fontGlyphs[i].image.width;
+                glyph.height = fontGlyphs[i].image.height;
+                const unsigned char *alpha = (const unsigned char *) fontGlyphs[i].image.data;
+                if (alpha != nullptr) {
+                    glyph.alpha.assign(alpha, alpha + glyph.width * glyph.height);
+                }
+            }
+            UnloadFontData(fontGlyphs, 95);
+        }
+        UnloadFileData(fileData);
+    }
+
+    staticRgba.resize((size_t) width * height * 4);
+    staticGray.resize((size_t) width * height);
+    grayFrame.resize((size_t) width * height);
+    RgbaCanvas rgba = {staticRgba.data(), width, height};
+    GrayCanvas gray = {staticGray.data(), width, height};
+    DrawStaticLayer(rgba);
+    DrawStaticLayer(gray);
+}
+
+/**
+ * @brief Возвращает ширину полноразмерного кадра.
+ */
+
+int SoftwareRenderer::Width() const {
+    return width;
+}
+
+/**
+ * @brief Возвращает высоту полноразмерного кадра.
+ */
+
+int SoftwareRenderer::Height() const {
+    return height;
+}
+
+/**
+ * @brief Рисует полноразмерный кадр в формате RGBA.
+ *
+ * @param game Игра, состояние которой нужно нарисовать.
+ * @param pixels Буфер размером Width() * Height() * 4 байт.
+ */
+
+void SoftwareRenderer::RenderRgba(Game &game, unsigned char *pixels) {
+    memcpy(pixels, staticRgba.data(), staticRgba.size());
+    RgbaCanvas canvas = {pixels, width, height};
+    DrawScene(game, canvas);
+}
+
+/**
+ * @brief Рисует кадр в оттенках серого, уменьшенный усреднением по площади.
+ *
+ * @param game Игра, состояние которой нужно нарисовать.
+ * @param pixels Буфер размером width * height байт.
+ * @param width Ширина уменьшенного кадра.
+ * @param height Высота уменьшенного кадра.
+ */
+
+void SoftwareRenderer::RenderGray(Game &game, unsigned char *pixels, int width, int height) {
+    memcpy(grayFrame.data(), staticGray.data(), staticGray.size());
+    GrayCanvas canvas = {grayFrame.data(), this->width, this->height};
+    DrawScene(game, canvas);
+
+    if (width == this->width && height == this->height) {
+        memcpy(pixels, grayFrame.data(), grayFrame.size());
+        return;
+    }
+
+    if ((int) columnBounds.size() != width + 1 || (int) rowBounds.size() != height + 1) {
+        columnBounds.resize(width + 1);
+        rowBounds.resize(height + 1);
+        for (int x = 0; x <= width; ++x) {
+            columnBounds[x] = (int) ((long long) x * this->width / width);
+        }
+        for (int y = 0; y <= height; ++y) {
+            rowBounds[y] = (int) ((long long) y * this->height / height);
+        }
+    }
+
+    for (int y = 0; y < height; ++y) {
+        int top = rowBounds[y];
+        int bottom = std::max(rowBounds[y + 1], top + 1);
+        for (int x = 0; x < width; ++x) {
+            int left = columnBounds[x];
+            int right = std::max(columnBounds[x + 1], left + 1);
+            unsigned int sum = 0;
+            for (int row = top; row < bottom; ++row) {
+                const unsigned char *source = grayFrame.data() + (size_t) row * this->width;
+                for (int column = left; column < right; ++column) {
+                    sum += source[column];
+                }
+            }
+            unsigned int area = (bottom - top) * (right - left);
+            pixels[y * width + x] = (sum + area / 2) / area;
+        }
+    }
+}
+
+/**
+ * @brief Рисует кадр в оттенках серого в стопку последних кадров.
+ *
+ * Кадры в буфере сдвигаются на один к началу, новый кадр записывается последним.
+ *
+ * @param game Игра, состояние которой нужно нарисовать.
+ * @param frames Буфер размером stackSize * width * height байт.
+ * @param width Ширина уменьшенного кадра.
+ * @param height Высота уменьшенного кадра.
+ * @param stackSize Количество кадров в стопке.
+ */
+
+void SoftwareRenderer::RenderGrayStack(Game &game, unsigned char *frames, int width, int height, int stackSize) {
+    size_t frameSize = (size_t) width * height;
+    if (stackSize > 1) {
+        memmove(frames, frames + frameSize, frameSize * (stackSize - 1));
+    }
+    RenderGray(game, frames + frameSize * (stackSize - 1), width, height);
+}
+
+/**
+ * @brief Растеризует неподвижный слой кадра.
+ *
+ * Фон, скругленная рамка, линия над панелью жизней и подписи SCORE и HIGH-SCORE.
+ */
+
+template <typename Canvas>
+void SoftwareRenderer::DrawStaticLayer(Canvas &canvas) {
+    canvas.Fill(0, 0, width, height, grey);
+
+    // DrawRectangleRoundedLines({10, 10, 780, 780}, 0.18f, 20, 2, yellow): линия толщиной 2
+    // снаружи прямоугольника со скруглением радиуса 780 * 0.18 / 2
+    const float frameX = 10, frameY = 10, frameSize = 780, lineThick = 2;
+    const float radius = frameSize * 0.18f / 2;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            float centerX = x + 0.5f;
+            float centerY = y + 0.5f;
+            float nearestX = std::min(std::max(centerX, frameX + radius), frameX + frameSize - radius);
+            float nearestY = std::min(std::max(centerY, frameY + radius), frameY + frameSize - radius);
+            float distance = std::hypot(centerX - nearestX, centerY - nearestY);
+            if (distance >= radius && distance < radius + lineThick) {
+                canvas.Blend(x, y, yellow, 255);
+            }
+        }
+    }
+
+    // DrawLineEx({25, 730}, {775, 730}, 3, yellow)
+    canvas.Fill(25, PixelAt(730 - 1.5f), 775, PixelAt(730 + 1.5f), yellow);
+
+    DrawHudText(canvas, "SCORE", 50, 15);
+    DrawHudText(canvas, "HIGH-SCORE", 570, 15);
+}
+
+/**
+ * @brief Рисует динамическую часть кадра поверх неподвижного слоя.
+ *
+ * Повторяет порядок отрисовки main.cpp и Game::Draw.
+ */
+
+template <typename Canvas>
+void SoftwareRenderer::DrawScene(Game &game, Canvas &canvas) {
+    char text[16];
+    snprintf(text, sizeof(text), "LEVEL %02d", game.level);
+    DrawHudText(canvas, game.run ? text : "GAME OVER", 570, 740);
+
+    float x = 50.0;
+    for (int i = 0; i < game.lives; i++) {
+        canvas.Blit(spaceshipSprite, x, 745);
+        x += 50;
+    }
+
+    snprintf(text, sizeof(text), "%05d", game.score);
+    DrawHudText(canvas, text, 50, 40);
+    snprintf(text, sizeof(text), "%05d", game.highscore);
+    DrawHudText(canvas, text, 655, 40);
+
+    Rectangle ship = game.spaceship.getRect();
+    canvas.Blit(spaceshipSprite, ship.x, ship.y);
+
+    // DrawRectangle принимает целые координаты, поэтому позиции отбрасывают дробную часть
+    for (auto &laser: game.spaceship.lasers) {
+        if (laser.active) {
+            int laserX = (int) laser.position.x, laserY = (int) laser.position.y;
+            canvas.Fill(laserX, laserY, laserX + 4, laserY + 15, yellow);
+        }
+    }
+
+    for (auto &obstacle: game.obstacles) {
+        for (auto &block: obstacle.blocks) {
+            Rectangle rect = block.getRect();
+            int blockX = (int) rect.x, blockY = (int) rect.y;
+            canvas.Fill(blockX, blockY, blockX + 3, blockY + 3, yellow);
+        }
+    }
+
+    for (auto &alien: game.aliens) {
+        canvas.Blit(alienSprites[alien.type - 1], alien.position.x, alien.position.y);
+    }
+
+    for (auto &laser: game.alienLasers) {
+        if (laser.active) {
+            int laserX = (int) laser.position.x, laserY = (int) laser.position.y;
+            canvas.Fill(laserX, laserY, laserX + 4, laserY + 15, yellow);
+        }
+    }
+
+    if (game.mysteryship.alive) {
+        Rectangle mystery = game.mysteryship.getRect();
+        canvas.Blit(mysterySprite, mystery.x, mystery.y);
+    }
+}
+
+/**
+ * @brief Рисует строку шрифтом monogram размером 34 с межбуквенным интервалом 2.
+ *
+ * Раскладка совпадает с DrawTextEx; глифы масштабируются выборкой ближайшего пикселя.
+ */
+
+template <typename Canvas>
+void SoftwareRenderer::DrawHudText(Canvas &canvas, const char *text, float x, float y) {
+    if (glyphs.empty()) {
+        return;
+    }
+    float scale = fontSize / fontBaseSize;
+    float offset = 0;
+    for (const char *c = text; *c != '\0'; ++c) {
+        int index = (*c >= 32 && *c < 127) ? *c - 32 : '?' - 32;
+        const Glyph &glyph = glyphs[index];
+
+        if (*c != ' ' && !glyph.alpha.empty()) {
+            float left = x + offset + glyph.offsetX * scale;
+            float top = y + glyph.offsetY * scale;
+            int x0 = std::max(PixelAt(left), 0);
+            int y0 = std::max(PixelAt(top), 0);
+            int x1 = std::min(PixelAt(left + glyph.width * scale), canvas.width);
+            int y1 = std::min(PixelAt(top + glyph.height * scale), canvas.height);
+            for (int py = y0; py < y1; ++py) {
+                int sourceY = std::min((int) ((py + 0.5f - top) / scale), glyph.height - 1);
+                for (int px = x0; px < x1; ++px) {
+                    int sourceX = std::min((int) ((px + 0.5f - left) / scale), glyph.width - 1);
+                    int alpha = glyph.alpha[sourceY * glyph.width + sourceX];
+                    if (alpha != 0) {
+                        canvas.Blend(px, py, yellow, alpha);
+                    }
+                }
+            }
+        }
+
+        if (glyph.advanceX == 0) {
+            offset += glyph.width * scale + fontSpacing;
+        } else {
+            offset += glyph.advanceX * scale + fontSpacing;
+        }
+    }
+}
@@ -0,0 +1,194 @@
+/**
+ * @file softwarerenderer.hpp
+ * @brief Заголовочный файл, содержащий класс SoftwareRenderer.
+ */
+
+#pragma once
+
+#include "game.hpp"
+#include <vector>
+
+/**
+ * @class SoftwareRenderer
+ * @brief Программный растеризатор сцены для работы без окна и OpenGL.
+ *
+ * Рисует ту же сцену, что и основной цикл в main.cpp вместе с Game::Draw, в буфер вызывающей
+ * стороны: полноразмерный RGBA или уменьшенный в оттенках серого (например, 84x84) с возможностью
+ * накапливать несколько последних кадров. Спрайты копируются из изображений папки Graphics,
+ * загруженных в оперативную память, щиты заполняются по оставшимся блокам. Неподвижные части
+ * кадра (фон, рамка, подписи) растеризуются один раз при создании.
+ */
+
+class SoftwareRenderer {
+public:
+    /**
+     * @brief Конструктор класса SoftwareRenderer.
+     *
+     * Загружает изображения спрайтов и глифы шрифта в оперативную память и растеризует
+     * неподвижный слой кадра размером ScreenWidth() x ScreenHeight().
+     */
+    SoftwareRenderer();
+
+    /**
+     * @brief Возвращает ширину полноразмерного кадра.
+     */
+    int Width() const;
+
+    /**
+     * @brief Возвращает высоту полноразмерного кадра.
+     */
+    int Height() const;
+
+    /**
+     * @brief Рисует полноразмерный кадр в формате RGBA.
+     *
+     * @param game Игра, состояние которой нужно нарисовать.
+     * @param pixels Буфер размером Width() * Height() * 4 байт.
+     */
+    void RenderRgba(Game &game, unsigned char *pixels);
+
+    /**
+     * @brief Рисует кадр в оттенках серого, уменьшенный усреднением по площади.
+     *
+     * @param game Игра, состояние которой нужно нарисовать.
+     * @param pixels Буфер размером width * height байт.
+     * @param width Ширина уменьшенного кадра.
+     * @param height Высота уменьшенного кадра.
+     */
+    void RenderGray(Game &game, unsigned char *pixels, int width, int height);
+
+    /**
+     * @brief Рисует кадр в оттенках серого в стопку последних кадров.
+     *
+     * Кадры в буфере сдвигаются на один к началу, новый кадр записывается последним.
+     *
+     * @param game Игра, состояние которой нужно нарисовать.
+     * @param frames Буфер размером stackSize * width * height байт.
+     * @param width Ширина уменьшенного кадра.
+     * @param height Высота уменьшенного кадра.
+     * @param stackSize Количество кадров в стопке.
+     */
+    void RenderGrayStack(Game &game, unsigned char *frames, int width, int height, int stackSize);
+
+    /**
+     * @struct Sprite
+     * @brief Изображение в оперативной памяти с заранее посчитанной яркостью.
+     */
+    struct Sprite {
+        /**
+         * @brief Ширина изображения.
+         */
+        int width = 0;
+        /**
+         * @brief Высота изображения.
+         */
+        int height = 0;
+        /**
+         * @brief Пиксели в формате RGBA.
+         */
+        std::vector<unsigned char> rgba;
+        /**
+         * @brief Яркость пикселей.
+         */
+        std::vector<unsigned char> gray;
+    };
+
+    /**
+     * @struct Glyph
+     * @brief Глиф шрифта в оперативной памяти.
+     */
+    struct Glyph {
+        /**
+         * @brief Смещение глифа по X относительно позиции символа.
+         */
+        int offsetX = 0;
+        /**
+         * @brief Смещение глифа по Y относительно позиции символа.
+         */
+        int offsetY = 0;
+        /**
+         * @brief Сдвиг позиции после глифа.
+         */
+        int advanceX = 0;
+        /**
+         * @brief Ширина изображения глифа.
+         */
+        int width = 0;
+        /**
+         * @brief Высота изображения глифа.
+         */
+        int height = 0;
+        /**
+         * @brief Покрытие пикселей глифа (альфа).
+         */
+        std::vector<unsigned char> alpha;
+    };
+
+private:
+    /**
+     * @brief Рисует динамическую часть кадра поверх неподвижного слоя.
+     */
+    template <typename Canvas>
+    void DrawScene(Game &game, Canvas &canvas);
+
+    /**
+     * @brief Рисует строку шрифтом monogram размером 34 с межбуквенным интервалом 2.
+     */
+    template <typename Canvas>
+    void DrawHudText(Canvas &canvas, const char *text, float x, float y);
+
+    /**
+     * @brief Растеризует неподвижный слой кадра.
+     */
+    template <typename Canvas>
+    void DrawStaticLayer(Canvas &canvas);
+
+    /**
+     * @brief Ширина полноразмерного кадра.
+     */
+    int width;
+    /**
+     * @brief Высота полноразмерного кадра.
+     */
+    int height;
+    /**
+     * @brief Спрайты инопланетян трех типов.
+     */
+    Sprite alienSprites[3];
+    /**
+     * @brief Спрайт космического корабля.
+     */
+    Sprite spaceshipSprite;
+    /**
+     * @brief Спрайт загадочного корабля.
+     */
+    Sprite mysterySprite;
+    /**
+     * @brief Глифы символов с кодами от 32 до 126.
+     */
+    std::vector<Glyph> glyphs;
+    /**
+     * @brief Базовый размер шрифта, в котором растеризованы глифы.
+     */
+    int fontBaseSize;
+    /**
+     * @brief Неподвижный слой в формате RGBA.
+     */
+    std::vector<unsigned char> staticRgba;
+    /**
+     * @brief Неподвижный слой в оттенках серого.
+     */
+    std::vector<unsigned char> staticGray;
+    /**
+     * @brief Полноразмерный кадр в оттенках серого перед уменьшением.
+     */
+    std::vector<unsigned char> grayFrame;
+    /**
+     * @brief Границы столбцов исходного кадра для каждого столбца уменьшенного кадра.
+     */
+    std::vector<int> columnBounds;
+    /**
+     * @brief Границы строк исходного кадра для каждой строки уменьшенного кадра.
+     */
+    std::vector<int> rowBounds;
+};
@@ -4,6 +4,7 @@
  */
 
 #include "spaceship.hpp"
+#include "platform.hpp"
 
 /**
  * @brief Конструктор класса Spaceship.
@@ -12,11 +13,12 @@
  */
 
 Spaceship::Spaceship() {
-    image = LoadTexture("../Graphics/spaceship.png");
-    position.x = (GetScreenWidth() - image.width) / 2;
-    position.y = GetScreenHeight() - image.height - 100;
-    lastFireTime = 0.0;
-    laserSound = LoadSound("../Sounds/laser.ogg");
+    image = LoadGameTexture("../Graphics/spaceship.png");
+    mask = SpriteMask::Load("../Graphics/spaceship.png");
+    position.x = (ScreenWidth() - image.width) / 2;
+    position.y = ScreenHeight() - image.height - 100;
+    lastFireTime = -1e9;
+    laserSound = LoadGameSound("../Sounds/laser.ogg");
 }
 
 /**
@@ -27,16 +29,18 @@ Spaceship::Spaceship() {
 
 
 Spaceship::~Spaceship() {
-    UnloadTexture(image);
-    UnloadSound(laserSound);
+    UnloadGameTexture(image);
+    UnloadGameSound(laserSound);
 }
 
 /**
  * @brief Отрисовывает космический корабль на экране.
+ *
+ * @param tint Оттенок изображения (второй игрок рисуется другим цветом).
  */
 
-void Spaceship::Draw() {
-    DrawTextureV(image, position, WHITE);
+void Spaceship::Draw(Color tint) {
+    DrawTextureV(image, position, tint);
 }
 
 /**
@@ -55,18 +59,20 @@ void Spaceship::MoveLeft() {
 
 void Spaceship::MoveRight() {
     position.x += 7;
-    if (position.x > GetScreenWidth() - image.width - 25) {
-        position.x = GetScreenWidth() - image.width - 25;
+    if (position.x > ScreenWidth() - image.width - 25) {
+        position.x = ScreenWidth() - image.width - 25;
     }
 }
 
 /**
  * @brief Стреляет лазером из космического корабля.
+ *
+ * @param time Текущее время симуляции в секундах.
  */
-void Spaceship::FireLaser() {
-    if (GetTime() - lastFireTime >= 0.35) {
+void Spaceship::FireLaser(double time) {
+    if (time - lastFireTime >= 0.35) {
         lasers.push_back(Laser({position.x + image.width / 2 - 2, position.y}, -6));
-        lastFireTime = GetTime();
+        lastFireTime = time;
         PlaySound(laserSound);
     }
 }
@@ -82,11 +88,71 @@ Rectangle Spaceship::getRect() {
 }
 
 /**
- * @brief Сбрасывает позицию космического корабля и очищает список лазеров.
+ * @brief Проверяет попадание прямоугольника в непрозрачные пиксели корабля.
+ *
+ * Если маска не загружена, используется прямоугольник текстуры.
+ *
+ * @param rect Прямоугольник, например лазер.
+ * @return true, если прямоугольник задевает корабль.
+ */
+
+bool Spaceship::CollidesWith(Rectangle rect) {
+    if (mask.Empty()) {
+        return CheckCollisionRecs(getRect(), rect);
+    }
+    return mask.OverlapsRect(position.x, position.y, rect.x, rect.y, rect.width, rect.height);
+}
+
+/**
+ * @brief Возвращает маску столкновений космического корабля.
+ *
+ * @return Маска столкновений.
+ */
+
+const SpriteMask &Spaceship::getMask() {
+    return mask;
+}
+
+/**
+ * @brief Сбрасывает позицию космического корабля, очищает список лазеров и разрешает выстрел.
+ *
+ * Время симуляции новой игры начинается с нуля, поэтому время последнего выстрела прошлой игры
+ * сбрасывается, иначе корабль не стрелял бы, пока часы не догонят его.
  */
 
 void Spaceship::Reset() {
-    position.x = (GetScreenWidth() - image.width) / 2.0f;
-    position.y = GetScreenHeight() - image.height - 100;
+    position.x = (ScreenWidth() - image.width) / 2.0f;
+    position.y = ScreenHeight() - image.height - 100;
     lasers.clear();
+    lastFireTime = -1e9;
+}
+
+/**
+ * @brief Устанавливает положение космического корабля по оси X.
+ *
+ * @param x Координата левого края корабля.
+ */
+
+void Spaceship::SetX(float x) {
+    position.x = x;
+}
+
+/**
+ * @brief Возвращает время последнего выстрела.
+ */
+
+double Spaceship::getLastFireTime() {
+    return lastFireTime;
+}
+
+/**
+ * @brief Восстанавливает положение и время последнего выстрела из снимка состояния.
+ *
+ * @param x Координата левого края корабля.
+ * @param lastFireTime Время последнего выстрела.
+ */
+
+void Spaceship::Restore(float x, double lastFireTime) {
+    position.x = x;
+    this->lastFireTime = lastFireTime;
 }
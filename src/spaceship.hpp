@@ -4,6 +4,7 @@
  */
 #pragma once
 #include "laser.hpp"
+#include "spritemask.hpp"
 #include <vector>
 #include <raylib.h>
 
@@ -29,8 +30,10 @@ class Spaceship{
         ~Spaceship();
     /**
      * @brief Отрисовывает космический корабль на экране.
+     *
+     * @param tint Оттенок изображения (второй игрок рисуется другим цветом).
      */
-        void Draw();
+        void Draw(Color tint = WHITE);
     /**
      * @brief Перемещает космический корабль влево.
      */
@@ -41,8 +44,10 @@ class Spaceship{
         void MoveRight();
     /**
      * @brief Стреляет лазером из космического корабля.
+     *
+     * @param time Текущее время симуляции в секундах.
      */
-        void FireLaser();
+        void FireLaser(double time);
     /**
      * @brief Возвращает прямоугольник, определяющий положение и размер космического корабля.
      *
@@ -50,9 +55,39 @@ class Spaceship{
      */
         Rectangle getRect();
     /**
-     * @brief Сбрасывает позицию космического корабля и очищает список лазеров.
+     * @brief Проверяет попадание прямоугольника в непрозрачные пиксели корабля.
+     *
+     * @param rect Прямоугольник, например лазер.
+     * @return true, если прямоугольник задевает корабль.
+     */
+        bool CollidesWith(Rectangle rect);
+    /**
+     * @brief Возвращает маску столкновений космического корабля.
+     *
+     * @return Маска столкновений.
+     */
+        const SpriteMask &getMask();
+    /**
+     * @brief Сбрасывает позицию космического корабля, очищает список лазеров и разрешает выстрел.
      */
         void Reset();
+    /**
+     * @brief Устанавливает положение космического корабля по оси X.
+     *
+     * @param x Координата левого края корабля.
+     */
+        void SetX(float x);
+    /**
+     * @brief Возвращает время последнего выстрела.
+     */
+        double getLastFireTime();
+    /**
+     * @brief Восстанавливает положение и время последнего выстрела из снимка состояния.
+     *
+     * @param x Координата левого края корабля.
+     * @param lastFireTime Время последнего выстрела.
+     */
+        void Restore(float x, double lastFireTime);
     /**
      * @brief Вектор, содержащий активные лазеры, выпущенные космическим кораблем.
      */
@@ -63,6 +98,10 @@ class Spaceship{
      * @brief Текстура изображения космического корабля.
      */
         Texture2D image;
+    /**
+     * @brief Маска столкновений космического корабля.
+     */
+        SpriteMask mask;
     /**
      * @brief Позиция космического корабля на экране.
      */
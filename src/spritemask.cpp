@@ -0,0 +1,149 @@
+/**
+ * @file spritemask.cpp
+ * @brief Файл реализации, содержащий методы класса SpriteMask.
+ */
+
+#include "spritemask.hpp"
+#include "platform.hpp"
+#include <raylib.h>
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Конструктор класса SpriteMask.
+ *
+ * Создает пустую маску нулевого размера.
+ */
+
+SpriteMask::SpriteMask() {
+    width = 0;
+    height = 0;
+}
+
+/**
+ * @brief Конструктор маски по альфа-каналу изображения.
+ *
+ * @param alpha Указатель на альфа-значение первого пикселя.
+ * @param width Ширина изображения.
+ * @param height Высота изображения.
+ * @param stride Расстояние в байтах между альфа-значениями соседних пикселей (4 для RGBA).
+ * @param threshold Пиксель считается непрозрачным, если его альфа больше порога.
+ */
+
+SpriteMask::SpriteMask(const unsigned char *alpha, int width, int height, int stride, unsigned char threshold) {
+    this->width = std::min(width, maxWidth);
+    this->height = height;
+    rows.assign(height, 0);
+    for (int row = 0; row < height; ++row) {
+        const unsigned char *pixel = alpha + (size_t) row * width * stride;
+        for (int column = 0; column < this->width; ++column) {
+            if (pixel[column * stride] > threshold) {
+                rows[row] |= uint64_t(1) << column;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Загружает маску из альфа-канала PNG-файла.
+ *
+ * @param fileName Путь к изображению.
+ * @return Маска изображения или пустая маска, если файл не загружен.
+ */
+
+SpriteMask SpriteMask::Load(const char *fileName) {
+    Image image = LoadGameImage(fileName);
+    if (image.data == nullptr) {
+        return SpriteMask();
+    }
+    SpriteMask mask((const unsigned char *) image.data + 3, image.width, image.height, 4);
+    UnloadGameImage(image);
+    return mask;
+}
+
+/**
+ * @brief Проверяет пересечение с другой маской.
+ *
+ * Для каждой общей строки слово другой маски сдвигается на разницу координат по X и
+ * сравнивается побитовым И со словом этой маски.
+ *
+ * @param x Координата X левого верхнего угла этой маски.
+ * @param y Координата Y левого верхнего угла этой маски.
+ * @param other Другая маска.
+ * @param otherX Координата X левого верхнего угла другой маски.
+ * @param otherY Координата Y левого верхнего угла другой маски.
+ * @return true, если непрозрачные пиксели масок пересекаются.
+ */
+
+bool SpriteMask::Overlaps(float x, float y, const SpriteMask &other, float otherX, float otherY) const {
+    int dx = (int) std::floor(otherX - x);
+    int dy = (int) std::floor(otherY - y);
+    if (dx >= maxWidth || dx <= -maxWidth) {
+        return false;
+    }
+
+    int first = std::max(0, dy);
+    int last = std::min(height, dy + other.height);
+    for (int row = first; row < last; ++row) {
+        uint64_t shifted = dx >= 0 ? other.rows[row - dy] << dx : other.rows[row - dy] >> -dx;
+        if (rows[row] & shifted) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Проверяет пересечение со сплошным прямоугольником.
+ *
+ * @param x Координата X левого верхнего угла маски.
+ * @param y Координата Y левого верхнего угла маски.
+ * @param rectX Координата X прямоугольника.
+ * @param rectY Координата Y прямоугольника.
+ * @param rectWidth Ширина прямоугольника.
+ * @param rectHeight Высота прямоугольника.
+ * @return true, если прямоугольник задевает непрозрачный пиксель маски.
+ */
+
+bool SpriteMask::OverlapsRect(float x, float y, float rectX, float rectY, float rectWidth, float rectHeight) const {
+    int left = std::max(0, (int) std::floor(rectX - x));
+    int right = std::min(width, (int) std::ceil(rectX + rectWidth - x));
+    int top = std::max(0, (int) std::floor(rectY - y));
+    int bottom = std::min(height, (int) std::ceil(rectY + rectHeight - y));
+    if (left >= right || top >= bottom) {
+        return false;
+    }
+
+    uint64_t span = (right - left == 64 ? ~uint64_t(0) : ((uint64_t(1) << (right - left)) - 1)) << left;
+    for (int row = top; row < bottom; ++row) {
+        if (rows[row] & span) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Проверяет, установлен ли пиксель маски.
+ *
+ * @param column Столбец пикселя.
+ * @param row Строка пикселя.
+ * @return true, если пиксель непрозрачный.
+ */
+
+bool SpriteMask::Test(int column, int row) const {
+    if (column < 0 || column >= width || row < 0 || row >= height) {
+        return false;
+    }
+    return (rows[row] >> column) & 1;
+}
+
+/**
+ * @brief Проверяет, загружена ли маска.
+ *
+ * @return true, если у маски нет строк.
+ */
+
+bool SpriteMask::Empty() const {
+    return rows.empty();
+}
@@ -0,0 +1,107 @@
+/**
+ * @file spritemask.hpp
+ * @brief Заголовочный файл, содержащий класс SpriteMask.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class SpriteMask
+ * @brief Однобитная маска столкновений спрайта.
+ *
+ * Каждая строка спрайта хранится одним 64-битным словом (бит c соответствует пикселю c строки),
+ * поэтому пересечение двух масок проверяется сдвигом и побитовым И по перекрывающимся строкам.
+ * Поддерживаются спрайты шириной до 64 пикселей; пиксели правее обрезаются.
+ */
+
+class SpriteMask {
+public:
+    /**
+     * @brief Максимальная ширина маски в пикселях.
+     */
+    constexpr static int maxWidth = 64;
+
+    /**
+     * @brief Конструктор класса SpriteMask.
+     *
+     * Создает пустую маску нулевого размера.
+     */
+    SpriteMask();
+
+    /**
+     * @brief Конструктор маски по альфа-каналу изображения.
+     *
+     * @param alpha Указатель на альфа-значение первого пикселя.
+     * @param width Ширина изображения.
+     * @param height Высота изображения.
+     * @param stride Расстояние в байтах между альфа-значениями соседних пикселей (4 для RGBA).
+     * @param threshold Пиксель считается непрозрачным, если его альфа больше порога.
+     */
+    SpriteMask(const unsigned char *alpha, int width, int height, int stride, unsigned char threshold = 0);
+
+    /**
+     * @brief Загружает маску из альфа-канала PNG-файла.
+     *
+     * @param fileName Путь к изображению.
+     * @return Маска изображения или пустая маска, если файл не загружен.
+     */
+    static SpriteMask Load(const char *fileName);
+
+    /**
+     * @brief Проверяет пересечение с другой маской.
+     *
+     * @param x Координата X левого верхнего угла этой маски.
+     * @param y Координата Y левого верхнего угла этой маски.
+     * @param other Другая маска.
+     * @param otherX Координата X левого верхнего угла другой маски.
+     * @param otherY Координата Y левого верхнего угла другой маски.
+     * @return true, если непрозрачные пиксели масок пересекаются.
+     */
+    bool Overlaps(float x, float y, const SpriteMask &other, float otherX, float otherY) const;
+
+    /**
+     * @brief Проверяет пересечение со сплошным прямоугольником.
+     *
+     * @param x Координата X левого верхнего угла маски.
+     * @param y Координата Y левого верхнего угла маски.
+     * @param rectX Координата X прямоугольника.
+     * @param rectY Координата Y прямоугольника.
+     * @param rectWidth Ширина прямоугольника.
+     * @param rectHeight Высота прямоугольника.
+     * @return true, если прямоугольник задевает непрозрачный пиксель маски.
+     */
+    bool OverlapsRect(float x, float y, float rectX, float rectY, float rectWidth, float rectHeight) const;
+
+    /**
+     * @brief Проверяет, установлен ли пиксель маски.
+     *
+     * @param column Столбец пикселя.
+     * @param row Строка пикселя.
+     * @return true, если пиксель непрозрачный.
+     */
+    bool Test(int column, int row) const;
+
+    /**
+     * @brief Проверяет, загружена ли маска.
+     *
+     * @return true, если у маски нет строк.
+     */
+    bool Empty() const;
+
+    /**
+     * @brief Ширина маски в пикселях.
+     */
+    int width;
+    /**
+     * @brief Высота маски в пикселях.
+     */
+    int height;
+private:
+    /**
+     * @brief Строки маски.
+     */
+    std::vector<uint64_t> rows;
+};
@@ -0,0 +1,94 @@
+/**
+ * @file statebytes.hpp
+ * @brief Заголовочный файл, содержащий запись состояния симуляции в байты и его чтение.
+ *
+ * Значения копируются побайтно, без перевода порядка байтов и выравнивания, поэтому байты
+ * предназначены только для памяти того же процесса (см. RewindBuffer), а не для файлов и сети.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Дописывает значение в байты.
+ *
+ * @param bytes Байты.
+ * @param value Значение тривиально копируемого типа.
+ */
+template<typename T>
+void PutState(std::vector<uint8_t> &bytes, const T &value) {
+    static_assert(std::is_trivially_copyable<T>::value, "state values are copied bytewise");
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(&value);
+    bytes.insert(bytes.end(), data, data + sizeof(T));
+}
+
+/**
+ * @brief Дописывает в байты размер вектора и его элементы.
+ *
+ * @param bytes Байты.
+ * @param values Вектор элементов тривиально копируемого типа.
+ */
+template<typename T>
+void PutState(std::vector<uint8_t> &bytes, const std::vector<T> &values) {
+    static_assert(std::is_trivially_copyable<T>::value, "state values are copied bytewise");
+    PutState(bytes, (uint32_t) values.size());
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(values.data());
+    bytes.insert(bytes.end(), data, data + values.size() * sizeof(T));
+}
+
+/**
+ * @struct StateReader
+ * @brief Чтение значений, записанных PutState, в том же порядке.
+ *
+ * После первой ошибки (байты кончились) все чтения возвращают false.
+ */
+struct StateReader {
+    const uint8_t *data; ///< Следующий байт.
+    const uint8_t *end;  ///< Конец байтов.
+    bool ok;             ///< false после ошибки чтения.
+
+    /**
+     * @brief Создает чтение байтов.
+     */
+    StateReader(const uint8_t *data, size_t size) : data(data), end(data + size), ok(true) {}
+
+    /**
+     * @brief Читает значение.
+     */
+    template<typename T>
+    bool Get(T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "state values are copied bytewise");
+        if (!ok || (size_t) (end - data) < sizeof(T)) {
+            return ok = false;
+        }
+        memcpy(&value, data, sizeof(T));
+        data += sizeof(T);
+        return true;
+    }
+
+    /**
+     * @brief Читает вектор; память вектора переиспользуется.
+     *
+     * Элементы копируются по одному через выровненный буфер: у типов вроде Laser нет
+     * конструктора по умолчанию, а байты не выровнены.
+     */
+    template<typename T>
+    bool Get(std::vector<T> &values) {
+        uint32_t count;
+        if (!Get(count) || (size_t) (end - data) / sizeof(T) < count) {
+            return ok = false;
+        }
+        values.clear();
+        for (uint32_t i = 0; i < count; ++i) {
+            alignas(T) uint8_t storage[sizeof(T)];
+            memcpy(storage, data, sizeof(T));
+            values.push_back(*reinterpret_cast<const T *>(storage));
+            data += sizeof(T);
+        }
+        return true;
+    }
+};
@@ -0,0 +1,605 @@
+/**
+ * @file streamcodec.cpp
+ * @brief Файл реализации кодера и декодера потока разностей состояния игры.
+ */
+
+#include "streamcodec.hpp"
+#include <cstring>
+#include <utility>
+
+/**
+ * @brief Флаги секций разностного кадра.
+ */
+enum StreamDeltaFlags : uint32_t {
+    DELTA_SCORE = 1 << 0,
+    DELTA_HIGHSCORE = 1 << 1,
+    DELTA_LIVES = 1 << 2,
+    DELTA_RUN = 1 << 3,
+    DELTA_SHIP = 1 << 4,
+    DELTA_FORMATION = 1 << 5,
+    DELTA_DIRECTION = 1 << 6,
+    DELTA_ALIVE = 1 << 7,
+    DELTA_MYSTERY = 1 << 8,
+    DELTA_SHIELDS = 1 << 9,
+    DELTA_PLAYER_LASERS = 1 << 10,
+    DELTA_ALIEN_LASERS = 1 << 11
+};
+
+/**
+ * @brief Наибольшее количество тиков, пропущенных между разностными кадрами.
+ */
+static constexpr uint32_t maxTickGap = 1024;
+
+/**
+ * @brief Дописывает беззнаковое число в формате varint.
+ */
+
+static void PutVarint(std::vector<uint8_t> &out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(uint8_t(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(uint8_t(value));
+}
+
+/**
+ * @brief Дописывает знаковое число в формате zigzag varint.
+ */
+
+static void PutSigned(std::vector<uint8_t> &out, int64_t value) {
+    PutVarint(out, (uint64_t(value) << 1) ^ uint64_t(value >> 63));
+}
+
+/**
+ * @struct Reader
+ * @brief Последовательное чтение кадра с проверкой границ.
+ */
+struct Reader {
+    /**
+     * @brief Текущая позиция.
+     */
+    const uint8_t *data;
+    /**
+     * @brief Конец кадра.
+     */
+    const uint8_t *end;
+    /**
+     * @brief Флаг ошибки чтения.
+     */
+    bool failed;
+
+    uint64_t Varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (data == end) {
+                failed = true;
+                return 0;
+            }
+            uint8_t byte = *data++;
+            value |= uint64_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        failed = true;
+        return 0;
+    }
+
+    int64_t Signed() {
+        uint64_t value = Varint();
+        return int64_t(value >> 1) ^ -int64_t(value & 1);
+    }
+
+    uint8_t Byte() {
+        if (data == end) {
+            failed = true;
+            return 0;
+        }
+        return *data++;
+    }
+};
+
+/**
+ * @brief Дописывает список снарядов целиком.
+ */
+
+static void PutProjectiles(std::vector<uint8_t> &out, const std::vector<StreamProjectile> &projectiles) {
+    PutVarint(out, projectiles.size());
+    for (auto &projectile: projectiles) {
+        PutSigned(out, projectile.x);
+        PutSigned(out, projectile.y);
+        PutSigned(out, projectile.speed);
+    }
+}
+
+/**
+ * @brief Дописывает к списку снаряды, прочитанные из кадра.
+ *
+ * @return false, если кадр поврежден.
+ */
+
+static bool ReadProjectiles(Reader &reader, std::vector<StreamProjectile> &projectiles) {
+    uint64_t count = reader.Varint();
+    if (count > uint64_t(reader.end - reader.data)) {
+        return false;
+    }
+    for (uint64_t i = 0; i < count && !reader.failed; ++i) {
+        StreamProjectile projectile;
+        projectile.x = (int32_t) reader.Signed();
+        projectile.y = (int32_t) reader.Signed();
+        projectile.speed = (int32_t) reader.Signed();
+        projectiles.push_back(projectile);
+    }
+    return !reader.failed;
+}
+
+/**
+ * @brief Копирует все поля состояния, кроме списков снарядов.
+ */
+
+static void CopyScalars(StreamState &to, const StreamState &from) {
+    to.tick = from.tick;
+    to.score = from.score;
+    to.highscore = from.highscore;
+    to.lives = from.lives;
+    to.run = from.run;
+    to.shipX = from.shipX;
+    to.formationX = from.formationX;
+    to.formationY = from.formationY;
+    to.direction = from.direction;
+    to.alive = from.alive;
+    to.mysteryAlive = from.mysteryAlive;
+    to.mysteryX = from.mysteryX;
+    to.mysterySpeed = from.mysterySpeed;
+    memcpy(to.shields, from.shields, sizeof(to.shields));
+}
+
+/**
+ * @brief Продвигает состояние на один тик по правилам предсказания потока.
+ *
+ * Формация сдвигается на direction пикселей, загадочный корабль - на свою скорость, лазеры - на свою.
+ *
+ * @param state Состояние.
+ */
+
+void PredictStreamState(StreamState &state) {
+    state.tick++;
+    state.formationX += state.direction * 2;
+    if (state.mysteryAlive) {
+        state.mysteryX += state.mysterySpeed * 2;
+    }
+    for (auto &laser: state.playerLasers) {
+        laser.y += laser.speed * 2;
+    }
+    for (auto &laser: state.alienLasers) {
+        laser.y += laser.speed * 2;
+    }
+}
+
+/**
+ * @brief Конструктор класса StreamEncoder.
+ *
+ * @param keyframeInterval Наибольшее количество кадров между ключевыми кадрами.
+ */
+
+StreamEncoder::StreamEncoder(int keyframeInterval) : sent() {
+    this->keyframeInterval = keyframeInterval;
+    haveKeyframe = false;
+    sinceKeyframe = 0;
+}
+
+/**
+ * @brief Требует записать следующим ключевой кадр (например, для нового зрителя).
+ */
+
+void StreamEncoder::ForceKeyframe() {
+    haveKeyframe = false;
+}
+
+/**
+ * @brief Проверяет, выражается ли состояние разностью с отправленным.
+ */
+
+bool StreamEncoder::CanEncodeDelta(const StreamState &state) const {
+    if (state.tick < sent.tick || state.tick - sent.tick > maxTickGap) {
+        return false;
+    }
+    // Разность умеет только убирать инопланетян и клетки щитов
+    if (state.alive & ~sent.alive) {
+        return false;
+    }
+    for (int shield = 0; shield < streamShieldCount; ++shield) {
+        for (int row = 0; row < streamShieldRows; ++row) {
+            if (state.shields[shield][row] & ~sent.shields[shield][row]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Дописывает в буфер кадр для очередного состояния.
+ *
+ * Ключевой кадр записывается по расписанию, по запросу и когда состояние не выражается
+ * разностью (например, после перезапуска игры вернулись инопланетяне и клетки щитов).
+ *
+ * @param state Текущее состояние.
+ * @param out Буфер, в конец которого дописывается кадр.
+ * @return Размер кадра в байтах.
+ */
+
+size_t StreamEncoder::Encode(const StreamState &state, std::vector<uint8_t> &out) {
+    size_t start = out.size();
+    if (!haveKeyframe || sinceKeyframe >= keyframeInterval || !CanEncodeDelta(state)) {
+        EncodeKeyframe(state, out);
+        return out.size() - start;
+    }
+    sinceKeyframe++;
+
+    uint32_t gap = state.tick - sent.tick;
+    for (uint32_t i = 0; i < gap; ++i) {
+        PredictStreamState(sent);
+    }
+
+    uint32_t flags = 0;
+    section.clear();
+    if (state.score != sent.score) {
+        flags |= DELTA_SCORE;
+        PutSigned(section, int64_t(state.score) - sent.score);
+    }
+    if (state.highscore != sent.highscore) {
+        flags |= DELTA_HIGHSCORE;
+        PutSigned(section, int64_t(state.highscore) - sent.highscore);
+    }
+    if (state.lives != sent.lives) {
+        flags |= DELTA_LIVES;
+        PutSigned(section, int64_t(state.lives) - sent.lives);
+    }
+    if (state.run != sent.run) {
+        flags |= DELTA_RUN;
+        section.push_back(uint8_t(state.run));
+    }
+    if (state.shipX != sent.shipX) {
+        flags |= DELTA_SHIP;
+        PutSigned(section, int64_t(state.shipX) - sent.shipX);
+    }
+    if (state.formationX != sent.formationX || state.formationY != sent.formationY) {
+        flags |= DELTA_FORMATION;
+        PutSigned(section, int64_t(state.formationX) - sent.formationX);
+        PutSigned(section, int64_t(state.formationY) - sent.formationY);
+    }
+    if (state.direction != sent.direction) {
+        flags |= DELTA_DIRECTION;
+        PutSigned(section, state.direction);
+    }
+    uint64_t killed = sent.alive & ~state.alive;
+    if (killed) {
+        flags |= DELTA_ALIVE;
+        PutVarint(section, __builtin_popcountll(killed));
+        for (uint64_t bits = killed; bits; bits &= bits - 1) {
+            section.push_back(uint8_t(__builtin_ctzll(bits)));
+        }
+    }
+    bool mysteryPredicted = state.mysteryAlive == sent.mysteryAlive &&
+                            (!state.mysteryAlive ||
+                             (state.mysteryX == sent.mysteryX && state.mysterySpeed == sent.mysterySpeed));
+    if (!mysteryPredicted) {
+        flags |= DELTA_MYSTERY;
+        PutVarint(section, state.mysteryAlive ? 1 : 0);
+        if (state.mysteryAlive) {
+            PutSigned(section, state.mysteryX);
+            PutSigned(section, state.mysterySpeed);
+        }
+    }
+
+    int cleared = 0;
+    for (int shield = 0; shield < streamShieldCount; ++shield) {
+        for (int row = 0; row < streamShieldRows; ++row) {
+            cleared += __builtin_popcount(sent.shields[shield][row] & ~state.shields[shield][row]);
+        }
+    }
+    if (cleared > 0) {
+        flags |= DELTA_SHIELDS;
+        PutVarint(section, cleared);
+        for (int shield = 0; shield < streamShieldCount; ++shield) {
+            for (int row = 0; row < streamShieldRows; ++row) {
+                for (uint32_t bits = sent.shields[shield][row] & ~state.shields[shield][row]; bits; bits &= bits - 1) {
+                    PutVarint(section, (shield * streamShieldRows + row) * streamShieldColumns + __builtin_ctz(bits));
+                }
+            }
+        }
+    }
+
+    if (EncodeProjectiles(sent.playerLasers, state.playerLasers, section)) {
+        flags |= DELTA_PLAYER_LASERS;
+    }
+    if (EncodeProjectiles(sent.alienLasers, state.alienLasers, section)) {
+        flags |= DELTA_ALIEN_LASERS;
+    }
+
+    out.push_back(STREAM_DELTA);
+    PutVarint(out, gap);
+    PutVarint(out, flags);
+    out.insert(out.end(), section.begin(), section.end());
+
+    // Списки снарядов уже обновлены в порядке декодера, а не игры
+    CopyScalars(sent, state);
+    return out.size() - start;
+}
+
+/**
+ * @brief Записывает ключевой кадр.
+ */
+
+void StreamEncoder::EncodeKeyframe(const StreamState &state, std::vector<uint8_t> &out) {
+    out.push_back(STREAM_KEYFRAME);
+    PutVarint(out, state.tick);
+    PutSigned(out, state.score);
+    PutSigned(out, state.highscore);
+    PutSigned(out, state.lives);
+    out.push_back(uint8_t(state.run));
+    PutSigned(out, state.shipX);
+    PutSigned(out, state.formationX);
+    PutSigned(out, state.formationY);
+    PutSigned(out, state.direction);
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(uint8_t(state.alive >> (8 * i)));
+    }
+    PutVarint(out, state.mysteryAlive ? 1 : 0);
+    PutSigned(out, state.mysteryX);
+    PutSigned(out, state.mysterySpeed);
+    for (int shield = 0; shield < streamShieldCount; ++shield) {
+        for (int row = 0; row < streamShieldRows; ++row) {
+            PutVarint(out, state.shields[shield][row]);
+        }
+    }
+    PutProjectiles(out, state.playerLasers);
+    PutProjectiles(out, state.alienLasers);
+
+    sent = state;
+    haveKeyframe = true;
+    sinceKeyframe = 0;
+}
+
+/**
+ * @brief Записывает изменения списка снарядов и обновляет отправленный список.
+ *
+ * Снаряды только исчезают из середины списка и добавляются в конец, поэтому текущий список
+ * сопоставляется с предсказанным по порядку. Несопоставленные предсказанные снаряды считаются
+ * исчезнувшими, несопоставленные текущие - новыми.
+ *
+ * @param sent Отправленный список (обновляется до вида, который восстановит декодер).
+ * @param current Текущий список.
+ * @param out Буфер.
+ * @return true, если список отличается от предсказания.
+ */
+
+bool StreamEncoder::EncodeProjectiles(std::vector<StreamProjectile> &sent,
+                                      const std::vector<StreamProjectile> &current, std::vector<uint8_t> &out) {
+    expiredIndices.clear();
+    isNew.assign(current.size(), 0);
+    size_t next = 0;
+    size_t newCount = 0;
+    for (size_t i = 0; i < current.size(); ++i) {
+        size_t found = next;
+        while (found < sent.size() && !(sent[found] == current[i])) {
+            found++;
+        }
+        if (found == sent.size()) {
+            isNew[i] = 1;
+            newCount++;
+            continue;
+        }
+        for (; next < found; ++next) {
+            expiredIndices.push_back(next);
+        }
+        next = found + 1;
+    }
+    for (; next < sent.size(); ++next) {
+        expiredIndices.push_back(next);
+    }
+    if (expiredIndices.empty() && newCount == 0) {
+        return false;
+    }
+
+    // Номера исчезнувших записываются разностями с предыдущим номером
+    PutVarint(out, expiredIndices.size());
+    size_t previous = 0;
+    for (size_t index: expiredIndices) {
+        PutVarint(out, index - previous);
+        previous = index;
+    }
+    PutVarint(out, newCount);
+
+    survivors.clear();
+    size_t expired = 0;
+    for (size_t i = 0; i < sent.size(); ++i) {
+        if (expired < expiredIndices.size() && expiredIndices[expired] == i) {
+            expired++;
+        } else {
+            survivors.push_back(sent[i]);
+        }
+    }
+    for (size_t i = 0; i < current.size(); ++i) {
+        if (isNew[i]) {
+            PutSigned(out, current[i].x);
+            PutSigned(out, current[i].y);
+            PutSigned(out, current[i].speed);
+            survivors.push_back(current[i]);
+        }
+    }
+    sent.swap(survivors);
+    return true;
+}
+
+/**
+ * @brief Конструктор класса StreamDecoder.
+ */
+
+StreamDecoder::StreamDecoder() : state(), ready(false) {
+}
+
+/**
+ * @brief Возвращает true, если получен хотя бы один ключевой кадр.
+ */
+
+bool StreamDecoder::Ready() const {
+    return ready;
+}
+
+/**
+ * @brief Применяет один кадр.
+ *
+ * Разностные кадры до первого ключевого пропускаются.
+ *
+ * @param data Кадр.
+ * @param size Размер кадра.
+ * @return false, если кадр поврежден или получен до первого ключевого кадра.
+ */
+
+bool StreamDecoder::Decode(const uint8_t *data, size_t size) {
+    Reader reader = {data, data + size, false};
+    uint8_t type = reader.Byte();
+
+    if (type == STREAM_KEYFRAME) {
+        next.playerLasers.clear();
+        next.alienLasers.clear();
+        next.tick = (uint32_t) reader.Varint();
+        next.score = (int32_t) reader.Signed();
+        next.highscore = (int32_t) reader.Signed();
+        next.lives = (int32_t) reader.Signed();
+        next.run = reader.Byte();
+        next.shipX = (int32_t) reader.Signed();
+        next.formationX = (int32_t) reader.Signed();
+        next.formationY = (int32_t) reader.Signed();
+        next.direction = (int32_t) reader.Signed();
+        next.alive = 0;
+        for (int i = 0; i < 8; ++i) {
+            next.alive |= uint64_t(reader.Byte()) << (8 * i);
+        }
+        next.mysteryAlive = (int32_t) reader.Varint();
+        next.mysteryX = (int32_t) reader.Signed();
+        next.mysterySpeed = (int32_t) reader.Signed();
+        for (int shield = 0; shield < streamShieldCount; ++shield) {
+            for (int row = 0; row < streamShieldRows; ++row) {
+                next.shields[shield][row] = (uint32_t) reader.Varint();
+            }
+        }
+        if (!ReadProjectiles(reader, next.playerLasers) || !ReadProjectiles(reader, next.alienLasers) ||
+            reader.data != reader.end) {
+            return false;
+        }
+        std::swap(state, next);
+        ready = true;
+        return true;
+    }
+
+    if (type != STREAM_DELTA || !ready) {
+        return false;
+    }
+    // Кадр применяется к копии, чтобы поврежденный кадр не испортил состояние
+    next = state;
+    uint64_t gap = reader.Varint();
+    uint64_t flags = reader.Varint();
+    if (reader.failed || gap > maxTickGap) {
+        return false;
+    }
+    for (uint64_t i = 0; i < gap; ++i) {
+        PredictStreamState(next);
+    }
+
+    if (flags & DELTA_SCORE) {
+        next.score += (int32_t) reader.Signed();
+    }
+    if (flags & DELTA_HIGHSCORE) {
+        next.highscore += (int32_t) reader.Signed();
+    }
+    if (flags & DELTA_LIVES) {
+        next.lives += (int32_t) reader.Signed();
+    }
+    if (flags & DELTA_RUN) {
+        next.run = reader.Byte();
+    }
+    if (flags & DELTA_SHIP) {
+        next.shipX += (int32_t) reader.Signed();
+    }
+    if (flags & DELTA_FORMATION) {
+        next.formationX += (int32_t) reader.Signed();
+        next.formationY += (int32_t) reader.Signed();
+    }
+    if (flags & DELTA_DIRECTION) {
+        next.direction = (int32_t) reader.Signed();
+    }
+    if (flags & DELTA_ALIVE) {
+        uint64_t count = reader.Varint();
+        for (uint64_t i = 0; i < count && !reader.failed; ++i) {
+            uint8_t bit = reader.Byte();
+            if (bit >= 64) {
+                return false;
+            }
+            next.alive &= ~(1ull << bit);
+        }
+    }
+    if (flags & DELTA_MYSTERY) {
+        next.mysteryAlive = (int32_t) reader.Varint();
+        if (next.mysteryAlive) {
+            next.mysteryX = (int32_t) reader.Signed();
+            next.mysterySpeed = (int32_t) reader.Signed();
+        }
+    }
+    if (flags & DELTA_SHIELDS) {
+        uint64_t count = reader.Varint();
+        for (uint64_t i = 0; i < count && !reader.failed; ++i) {
+            uint64_t cell = reader.Varint();
+            if (cell >= uint64_t(streamShieldCount * streamShieldRows * streamShieldColumns)) {
+                return false;
+            }
+            int column = cell % streamShieldColumns;
+            int row = (cell / streamShieldColumns) % streamShieldRows;
+            int shield = cell / (streamShieldColumns * streamShieldRows);
+            next.shields[shield][row] &= ~(1u << column);
+        }
+    }
+
+    std::vector<StreamProjectile> *lists[2] = {&next.playerLasers, &next.alienLasers};
+    uint32_t listFlags[2] = {DELTA_PLAYER_LASERS, DELTA_ALIEN_LASERS};
+    for (int list = 0; list < 2; ++list) {
+        if (!(flags & listFlags[list])) {
+            continue;
+        }
+        std::vector<StreamProjectile> &projectiles = *lists[list];
+        uint64_t expired = reader.Varint();
+        if (expired > projectiles.size()) {
+            return false;
+        }
+        // Номера исчезнувших возрастают, поэтому список сжимается одним проходом
+        size_t kept = 0;
+        size_t source = 0;
+        uint64_t index = 0;
+        for (uint64_t i = 0; i < expired; ++i) {
+            uint64_t gap = reader.Varint();
+            index += gap;
+            if (reader.failed || (i > 0 && gap == 0) || index >= projectiles.size()) {
+                return false;
+            }
+            for (; source < index; ++source) {
+                projectiles[kept++] = projectiles[source];
+            }
+            source = index + 1;
+        }
+        for (; source < projectiles.size(); ++source) {
+            projectiles[kept++] = projectiles[source];
+        }
+        projectiles.resize(kept);
+        if (!ReadProjectiles(reader, projectiles)) {
+            return false;
+        }
+    }
+
+    if (reader.failed || reader.data != reader.end) {
+        return false;
+    }
+    std::swap(state, next);
+    return true;
+}
@@ -0,0 +1,281 @@
+/**
+ * @file streamcodec.hpp
+ * @brief Заголовочный файл, содержащий кодер и декодер потока разностей состояния игры для зрителей.
+ *
+ * Поток состоит из кадров: ключевой кадр содержит полное состояние, разностный кадр - только
+ * отличия от состояния, предсказанного по предыдущему кадру. Предсказание учитывает равномерное
+ * движение формации, загадочного корабля и лазеров, поэтому в обычном тике передаются лишь
+ * события: гибель инопланетян (номера битов маски), исчезнувшие и новые снаряды, разрушенные
+ * клетки щитов и изменение счета. Числа записываются в формате varint (со знаком - zigzag),
+ * координаты - в половинах пикселя.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Количество щитов в состоянии потока.
+ */
+constexpr int streamShieldCount = 4;
+
+/**
+ * @brief Количество рядов клеток щита.
+ */
+constexpr int streamShieldRows = 13;
+
+/**
+ * @brief Количество столбцов клеток щита.
+ */
+constexpr int streamShieldColumns = 23;
+
+/**
+ * @brief Типы кадров потока.
+ */
+enum StreamFrameType : uint8_t {
+    /**
+     * @brief Полное состояние.
+     */
+    STREAM_KEYFRAME = 1,
+    /**
+     * @brief Разность с предсказанным состоянием.
+     */
+    STREAM_DELTA = 2
+};
+
+/**
+ * @struct StreamProjectile
+ * @brief Снаряд в состоянии потока.
+ */
+struct StreamProjectile {
+    /**
+     * @brief Координата X в половинах пикселя.
+     */
+    int32_t x;
+    /**
+     * @brief Координата Y в половинах пикселя.
+     */
+    int32_t y;
+    /**
+     * @brief Скорость по Y в пикселях за тик.
+     */
+    int32_t speed;
+
+    bool operator==(const StreamProjectile &other) const {
+        return x == other.x && y == other.y && speed == other.speed;
+    }
+};
+
+/**
+ * @struct StreamState
+ * @brief Состояние игры, достаточное для отрисовки.
+ */
+struct StreamState {
+    /**
+     * @brief Номер тика.
+     */
+    uint32_t tick;
+    /**
+     * @brief Счет.
+     */
+    int32_t score;
+    /**
+     * @brief Рекорд.
+     */
+    int32_t highscore;
+    /**
+     * @brief Количество жизней.
+     */
+    int32_t lives;
+    /**
+     * @brief Флаг идущей игры.
+     */
+    int32_t run;
+    /**
+     * @brief Координата X корабля игрока в половинах пикселя.
+     */
+    int32_t shipX;
+    /**
+     * @brief Координата X ячейки (0, 0) формации в половинах пикселя.
+     */
+    int32_t formationX;
+    /**
+     * @brief Координата Y ячейки (0, 0) формации в половинах пикселя.
+     */
+    int32_t formationY;
+    /**
+     * @brief Направление движения формации (-1 или 1).
+     */
+    int32_t direction;
+    /**
+     * @brief Маска живых инопланетян: бит row * columns + column.
+     */
+    uint64_t alive;
+    /**
+     * @brief Флаг живого загадочного корабля.
+     */
+    int32_t mysteryAlive;
+    /**
+     * @brief Координата X загадочного корабля в половинах пикселя.
+     */
+    int32_t mysteryX;
+    /**
+     * @brief Скорость загадочного корабля в пикселях за тик.
+     */
+    int32_t mysterySpeed;
+    /**
+     * @brief Клетки щитов: по маске столбцов на каждый ряд.
+     */
+    uint32_t shields[streamShieldCount][streamShieldRows];
+    /**
+     * @brief Лазеры игрока.
+     */
+    std::vector<StreamProjectile> playerLasers;
+    /**
+     * @brief Лазеры инопланетян.
+     */
+    std::vector<StreamProjectile> alienLasers;
+};
+
+/**
+ * @class StreamEncoder
+ * @brief Кодер потока одной игры.
+ *
+ * Кодер хранит состояние в том виде, в каком его восстановит декодер, и считает разности от него.
+ * Буферы переиспользуются между кадрами, поэтому после первых кадров кодирование не выделяет память.
+ */
+class StreamEncoder {
+public:
+    /**
+     * @brief Конструктор класса StreamEncoder.
+     *
+     * @param keyframeInterval Наибольшее количество кадров между ключевыми кадрами.
+     */
+    explicit StreamEncoder(int keyframeInterval = 120);
+
+    /**
+     * @brief Дописывает в буфер кадр для очередного состояния.
+     *
+     * Ключевой кадр записывается по расписанию, по запросу и когда состояние не выражается
+     * разностью (например, после перезапуска игры вернулись инопланетяне и клетки щитов).
+     *
+     * @param state Текущее состояние.
+     * @param out Буфер, в конец которого дописывается кадр.
+     * @return Размер кадра в байтах.
+     */
+    size_t Encode(const StreamState &state, std::vector<uint8_t> &out);
+
+    /**
+     * @brief Требует записать следующим ключевой кадр (например, для нового зрителя).
+     */
+    void ForceKeyframe();
+
+private:
+    /**
+     * @brief Записывает ключевой кадр.
+     */
+    void EncodeKeyframe(const StreamState &state, std::vector<uint8_t> &out);
+
+    /**
+     * @brief Проверяет, выражается ли состояние разностью с отправленным.
+     */
+    bool CanEncodeDelta(const StreamState &state) const;
+
+    /**
+     * @brief Записывает изменения списка снарядов и обновляет отправленный список.
+     *
+     * @param sent Отправленный список (обновляется до вида, который восстановит декодер).
+     * @param current Текущий список.
+     * @param out Буфер.
+     * @return true, если список отличается от предсказания.
+     */
+    bool EncodeProjectiles(std::vector<StreamProjectile> &sent, const std::vector<StreamProjectile> &current,
+                           std::vector<uint8_t> &out);
+
+    /**
+     * @brief Последнее отправленное состояние в виде, который восстановит декодер.
+     */
+    StreamState sent;
+    /**
+     * @brief Флаг наличия отправленного ключевого кадра.
+     */
+    bool haveKeyframe;
+    /**
+     * @brief Количество кадров после последнего ключевого.
+     */
+    int sinceKeyframe;
+    /**
+     * @brief Наибольшее количество кадров между ключевыми кадрами.
+     */
+    int keyframeInterval;
+    /**
+     * @brief Временный буфер секции кадра.
+     */
+    std::vector<uint8_t> section;
+    /**
+     * @brief Временный список снарядов.
+     */
+    std::vector<StreamProjectile> survivors;
+    /**
+     * @brief Номера исчезнувших снарядов в отправленном списке.
+     */
+    std::vector<size_t> expiredIndices;
+    /**
+     * @brief Флаги новых снарядов в текущем списке.
+     */
+    std::vector<uint8_t> isNew;
+};
+
+/**
+ * @class StreamDecoder
+ * @brief Декодер потока одной игры.
+ */
+class StreamDecoder {
+public:
+    /**
+     * @brief Конструктор класса StreamDecoder.
+     */
+    StreamDecoder();
+
+    /**
+     * @brief Применяет один кадр.
+     *
+     * Разностные кадры до первого ключевого пропускаются.
+     *
+     * @param data Кадр.
+     * @param size Размер кадра.
+     * @return false, если кадр поврежден или получен до первого ключевого кадра.
+     */
+    bool Decode(const uint8_t *data, size_t size);
+
+    /**
+     * @brief Возвращает true, если получен хотя бы один ключевой кадр.
+     */
+    bool Ready() const;
+
+    /**
+     * @brief Восстановленное состояние.
+     */
+    StreamState state;
+
+private:
+    /**
+     * @brief Состояние, к которому применяется кадр до проверки.
+     */
+    StreamState next;
+    /**
+     * @brief Флаг наличия ключевого кадра.
+     */
+    bool ready;
+};
+
+/**
+ * @brief Продвигает состояние на один тик по правилам предсказания потока.
+ *
+ * Формация сдвигается на direction пикселей, загадочный корабль - на свою скорость, лазеры - на свою.
+ *
+ * @param state Состояние.
+ */
+void PredictStreamState(StreamState &state);
@@ -0,0 +1,176 @@
+/**
+ * @file streamviewer.cpp
+ * @brief Зритель потока разностей состояния: восстанавливает игру из потока и рисует ее кодом Game::Draw.
+ *
+ * Запуск: invaders_stream_viewer FILE | -
+ *         invaders_stream_viewer --demo [--write FILE]
+ *
+ * Поток в файле или на стандартном вводе - последовательность кадров StreamEncoder, перед каждым
+ * из которых записана его длина (uint32, little-endian). В режиме --demo зритель сам запускает
+ * игру без окна со случайным вводом, кодирует ее состояние и показывает восстановленную копию;
+ * с --write поток дополнительно записывается в файл.
+ */
+
+#include "gamestream.hpp"
+#include "hud.hpp"
+#include "platform.hpp"
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <raylib.h>
+
+/**
+ * @brief Читает очередной кадр из файла.
+ *
+ * @param file Файл потока.
+ * @param frame Буфер кадра.
+ * @return false в конце потока.
+ */
+
+static bool ReadFrame(FILE *file, std::vector<uint8_t> &frame) {
+    uint8_t header[4];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header)) {
+        return false;
+    }
+    uint32_t size = header[0] | (header[1] << 8) | (header[2] << 16) | ((uint32_t) header[3] << 24);
+    frame.resize(size);
+    return fread(frame.data(), 1, size, file) == size;
+}
+
+/**
+ * @brief Записывает кадр в файл.
+ *
+ * @param file Файл потока.
+ * @param frame Кадр.
+ */
+
+static void WriteFrame(FILE *file, const std::vector<uint8_t> &frame) {
+    uint32_t size = frame.size();
+    uint8_t header[4] = {uint8_t(size), uint8_t(size >> 8), uint8_t(size >> 16), uint8_t(size >> 24)};
+    fwrite(header, 1, sizeof(header), file);
+    fwrite(frame.data(), 1, frame.size(), file);
+}
+
+/**
+ * @brief Главная функция зрителя.
+ *
+ * @param argc Количество аргументов командной строки.
+ * @param argv Аргументы командной строки.
+ * @return 0 в случае успешного завершения, 1 при ошибке аргументов.
+ */
+
+int main(int argc, char **argv) {
+    bool demo = false;
+    const char *inputPath = nullptr;
+    const char *writePath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--demo") == 0) {
+            demo = true;
+        } else if (strcmp(argv[i], "--write") == 0 && i + 1 < argc) {
+            writePath = argv[++i];
+        } else {
+            inputPath = argv[i];
+        }
+    }
+    if (!demo && inputPath == nullptr) {
+        fprintf(stderr, "usage: %s FILE | - | --demo [--write FILE]\n", argv[0]);
+        return 1;
+    }
+
+    FILE *input = nullptr;
+    if (!demo) {
+        input = strcmp(inputPath, "-") == 0 ? stdin : fopen(inputPath, "rb");
+        if (input == nullptr) {
+            perror(inputPath);
+            return 1;
+        }
+    }
+    FILE *output = writePath != nullptr ? fopen(writePath, "wb") : nullptr;
+
+    MountAssetPack(TextFormat("%sassets.pak", GetApplicationDirectory()));
+    Color grey = {29, 29, 27, 255};
+    Color yellow = {243, 216, 63, 255};
+    InitWindow(800, 800, "C++ Space Invaders - Stream Viewer");
+    SetTargetFPS(60);
+    Font font = LoadGameFont("../Font/monogram.ttf", 64);
+    Texture2D spaceshipImage = LoadGameTexture("../Graphics/spaceship.png");
+
+    // Игра-зеркало только рисует состояние из потока и не пишет рекорд в файл
+    Game mirror(true);
+    std::unique_ptr<Game> source;
+    if (demo) {
+        source.reset(new Game(true));
+        source->Seed(1);
+    }
+
+    StreamEncoder encoder;
+    StreamDecoder decoder;
+    StreamState captured;
+    std::vector<uint8_t> frame;
+    long long totalBytes = 0;
+    long long totalFrames = 0;
+    int inputFlags = 0;
+    InputQueue botQueue;
+    bool ended = false;
+
+    while (!WindowShouldClose()) {
+        bool haveFrame = false;
+        if (demo) {
+            // Случайный игрок, который держит команду несколько тиков подряд
+            if (source->RandomValue(0, 9) == 0) {
+                inputFlags = source->RandomValue(0, 7);
+            }
+            botQueue.PushState(source->simulationTime, 0, inputFlags);
+            botQueue.Tick(source->simulationTime);
+            source->ApplyInput(botQueue.Input(0));
+            source->Update();
+            if (!source->run) {
+                source->Reset();
+                source->InitGame();
+            }
+            CaptureStreamState(*source, captured);
+            frame.clear();
+            encoder.Encode(captured, frame);
+            if (output != nullptr) {
+                WriteFrame(output, frame);
+            }
+            haveFrame = true;
+        } else if (!ended) {
+            haveFrame = ReadFrame(input, frame);
+            ended = !haveFrame;
+        }
+
+        if (haveFrame) {
+            totalBytes += frame.size();
+            totalFrames++;
+            if (decoder.Decode(frame.data(), frame.size())) {
+                ApplyStreamState(decoder.state, mirror);
+            }
+        }
+
+        BeginDrawing();
+        ClearBackground(grey);
+        if (decoder.Ready()) {
+            DrawHud(mirror, font, spaceshipImage);
+            mirror.Draw();
+        }
+        if (totalFrames > 0) {
+            DrawText(TextFormat("%.1f B/tick%s", double(totalBytes) / totalFrames, ended ? "  (end of stream)" : ""),
+                     300, 770, 10, yellow);
+        }
+        EndDrawing();
+    }
+
+    if (output != nullptr) {
+        fclose(output);
+    }
+    if (input != nullptr && input != stdin) {
+        fclose(input);
+    }
+    source.reset();
+    Alien::UnloadImages();
+    UnloadGameTexture(spaceshipImage);
+    UnloadFont(font);
+    CloseWindow();
+    return 0;
+}
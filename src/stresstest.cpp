@@ -0,0 +1,187 @@
+/**
+ * @file stresstest.cpp
+ * @brief Файл реализации нагрузочного режима игры.
+ */
+
+#include "stresstest.hpp"
+#include "game.hpp"
+#include "framepacer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+/**
+ * @brief Возвращает пик занятой процессом памяти в килобайтах или -1, если он неизвестен.
+ */
+
+static long long PeakMemoryKb() {
+#if defined(_WIN32)
+    // windows.h конфликтует с именами raylib, а без него пик памяти не узнать
+    return -1;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+/**
+ * @brief Возвращает записанный ввод: корабль ходит от края до края и стреляет без перерыва.
+ *
+ * @param tick Номер тика.
+ */
+
+static int ScriptedInput(long long tick) {
+    return ((tick / 120) % 2 == 0 ? INPUT_RIGHT : INPUT_LEFT) | INPUT_FIRE;
+}
+
+/**
+ * @brief Возвращает случайный ввод; направление и выстрел меняются каждые 10 тиков.
+ *
+ * @param rng Генератор случайных чисел.
+ */
+
+static int RandomInput(std::mt19937 &rng) {
+    static const int moves[] = {0, INPUT_LEFT, INPUT_RIGHT};
+    return moves[rng() % 3] | (rng() % 4 != 0 ? INPUT_FIRE : 0);
+}
+
+/**
+ * @brief Запускает нагрузочный режим и печатает результаты измерений.
+ *
+ * @param argc Количество аргументов командной строки.
+ * @param argv Аргументы командной строки; argv[1] - "--stress".
+ * @return 0 при успешном прогоне, 1 при ошибке в аргументах.
+ */
+
+int RunStressTest(int argc, char **argv) {
+    int aliens = 4000;
+    int shields = 32;
+    int fireTicks = 2;
+    int volley = 8;
+    long long ticks = 3000;
+    bool randomInput = false;
+    unsigned int seed = 1;
+    int threads = JobSystem::HardwareThreads();
+    bool headless = false;
+    for (int i = 2; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--aliens") == 0 && hasValue) {
+            aliens = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--shields") == 0 && hasValue) {
+            shields = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fire") == 0 && hasValue) {
+            fireTicks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--volley") == 0 && hasValue) {
+            volley = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ticks") == 0 && hasValue) {
+            ticks = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--input") == 0 && hasValue) {
+            randomInput = strcmp(argv[++i], "random") == 0;
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            seed = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    SetTraceLogLevel(LOG_WARNING);
+    if (!headless) {
+        InitWindow(800, 800, "C++ Space Invaders - stress");
+        SetTargetFPS(0);
+    }
+    Color grey = {29, 29, 27, 255};
+
+    // Игра всегда создается без сохранения рекорда, чтобы прогоны не портили рекорд игрока
+    std::unique_ptr<Game> game(new Game(true));
+    game->Seed(seed);
+    game->SetThreads(threads);
+    game->EnableStress(aliens, shields, fireTicks, volley);
+    int formationSize = game->aliens.size();
+    int shieldCount = game->obstacles.size();
+
+    // Корзины по 0.1 мс до 500 мс
+    LatencyHistogram frameTimes(0.0001, 5000);
+    std::mt19937 inputRng(seed);
+    int input = 0;
+    long long restarts = 0;
+    size_t peakLasers = 0;
+
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start = Clock::now();
+    long long tick = 0;
+    for (; tick < ticks && (headless || !WindowShouldClose()); ++tick) {
+        Clock::time_point frameStart = Clock::now();
+        if (randomInput) {
+            if (tick % 10 == 0) {
+                input = RandomInput(inputRng);
+            }
+        } else {
+            input = ScriptedInput(tick);
+        }
+        // Под плотным огнем корабль не теряет жизни (за тик в него попадает несколько лазеров залпа),
+        // иначе игра почти все время начиналась бы заново
+        game->lives = 1000;
+        game->ApplyInput(input);
+        game->Update();
+        if (!game->run) {
+            game->Reset();
+            game->InitGame();
+            restarts++;
+        }
+        peakLasers = std::max(peakLasers, game->alienLasers.size() + game->spaceship.lasers.size());
+
+        if (!headless) {
+            BeginDrawing();
+            ClearBackground(grey);
+            game->Draw();
+            EndDrawing();
+        }
+        frameTimes.Add(std::chrono::duration<double>(Clock::now() - frameStart).count());
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    printf("mode               %s, %s input, seed %u, %d threads\n", headless ? "headless" : "window",
+           randomInput ? "random" : "scripted", seed, std::max(threads, 1));
+    printf("formation          %d aliens (%d x %d), %d shields\n", formationSize, game->formationRows,
+           game->formationColumns, shieldCount);
+    printf("alien fire         %d shots every %d ticks, peak %zu lasers\n", volley, fireTicks, peakLasers);
+    printf("ticks              %lld in %.2f s, %lld restarts\n", tick, elapsed, restarts);
+    printf("ticks/s            %.1f\n", elapsed > 0 ? tick / elapsed : 0.0);
+    printf("frame p50/p95/p99  %.2f / %.2f / %.2f ms\n", frameTimes.Percentile(0.5) * 1000,
+           frameTimes.Percentile(0.95) * 1000, frameTimes.Percentile(0.99) * 1000);
+    printf("frame mean/max     %.2f / %.2f ms\n", frameTimes.Mean() * 1000, frameTimes.Max() * 1000);
+    long long peakMemory = PeakMemoryKb();
+    if (peakMemory >= 0) {
+        printf("peak memory        %.1f MB\n", peakMemory / 1024.0);
+    } else {
+        printf("peak memory        n/a\n");
+    }
+
+    game.reset();
+    if (!headless) {
+        // Игра без окна не выгружает общие изображения инопланетян, они выгружаются до закрытия окна
+        Alien::UnloadImages();
+        CloseWindow();
+    }
+    return 0;
+}
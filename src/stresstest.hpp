@@ -0,0 +1,24 @@
+/**
+ * @file stresstest.hpp
+ * @brief Заголовочный файл нагрузочного режима игры.
+ */
+
+#pragma once
+
+/**
+ * @brief Запускает нагрузочный режим и печатает результаты измерений.
+ *
+ * Запуск: untitled --stress [--aliens 4000] [--shields 32] [--fire 2] [--volley 8] [--ticks 3000]
+ *         [--input script|random] [--seed 1] [--threads N] [--headless]
+ *
+ * Игра с формацией из тысяч инопланетян, множеством щитов и плотным огнем проходит заданное
+ * количество тиков с записанным или случайным вводом. Корабль не теряет жизни, а если формация
+ * дошла до корабля, игра сразу начинается заново. Кадры не ограничиваются по частоте. В конце
+ * печатаются тики в секунду, процентили времени кадра (симуляция и отрисовка) и пик занятой памяти.
+ * По умолчанию параллельные части тика используют все аппаратные потоки.
+ *
+ * @param argc Количество аргументов командной строки.
+ * @param argv Аргументы командной строки; argv[1] - "--stress".
+ * @return 0 при успешном прогоне, 1 при ошибке в аргументах.
+ */
+int RunStressTest(int argc, char **argv);
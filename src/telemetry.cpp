@@ -0,0 +1,373 @@
+/**
+ * @file telemetry.cpp
+ * @brief Файл реализации, содержащий чтение журнала телеметрии и методы классов TelemetryWriter
+ * и GameTelemetry.
+ */
+
+#include "telemetry.hpp"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+/**
+ * @brief Сигнатура файла журнала телеметрии.
+ */
+
+static const char telemetryMagic[8] = {'I', 'N', 'V', 'T', 'E', 'L', 'E', 'M'};
+
+/**
+ * @brief Возвращает время в микросекундах, ограниченное диапазоном uint32_t.
+ */
+
+static uint32_t Microseconds(double seconds) {
+    return (uint32_t) std::min(std::max(seconds * 1e6 + 0.5, 0.0), 4294967295.0);
+}
+
+/**
+ * @brief Читает записи файла журнала телеметрии и добавляет их в конец records.
+ *
+ * @param fileName Путь к файлу.
+ * @param records Записи.
+ * @return false, если файл не открылся или не является журналом телеметрии; неполная последняя
+ * запись (например, при аварийном завершении) отбрасывается без ошибки.
+ */
+
+bool ReadTelemetryFile(const char *fileName, std::vector<TelemetryRecord> &records) {
+    FILE *file = fopen(fileName, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    TelemetryFileHeader header;
+    bool valid = fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.magic, telemetryMagic, 8) == 0 &&
+                 header.version == telemetryVersion && header.recordSize == sizeof(TelemetryRecord);
+    if (valid) {
+        TelemetryRecord batch[256];
+        size_t count;
+        while ((count = fread(batch, sizeof(TelemetryRecord), 256, file)) > 0) {
+            records.insert(records.end(), batch, batch + count);
+        }
+    }
+    fclose(file);
+    return valid;
+}
+
+/**
+ * @brief Конструктор класса TelemetryWriter. Запускает поток записи.
+ *
+ * @param prefix Начало пути файлов журнала.
+ * @param maxFileBytes Наибольший размер файла в байтах.
+ * @param queueCapacity Наибольшее количество записей в очереди.
+ */
+
+TelemetryWriter::TelemetryWriter(const std::string &prefix, long long maxFileBytes, int queueCapacity) {
+    this->prefix = prefix + "-" + std::to_string((long long) time(nullptr));
+    // В файл помещаются хотя бы заголовок и одна запись
+    this->maxFileBytes = std::max<long long>(maxFileBytes, sizeof(TelemetryFileHeader) + sizeof(TelemetryRecord));
+    this->queueCapacity = std::max(queueCapacity, 1);
+    queue.reserve(this->queueCapacity);
+    writing = false;
+    stopping = false;
+    dropped = 0;
+    file = nullptr;
+    fileBytes = 0;
+    thread = std::thread(&TelemetryWriter::Run, this);
+}
+
+/**
+ * @brief Деструктор класса TelemetryWriter. Дописывает очередь и останавливает поток.
+ */
+
+TelemetryWriter::~TelemetryWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    thread.join();
+    if (file != nullptr) {
+        fclose(file);
+    }
+}
+
+/**
+ * @brief Ставит запись в очередь.
+ *
+ * @return false, если очередь заполнена и запись потеряна.
+ */
+
+bool TelemetryWriter::Write(const TelemetryRecord &record) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queue.size() >= queueCapacity) {
+            dropped++;
+            return false;
+        }
+        queue.push_back(record);
+    }
+    wake.notify_one();
+    return true;
+}
+
+/**
+ * @brief Ждет, пока поток запишет все поставленные в очередь записи.
+ */
+
+void TelemetryWriter::Flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    drained.wait(lock, [this]() { return queue.empty() && !writing; });
+}
+
+/**
+ * @brief Возвращает количество потерянных записей.
+ */
+
+long long TelemetryWriter::Dropped() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return dropped;
+}
+
+/**
+ * @brief Возвращает пути созданных файлов журнала.
+ */
+
+std::vector<std::string> TelemetryWriter::Files() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return files;
+}
+
+/**
+ * @brief Цикл потока записи.
+ *
+ * Очередь меняется местами с пачкой потока, поэтому запись на диск идет без блокировки,
+ * а память обеих не выделяется заново.
+ */
+
+void TelemetryWriter::Run() {
+    std::vector<TelemetryRecord> batch;
+    batch.reserve(queueCapacity);
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if (queue.empty()) {
+            return;
+        }
+        batch.swap(queue);
+        writing = true;
+        lock.unlock();
+        Append(batch);
+        batch.clear();
+        lock.lock();
+        writing = false;
+        drained.notify_all();
+    }
+}
+
+/**
+ * @brief Дописывает записи в текущий файл, открывая следующий при необходимости.
+ *
+ * Файл сбрасывается на диск после каждой пачки, чтобы при аварийном завершении терялось не больше
+ * одной пачки. Если файл не открылся, записи пачки теряются.
+ */
+
+void TelemetryWriter::Append(const std::vector<TelemetryRecord> &records) {
+    for (const TelemetryRecord &record: records) {
+        if (file != nullptr && fileBytes + (long long) sizeof(record) > maxFileBytes) {
+            fclose(file);
+            file = nullptr;
+        }
+        if (file == nullptr) {
+            std::string name;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                name = prefix + "-" + std::to_string(files.size()) + ".bin";
+                files.push_back(name);
+            }
+            file = fopen(name.c_str(), "wb");
+            if (file == nullptr) {
+                std::lock_guard<std::mutex> lock(mutex);
+                dropped += records.size();
+                return;
+            }
+            TelemetryFileHeader header;
+            memcpy(header.magic, telemetryMagic, 8);
+            header.version = telemetryVersion;
+            header.recordSize = sizeof(TelemetryRecord);
+            fwrite(&header, sizeof(header), 1, file);
+            fileBytes = sizeof(header);
+        }
+        fwrite(&record, sizeof(record), 1, file);
+        fileBytes += sizeof(record);
+    }
+    if (file != nullptr) {
+        fflush(file);
+    }
+}
+
+/**
+ * @brief Конструктор класса GameTelemetry.
+ *
+ * @param writer Журнал, в который пишутся записи.
+ * @param session Идентификатор запуска игры.
+ * @param budget Бюджет времени работы кадра в секундах.
+ */
+
+GameTelemetry::GameTelemetry(TelemetryWriter &writer, uint32_t session, double budget) : writer(writer) {
+    this->session = session;
+    this->budget = budget;
+    playing = false;
+    game = 0;
+    level = 0;
+    wave = {};
+    total = {};
+    overBudget = 0;
+    window = 0;
+}
+
+/**
+ * @brief Деструктор класса GameTelemetry. Записывает незаконченные волну, игру и окно кадров.
+ */
+
+GameTelemetry::~GameTelemetry() {
+    if (playing) {
+        WriteCounters(TELEMETRY_WAVE, wave);
+        WriteCounters(TELEMETRY_GAME, total);
+    }
+    if (frames.Count() > 0) {
+        WriteFrames();
+    }
+}
+
+/**
+ * @brief Учитывает шаг симуляции.
+ *
+ * Первый шаг идущей игры после окончания прошлой начинает новую игру; шаги остановленной игры
+ * не учитываются. Шаг, сменивший уровень, считается в прошлую волну.
+ *
+ * @param level Номер уровня после шага.
+ * @param shots Количество выстрелов игроков в шаге.
+ * @param score Счет после шага.
+ * @param run Флаг Game::run после шага.
+ * @param events События шага.
+ */
+
+void GameTelemetry::Tick(int level, int shots, int score, bool run, const std::vector<GameEvent> &events) {
+    if (!playing) {
+        if (!run) {
+            return;
+        }
+        playing = true;
+        game++;
+        this->level = level;
+    }
+
+    Counters delta = {};
+    delta.values[COUNT_TICKS] = 1;
+    delta.values[COUNT_SHOTS] = shots;
+    bool over = false;
+    for (const GameEvent &event: events) {
+        if (event.type == EVENT_ALIEN_KILLED || event.type == EVENT_MYSTERY_SHIP_KILLED) {
+            delta.values[COUNT_HITS]++;
+        } else if (event.type == EVENT_PLAYER_HIT) {
+            delta.values[COUNT_LIVES_LOST]++;
+        } else if (event.type == EVENT_BLOCK_DESTROYED) {
+            delta.values[COUNT_BLOCKS_LOST]++;
+        } else if (event.type == EVENT_GAME_OVER) {
+            over = true;
+        }
+    }
+    for (int i = 0; i < COUNT_SCORE; ++i) {
+        wave.values[i] += delta.values[i];
+        total.values[i] += delta.values[i];
+    }
+    wave.values[COUNT_SCORE] = score;
+    total.values[COUNT_SCORE] = score;
+
+    if (over) {
+        WriteCounters(TELEMETRY_WAVE, wave);
+        WriteCounters(TELEMETRY_GAME, total);
+        playing = false;
+    } else if (level != this->level) {
+        // Шаг, в котором уровень сменился, завершил прошлую волну
+        WriteCounters(TELEMETRY_WAVE, wave);
+        this->level = level;
+    }
+}
+
+/**
+ * @brief Учитывает перемотку идущей игры.
+ *
+ * Шаги незаконченной волны до перемотки вычитаются из счетчиков игры, и волна считается
+ * заново с места перемотки: иначе повторенные шаги считались бы дважды, а счет уменьшался бы.
+ * Волны, записанные до перемотки, остаются в журнале.
+ *
+ * @param level Номер уровня после перемотки.
+ * @param score Счет после перемотки.
+ */
+
+void GameTelemetry::Rewind(int level, int score) {
+    if (!playing) {
+        return;
+    }
+    for (int i = 0; i < COUNT_SCORE; ++i) {
+        total.values[i] -= wave.values[i];
+    }
+    wave = {};
+    wave.values[COUNT_SCORE] = score;
+    total.values[COUNT_SCORE] = score;
+    this->level = level;
+}
+
+/**
+ * @brief Учитывает время работы кадра.
+ *
+ * @param seconds Время работы кадра в секундах.
+ */
+
+void GameTelemetry::Frame(double seconds) {
+    frames.Add(seconds);
+    if (seconds > budget) {
+        overBudget++;
+    }
+    if (frames.Count() >= framesPerRecord) {
+        WriteFrames();
+    }
+}
+
+/**
+ * @brief Записывает счетчики и обнуляет их.
+ */
+
+void GameTelemetry::WriteCounters(int kind, Counters &counters) {
+    TelemetryRecord record = {};
+    record.session = session;
+    record.game = game;
+    record.kind = kind;
+    record.level = level;
+    std::copy(counters.values, counters.values + telemetryValueCount, record.values);
+    writer.Write(record);
+    counters = {};
+}
+
+/**
+ * @brief Записывает распределение времени кадров и начинает новое окно.
+ *
+ * Процентили берутся из гистограммы, поэтому точны до ширины ее корзины, и не превышают
+ * наибольшего времени.
+ */
+
+void GameTelemetry::WriteFrames() {
+    TelemetryRecord record = {};
+    record.session = session;
+    record.game = ++window;
+    record.kind = TELEMETRY_FRAMES;
+    record.level = level;
+    record.values[FRAME_COUNT] = frames.Count();
+    record.values[FRAME_MEAN] = Microseconds(frames.Mean());
+    record.values[FRAME_P50] = Microseconds(std::min(frames.Percentile(0.5), frames.Max()));
+    record.values[FRAME_P99] = Microseconds(std::min(frames.Percentile(0.99), frames.Max()));
+    record.values[FRAME_MAX] = Microseconds(frames.Max());
+    record.values[FRAME_OVER_BUDGET] = overBudget;
+    writer.Write(record);
+    frames.Reset();
+    overBudget = 0;
+}
@@ -0,0 +1,347 @@
+/**
+ * @file telemetry.hpp
+ * @brief Заголовочный файл, содержащий формат журнала телеметрии, класс TelemetryWriter для его
+ * записи и класс GameTelemetry, собирающий статистику игр и кадров.
+ *
+ * Журнал - набор файлов с записями фиксированного размера. Формат файла (little-endian): заголовок
+ * TelemetryFileHeader, затем записи TelemetryRecord. Файлы сводит программа invaders_telemetry.
+ */
+
+#pragma once
+
+#include "framepacer.hpp"
+#include "gameevents.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Версия формата журнала телеметрии.
+ */
+constexpr uint32_t telemetryVersion = 1;
+
+/**
+ * @enum TelemetryKind
+ * @brief Виды записей телеметрии.
+ */
+enum TelemetryKind {
+    TELEMETRY_WAVE,  ///< Волна (уровень) пройдена или прервана окончанием игры; значения TelemetryCount.
+    TELEMETRY_GAME,  ///< Игра окончена; значения TelemetryCount за всю игру.
+    TELEMETRY_FRAMES ///< Распределение времени работы кадров за окно; значения TelemetryFrameValue.
+};
+
+/**
+ * @enum TelemetryCount
+ * @brief Индексы значений записей TELEMETRY_WAVE и TELEMETRY_GAME.
+ */
+enum TelemetryCount {
+    COUNT_TICKS,       ///< Длительность в тиках.
+    COUNT_SHOTS,       ///< Выстрелы игроков.
+    COUNT_HITS,        ///< Сбитые инопланетяне и загадочные корабли.
+    COUNT_LIVES_LOST,  ///< Потерянные жизни.
+    COUNT_BLOCKS_LOST, ///< Попадания лазеров в щиты.
+    COUNT_SCORE        ///< Счет в конце.
+};
+
+/**
+ * @enum TelemetryFrameValue
+ * @brief Индексы значений записи TELEMETRY_FRAMES; время - в микросекундах.
+ */
+enum TelemetryFrameValue {
+    FRAME_COUNT,      ///< Количество кадров в окне.
+    FRAME_MEAN,       ///< Среднее время.
+    FRAME_P50,        ///< Медиана.
+    FRAME_P99,        ///< 99-й процентиль.
+    FRAME_MAX,        ///< Наибольшее время.
+    FRAME_OVER_BUDGET ///< Количество кадров дольше бюджета.
+};
+
+/**
+ * @brief Количество значений в записи телеметрии.
+ */
+constexpr int telemetryValueCount = 6;
+
+/**
+ * @struct TelemetryRecord
+ * @brief Запись журнала телеметрии (36 байт).
+ */
+struct TelemetryRecord {
+    uint32_t session;                     ///< Идентификатор запуска игры.
+    uint32_t game;                        ///< Номер игры в запуске, начиная с 1; для TELEMETRY_FRAMES - номер окна.
+    uint16_t kind;                        ///< Вид записи (TelemetryKind).
+    uint16_t level;                       ///< Номер уровня; для TELEMETRY_GAME - последний уровень.
+    uint32_t values[telemetryValueCount]; ///< Значения по индексам TelemetryCount или TelemetryFrameValue.
+};
+
+static_assert(sizeof(TelemetryRecord) == 36, "TelemetryRecord must stay 36 bytes");
+
+/**
+ * @struct TelemetryFileHeader
+ * @brief Заголовок файла журнала телеметрии.
+ */
+struct TelemetryFileHeader {
+    char magic[8];       ///< Сигнатура "INVTELEM".
+    uint32_t version;    ///< Версия формата (telemetryVersion).
+    uint32_t recordSize; ///< Размер записи в байтах.
+};
+
+/**
+ * @brief Читает записи файла журнала телеметрии и добавляет их в конец records.
+ *
+ * @param fileName Путь к файлу.
+ * @param records Записи.
+ * @return false, если файл не открылся или не является журналом телеметрии; неполная последняя
+ * запись (например, при аварийном завершении) отбрасывается без ошибки.
+ */
+bool ReadTelemetryFile(const char *fileName, std::vector<TelemetryRecord> &records);
+
+/**
+ * @class TelemetryWriter
+ * @brief Запись журнала телеметрии в фоновом потоке с ограниченной очередью и сменой файлов по размеру.
+ *
+ * Write только кладет запись в очередь и не ждет диска; если очередь заполнена, запись теряется
+ * и учитывается в Dropped(). Поток забирает из очереди все записи сразу и дописывает их в файл
+ * prefix-<время запуска>-<номер>.bin; файл, который превысил бы maxFileBytes, закрывается,
+ * и запись продолжается в следующий.
+ */
+
+class TelemetryWriter {
+public:
+    /**
+     * @brief Конструктор класса TelemetryWriter. Запускает поток записи.
+     *
+     * @param prefix Начало пути файлов журнала.
+     * @param maxFileBytes Наибольший размер файла в байтах.
+     * @param queueCapacity Наибольшее количество записей в очереди.
+     */
+    explicit TelemetryWriter(const std::string &prefix, long long maxFileBytes = 1 << 20,
+                             int queueCapacity = 1024);
+
+    /**
+     * @brief Деструктор класса TelemetryWriter. Дописывает очередь и останавливает поток.
+     */
+    ~TelemetryWriter();
+
+    TelemetryWriter(const TelemetryWriter &) = delete;
+    TelemetryWriter &operator=(const TelemetryWriter &) = delete;
+
+    /**
+     * @brief Ставит запись в очередь.
+     *
+     * @return false, если очередь заполнена и запись потеряна.
+     */
+    bool Write(const TelemetryRecord &record);
+
+    /**
+     * @brief Ждет, пока поток запишет все поставленные в очередь записи.
+     */
+    void Flush();
+
+    /**
+     * @brief Возвращает количество потерянных записей.
+     */
+    long long Dropped();
+
+    /**
+     * @brief Возвращает пути созданных файлов журнала.
+     */
+    std::vector<std::string> Files();
+
+private:
+    /**
+     * @brief Цикл потока записи.
+     */
+    void Run();
+
+    /**
+     * @brief Дописывает записи в текущий файл, открывая следующий при необходимости.
+     */
+    void Append(const std::vector<TelemetryRecord> &records);
+
+    /**
+     * @brief Начало пути файлов журнала вместе со временем запуска.
+     */
+    std::string prefix;
+    /**
+     * @brief Наибольший размер файла.
+     */
+    long long maxFileBytes;
+    /**
+     * @brief Наибольшее количество записей в очереди.
+     */
+    size_t queueCapacity;
+    /**
+     * @brief Защищает очередь, флаги и счетчики.
+     */
+    std::mutex mutex;
+    /**
+     * @brief Будит поток записи.
+     */
+    std::condition_variable wake;
+    /**
+     * @brief Сообщает о записи очереди.
+     */
+    std::condition_variable drained;
+    /**
+     * @brief Очередь записей.
+     */
+    std::vector<TelemetryRecord> queue;
+    /**
+     * @brief Флаг записи забранной из очереди пачки.
+     */
+    bool writing;
+    /**
+     * @brief Флаг остановки потока.
+     */
+    bool stopping;
+    /**
+     * @brief Количество потерянных записей.
+     */
+    long long dropped;
+    /**
+     * @brief Пути созданных файлов.
+     */
+    std::vector<std::string> files;
+    /**
+     * @brief Текущий файл или nullptr; используется только потоком записи.
+     */
+    FILE *file;
+    /**
+     * @brief Размер текущего файла; используется только потоком записи.
+     */
+    long long fileBytes;
+    /**
+     * @brief Поток записи.
+     */
+    std::thread thread;
+};
+
+/**
+ * @class GameTelemetry
+ * @brief Сбор статистики игр, волн и кадров в записи телеметрии.
+ *
+ * Tick вызывается после каждого шага симуляции и считает выстрелы, попадания, потерянные жизни
+ * и попадания в щиты по событиям тика. Смена уровня закрывает запись волны, событие окончания
+ * игры - записи волны и игры; Rewind отбрасывает шаги незаконченной волны при перемотке игры.
+ * Frame добавляет время работы кадра в гистограмму, которая каждые framesPerRecord кадров
+ * становится записью распределения. Эти вызовы не выделяют память и не обращаются к диску.
+ */
+
+class GameTelemetry {
+public:
+    /**
+     * @brief Конструктор класса GameTelemetry.
+     *
+     * @param writer Журнал, в который пишутся записи.
+     * @param session Идентификатор запуска игры.
+     * @param budget Бюджет времени работы кадра в секундах.
+     */
+    GameTelemetry(TelemetryWriter &writer, uint32_t session, double budget = 1.0 / 60.0);
+
+    /**
+     * @brief Деструктор класса GameTelemetry. Записывает незаконченные волну, игру и окно кадров.
+     */
+    ~GameTelemetry();
+
+    /**
+     * @brief Учитывает шаг симуляции.
+     *
+     * @param level Номер уровня после шага.
+     * @param shots Количество выстрелов игроков в шаге.
+     * @param score Счет после шага.
+     * @param run Флаг Game::run после шага.
+     * @param events События шага.
+     */
+    void Tick(int level, int shots, int score, bool run, const std::vector<GameEvent> &events);
+
+    /**
+     * @brief Учитывает перемотку идущей игры.
+     *
+     * Шаги незаконченной волны до перемотки вычитаются из счетчиков игры, и волна считается
+     * заново с места перемотки: иначе повторенные шаги считались бы дважды, а счет уменьшался бы.
+     * Волны, записанные до перемотки, остаются в журнале.
+     *
+     * @param level Номер уровня после перемотки.
+     * @param score Счет после перемотки.
+     */
+    void Rewind(int level, int score);
+
+    /**
+     * @brief Учитывает время работы кадра.
+     *
+     * @param seconds Время работы кадра в секундах.
+     */
+    void Frame(double seconds);
+
+    /**
+     * @brief Количество кадров в одной записи распределения.
+     */
+    constexpr static int framesPerRecord = 600;
+
+private:
+    /**
+     * @brief Счетчики волны или игры по индексам TelemetryCount.
+     */
+    struct Counters {
+        uint32_t values[telemetryValueCount]; ///< Значения.
+    };
+
+    /**
+     * @brief Записывает счетчики и обнуляет их.
+     */
+    void WriteCounters(int kind, Counters &counters);
+
+    /**
+     * @brief Записывает распределение времени кадров и начинает новое окно.
+     */
+    void WriteFrames();
+
+    /**
+     * @brief Журнал.
+     */
+    TelemetryWriter &writer;
+    /**
+     * @brief Идентификатор запуска.
+     */
+    uint32_t session;
+    /**
+     * @brief Бюджет времени работы кадра.
+     */
+    double budget;
+    /**
+     * @brief Флаг идущей игры.
+     */
+    bool playing;
+    /**
+     * @brief Номер текущей или последней игры.
+     */
+    uint32_t game;
+    /**
+     * @brief Текущий уровень.
+     */
+    int level;
+    /**
+     * @brief Счетчики текущей волны.
+     */
+    Counters wave;
+    /**
+     * @brief Счетчики текущей игры.
+     */
+    Counters total;
+    /**
+     * @brief Время работы кадров текущего окна.
+     */
+    LatencyHistogram frames;
+    /**
+     * @brief Количество кадров текущего окна дольше бюджета.
+     */
+    uint32_t overBudget;
+    /**
+     * @brief Номер окна кадров.
+     */
+    uint32_t window;
+};
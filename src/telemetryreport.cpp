@@ -0,0 +1,146 @@
+/**
+ * @file telemetryreport.cpp
+ * @brief Программа сводки журналов телеметрии (см. telemetry.hpp).
+ *
+ * Запуск: invaders_telemetry FILE...
+ *
+ * Читает файлы журнала любого количества запусков и печатает таблицы: итоги игр, итоги волн
+ * по уровням и распределение времени работы кадров.
+ */
+
+#include "telemetry.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <vector>
+
+/**
+ * @brief Итоги группы записей волн или игр.
+ */
+struct CountSummary {
+    long long records;                   ///< Количество записей.
+    long long sums[telemetryValueCount]; ///< Суммы значений по индексам TelemetryCount.
+    std::vector<uint32_t> ticks;         ///< Длительности для медианы.
+    uint32_t bestScore;                  ///< Наибольший счет.
+};
+
+/**
+ * @brief Добавляет запись волны или игры в итоги.
+ */
+
+static void AddCounts(CountSummary &summary, const TelemetryRecord &record) {
+    summary.records++;
+    for (int i = 0; i < telemetryValueCount; ++i) {
+        summary.sums[i] += record.values[i];
+    }
+    summary.ticks.push_back(record.values[COUNT_TICKS]);
+    summary.bestScore = std::max(summary.bestScore, record.values[COUNT_SCORE]);
+}
+
+/**
+ * @brief Возвращает медиану длительностей в секундах.
+ */
+
+static double MedianSeconds(std::vector<uint32_t> ticks) {
+    if (ticks.empty()) {
+        return 0.0;
+    }
+    std::nth_element(ticks.begin(), ticks.begin() + ticks.size() / 2, ticks.end());
+    return ticks[ticks.size() / 2] / 60.0;
+}
+
+/**
+ * @brief Возвращает отношение или 0, если знаменатель равен 0.
+ */
+
+static double Ratio(double value, double total) {
+    return total > 0 ? value / total : 0.0;
+}
+
+/**
+ * @brief Печатает строку таблицы итогов волн или игр.
+ */
+
+static void PrintCounts(const char *name, const CountSummary &summary) {
+    double records = summary.records;
+    printf("%-8s %7lld %9.1f %9.1f %8.1f%% %7.2f %8.1f %9.0f %8u\n", name, summary.records,
+           Ratio(summary.sums[COUNT_TICKS], records) / 60.0, MedianSeconds(summary.ticks),
+           100.0 * Ratio(summary.sums[COUNT_HITS], summary.sums[COUNT_SHOTS]),
+           Ratio(summary.sums[COUNT_LIVES_LOST], records), Ratio(summary.sums[COUNT_BLOCKS_LOST], records),
+           Ratio(summary.sums[COUNT_SCORE], records), summary.bestScore);
+}
+
+/**
+ * @brief Главная функция программы сводки.
+ *
+ * @param argc Количество аргументов командной строки.
+ * @param argv Аргументы командной строки.
+ * @return 0 в случае успеха, 1 при ошибке.
+ */
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s FILE...\n", argv[0]);
+        return 1;
+    }
+    std::vector<TelemetryRecord> records;
+    int files = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (ReadTelemetryFile(argv[i], records)) {
+            files++;
+        } else {
+            fprintf(stderr, "skipping %s: not a telemetry log\n", argv[i]);
+        }
+    }
+
+    std::set<uint32_t> sessions;
+    CountSummary games = {};
+    std::map<int, CountSummary> waves;
+    long long windows = 0;
+    long long frames = 0;
+    long long overBudget = 0;
+    double weightedMean = 0;
+    double weightedP50 = 0;
+    uint32_t worstP99 = 0;
+    uint32_t worstMax = 0;
+    std::vector<uint32_t> p99s;
+    for (const TelemetryRecord &record: records) {
+        sessions.insert(record.session);
+        if (record.kind == TELEMETRY_GAME) {
+            AddCounts(games, record);
+        } else if (record.kind == TELEMETRY_WAVE) {
+            AddCounts(waves[record.level], record);
+        } else if (record.kind == TELEMETRY_FRAMES) {
+            uint32_t count = record.values[FRAME_COUNT];
+            windows++;
+            frames += count;
+            overBudget += record.values[FRAME_OVER_BUDGET];
+            weightedMean += (double) record.values[FRAME_MEAN] * count;
+            weightedP50 += (double) record.values[FRAME_P50] * count;
+            worstP99 = std::max(worstP99, record.values[FRAME_P99]);
+            worstMax = std::max(worstMax, record.values[FRAME_MAX]);
+            p99s.push_back(record.values[FRAME_P99]);
+        }
+    }
+
+    printf("%d files, %zu records, %zu sessions\n\n", files, records.size(), sessions.size());
+    printf("%-8s %7s %9s %9s %9s %7s %8s %9s %8s\n", "", "count", "mean s", "median s", "accuracy", "lives",
+           "shields", "score", "best");
+    PrintCounts("games", games);
+    for (const auto &wave: waves) {
+        char name[16];
+        snprintf(name, sizeof(name), "wave %d", wave.first);
+        PrintCounts(name, wave.second);
+    }
+
+    printf("\nframe work time: %lld frames in %lld windows\n", frames, windows);
+    if (frames > 0) {
+        std::sort(p99s.begin(), p99s.end());
+        printf("  mean %.2f ms  p50 avg %.2f ms  p99 median %.2f ms  p99 worst %.2f ms  max %.2f ms\n",
+               weightedMean / frames / 1000, weightedP50 / frames / 1000, p99s[p99s.size() / 2] / 1000.0,
+               worstP99 / 1000.0, worstMax / 1000.0);
+        printf("  over budget %lld (%.2f%%)\n", overBudget, 100.0 * overBudget / frames);
+    }
+    return 0;
+}
@@ -0,0 +1,297 @@
+/**
+ * @file timerwheel.cpp
+ * @brief Файл реализации класса TimerWheel.
+ */
+
+#include "timerwheel.hpp"
+
+/**
+ * @brief Количество ячеек на одном уровне.
+ */
+static const int slotsPerLevel = 1 << timerWheelBits;
+
+/**
+ * @brief Маска номера ячейки.
+ */
+static const uint64_t slotMask = slotsPerLevel - 1;
+
+/**
+ * @brief Наибольшее расстояние до срока, которое помещается в колесо.
+ */
+static const uint64_t wheelSpan = (uint64_t) 1 << (timerWheelBits * timerWheelLevels);
+
+/**
+ * @brief Конструктор класса TimerWheel. Создает пустое колесо с текущим тиком 0.
+ */
+
+TimerWheel::TimerWheel() {
+    heads.assign(timerWheelLevels * slotsPerLevel, -1);
+    freeList = -1;
+    now = 0;
+    count = 0;
+}
+
+/**
+ * @brief Удаляет все таймеры и задает текущий тик.
+ *
+ * Узлы остаются в пуле, их поколения увеличиваются, поэтому старые идентификаторы становятся
+ * недействительными.
+ *
+ * @param tick Текущий тик.
+ */
+
+void TimerWheel::Reset(uint64_t tick) {
+    heads.assign(timerWheelLevels * slotsPerLevel, -1);
+    freeList = -1;
+    for (int i = (int) nodes.size() - 1; i >= 0; --i) {
+        if (nodes[i].slot >= 0) {
+            nodes[i].generation++;
+        }
+        nodes[i].slot = -1;
+        nodes[i].next = freeList;
+        freeList = i;
+    }
+    now = tick;
+    count = 0;
+}
+
+/**
+ * @brief Выделяет память под заданное количество таймеров заранее.
+ *
+ * @param capacity Количество таймеров.
+ */
+
+void TimerWheel::Reserve(int capacity) {
+    nodes.reserve(capacity);
+}
+
+/**
+ * @brief Ставит таймер.
+ *
+ * @param delay Через сколько тиков таймер сработает (0 считается за 1).
+ * @param kind Вид события.
+ * @param payload Значение для владельца.
+ * @return Идентификатор таймера.
+ */
+
+TimerId TimerWheel::Schedule(uint64_t delay, int kind, int payload) {
+    int index = freeList;
+    if (index >= 0) {
+        freeList = nodes[index].next;
+    } else {
+        index = nodes.size();
+        nodes.push_back({});
+        nodes[index].generation = 1;
+    }
+    Node &node = nodes[index];
+    node.due = now + (delay > 0 ? delay : 1);
+    node.kind = kind;
+    node.payload = payload;
+    Insert(index);
+    count++;
+    return (TimerId) node.generation << 32 | (uint32_t) index;
+}
+
+/**
+ * @brief Отменяет таймер.
+ *
+ * @param id Идентификатор таймера.
+ * @return false, если таймер уже сработал или отменен.
+ */
+
+bool TimerWheel::Cancel(TimerId id) {
+    int index = Find(id);
+    if (index < 0) {
+        return false;
+    }
+    Unlink(index);
+    Release(index);
+    return true;
+}
+
+/**
+ * @brief Проверяет, ждет ли таймер срабатывания.
+ */
+
+bool TimerWheel::Pending(TimerId id) const {
+    return Find(id) >= 0;
+}
+
+/**
+ * @brief Возвращает, через сколько тиков сработает таймер, или -1, если он не ждет.
+ */
+
+long long TimerWheel::Remaining(TimerId id) const {
+    int index = Find(id);
+    return index < 0 ? -1 : (long long) (nodes[index].due - now);
+}
+
+/**
+ * @brief Продвигает колесо на один тик и возвращает сработавшие таймеры.
+ *
+ * Сначала на нижние уровни перекладываются ячейки верхних уровней, у которых начался период,
+ * затем срабатывают таймеры текущей ячейки нижнего уровня в порядке постановки в ячейку.
+ *
+ * @param fired Вектор, в который записываются сработавшие таймеры (старое содержимое удаляется).
+ */
+
+void TimerWheel::Advance(std::vector<TimerEvent> &fired) {
+    fired.clear();
+    now++;
+    for (int level = 1; level < timerWheelLevels; ++level) {
+        if ((now & (((uint64_t) 1 << (timerWheelBits * level)) - 1)) != 0) {
+            break;
+        }
+        Cascade(level);
+    }
+
+    int slot = now & slotMask;
+    while (heads[slot] >= 0) {
+        int index = heads[slot];
+        Unlink(index);
+        if (nodes[index].due > now) {
+            // Сюда попадают только таймеры, перенесенные из-за ограничения дальности колеса
+            Insert(index);
+            continue;
+        }
+        uint32_t generation = nodes[index].generation;
+        fired.push_back({(TimerId) generation << 32 | (uint32_t) index, nodes[index].kind, nodes[index].payload});
+        Release(index);
+    }
+}
+
+/**
+ * @brief Возвращает текущий тик.
+ */
+
+uint64_t TimerWheel::Now() const {
+    return now;
+}
+
+/**
+ * @brief Возвращает количество ждущих таймеров.
+ */
+
+int TimerWheel::Count() const {
+    return count;
+}
+
+/**
+ * @brief Дописывает состояние колеса в байты (см. statebytes.hpp).
+ */
+
+void TimerWheel::Save(std::vector<uint8_t> &bytes) const {
+    PutState(bytes, nodes);
+    PutState(bytes, heads);
+    PutState(bytes, freeList);
+    PutState(bytes, now);
+    PutState(bytes, count);
+}
+
+/**
+ * @brief Восстанавливает состояние колеса из байтов Save.
+ *
+ * @return false, если байты кончились или не подходят колесу.
+ */
+
+bool TimerWheel::Load(StateReader &reader) {
+    return reader.Get(nodes) && reader.Get(heads) && heads.size() == timerWheelLevels * slotsPerLevel &&
+           reader.Get(freeList) && reader.Get(now) && reader.Get(count);
+}
+
+/**
+ * @brief Кладет узел в ячейку, соответствующую сроку.
+ *
+ * Уровень выбирается по расстоянию до срока, ячейка - по битам срока этого уровня. Узлы
+ * добавляются в конец списка, поэтому таймеры с одним сроком срабатывают в порядке постановки.
+ */
+
+void TimerWheel::Insert(int index) {
+    Node &node = nodes[index];
+    uint64_t due = node.due > now ? node.due : now;
+    if (due - now >= wheelSpan) {
+        due = now + wheelSpan - 1;
+    }
+    uint64_t distance = due - now;
+    int level = 0;
+    while (level < timerWheelLevels - 1 && distance >= ((uint64_t) 1 << (timerWheelBits * (level + 1)))) {
+        level++;
+    }
+    int slot = level * slotsPerLevel + (int) ((due >> (timerWheelBits * level)) & slotMask);
+
+    node.slot = slot;
+    node.next = -1;
+    // Последний узел списка хранится в prev первого узла
+    if (heads[slot] < 0) {
+        node.prev = index;
+        heads[slot] = index;
+        return;
+    }
+    int tail = nodes[heads[slot]].prev;
+    nodes[tail].next = index;
+    node.prev = tail;
+    nodes[heads[slot]].prev = index;
+}
+
+/**
+ * @brief Вынимает узел из списка ячейки.
+ */
+
+void TimerWheel::Unlink(int index) {
+    Node &node = nodes[index];
+    int head = heads[node.slot];
+    if (index == head) {
+        heads[node.slot] = node.next;
+        if (node.next >= 0) {
+            nodes[node.next].prev = node.prev;
+        }
+    } else {
+        nodes[node.prev].next = node.next;
+        if (node.next >= 0) {
+            nodes[node.next].prev = node.prev;
+        } else {
+            nodes[head].prev = node.prev;
+        }
+    }
+    node.slot = -1;
+}
+
+/**
+ * @brief Освобождает вынутый узел.
+ */
+
+void TimerWheel::Release(int index) {
+    Node &node = nodes[index];
+    node.generation++;
+    node.next = freeList;
+    freeList = index;
+    count--;
+}
+
+/**
+ * @brief Перекладывает таймеры текущей ячейки уровня по нижним уровням.
+ */
+
+void TimerWheel::Cascade(int level) {
+    int slot = level * slotsPerLevel + (int) ((now >> (timerWheelBits * level)) & slotMask);
+    int index = heads[slot];
+    heads[slot] = -1;
+    while (index >= 0) {
+        int next = nodes[index].next;
+        Insert(index);
+        index = next;
+    }
+}
+
+/**
+ * @brief Возвращает номер узла по идентификатору или -1.
+ */
+
+int TimerWheel::Find(TimerId id) const {
+    uint32_t index = (uint32_t) id;
+    uint32_t generation = id >> 32;
+    if (index >= nodes.size() || nodes[index].generation != generation || nodes[index].slot < 0) {
+        return -1;
+    }
+    return index;
+}
@@ -0,0 +1,199 @@
+/**
+ * @file timerwheel.hpp
+ * @brief Заголовочный файл, содержащий класс TimerWheel.
+ */
+
+#pragma once
+
+#include "statebytes.hpp"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Идентификатор таймера; 0 - недействительный идентификатор.
+ */
+using TimerId = uint64_t;
+
+/**
+ * @brief Количество уровней колеса таймеров.
+ */
+constexpr int timerWheelLevels = 4;
+
+/**
+ * @brief Количество бит номера ячейки на одном уровне (64 ячейки).
+ */
+constexpr int timerWheelBits = 6;
+
+/**
+ * @struct TimerEvent
+ * @brief Сработавший таймер.
+ */
+struct TimerEvent {
+    /**
+     * @brief Идентификатор таймера.
+     */
+    TimerId id;
+    /**
+     * @brief Вид события, заданный при постановке таймера.
+     */
+    int kind;
+    /**
+     * @brief Значение, заданное при постановке таймера.
+     */
+    int payload;
+};
+
+/**
+ * @class TimerWheel
+ * @brief Иерархическое колесо таймеров с отсчетом в тиках симуляции.
+ *
+ * Таймеры хранятся в ячейках 4 уровней по 64 ячейки: на уровне L ячейка покрывает 64^L тиков.
+ * Постановка и отмена таймера - O(1) (вставка в двусвязный список ячейки и удаление из него),
+ * тик обрабатывает только одну ячейку нижнего уровня; раз в 64^L тиков ячейка уровня L
+ * раскладывается по нижним уровням. Таймеры не хранят функций: при срабатывании выдаются вид
+ * события и значение, и владелец сам решает, что делать. Поэтому колесо можно восстановить из
+ * сохраненного состояния, поставив таймеры заново.
+ *
+ * Таймеры дальше 64^4 тиков (около 77 часов при 60 тиках в секунду) ставятся в последнюю ячейку
+ * верхнего уровня и перекладываются, пока срок не приблизится.
+ */
+
+class TimerWheel {
+public:
+    /**
+     * @brief Конструктор класса TimerWheel. Создает пустое колесо с текущим тиком 0.
+     */
+    TimerWheel();
+
+    /**
+     * @brief Удаляет все таймеры и задает текущий тик.
+     *
+     * @param tick Текущий тик.
+     */
+    void Reset(uint64_t tick);
+
+    /**
+     * @brief Выделяет память под заданное количество таймеров заранее.
+     *
+     * @param capacity Количество таймеров.
+     */
+    void Reserve(int capacity);
+
+    /**
+     * @brief Ставит таймер.
+     *
+     * @param delay Через сколько тиков таймер сработает (0 считается за 1).
+     * @param kind Вид события.
+     * @param payload Значение для владельца.
+     * @return Идентификатор таймера.
+     */
+    TimerId Schedule(uint64_t delay, int kind, int payload = 0);
+
+    /**
+     * @brief Отменяет таймер.
+     *
+     * @param id Идентификатор таймера.
+     * @return false, если таймер уже сработал или отменен.
+     */
+    bool Cancel(TimerId id);
+
+    /**
+     * @brief Проверяет, ждет ли таймер срабатывания.
+     */
+    bool Pending(TimerId id) const;
+
+    /**
+     * @brief Возвращает, через сколько тиков сработает таймер, или -1, если он не ждет.
+     */
+    long long Remaining(TimerId id) const;
+
+    /**
+     * @brief Продвигает колесо на один тик и возвращает сработавшие таймеры.
+     *
+     * @param fired Вектор, в который записываются сработавшие таймеры (старое содержимое удаляется).
+     */
+    void Advance(std::vector<TimerEvent> &fired);
+
+    /**
+     * @brief Возвращает текущий тик.
+     */
+    uint64_t Now() const;
+
+    /**
+     * @brief Возвращает количество ждущих таймеров.
+     */
+    int Count() const;
+
+    /**
+     * @brief Дописывает состояние колеса в байты (см. statebytes.hpp).
+     */
+    void Save(std::vector<uint8_t> &bytes) const;
+
+    /**
+     * @brief Восстанавливает состояние колеса из байтов Save.
+     *
+     * @return false, если байты кончились или не подходят колесу.
+     */
+    bool Load(StateReader &reader);
+
+private:
+    /**
+     * @struct Node
+     * @brief Таймер в списке ячейки.
+     */
+    struct Node {
+        uint64_t due;        ///< Тик срабатывания.
+        int kind;            ///< Вид события.
+        int payload;         ///< Значение для владельца.
+        uint32_t generation; ///< Поколение узла; меняется при освобождении, чтобы старые идентификаторы не совпадали.
+        int slot;            ///< Номер ячейки или -1, если узел свободен.
+        int prev;            ///< Предыдущий узел списка ячейки; у первого узла - последний узел.
+        int next;            ///< Следующий узел списка ячейки или следующий свободный узел.
+    };
+
+    /**
+     * @brief Кладет узел в ячейку, соответствующую сроку.
+     */
+    void Insert(int index);
+
+    /**
+     * @brief Вынимает узел из списка ячейки.
+     */
+    void Unlink(int index);
+
+    /**
+     * @brief Освобождает вынутый узел.
+     */
+    void Release(int index);
+
+    /**
+     * @brief Перекладывает таймеры текущей ячейки уровня по нижним уровням.
+     */
+    void Cascade(int level);
+
+    /**
+     * @brief Возвращает номер узла по идентификатору или -1.
+     */
+    int Find(TimerId id) const;
+
+    /**
+     * @brief Узлы таймеров.
+     */
+    std::vector<Node> nodes;
+    /**
+     * @brief Первые узлы списков ячеек (-1 - пустая ячейка).
+     */
+    std::vector<int> heads;
+    /**
+     * @brief Первый свободный узел или -1.
+     */
+    int freeList;
+    /**
+     * @brief Текущий тик.
+     */
+    uint64_t now;
+    /**
+     * @brief Количество ждущих таймеров.
+     */
+    int count;
+};
@@ -0,0 +1,136 @@
+/**
+ * @file udplink.cpp
+ * @brief Файл реализации канала UDP между двумя игроками с имитацией задержки и потерь.
+ */
+
+#include "udplink.hpp"
+#include <arpa/inet.h>
+#include <cstring>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief Возвращает текущее время CLOCK_MONOTONIC в наносекундах.
+ */
+
+static long long NowNs() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * @brief Конструктор класса UdpLink.
+ *
+ * @param conditions Имитируемые условия сети.
+ * @param seed Начальное значение генератора потерь и задержек.
+ */
+
+UdpLink::UdpLink(LinkConditions conditions, unsigned int seed) {
+    this->conditions = conditions;
+    rng.seed(seed);
+    fd = -1;
+    dropped = 0;
+    memset(&remote, 0, sizeof(remote));
+}
+
+/**
+ * @brief Деструктор класса UdpLink. Закрывает сокет.
+ */
+
+UdpLink::~UdpLink() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+/**
+ * @brief Открывает сокет на локальном порту и задает адрес соперника.
+ *
+ * @param localPort Локальный порт UDP.
+ * @param remoteHost Адрес IPv4 соперника.
+ * @param remotePort Порт соперника.
+ * @return false при ошибке.
+ */
+
+bool UdpLink::Open(int localPort, const char *remoteHost, int remotePort) {
+    remote.sin_family = AF_INET;
+    remote.sin_port = htons(remotePort);
+    if (inet_pton(AF_INET, remoteHost, &remote.sin_addr) != 1) {
+        return false;
+    }
+
+    fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    sockaddr_in local = {};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(localPort);
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    return bind(fd, (sockaddr *) &local, sizeof(local)) == 0;
+}
+
+/**
+ * @brief Ставит пакет в очередь отправки с имитируемой задержкой (или теряет его).
+ *
+ * Без имитации пакет отправляется сразу.
+ *
+ * @param data Пакет.
+ * @param size Размер пакета.
+ */
+
+void UdpLink::Send(const uint8_t *data, size_t size) {
+    if (conditions.loss > 0 && std::uniform_real_distribution<double>(0, 1)(rng) < conditions.loss) {
+        dropped++;
+        return;
+    }
+    if (conditions.latencyMs <= 0 && conditions.jitterMs <= 0) {
+        sendto(fd, data, size, 0, (sockaddr *) &remote, sizeof(remote));
+        return;
+    }
+    int jitter = conditions.jitterMs > 0 ? std::uniform_int_distribution<int>(0, conditions.jitterMs)(rng) : 0;
+    long long due = NowNs() + (conditions.latencyMs + jitter) * 1000000LL;
+    queue.push_back({due, std::vector<uint8_t>(data, data + size)});
+}
+
+/**
+ * @brief Отправляет пакеты, задержка которых истекла.
+ *
+ * Из-за случайной добавки к задержке пакеты могут уходить не по порядку, как в реальной сети.
+ */
+
+void UdpLink::Flush() {
+    long long now = NowNs();
+    for (auto it = queue.begin(); it != queue.end();) {
+        if (it->dueNs <= now) {
+            sendto(fd, it->data.data(), it->data.size(), 0, (sockaddr *) &remote, sizeof(remote));
+            it = queue.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * @brief Принимает один пакет соперника без ожидания.
+ *
+ * @param buffer Буфер.
+ * @param capacity Размер буфера.
+ * @return Размер пакета или 0, если пакетов нет.
+ */
+
+size_t UdpLink::Receive(uint8_t *buffer, size_t capacity) {
+    while (true) {
+        sockaddr_in from;
+        socklen_t fromSize = sizeof(from);
+        ssize_t received = recvfrom(fd, buffer, capacity, 0, (sockaddr *) &from, &fromSize);
+        if (received <= 0) {
+            return 0;
+        }
+        if (from.sin_port == remote.sin_port && from.sin_addr.s_addr == remote.sin_addr.s_addr) {
+            return received;
+        }
+    }
+}
@@ -0,0 +1,129 @@
+/**
+ * @file udplink.hpp
+ * @brief Заголовочный файл, содержащий канал UDP между двумя игроками с имитацией задержки и потерь.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <netinet/in.h>
+#include <random>
+#include <vector>
+
+/**
+ * @struct LinkConditions
+ * @brief Имитируемые условия сети для исходящих пакетов.
+ */
+struct LinkConditions {
+    /**
+     * @brief Задержка в одну сторону в миллисекундах.
+     */
+    int latencyMs;
+    /**
+     * @brief Наибольшее случайное добавление к задержке в миллисекундах.
+     */
+    int jitterMs;
+    /**
+     * @brief Доля теряемых пакетов (0..1).
+     */
+    double loss;
+};
+
+/**
+ * @class UdpLink
+ * @brief Неблокирующий сокет UDP, связанный с одним адресом соперника.
+ *
+ * Исходящие пакеты задерживаются и теряются по LinkConditions, поэтому сетевую игру можно
+ * проверить на 127.0.0.1 в условиях, близких к реальной сети. Пакеты с другими адресами отбрасываются.
+ */
+class UdpLink {
+public:
+    /**
+     * @brief Конструктор класса UdpLink.
+     *
+     * @param conditions Имитируемые условия сети.
+     * @param seed Начальное значение генератора потерь и задержек.
+     */
+    UdpLink(LinkConditions conditions, unsigned int seed);
+
+    /**
+     * @brief Деструктор класса UdpLink. Закрывает сокет.
+     */
+    ~UdpLink();
+
+    /**
+     * @brief Открывает сокет на локальном порту и задает адрес соперника.
+     *
+     * @param localPort Локальный порт UDP.
+     * @param remoteHost Адрес IPv4 соперника.
+     * @param remotePort Порт соперника.
+     * @return false при ошибке.
+     */
+    bool Open(int localPort, const char *remoteHost, int remotePort);
+
+    /**
+     * @brief Ставит пакет в очередь отправки с имитируемой задержкой (или теряет его).
+     *
+     * @param data Пакет.
+     * @param size Размер пакета.
+     */
+    void Send(const uint8_t *data, size_t size);
+
+    /**
+     * @brief Отправляет пакеты, задержка которых истекла.
+     */
+    void Flush();
+
+    /**
+     * @brief Принимает один пакет соперника без ожидания.
+     *
+     * @param buffer Буфер.
+     * @param capacity Размер буфера.
+     * @return Размер пакета или 0, если пакетов нет.
+     */
+    size_t Receive(uint8_t *buffer, size_t capacity);
+
+    /**
+     * @brief Количество пакетов, потерянных имитацией.
+     */
+    long long dropped;
+
+private:
+    /**
+     * @struct DelayedPacket
+     * @brief Пакет, ожидающий отправки.
+     */
+    struct DelayedPacket {
+        /**
+         * @brief Момент отправки в наносекундах CLOCK_MONOTONIC.
+         */
+        long long dueNs;
+        /**
+         * @brief Данные пакета.
+         */
+        std::vector<uint8_t> data;
+    };
+
+    /**
+     * @brief Сокет или -1.
+     */
+    int fd;
+    /**
+     * @brief Адрес соперника.
+     */
+    sockaddr_in remote;
+    /**
+     * @brief Имитируемые условия сети.
+     */
+    LinkConditions conditions;
+    /**
+     * @brief Генератор потерь и задержек.
+     */
+    std::mt19937 rng;
+    /**
+     * @brief Пакеты, ожидающие отправки, в порядке постановки.
+     */
+    std::deque<DelayedPacket> queue;
+};
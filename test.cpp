@@ -76,3 +76,1415 @@ TEST_CASE("Testing NewObstacle constructor") {
         }
     }
 }
+
+#include "src/shooterindex.hpp"
+
+TEST_CASE("Testing ShooterIndex") {
+    ShooterIndex index;
+    index.Reset(5, 11);
+    for (int row = 0; row < 5; ++row) {
+        for (int column = 0; column < 11; ++column) {
+            index.Add(row, column);
+        }
+    }
+
+    SUBCASE("Bottom row of a full formation") {
+        CHECK(index.ActiveColumnCount() == 11);
+        CHECK(index.BottomRow() == 4);
+        for (int column = 0; column < 11; ++column) {
+            CHECK(index.BottomRow(column) == 4);
+        }
+    }
+
+    SUBCASE("Removing aliens moves the shooter up") {
+        index.Remove(4, 3);
+        CHECK(index.BottomRow(3) == 3);
+        index.Remove(2, 3);
+        CHECK(index.BottomRow(3) == 3);
+        CHECK_FALSE(index.IsAlive(2, 3));
+        index.Remove(3, 3);
+        CHECK(index.BottomRow(3) == 1);
+    }
+
+    SUBCASE("Empty columns leave the active list") {
+        for (int row = 0; row < 5; ++row) {
+            index.Remove(row, 7);
+        }
+        CHECK(index.BottomRow(7) == -1);
+        CHECK(index.ActiveColumnCount() == 10);
+        for (int i = 0; i < index.ActiveColumnCount(); ++i) {
+            CHECK(index.ActiveColumn(i) != 7);
+        }
+    }
+
+    SUBCASE("Active columns do not depend on the order of kills") {
+        // Индекс, перестроенный по тем же живым инопланетянам, выбирает те же столбцы
+        ShooterIndex rebuilt;
+        rebuilt.Reset(5, 11);
+        for (int column: {2, 9, 5}) {
+            for (int row = 0; row < 5; ++row) {
+                index.Remove(row, column);
+            }
+        }
+        index.Add(0, 5);
+        for (int column = 10; column >= 0; --column) {
+            for (int row = 0; row < 5; ++row) {
+                if (column != 2 && column != 9 && (column != 5 || row == 0)) {
+                    rebuilt.Add(row, column);
+                }
+            }
+        }
+        REQUIRE(index.ActiveColumnCount() == 9);
+        REQUIRE(rebuilt.ActiveColumnCount() == 9);
+        for (int i = 0; i < index.ActiveColumnCount(); ++i) {
+            CHECK(index.ActiveColumn(i) == rebuilt.ActiveColumn(i));
+        }
+    }
+
+    SUBCASE("Formation bottom follows the lowest non-empty row") {
+        for (int column = 0; column < 11; ++column) {
+            index.Remove(4, column);
+            index.Remove(3, column);
+        }
+        CHECK(index.BottomRow() == 2);
+    }
+}
+
+#include "src/aabbbatch.hpp"
+#include <random>
+
+TEST_CASE("Testing AabbBatch against the scalar reference") {
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> position(0.0f, 200.0f);
+    std::uniform_real_distribution<float> size(0.0f, 40.0f);
+
+    for (int round = 0; round < 200; ++round) {
+        AabbBatch batch;
+        int count = rng() % 300;
+        std::vector<float> rects;
+        for (int i = 0; i < count; ++i) {
+            // Целочисленные координаты дают много касаний по границам
+            float x = (round % 2) ? float(int(position(rng))) : position(rng);
+            float y = (round % 2) ? float(int(position(rng))) : position(rng);
+            float w = (round % 2) ? float(int(size(rng))) : size(rng);
+            float h = (round % 2) ? float(int(size(rng))) : size(rng);
+            batch.Add(x, y, w, h);
+            rects.insert(rects.end(), {x, y, w, h});
+        }
+
+        float x = float(int(position(rng)));
+        float y = float(int(position(rng)));
+        float w = float(int(size(rng)));
+        float h = float(int(size(rng)));
+
+        std::vector<uint64_t> fast;
+        std::vector<uint64_t> reference;
+        int fastHits = batch.Collide(x, y, w, h, fast);
+        int referenceHits = batch.CollideScalar(x, y, w, h, reference);
+        CHECK(fastHits == referenceHits);
+        CHECK(fast == reference);
+
+        // Массив, заполненный по номерам, совпадает с собранным по одному
+        AabbBatch filled;
+        filled.Resize(count);
+        for (int i = 0; i < count; ++i) {
+            filled.Set(i, rects[i * 4], rects[i * 4 + 1], rects[i * 4 + 2], rects[i * 4 + 3]);
+        }
+        std::vector<uint64_t> filledMask;
+        CHECK(filled.Size() == count);
+        CHECK(filled.Collide(x, y, w, h, filledMask) == fastHits);
+        CHECK(filledMask == fast);
+
+        for (int i = 0; i < count; ++i) {
+            const float *r = &rects[i * 4];
+            bool expected = r[0] < x + w && r[0] + r[2] > x && r[1] < y + h && r[1] + r[3] > y;
+            CHECK(bool((reference[i / 64] >> (i % 64)) & 1) == expected);
+        }
+    }
+}
+
+#include "src/spritemask.hpp"
+
+TEST_CASE("Testing SpriteMask") {
+    // Ромб 5x5 с прозрачными углами
+    const unsigned char alpha[5 * 5] = {
+        0,   0,   255, 0,   0,
+        0,   255, 255, 255, 0,
+        255, 255, 255, 255, 255,
+        0,   255, 255, 255, 0,
+        0,   0,   255, 0,   0
+    };
+    SpriteMask diamond(alpha, 5, 5, 1);
+
+    SUBCASE("Mask follows the alpha channel") {
+        CHECK(diamond.Test(2, 0));
+        CHECK_FALSE(diamond.Test(0, 0));
+        CHECK(diamond.Test(4, 2));
+    }
+
+    SUBCASE("Transparent corners do not collide with rectangles") {
+        CHECK_FALSE(diamond.OverlapsRect(10, 10, 9, 9, 2, 2));
+        CHECK(diamond.OverlapsRect(10, 10, 11, 11, 2, 2));
+        CHECK_FALSE(diamond.OverlapsRect(10, 10, 15, 10, 4, 15));
+    }
+
+    SUBCASE("Masks collide only where opaque pixels meet") {
+        CHECK(diamond.Overlaps(0, 0, diamond, 2, 2));
+        CHECK_FALSE(diamond.Overlaps(0, 0, diamond, 4, 3));
+        CHECK(diamond.Overlaps(0, 0, diamond, -2, 2));
+        CHECK_FALSE(diamond.Overlaps(0, 0, diamond, 5, 0));
+    }
+}
+
+#include "src/sessionprotocol.hpp"
+
+TEST_CASE("Testing session state deltas") {
+    SessionState previous = {};
+    SessionState current = {};
+    for (int i = 0; i < FIELD_COUNT; ++i) {
+        previous.fields[i] = i * 7;
+        current.fields[i] = i * 7;
+    }
+    current.fields[FIELD_SCORE] = 1250;
+    current.fields[FIELD_MYSTERY_X] = -1;
+    current.fields[FIELD_ALIVE_HIGH] = (int32_t) 0x807fffff;
+
+    uint8_t frame[sessionMaxStateFrame];
+    size_t size = EncodeStateDelta(previous, current, frame);
+
+    SUBCASE("Only changed fields are sent") {
+        CHECK(size == sessionFrameHeaderSize + 2 + 3 * 4);
+        CHECK(frame[0] + (frame[1] << 8) == (int) size - 2);
+        CHECK(frame[2] == SESSION_STATE);
+    }
+
+    SUBCASE("Decoding restores the current state") {
+        SessionState decoded = previous;
+        REQUIRE(DecodeStateDelta(decoded, frame + sessionFrameHeaderSize, size - sessionFrameHeaderSize));
+        for (int i = 0; i < FIELD_COUNT; ++i) {
+            CHECK(decoded.fields[i] == current.fields[i]);
+        }
+    }
+
+    SUBCASE("Truncated frames are rejected") {
+        SessionState decoded = previous;
+        CHECK_FALSE(DecodeStateDelta(decoded, frame + sessionFrameHeaderSize, size - sessionFrameHeaderSize - 1));
+    }
+
+    SUBCASE("Unchanged state encodes to an empty mask") {
+        CHECK(EncodeStateDelta(current, current, frame) == sessionFrameHeaderSize + 2);
+    }
+}
+
+#include "src/shmprotocol.hpp"
+
+TEST_CASE("Testing shared memory ring size") {
+    CHECK(IsValidRingSize(1));
+    CHECK(IsValidRingSize(4));
+    CHECK(IsValidRingSize(0x80000000u));
+    CHECK_FALSE(IsValidRingSize(0));
+    CHECK_FALSE(IsValidRingSize(3));
+    CHECK_FALSE(IsValidRingSize(12));
+
+    // Степень двойки делит 2^32: номера до и после переполнения попадают в соседние ячейки
+    uint32_t last = 0xffffffffu;
+    CHECK((last % 4 + 1) % 4 == (uint32_t) (last + 1) % 4);
+    CHECK_FALSE((last % 3 + 1) % 3 == (uint32_t) (last + 1) % 3);
+}
+
+#include "src/streamcodec.hpp"
+
+/**
+ * @brief Сравнивает два состояния потока.
+ */
+static bool SameStreamState(const StreamState &a, const StreamState &b) {
+    return a.tick == b.tick && a.score == b.score && a.highscore == b.highscore && a.lives == b.lives &&
+           a.run == b.run && a.shipX == b.shipX && a.formationX == b.formationX && a.formationY == b.formationY &&
+           a.direction == b.direction && a.alive == b.alive && a.mysteryAlive == b.mysteryAlive &&
+           (!a.mysteryAlive || (a.mysteryX == b.mysteryX && a.mysterySpeed == b.mysterySpeed)) &&
+           memcmp(a.shields, b.shields, sizeof(a.shields)) == 0 && a.playerLasers == b.playerLasers &&
+           a.alienLasers == b.alienLasers;
+}
+
+TEST_CASE("Testing state stream round trip") {
+    std::mt19937 rng(7);
+    StreamState state = {};
+    state.lives = 3;
+    state.run = 1;
+    state.formationX = 150;
+    state.formationY = 220;
+    state.direction = 1;
+    state.alive = (1ull << 55) - 1;
+    for (auto &shield: state.shields) {
+        for (auto &row: shield) {
+            row = (1u << streamShieldColumns) - 1;
+        }
+    }
+
+    StreamEncoder encoder(60);
+    StreamDecoder decoder;
+    std::vector<uint8_t> frame;
+    size_t deltaBytes = 0;
+    int deltaFrames = 0;
+
+    for (int tick = 0; tick < 2000; ++tick) {
+        // Эволюция, похожая на игру: снаряды летят, иногда появляются и исчезают
+        PredictStreamState(state);
+        if (rng() % 40 == 0) {
+            state.direction = -state.direction;
+            state.formationY += 8;
+        }
+        if (rng() % 15 == 0) {
+            state.playerLasers.push_back({int32_t(rng() % 1500), 1300, -6});
+        }
+        if (rng() % 10 == 0) {
+            state.alienLasers.push_back({int32_t(rng() % 1500), 400, 6});
+        }
+        if (!state.alienLasers.empty() && rng() % 12 == 0) {
+            state.alienLasers.erase(state.alienLasers.begin() + rng() % state.alienLasers.size());
+        }
+        if (!state.playerLasers.empty() && rng() % 20 == 0) {
+            state.playerLasers.erase(state.playerLasers.begin() + rng() % state.playerLasers.size());
+            state.alive &= ~(1ull << (rng() % 55));
+            state.score += 100;
+        }
+        if (rng() % 25 == 0) {
+            state.shields[rng() % streamShieldCount][rng() % streamShieldRows] &= ~(1u << (rng() % streamShieldColumns));
+        }
+        if (rng() % 300 == 0) {
+            state.mysteryAlive = !state.mysteryAlive;
+            state.mysteryX = 50;
+            state.mysterySpeed = 3;
+        }
+        state.shipX += int32_t(rng() % 3) * 14 - 14;
+        if (tick == 1000) {
+            // Перезапуск игры возвращает инопланетян и требует ключевого кадра
+            state.alive = (1ull << 55) - 1;
+        }
+
+        frame.clear();
+        size_t size = encoder.Encode(state, frame);
+        REQUIRE(size == frame.size());
+        REQUIRE(decoder.Decode(frame.data(), frame.size()));
+        REQUIRE(SameStreamState(decoder.state, state) == true);
+        if (frame[0] == STREAM_DELTA) {
+            deltaBytes += size;
+            deltaFrames++;
+        }
+    }
+
+    CHECK(deltaFrames > 1800);
+    CHECK(deltaBytes / deltaFrames < 16);
+
+    SUBCASE("Corrupted frames leave the state unchanged") {
+        StreamState before = decoder.state;
+        frame.clear();
+        PredictStreamState(state);
+        state.score += 10;
+        encoder.Encode(state, frame);
+        frame.pop_back();
+        CHECK_FALSE(decoder.Decode(frame.data(), frame.size()));
+        CHECK(SameStreamState(decoder.state, before));
+    }
+}
+
+#include "src/rollback.hpp"
+#include <deque>
+
+/**
+ * @struct ToyRollbackPeer
+ * @brief Игрок с игрушечной детерминированной игрой для проверки RollbackSession.
+ */
+struct ToyRollbackPeer {
+    explicit ToyRollbackPeer(int player) : session(player, 2, 8) {
+        session.saveState = [this](int slot) {
+            values[slot] = value;
+            ticks[slot] = tick;
+        };
+        session.loadState = [this](int slot) {
+            value = values[slot];
+            tick = ticks[slot];
+        };
+        session.hashState = [this](int slot) { return values[slot]; };
+        session.advance = [this](const uint8_t *inputs) {
+            value = value * 1000003 + inputs[0] * 16 + inputs[1] + (tick == corruptTick ? 1 : 0);
+            tick++;
+        };
+    }
+
+    RollbackSession session;
+    uint64_t value = 0;
+    int tick = 0;
+    int corruptTick = -1;
+    uint64_t values[rollbackWindow];
+    int ticks[rollbackWindow];
+};
+
+/**
+ * @brief Проводит кадры двух игроков через канал с задержкой в кадрах и потерями.
+ */
+static void RunToyRollback(ToyRollbackPeer &a, ToyRollbackPeer &b, int frames, double loss, std::mt19937 &rng) {
+    struct Packet {
+        int due;
+        bool toB;
+        std::vector<uint8_t> data;
+    };
+    std::deque<Packet> wire;
+    uint8_t inputs[2] = {0, 0};
+    uint8_t buffer[rollbackMaxPacket];
+    for (int frame = 0; frame < frames; ++frame) {
+        for (auto it = wire.begin(); it != wire.end();) {
+            if (it->due <= frame) {
+                REQUIRE((it->toB ? b : a).session.ReadPacket(it->data.data(), it->data.size()));
+                it = wire.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        ToyRollbackPeer *peers[2] = {&a, &b};
+        for (int i = 0; i < 2; ++i) {
+            if (loss > 0 && rng() % 4 == 0) {
+                inputs[i] = rng() % 8;
+            }
+            peers[i]->session.AdvanceFrame(loss > 0 ? inputs[i] : 0);
+            size_t size = peers[i]->session.WritePacket(buffer);
+            if (std::uniform_real_distribution<double>(0, 1)(rng) >= loss) {
+                wire.push_back({frame + 3 + (int) (rng() % 3), i == 0, std::vector<uint8_t>(buffer, buffer + size)});
+            }
+        }
+    }
+}
+
+TEST_CASE("Testing rollback session") {
+    std::mt19937 rng(3);
+    ToyRollbackPeer a(0);
+    ToyRollbackPeer b(1);
+
+    SUBCASE("Peers converge despite latency and loss") {
+        RunToyRollback(a, b, 600, 0.1, rng);
+        // Без потерь и новых команд оба игрока подтверждают весь ввод
+        RunToyRollback(a, b, 60, 0.0, rng);
+
+        CHECK(a.session.stats.rollbacks > 0);
+        CHECK(a.session.stats.maxRollback <= 8);
+        CHECK(a.session.stats.checkedHashes > 100);
+        CHECK(a.session.DesyncTick() == -1);
+        CHECK(b.session.DesyncTick() == -1);
+        int common = std::min(a.session.Tick(), b.session.Tick()) - 10;
+        CHECK(a.values[common % rollbackWindow] == b.values[common % rollbackWindow]);
+    }
+
+    SUBCASE("Re-simulated ticks go through resimulate") {
+        // Повторная симуляция та же, но без эффектов: advance вызывается только для новых тиков
+        long long presented = 0;
+        long long replayed = 0;
+        for (ToyRollbackPeer *peer: {&a, &b}) {
+            std::function<void(const uint8_t *)> advance = peer->session.advance;
+            peer->session.advance = [advance, &presented](const uint8_t *inputs) {
+                advance(inputs);
+                presented++;
+            };
+            peer->session.resimulate = [advance, &replayed](const uint8_t *inputs) {
+                advance(inputs);
+                replayed++;
+            };
+        }
+        RunToyRollback(a, b, 600, 0.1, rng);
+        CHECK(replayed > 0);
+        CHECK(replayed == a.session.stats.resimulatedTicks + b.session.stats.resimulatedTicks);
+        CHECK(presented == a.session.Tick() + b.session.Tick());
+        CHECK(a.session.DesyncTick() == -1);
+        CHECK(b.session.DesyncTick() == -1);
+    }
+
+    SUBCASE("Diverging simulation is reported") {
+        b.corruptTick = 100;
+        RunToyRollback(a, b, 300, 0.1, rng);
+        CHECK(a.session.DesyncTick() > 100);
+        CHECK(b.session.DesyncTick() > 100);
+    }
+
+    SUBCASE("Malformed packets are rejected") {
+        uint8_t buffer[rollbackMaxPacket];
+        size_t size = a.session.WritePacket(buffer);
+        CHECK_FALSE(b.session.ReadPacket(buffer, size - 1));
+        buffer[1] = 5;
+        CHECK_FALSE(b.session.ReadPacket(buffer, size));
+    }
+}
+
+#include "src/assetpack.hpp"
+#include <cstdio>
+
+TEST_CASE("Testing asset pack") {
+    const char *path = "test_assets.pak";
+    std::vector<uint8_t> pixels(4 * 3 * 4);
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        pixels[i] = (uint8_t) i;
+    }
+    const char music[] = "OggS music";
+
+    AssetPackWriter writer;
+    CHECK(writer.Add("Graphics/test.png", ASSET_IMAGE, {4, 3, 1, 7}, pixels.data(), pixels.size()));
+    CHECK(writer.Add("Sounds/music.ogg", ASSET_MUSIC, {}, music, sizeof(music)));
+    CHECK_FALSE(writer.Add("Sounds/music.ogg", ASSET_MUSIC, {}, music, sizeof(music)));
+    CHECK_FALSE(writer.Add(std::string(assetNameSize, 'a').c_str(), ASSET_MUSIC, {}, music, sizeof(music)));
+    REQUIRE(writer.Write(path));
+
+    SUBCASE("Resources are found and aligned") {
+        AssetPack pack;
+        REQUIRE(pack.Open(path));
+        CHECK(pack.EntryCount() == 2);
+        CHECK(pack.Find("Graphics/missing.png") == nullptr);
+
+        const AssetEntry *image = pack.Find("Graphics/test.png");
+        REQUIRE(image != nullptr);
+        CHECK(image->type == ASSET_IMAGE);
+        CHECK(image->params[0] == 4);
+        CHECK(image->params[1] == 3);
+        CHECK(image->size == pixels.size());
+        CHECK((uintptr_t) pack.Data(*image) % assetPackAlignment == 0);
+        CHECK(memcmp(pack.Data(*image), pixels.data(), pixels.size()) == 0);
+        CHECK(pack.Contains(pack.Data(*image)));
+        CHECK_FALSE(pack.Contains(pixels.data()));
+
+        const AssetEntry *sound = pack.Find("Sounds/music.ogg");
+        REQUIRE(sound != nullptr);
+        CHECK((uintptr_t) pack.Data(*sound) % assetPackAlignment == 0);
+        CHECK(memcmp(pack.Data(*sound), music, sizeof(music)) == 0);
+    }
+
+    SUBCASE("Damaged packs are rejected") {
+        std::vector<uint8_t> bytes = writer.Build();
+        FILE *file = fopen(path, "wb");
+        fwrite(bytes.data(), 1, bytes.size() - 1, file);
+        fclose(file);
+        AssetPack pack;
+        CHECK_FALSE(pack.Open(path));
+
+        bytes[0] = 'X';
+        file = fopen(path, "wb");
+        fwrite(bytes.data(), 1, bytes.size(), file);
+        fclose(file);
+        CHECK_FALSE(pack.Open(path));
+        CHECK(pack.EntryCount() == 0);
+    }
+    remove(path);
+}
+
+#include "src/gameflow.hpp"
+
+TEST_CASE("Testing game flow states") {
+    GameFlow flow(30.0, 1.0);
+    CHECK(flow.State() == FLOW_PLAYING);
+    CHECK_FALSE(flow.Update(0, true, 1.0));
+
+    SUBCASE("Pause toggles without touching the game") {
+        CHECK(flow.Update(FLOW_EVENT_PAUSE, true, 2.0));
+        CHECK(flow.State() == FLOW_PAUSED);
+        CHECK(flow.Idle());
+        CHECK_FALSE(flow.Update(FLOW_EVENT_INPUT, true, 3.0));
+        CHECK(flow.Update(FLOW_EVENT_PAUSE, true, 4.0));
+        CHECK(flow.State() == FLOW_PLAYING);
+    }
+
+    SUBCASE("Game over waits until the attract timeout") {
+        CHECK(flow.Update(0, false, 10.0));
+        CHECK(flow.State() == FLOW_GAME_OVER);
+        CHECK(flow.WaitTimeout(10.0) == doctest::Approx(30.0));
+        // Ввод откладывает заставку
+        CHECK_FALSE(flow.Update(FLOW_EVENT_INPUT, false, 20.0));
+        CHECK(flow.WaitTimeout(25.0) == doctest::Approx(25.0));
+        CHECK_FALSE(flow.Update(0, false, 49.0));
+        CHECK(flow.Update(0, false, 50.0));
+        CHECK(flow.State() == FLOW_ATTRACT);
+
+        // Надпись заставки мигает раз в секунду, между сменами перерисовка не нужна
+        CHECK(flow.BlinkVisible());
+        CHECK(flow.WaitTimeout(50.25) == doctest::Approx(0.75));
+        CHECK_FALSE(flow.Update(0, false, 50.5));
+        CHECK(flow.Update(0, false, 51.0));
+        CHECK_FALSE(flow.BlinkVisible());
+
+        CHECK(flow.Update(FLOW_EVENT_INPUT, false, 52.0));
+        CHECK(flow.State() == FLOW_GAME_OVER);
+        CHECK(flow.Update(FLOW_EVENT_INPUT, true, 53.0));
+        CHECK(flow.State() == FLOW_PLAYING);
+    }
+}
+
+#include "src/framepacer.hpp"
+
+TEST_CASE("Testing latency histogram") {
+    LatencyHistogram histogram(0.001, 10);
+    CHECK(histogram.Percentile(0.5) == 0.0);
+    for (int i = 0; i < 90; ++i) {
+        histogram.Add(0.0025);
+    }
+    for (int i = 0; i < 10; ++i) {
+        histogram.Add(0.5);
+    }
+    CHECK(histogram.Count() == 100);
+    CHECK(histogram.Percentile(0.5) == doctest::Approx(0.003));
+    CHECK(histogram.Percentile(0.9) == doctest::Approx(0.003));
+    // Значения за пределами гистограммы попадают в последнюю корзину
+    CHECK(histogram.Percentile(0.99) == doctest::Approx(0.010));
+    CHECK(histogram.Max() == doctest::Approx(0.5));
+    CHECK(histogram.Mean() == doctest::Approx(0.05225));
+    histogram.Reset();
+    CHECK(histogram.Count() == 0);
+}
+
+#include "src/inputqueue.hpp"
+
+TEST_CASE("Testing input queue") {
+    InputQueue queue;
+
+    SUBCASE("Tap shorter than a tick is not lost") {
+        queue.Push({0.010, 0, INPUT_FIRE, true});
+        queue.Push({0.012, 0, INPUT_FIRE, false});
+        queue.Tick(0.016);
+        CHECK(queue.Input(0) == INPUT_FIRE);
+        queue.Tick(0.033);
+        CHECK(queue.Input(0) == 0);
+    }
+
+    SUBCASE("Moving and firing combine, the last direction wins") {
+        queue.Push({0.001, 0, INPUT_LEFT, true});
+        queue.Push({0.002, 0, INPUT_FIRE, true});
+        queue.Tick(0.016);
+        CHECK(queue.Input(0) == (INPUT_LEFT | INPUT_FIRE));
+        queue.Push({0.020, 0, INPUT_RIGHT, true});
+        queue.Tick(0.033);
+        CHECK(queue.Input(0) == (INPUT_RIGHT | INPUT_FIRE));
+        queue.Push({0.040, 0, INPUT_RIGHT, false});
+        queue.Tick(0.050);
+        CHECK(queue.Input(0) == (INPUT_LEFT | INPUT_FIRE));
+    }
+
+    SUBCASE("Events wait for their tick in time order") {
+        queue.Push({0.030, 1, INPUT_RIGHT, true});
+        queue.Push({0.005, 1, INPUT_LEFT, true});
+        queue.Tick(0.016);
+        CHECK(queue.Input(1) == INPUT_LEFT);
+        CHECK(queue.Input(0) == 0);
+        CHECK(queue.Pending() == 1);
+        queue.Tick(0.033);
+        CHECK(queue.Input(1) == INPUT_RIGHT);
+    }
+
+    SUBCASE("Masks from bots and peers become events") {
+        queue.PushState(0.0, 0, INPUT_LEFT | INPUT_FIRE);
+        queue.PushState(0.0, 0, INPUT_LEFT | INPUT_FIRE);
+        CHECK(queue.Pending() == 1);
+        queue.Tick(0.0);
+        CHECK(queue.Input(0) == (INPUT_LEFT | INPUT_FIRE));
+        queue.PushState(0.016, 0, INPUT_RIGHT);
+        queue.Tick(0.016);
+        CHECK(queue.Input(0) == INPUT_RIGHT);
+    }
+}
+
+#include "src/timerwheel.hpp"
+
+TEST_CASE("Testing timer wheel") {
+    TimerWheel wheel;
+    std::vector<TimerEvent> fired;
+
+    SUBCASE("Timers fire at their tick in scheduling order") {
+        TimerId late = wheel.Schedule(3, 1);
+        TimerId first = wheel.Schedule(1, 2);
+        TimerId second = wheel.Schedule(1, 3);
+        CHECK(wheel.Count() == 3);
+        CHECK(wheel.Remaining(late) == 3);
+        wheel.Advance(fired);
+        REQUIRE(fired.size() == 2);
+        CHECK(fired[0].id == first);
+        CHECK(fired[1].id == second);
+        wheel.Advance(fired);
+        CHECK(fired.empty());
+        wheel.Advance(fired);
+        REQUIRE(fired.size() == 1);
+        CHECK(fired[0].kind == 1);
+        CHECK_FALSE(wheel.Pending(late));
+        CHECK(wheel.Count() == 0);
+    }
+
+    SUBCASE("Cancelled and stale timers do not fire") {
+        TimerId id = wheel.Schedule(2, 1);
+        CHECK(wheel.Cancel(id));
+        CHECK_FALSE(wheel.Cancel(id));
+        TimerId reused = wheel.Schedule(2, 2);
+        CHECK(reused != id);
+        CHECK_FALSE(wheel.Pending(id));
+        wheel.Advance(fired);
+        wheel.Advance(fired);
+        REQUIRE(fired.size() == 1);
+        CHECK(fired[0].kind == 2);
+    }
+
+    SUBCASE("Long delays cascade down to the exact tick") {
+        const uint64_t delays[] = {63, 64, 65, 4095, 4096, 4097, 300000, 20000000};
+        for (uint64_t delay: delays) {
+            wheel.Reset(12345);
+            wheel.Schedule(delay, 7);
+            uint64_t firedAt = 0;
+            while (firedAt == 0 && wheel.Now() < 12345 + delay + 1) {
+                wheel.Advance(fired);
+                if (!fired.empty()) {
+                    firedAt = wheel.Now();
+                }
+            }
+            CHECK(firedAt == 12345 + delay);
+        }
+    }
+
+    SUBCASE("Thousands of timers fire once each") {
+        const int timerCount = 5000;
+        std::mt19937 rng(3);
+        std::vector<uint64_t> due(timerCount);
+        std::vector<TimerId> ids(timerCount);
+        for (int i = 0; i < timerCount; ++i) {
+            due[i] = 1 + rng() % 10000;
+            ids[i] = wheel.Schedule(due[i], 0, i);
+        }
+        for (int i = 0; i < timerCount; i += 2) {
+            wheel.Cancel(ids[i]);
+        }
+        int firedCount = 0;
+        bool onTime = true;
+        while (wheel.Count() > 0) {
+            wheel.Advance(fired);
+            for (const TimerEvent &event: fired) {
+                onTime = onTime && event.payload % 2 == 1 && due[event.payload] == wheel.Now();
+                firedCount++;
+            }
+        }
+        CHECK(onTime);
+        CHECK(firedCount == timerCount / 2);
+    }
+}
+
+#include "src/levelscript.hpp"
+
+TEST_CASE("Testing level script") {
+    LevelScript script;
+    std::vector<ScriptCommand> actions;
+
+    SUBCASE("Fibers wait for ticks and events") {
+        static const std::vector<ScriptCommand> program = {
+            {SCRIPT_FORMATION, FORMATION_WEDGE, 0},
+            {SCRIPT_SPAWN, 4, 0},
+            {SCRIPT_WAIT_EVENT, SCRIPT_EVENT_WAVE_CLEARED, 0},
+            {SCRIPT_NEXT_LEVEL, 0, 0},
+            {SCRIPT_WAIT, 3, 0},
+            {SCRIPT_REINFORCE, 0, 0},
+            {SCRIPT_REPEAT, 4, 1},
+        };
+        script.Start(program, 4, actions);
+        REQUIRE(actions.size() == 1);
+        CHECK(actions[0].op == SCRIPT_FORMATION);
+        CHECK(script.Running() == 2);
+
+        int reinforcements = 0;
+        for (int tick = 1; tick <= 10; ++tick) {
+            script.Tick(actions);
+            for (const ScriptCommand &action: actions) {
+                CHECK(action.op == SCRIPT_REINFORCE);
+                CHECK((tick == 3 || tick == 6));
+                reinforcements++;
+            }
+        }
+        CHECK(reinforcements == 2);
+        CHECK(script.Running() == 1);
+
+        script.Signal(SCRIPT_EVENT_SHIP_HIT, actions);
+        CHECK(actions.empty());
+        script.Signal(SCRIPT_EVENT_WAVE_CLEARED, actions);
+        REQUIRE(actions.size() == 1);
+        CHECK(actions[0].op == SCRIPT_NEXT_LEVEL);
+        CHECK(script.Running() == 0);
+    }
+
+    SUBCASE("Copies resume from the same point") {
+        static const std::vector<ScriptCommand> program = {
+            {SCRIPT_WAIT, 5, 0},
+            {SCRIPT_BOSS, 0, 0},
+            {SCRIPT_REPEAT, 0, -1},
+        };
+        script.Start(program, 1, actions);
+        for (int tick = 0; tick < 3; ++tick) {
+            script.Tick(actions);
+        }
+        LevelScript copy = script;
+        script.Tick(actions);
+        script.Tick(actions);
+        CHECK(actions.size() == 1);
+        copy.Tick(actions);
+        copy.Tick(actions);
+        CHECK(actions.size() == 1);
+    }
+
+    SUBCASE("Thousands of fibers fit the arena") {
+        const int fiberCount = 5000;
+        static const std::vector<ScriptCommand> program = {
+            {SCRIPT_SPAWN, 3, 0},
+            {SCRIPT_REPEAT, 0, fiberCount - 1},
+            {SCRIPT_END, 0, 0},
+            {SCRIPT_WAIT_EVENT, SCRIPT_EVENT_SHIP_HIT, 0},
+            {SCRIPT_WAIT, 2, 0},
+            {SCRIPT_BOSS, 0, 0},
+        };
+        script.Start(program, fiberCount, actions);
+        // Нить выполняет ограниченное число команд за пробуждение, поэтому запуски идут несколько тиков
+        for (int tick = 0; tick < 100; ++tick) {
+            script.Tick(actions);
+        }
+        CHECK(script.Running() == fiberCount - 1);
+        CHECK(script.Dropped() == 1);
+        script.Signal(SCRIPT_EVENT_SHIP_HIT, actions);
+        CHECK(actions.empty());
+        script.Tick(actions);
+        CHECK(actions.empty());
+        script.Tick(actions);
+        CHECK(actions.size() == fiberCount - 1);
+        CHECK(script.Running() == 0);
+    }
+
+    SUBCASE("Levels past the last repeat the last program") {
+        CHECK(&LevelProgram(0) == &LevelProgram(1));
+        CHECK(&LevelProgram(4) == &LevelProgram(40));
+        CHECK(LevelProgram(1)[0].op == SCRIPT_FORMATION);
+        CHECK(FormationCell(FORMATION_WEDGE, 0, 5, 11));
+        CHECK_FALSE(FormationCell(FORMATION_WEDGE, 0, 0, 11));
+    }
+}
+
+#include "src/jobsystem.hpp"
+
+TEST_CASE("Testing job system") {
+    SUBCASE("Every index runs exactly once") {
+        JobSystem jobs(4);
+        CHECK(jobs.Threads() == 4);
+        const int count = 100000;
+        std::vector<int> visits(count, 0);
+        // Проверки doctest не потокобезопасны, поэтому тело цикла только записывает результаты
+        std::atomic<int> largest(0);
+        for (int round = 0; round < 20; ++round) {
+            jobs.ParallelFor(count, 64, [&](int begin, int end) {
+                int size = end - begin;
+                int seen = largest.load();
+                while (size > seen && !largest.compare_exchange_weak(seen, size)) {
+                }
+                for (int i = begin; i < end; ++i) {
+                    visits[i]++;
+                }
+            });
+        }
+        CHECK(largest.load() <= 64);
+        CHECK(std::count(visits.begin(), visits.end(), 20) == count);
+    }
+
+    SUBCASE("Small loops run on the calling thread") {
+        JobSystem jobs(4);
+        std::thread::id caller = std::this_thread::get_id();
+        int calls = 0;
+        jobs.ParallelFor(100, 256, [&](int begin, int end) {
+            CHECK(begin == 0);
+            CHECK(end == 100);
+            CHECK(std::this_thread::get_id() == caller);
+            calls++;
+        });
+        jobs.ParallelFor(0, 1, [&](int, int) { calls++; });
+        CHECK(calls == 1);
+    }
+
+    SUBCASE("Per-index results do not depend on the thread count") {
+        std::vector<long long> serial(5000);
+        std::vector<long long> parallel(5000);
+        JobSystem one(1);
+        JobSystem many(8);
+        auto body = [](std::vector<long long> &out) {
+            return [&out](int begin, int end) {
+                for (int i = begin; i < end; ++i) {
+                    out[i] = (long long) i * i % 977;
+                }
+            };
+        };
+        one.ParallelFor(serial.size(), 7, body(serial));
+        many.ParallelFor(parallel.size(), 7, body(parallel));
+        CHECK(serial == parallel);
+    }
+}
+
+#include "src/particlepool.hpp"
+
+TEST_CASE("Testing particle pool") {
+    SUBCASE("Bursts stop at the capacity") {
+        ParticlePool pool(100);
+        CHECK(pool.Burst(10, 10, 60, 2.0f, 30, 0xFFFFFF) == 60);
+        CHECK(pool.Burst(10, 10, 60, 2.0f, 30, 0xFFFFFF) == 40);
+        CHECK(pool.Size() == 100);
+        CHECK(pool.Dropped() == 20);
+        pool.Clear();
+        CHECK(pool.Size() == 0);
+    }
+
+    SUBCASE("Vectorized update matches the scalar reference") {
+        ParticlePool fast(5000, 7);
+        ParticlePool reference(5000, 7);
+        for (int burst = 0; burst < 37; ++burst) {
+            fast.Burst(burst * 10.0f, 300, 101, 3.0f, 20 + burst, 0xF3D83F);
+            reference.Burst(burst * 10.0f, 300, 101, 3.0f, 20 + burst, 0xF3D83F);
+        }
+        for (int tick = 0; tick < 30; ++tick) {
+            fast.Update();
+            reference.UpdateScalar();
+            REQUIRE(fast.Size() == reference.Size());
+        }
+        bool same = true;
+        for (int i = 0; i < fast.Size(); ++i) {
+            same = same && fast.X(i) == reference.X(i) && fast.Y(i) == reference.Y(i) &&
+                   fast.Life(i) == reference.Life(i);
+        }
+        CHECK(same);
+    }
+
+    SUBCASE("Particles fall and expire") {
+        ParticlePool pool(1000);
+        pool.Burst(0, 0, 1000, 1.0f, 40, 0xFFFFFF);
+        float sum = 0;
+        for (int tick = 0; tick < 30; ++tick) {
+            pool.Update();
+        }
+        for (int i = 0; i < pool.Size(); ++i) {
+            sum += pool.Y(i);
+            CHECK(pool.Life(i) > 0);
+        }
+        CHECK(pool.Size() > 0);
+        CHECK(sum / pool.Size() > 0);
+        for (int tick = 0; tick < 30; ++tick) {
+            pool.Update();
+        }
+        CHECK(pool.Size() == 0);
+    }
+
+    SUBCASE("Density scales bursts without counting drops") {
+        ParticlePool pool(100);
+        pool.SetDensity(0.25f);
+        CHECK(pool.Burst(10, 10, 40, 2.0f, 30, 0xFFFFFF) == 10);
+        pool.SetDensity(0.0f);
+        CHECK(pool.Burst(10, 10, 40, 2.0f, 30, 0xFFFFFF) == 0);
+        CHECK(pool.Size() == 10);
+        CHECK(pool.Dropped() == 0);
+    }
+}
+
+TEST_CASE("Testing step accumulator") {
+    StepAccumulator clock(0.01, 4);
+    CHECK(clock.Advance(5.0) == 1);
+    // Колебания начала кадра в пределах доли шага не дают 0 или 2 шагов
+    CHECK(clock.Advance(5.0095) == 1);
+    CHECK(clock.Advance(5.0200) == 1);
+    CHECK(clock.Advance(5.0300) == 1);
+    // Долгий кадр догоняется несколькими шагами
+    CHECK(clock.Advance(5.0600) == 3);
+    CHECK(clock.catchUpFrames == 1);
+    // Больше maxSteps шагов за кадр не выполняется
+    CHECK(clock.Advance(5.2000) == 4);
+    CHECK(clock.droppedSteps == 10);
+    CHECK(clock.Advance(5.2100) == 1);
+    clock.Reset();
+    CHECK(clock.Advance(9.0) == 1);
+}
+
+#include "src/qualitygovernor.hpp"
+
+TEST_CASE("Testing quality governor") {
+    QualityGovernor governor(0.010);
+    double light[framePhaseCount] = {0.001, 0.002, 0.0005, 0.0005};
+    double heavy[framePhaseCount] = {0.002, 0.011, 0.001, 0.001};
+
+    // Кадр в бюджете не меняет уровень
+    for (int frame = 0; frame < 100; ++frame) {
+        CHECK_FALSE(governor.Frame(light));
+    }
+    CHECK(governor.Level() == 0);
+
+    // Под нагрузкой уровень понижается по ступени с ожиданием после каждой смены
+    int frames = 0;
+    while (governor.Level() < QualityGovernor::LevelCount() - 1 && frames < 1000) {
+        governor.Frame(heavy);
+        frames++;
+    }
+    CHECK(governor.Level() == QualityGovernor::LevelCount() - 1);
+    CHECK(frames >= (QualityGovernor::LevelCount() - 2) * QualityGovernor::settleFrames);
+    REQUIRE(governor.Changes().size() == (size_t) QualityGovernor::LevelCount() - 1);
+    CHECK(governor.Changes()[0].from == 0);
+    CHECK(governor.Changes()[0].to == 1);
+    CHECK(governor.Changes()[0].phase == PHASE_SCENE);
+    CHECK(governor.Changes()[0].average > 0.010 * QualityGovernor::pressureShare);
+    for (int frame = 0; frame < 100; ++frame) {
+        governor.Frame(heavy);
+    }
+    CHECK(governor.Level() == QualityGovernor::LevelCount() - 1);
+    CHECK(governor.Settings().particleDensity == 0.0f);
+    CHECK_FALSE(governor.Settings().fullBackground);
+
+    // Качество восстанавливается только после долгого запаса
+    for (int frame = 0; frame < QualityGovernor::headroomFrames; ++frame) {
+        governor.Frame(light);
+    }
+    CHECK(governor.Level() == QualityGovernor::LevelCount() - 1);
+    for (int frame = 0; frame < 20 * QualityGovernor::headroomFrames; ++frame) {
+        governor.Frame(light);
+    }
+    CHECK(governor.Level() == 0);
+    CHECK(governor.Changes().back().to == 0);
+    CHECK(governor.Settings().particleDensity == 1.0f);
+    CHECK(governor.Settings().hudInterval == 1);
+}
+
+#include "src/gameevents.hpp"
+#include <chrono>
+
+TEST_CASE("Testing game event ring") {
+    SUBCASE("Events come out in order until the ring is full") {
+        GameEventRing ring(5);
+        CHECK(ring.Capacity() == 8);
+        GameEvent event = {};
+        for (int i = 0; i < 8; ++i) {
+            event.tick = i;
+            CHECK(ring.Push(event));
+        }
+        CHECK_FALSE(ring.Push(event));
+        GameEvent out[16];
+        CHECK(ring.Pop(out, 3) == 3);
+        CHECK(out[0].tick == 0);
+        CHECK(out[2].tick == 2);
+        event.tick = 8;
+        CHECK(ring.Push(event));
+        CHECK(ring.Pop(out, 16) == 6);
+        CHECK(out[0].tick == 3);
+        CHECK(out[5].tick == 8);
+        CHECK(ring.Pop(out, 16) == 0);
+    }
+
+    SUBCASE("A consumer thread sees every event once and in order") {
+        GameEventRing ring(64);
+        const int count = 200000;
+        // Проверки doctest не потокобезопасны, поэтому читатель только считает ошибки
+        long long received = 0;
+        int outOfOrder = 0;
+        std::thread consumer([&]() {
+            GameEvent batch[32];
+            uint32_t expected = 0;
+            while (received < count) {
+                int popped = ring.Pop(batch, 32);
+                for (int i = 0; i < popped; ++i) {
+                    outOfOrder += batch[i].tick != expected++;
+                }
+                received += popped;
+            }
+        });
+        GameEvent event = {};
+        for (int i = 0; i < count; ++i) {
+            event.tick = i;
+            while (!ring.Push(event)) {
+                std::this_thread::yield();
+            }
+        }
+        consumer.join();
+        CHECK(received == count);
+        CHECK(outOfOrder == 0);
+    }
+
+    SUBCASE("The worker handles every posted event before it stops") {
+        long long sum = 0;
+        int batches = 0;
+        {
+            GameEventWorker worker(4096, [&](const GameEvent *events, int count) {
+                for (int i = 0; i < count; ++i) {
+                    sum += events[i].score;
+                }
+                batches++;
+            });
+            GameEvent event = {};
+            for (int i = 1; i <= 1000; ++i) {
+                event.score = i;
+                CHECK(worker.Post(event));
+            }
+            CHECK(worker.Dropped() == 0);
+        }
+        CHECK(sum == 500500);
+        CHECK(batches >= 1000 / GameEventWorker::batchSize);
+    }
+
+    SUBCASE("The idle worker sleeps until an event is posted") {
+        std::atomic<int> handled(0);
+        GameEventWorker worker(64, [&](const GameEvent *, int count) { handled += count; });
+        GameEvent event = {};
+        for (int round = 1; round <= 20; ++round) {
+            // Без событий поток засыпает один раз, а не просыпается по таймеру
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            CHECK(worker.Post(event));
+            while (handled.load() < round) {
+                std::this_thread::yield();
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        CHECK(worker.Sleeps() <= 21);
+        CHECK(handled.load() == 20);
+    }
+}
+
+#include "src/telemetry.hpp"
+
+TEST_CASE("Testing telemetry") {
+    std::vector<TelemetryRecord> records;
+    std::vector<std::string> files;
+    {
+        // Файл вмещает заголовок и 4 записи
+        TelemetryWriter writer("test_telemetry", sizeof(TelemetryFileHeader) + 4 * sizeof(TelemetryRecord));
+        {
+            GameTelemetry telemetry(writer, 42, 0.010);
+            std::vector<GameEvent> none;
+            std::vector<GameEvent> kill(1);
+            kill[0].type = EVENT_ALIEN_KILLED;
+            std::vector<GameEvent> hit(2);
+            hit[0].type = EVENT_PLAYER_HIT;
+            hit[1].type = EVENT_BLOCK_DESTROYED;
+            std::vector<GameEvent> over(1);
+            over[0].type = EVENT_GAME_OVER;
+
+            // Шаги остановленной игры не учитываются
+            telemetry.Tick(1, 0, 0, false, none);
+            telemetry.Tick(1, 1, 0, true, none);
+            telemetry.Tick(1, 1, 100, true, kill);
+            // Шаг, сменивший уровень, относится к прошлой волне
+            telemetry.Tick(2, 0, 200, true, kill);
+            telemetry.Tick(2, 1, 200, true, hit);
+            telemetry.Tick(2, 0, 200, false, over);
+            telemetry.Tick(2, 0, 200, false, none);
+            for (int frame = 0; frame < GameTelemetry::framesPerRecord + 10; ++frame) {
+                telemetry.Frame(frame % 10 == 0 ? 0.020 : 0.0049);
+            }
+        }
+        writer.Flush();
+        CHECK(writer.Dropped() == 0);
+        files = writer.Files();
+    }
+    REQUIRE(files.size() == 2);
+    for (const std::string &file: files) {
+        CHECK(ReadTelemetryFile(file.c_str(), records));
+        remove(file.c_str());
+    }
+    CHECK_FALSE(ReadTelemetryFile("test_telemetry_missing.bin", records));
+    REQUIRE(records.size() == 5);
+
+    const TelemetryRecord &first = records[0];
+    CHECK(first.kind == TELEMETRY_WAVE);
+    CHECK(first.session == 42);
+    CHECK(first.game == 1);
+    CHECK(first.level == 1);
+    CHECK(first.values[COUNT_TICKS] == 3);
+    CHECK(first.values[COUNT_SHOTS] == 2);
+    CHECK(first.values[COUNT_HITS] == 2);
+    CHECK(first.values[COUNT_SCORE] == 200);
+
+    const TelemetryRecord &second = records[1];
+    CHECK(second.kind == TELEMETRY_WAVE);
+    CHECK(second.level == 2);
+    CHECK(second.values[COUNT_TICKS] == 2);
+    CHECK(second.values[COUNT_LIVES_LOST] == 1);
+    CHECK(second.values[COUNT_BLOCKS_LOST] == 1);
+
+    const TelemetryRecord &game = records[2];
+    CHECK(game.kind == TELEMETRY_GAME);
+    CHECK(game.values[COUNT_TICKS] == 5);
+    CHECK(game.values[COUNT_SHOTS] == 3);
+    CHECK(game.values[COUNT_HITS] == 2);
+
+    // Полное окно кадров и остаток, записанный при уничтожении
+    CHECK(records[3].kind == TELEMETRY_FRAMES);
+    CHECK(records[3].values[FRAME_COUNT] == GameTelemetry::framesPerRecord);
+    CHECK(records[3].values[FRAME_OVER_BUDGET] == GameTelemetry::framesPerRecord / 10);
+    CHECK(records[3].values[FRAME_MAX] == 20000);
+    // Процентили точны до ширины корзины гистограммы
+    CHECK(records[3].values[FRAME_P50] == 5000);
+    CHECK(records[4].values[FRAME_COUNT] == 10);
+
+    // Перемотка: шаги незаконченной волны до нее не учитываются, а счет берется после нее
+    records.clear();
+    {
+        TelemetryWriter writer("test_telemetry_rewind");
+        {
+            GameTelemetry telemetry(writer, 7);
+            std::vector<GameEvent> none;
+            std::vector<GameEvent> kill(1);
+            kill[0].type = EVENT_ALIEN_KILLED;
+            std::vector<GameEvent> over(1);
+            over[0].type = EVENT_GAME_OVER;
+
+            telemetry.Tick(1, 1, 100, true, kill);
+            telemetry.Tick(2, 0, 200, true, kill);
+            telemetry.Tick(2, 1, 300, true, kill);
+            telemetry.Tick(2, 1, 400, true, kill);
+            telemetry.Rewind(2, 250);
+            telemetry.Tick(2, 1, 250, true, none);
+            telemetry.Tick(2, 0, 250, false, over);
+        }
+        writer.Flush();
+        files = writer.Files();
+    }
+    for (const std::string &file: files) {
+        CHECK(ReadTelemetryFile(file.c_str(), records));
+        remove(file.c_str());
+    }
+    REQUIRE(records.size() == 3);
+    CHECK(records[0].values[COUNT_TICKS] == 2);
+    CHECK(records[1].kind == TELEMETRY_WAVE);
+    CHECK(records[1].values[COUNT_TICKS] == 2);
+    CHECK(records[1].values[COUNT_SHOTS] == 1);
+    CHECK(records[1].values[COUNT_HITS] == 0);
+    CHECK(records[1].values[COUNT_SCORE] == 250);
+    CHECK(records[2].kind == TELEMETRY_GAME);
+    CHECK(records[2].values[COUNT_TICKS] == 4);
+    CHECK(records[2].values[COUNT_SHOTS] == 2);
+    CHECK(records[2].values[COUNT_HITS] == 2);
+    CHECK(records[2].values[COUNT_SCORE] == 250);
+}
+
+#include "src/leaderboard.hpp"
+#include <algorithm>
+#include <csignal>
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+TEST_CASE("Testing leaderboard") {
+    const char *path = "test_leaderboard";
+    std::string logPath = std::string(path) + ".log";
+    std::string indexPath = std::string(path) + ".idx";
+    remove(logPath.c_str());
+    remove(indexPath.c_str());
+
+    // Случайные результаты сверяются с полной сортировкой; в список попадают 8 лучших из 300
+    std::mt19937 random(7);
+    std::vector<std::pair<int, int>> expected;
+    {
+        Leaderboard leaderboard;
+        REQUIRE(leaderboard.Open(path, 8));
+        CHECK(leaderboard.BestScore() == 0);
+        CHECK_FALSE(leaderboard.Add("", 100, 1, 0));
+        for (int i = 0; i < 300; ++i) {
+            char player[16];
+            snprintf(player, sizeof(player), "P%d", i % 5);
+            int score = random() % 50 * 10;
+            REQUIRE(leaderboard.Add(player, score, i % 3 + 1, 1000 + i));
+            expected.push_back({-score, i});
+        }
+        CHECK(leaderboard.Count() == 300);
+        CHECK(leaderboard.Players() == 5);
+        CHECK(leaderboard.Runs("P3") == 60);
+        CHECK(leaderboard.Best("nobody") == -1);
+    }
+    std::sort(expected.begin(), expected.end());
+
+    // Повторное открытие не читает журнал
+    Leaderboard leaderboard;
+    REQUIRE(leaderboard.Open(path, 8));
+    CHECK(leaderboard.Replayed() == 0);
+    CHECK_FALSE(leaderboard.Rebuilt());
+    std::vector<LeaderboardEntry> entries;
+    REQUIRE(leaderboard.Top(20, entries) == 8);
+    for (int i = 0; i < 8; ++i) {
+        // Равные результаты идут в порядке игр
+        CHECK(entries[i].score == -expected[i].first);
+        CHECK(entries[i].time == (uint32_t) (1000 + expected[i].second));
+    }
+    CHECK(leaderboard.BestScore() == entries[0].score);
+    REQUIRE(leaderboard.History("P2", 3, entries) == 3);
+    CHECK(entries[0].time == 1000 + 297);
+    CHECK(entries[2].time == 1000 + 287);
+    leaderboard.Close();
+
+    // Сбой во время записи: неполная запись в конце журнала отрезается
+    FILE *log = fopen(logPath.c_str(), "ab");
+    REQUIRE(log != nullptr);
+    fwrite("partial", 1, 7, log);
+    fclose(log);
+    REQUIRE(leaderboard.Open(path, 8));
+    CHECK(leaderboard.Count() == 300);
+    CHECK(leaderboard.Replayed() == 0);
+    leaderboard.Close();
+
+    // Результат, дописанный в журнал, но не учтенный в индексе, учитывается при открытии
+    auto readIndex = [&indexPath]() {
+        std::vector<char> bytes;
+        FILE *file = fopen(indexPath.c_str(), "rb");
+        int c;
+        while (file != nullptr && (c = fgetc(file)) != EOF) {
+            bytes.push_back(c);
+        }
+        if (file != nullptr) {
+            fclose(file);
+        }
+        return bytes;
+    };
+    auto writeIndex = [&indexPath](const std::vector<char> &bytes) {
+        FILE *file = fopen(indexPath.c_str(), "wb");
+        fwrite(bytes.data(), 1, bytes.size(), file);
+        fclose(file);
+    };
+    auto fileSize = [](const std::string &name) {
+        FILE *file = fopen(name.c_str(), "rb");
+        if (file == nullptr) {
+            return -1L;
+        }
+        fseek(file, 0, SEEK_END);
+        long bytes = ftell(file);
+        fclose(file);
+        return bytes;
+    };
+    std::vector<char> stale = readIndex();
+    REQUIRE(leaderboard.Open(path, 8));
+    REQUIRE(leaderboard.Add("NEW", 1000, 4, 5000));
+    leaderboard.Close();
+    writeIndex(stale);
+    REQUIRE(leaderboard.Open(path, 8));
+    CHECK(leaderboard.Replayed() == 1);
+    CHECK_FALSE(leaderboard.Rebuilt());
+    CHECK(leaderboard.BestScore() == 1000);
+    CHECK(leaderboard.Best("NEW") == 1000);
+    REQUIRE(leaderboard.History("NEW", 5, entries) == 1);
+    CHECK(entries[0].previous == leaderboardNoRecord);
+    leaderboard.Close();
+
+    // Индекс, брошенный на середине изменения, строится заново и совпадает с прежним
+    std::vector<char> current = readIndex();
+    std::vector<char> dirty = current;
+    dirty[offsetof(LeaderboardIndexHeader, dirty)] = 1;
+    writeIndex(dirty);
+    REQUIRE(leaderboard.Open(path, 8));
+    CHECK(leaderboard.Rebuilt());
+    CHECK(leaderboard.Replayed() == 301);
+    leaderboard.Close();
+    CHECK(readIndex() == current);
+
+    // Хеш-таблица игроков растет, не теряя игроков
+    REQUIRE(leaderboard.Open(path, 8));
+    for (int i = 0; i < 700; ++i) {
+        char player[16];
+        snprintf(player, sizeof(player), "N%d", i);
+        REQUIRE(leaderboard.Add(player, i, 1, 0));
+    }
+    leaderboard.Close();
+    REQUIRE(leaderboard.Open(path, 8));
+    CHECK_FALSE(leaderboard.Rebuilt());
+    CHECK(leaderboard.Players() == 706);
+    CHECK(leaderboard.Best("N0") == 0);
+    CHECK(leaderboard.Best("N699") == 699);
+    CHECK(leaderboard.Best("P0") >= 0);
+    leaderboard.Close();
+
+#if !defined(_WIN32)
+    // Индекс не может вырасти при восстановлении: открытие не удается, а журнал не обрезается
+    const char *emptyPath = "test_leaderboard_empty";
+    REQUIRE(leaderboard.Open(emptyPath, 8));
+    leaderboard.Close();
+    long initialIndexBytes = fileSize(std::string(emptyPath) + ".idx");
+    remove((std::string(emptyPath) + ".log").c_str());
+    remove((std::string(emptyPath) + ".idx").c_str());
+    long logBytes = fileSize(logPath);
+    remove(indexPath.c_str());
+    struct rlimit limit;
+    REQUIRE(getrlimit(RLIMIT_FSIZE, &limit) == 0);
+    struct rlimit small = limit;
+    small.rlim_cur = initialIndexBytes;
+    void (*handler)(int) = signal(SIGXFSZ, SIG_IGN);
+    REQUIRE(setrlimit(RLIMIT_FSIZE, &small) == 0);
+    bool opened = leaderboard.Open(path, 8);
+    setrlimit(RLIMIT_FSIZE, &limit);
+    signal(SIGXFSZ, handler);
+    CHECK_FALSE(opened);
+    CHECK(fileSize(logPath) == logBytes);
+    REQUIRE(leaderboard.Open(path, 8));
+    CHECK(leaderboard.Players() == 706);
+    CHECK(leaderboard.Count() == 1001);
+    leaderboard.Close();
+#endif
+
+    remove(logPath.c_str());
+    remove(indexPath.c_str());
+}
+
+#include "src/rewindbuffer.hpp"
+
+TEST_CASE("Testing rewind buffer") {
+    // Состояние - 4 КБ, из которых шаг меняет счетчик тиков и несколько байтов по командам
+    std::vector<uint8_t> state(4096, 0);
+    auto step = [&state](const uint8_t *inputs) {
+        uint32_t tick;
+        memcpy(&tick, state.data(), 4);
+        for (int player = 0; player < 2; ++player) {
+            state[8 + (tick * 31 + inputs[player] * 7 + player) % (state.size() - 8)] += inputs[player] + 1;
+        }
+        // Иногда состояние меняет длину, как векторы лазеров в снимке игры
+        state.resize(tick % 50 == 49 ? 4096 + tick % 7 : state.size());
+        tick++;
+        memcpy(state.data(), &tick, 4);
+    };
+
+    RewindBuffer rewind(10, 8, 2);
+    rewind.saveState = [&state](std::vector<uint8_t> &bytes) { bytes = state; };
+    rewind.loadState = [&state](const std::vector<uint8_t> &bytes) {
+        state = bytes;
+        return true;
+    };
+    rewind.advance = step;
+    CHECK_FALSE(rewind.Rewind(0));
+
+    std::vector<std::vector<uint8_t>> history;
+    std::mt19937 random(5);
+    auto play = [&](int ticks) {
+        for (int i = 0; i < ticks; ++i) {
+            history.resize(rewind.Tick() + 1);
+            history[rewind.Tick()] = state;
+            uint8_t inputs[2] = {(uint8_t) (random() % 8), (uint8_t) (random() % 8)};
+            rewind.Record(inputs);
+            step(inputs);
+        }
+        history.resize(rewind.Tick() + 1);
+        history[rewind.Tick()] = state;
+    };
+    play(200);
+    CHECK(rewind.Snapshots() == 8);
+    // Последний снимок сохранен перед тиком 190
+    CHECK(rewind.OldestTick() == 120);
+    CHECK_FALSE(rewind.Rewind(119));
+    CHECK_FALSE(rewind.Rewind(201));
+    // Вместе с полными самым старым, самым новым и рабочими снимками память меньше 8 полных снимков
+    CHECK(rewind.Bytes() < 8 * 4096);
+
+    // Любой тик окна восстанавливается точно, не больше чем за interval - 1 повторенных тиков
+    for (long long tick: {199LL, 200LL, 150LL, 131LL, 133LL}) {
+        REQUIRE(rewind.Rewind(tick));
+        CHECK(rewind.Tick() == tick);
+        CHECK(rewind.LastResimulated() == tick % 10);
+        CHECK(state == history[tick]);
+        // После перемотки история продолжается с нового тика
+        play(3);
+    }
+    // Снимок тика 200 вытеснил снимок тика 120
+    CHECK(rewind.OldestTick() == 130);
+    CHECK(rewind.Tick() == 136);
+    play(100);
+    CHECK(rewind.Snapshots() == 8);
+    REQUIRE(rewind.Rewind(rewind.OldestTick()));
+    CHECK(state == history[rewind.Tick()]);
+
+    rewind.Clear();
+    CHECK(rewind.Snapshots() == 0);
+    CHECK(rewind.Tick() == 0);
+}
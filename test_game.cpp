@@ -0,0 +1,601 @@
+#include "external/doctest.h"
+
+#include "src/game.hpp"
+
+TEST_CASE("Testing game restart") {
+    Game game(true);
+    game.Seed(1);
+
+    // Первая игра: стрельба до окончания игры отодвигает время последнего выстрела
+    for (int tick = 0; tick < 120 && game.run; ++tick) {
+        game.ApplyInput(INPUT_FIRE);
+        game.Update();
+    }
+    game.GameOver();
+    REQUIRE_FALSE(game.run);
+
+    SUBCASE("Ship fires on the first tick of the next game") {
+        game.ApplyInput(INPUT_RESTART);
+        REQUIRE(game.run);
+        CHECK(game.simulationTime == 0.0);
+        CHECK(game.spaceship.lasers.empty());
+        game.ApplyInput(INPUT_FIRE);
+        CHECK(game.spaceship.lasers.size() == 1);
+    }
+
+    SUBCASE("Ship keeps its fire interval in the next game") {
+        game.ApplyInput(INPUT_RESTART);
+        int shots = 0;
+        for (int tick = 0; tick < 60; ++tick) {
+            size_t before = game.spaceship.lasers.size();
+            game.ApplyInput(INPUT_FIRE);
+            shots += (int) (game.spaceship.lasers.size() - before);
+            game.Update();
+        }
+        // Выстрел в тиках 0, 21, 42 (интервал 0.35 с)
+        CHECK(shots == 3);
+    }
+}
+
+#include "src/gamestream.hpp"
+
+TEST_CASE("Testing alien types in the stream viewer") {
+    Game game(true);
+    game.Seed(1);
+    for (const Alien &alien: game.aliens) {
+        CHECK(alien.type == Game::AlienTypeForRow(alien.row));
+    }
+
+    // Зритель восстанавливает формацию из маски живых инопланетян с теми же типами
+    game.RemoveAlien(0);
+    StreamState state;
+    CaptureStreamState(game, state);
+    Game viewer(true);
+    ApplyStreamState(state, viewer);
+    REQUIRE(viewer.aliens.size() == game.aliens.size());
+    int mismatches = 0;
+    for (const Alien &alien: game.aliens) {
+        bool found = false;
+        for (const Alien &shown: viewer.aliens) {
+            found |= shown.row == alien.row && shown.column == alien.column && shown.type == alien.type;
+        }
+        mismatches += !found;
+    }
+    CHECK(mismatches == 0);
+}
+
+#include "src/softwarerenderer.hpp"
+#include "src/platform.hpp"
+#include <cmath>
+#include <cstring>
+
+/**
+ * @brief Проверяет, что непрозрачные пиксели изображения нарисованы в кадре RGBA без изменений.
+ */
+static void CheckSpritePixels(const std::vector<unsigned char> &frame, int width, const char *fileName, float x,
+                              float y) {
+    Image image = LoadGameImage(fileName);
+    REQUIRE(image.data != nullptr);
+    const unsigned char *source = (const unsigned char *) image.data;
+    int left = (int) std::ceil(x - 0.5f);
+    int top = (int) std::ceil(y - 0.5f);
+    int opaque = 0;
+    int matched = 0;
+    for (int row = 0; row < image.height; ++row) {
+        for (int column = 0; column < image.width; ++column) {
+            const unsigned char *pixel = source + (row * image.width + column) * 4;
+            if (pixel[3] != 255) {
+                continue;
+            }
+            const unsigned char *drawn = frame.data() + ((size_t) (top + row) * width + left + column) * 4;
+            opaque++;
+            matched += memcmp(pixel, drawn, 3) == 0;
+        }
+    }
+    UnloadGameImage(image);
+    CHECK(opaque > 0);
+    CHECK(matched == opaque);
+}
+
+TEST_CASE("Testing software renderer") {
+    Game game(true);
+    game.Seed(1);
+    SoftwareRenderer renderer;
+    int width = renderer.Width();
+    int height = renderer.Height();
+    REQUIRE(width == ScreenWidth());
+    std::vector<unsigned char> rgba((size_t) width * height * 4);
+
+    SUBCASE("Sprites are copied at their positions") {
+        renderer.RenderRgba(game, rgba.data());
+        Rectangle ship = game.spaceship.getRect();
+        CheckSpritePixels(rgba, width, "../Graphics/spaceship.png", ship.x, ship.y);
+        REQUIRE_FALSE(game.aliens.empty());
+        const Alien &alien = game.aliens.back();
+        const char *alienImages[] = {"../Graphics/alien_1.png", "../Graphics/alien_2.png", "../Graphics/alien_3.png"};
+        CheckSpritePixels(rgba, width, alienImages[alien.type - 1], alien.position.x, alien.position.y);
+    }
+
+    SUBCASE("Erased shield cells show the background") {
+        REQUIRE_FALSE(game.obstacles.empty());
+        Obstacle &obstacle = game.obstacles[0];
+        Rectangle cell = obstacle.blocks[0].getRect();
+        size_t pixel = ((size_t) cell.y * width + (size_t) cell.x) * 4;
+        renderer.RenderRgba(game, rgba.data());
+        unsigned char yellow[3] = {243, 216, 63};
+        CHECK(memcmp(&rgba[pixel], yellow, 3) == 0);
+
+        // Клетка в 3 пикселя; прямоугольник внутри нее не задевает соседние клетки
+        size_t blocks = obstacle.blocks.size();
+        CHECK(obstacle.EraseBlocks({cell.x + 1, cell.y + 1, 1, 1}));
+        CHECK(obstacle.blocks.size() == blocks - 1);
+        renderer.RenderRgba(game, rgba.data());
+        unsigned char grey[3] = {29, 29, 27};
+        for (int y = 0; y < 3; ++y) {
+            for (int x = 0; x < 3; ++x) {
+                CHECK(memcmp(&rgba[pixel + ((size_t) y * width + x) * 4], grey, 3) == 0);
+            }
+        }
+    }
+
+    SUBCASE("Grayscale frame is averaged down and stacked") {
+        std::vector<unsigned char> full((size_t) width * height);
+        renderer.RenderGray(game, full.data(), width, height);
+
+        const int size = 84;
+        std::vector<unsigned char> small(size * size);
+        renderer.RenderGray(game, small.data(), size, size);
+        int mismatches = 0;
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                int x0 = x * width / size, x1 = (x + 1) * width / size;
+                int y0 = y * height / size, y1 = (y + 1) * height / size;
+                unsigned int sum = 0;
+                for (int row = y0; row < y1; ++row) {
+                    for (int column = x0; column < x1; ++column) {
+                        sum += full[(size_t) row * width + column];
+                    }
+                }
+                unsigned int area = (x1 - x0) * (y1 - y0);
+                mismatches += small[y * size + x] != (sum + area / 2) / area;
+            }
+        }
+        CHECK(mismatches == 0);
+
+        const int stackSize = 4;
+        std::vector<unsigned char> stack(stackSize * size * size);
+        for (int frame = 0; frame < stackSize; ++frame) {
+            memset(&stack[frame * size * size], frame + 1, size * size);
+        }
+        renderer.RenderGrayStack(game, stack.data(), size, size, stackSize);
+        for (int frame = 0; frame < stackSize - 1; ++frame) {
+            CHECK(stack[frame * size * size] == frame + 2);
+            CHECK(stack[(frame + 1) * size * size - 1] == frame + 2);
+        }
+        CHECK(memcmp(&stack[(stackSize - 1) * size * size], small.data(), size * size) == 0);
+    }
+}
+
+#include "src/observation.hpp"
+#include <algorithm>
+
+TEST_CASE("Testing observation layout") {
+    typedef ObservationLayout L;
+
+    SUBCASE("Layout of version 1 is fixed") {
+        // Любое изменение раскладки должно сопровождаться увеличением версии
+        CHECK(observationVersion == 1);
+        CHECK(L::ship == 0);
+        CHECK(L::formation == 2);
+        CHECK(L::aliveMask == 5);
+        CHECK(L::alienLasers == 60);
+        CHECK(L::playerLasers == 84);
+        CHECK(L::shieldDamage == 93);
+        CHECK(L::mysteryShip == 185);
+        CHECK(L::status == 188);
+        CHECK(L::size == 190);
+        CHECK(observationInt16Scale == 8192);
+    }
+
+    Game game(true);
+    game.Seed(1);
+    game.alienLasers.clear();
+    REQUIRE(game.aliens.size() == (size_t) (Game::alienRows * Game::alienColumns));
+    REQUIRE(game.obstacles.size() == (size_t) L::shieldCount);
+
+    // Убитый инопланетянин
+    int removedRow = game.aliens[13].row;
+    int removedColumn = game.aliens[13].column;
+    game.RemoveAlien(13);
+
+    // Лазеры инопланетян на разных расстояниях от центра корабля, в перемешанном порядке
+    Rectangle ship = game.spaceship.getRect();
+    float shipX = ship.x + ship.width / 2;
+    float shipY = ship.y + ship.height / 2;
+    const int laserCount = 10;
+    int distances[laserCount] = {70, 20, 90, 40, 10, 100, 60, 30, 80, 50};
+    for (int i = 0; i < laserCount; ++i) {
+        float dx = (i % 2 == 0 ? 1 : -1) * distances[i] * 0.6f;
+        float dy = -distances[i] * 0.8f;
+        game.alienLasers.push_back(Laser({shipX + dx - 2, shipY + dy - 15}, 6));
+    }
+
+    // Столбец 5 щита 2 разрушен полностью, в столбце 10 щита 3 выбит один блок
+    Obstacle &shield = game.obstacles[2];
+    int columnBlocks = shield.columnCounts[5];
+    CHECK(shield.EraseBlocks({shield.position.x + 5 * 3 + 1, shield.position.y, 1, 13 * 3}));
+    CHECK(shield.columnCounts[5] == 0);
+    Obstacle &damaged = game.obstacles[3];
+    int damagedBlocks = damaged.columnCounts[10];
+    CHECK(damaged.EraseBlocks({damaged.position.x + 10 * 3 + 1, damaged.position.y + 5 * 3 + 1, 1, 1}));
+
+    float features[L::size];
+    int16_t fixed[L::size];
+    FillObservation(game, features);
+    FillObservation(game, fixed);
+
+    SUBCASE("Alive mask") {
+        for (int row = 0; row < Game::alienRows; ++row) {
+            for (int column = 0; column < Game::alienColumns; ++column) {
+                float expected = row == removedRow && column == removedColumn ? 0 : 1;
+                CHECK(features[L::aliveMask + row * Game::alienColumns + column] == expected);
+            }
+        }
+    }
+
+    SUBCASE("Nearest alien lasers are sorted by distance") {
+        for (int i = 0; i < L::alienLaserCount; ++i) {
+            const float *slot = features + L::alienLasers + i * 3;
+            float distance = (i + 1) * 10;
+            CHECK(slot[2] == 1);
+            CHECK(std::fabs(slot[0]) * ScreenWidth() == doctest::Approx(distance * 0.6f).epsilon(1e-4));
+            CHECK(slot[1] * ScreenHeight() == doctest::Approx(-distance * 0.8f).epsilon(1e-4));
+        }
+    }
+
+    SUBCASE("Shield column damage") {
+        for (int i = 0; i < L::shieldCount; ++i) {
+            for (int column = 0; column < L::shieldColumns; ++column) {
+                float expected = 0;
+                if (i == 2 && column == 5) {
+                    expected = 1;
+                } else if (i == 3 && column == 10) {
+                    expected = 1.0f / damagedBlocks;
+                }
+                CHECK(features[L::shieldDamage + i * L::shieldColumns + column] == doctest::Approx(expected));
+            }
+        }
+        CHECK(columnBlocks > 0);
+    }
+
+    SUBCASE("Int16 features are the float features in Q13") {
+        int mismatches = 0;
+        for (int i = 0; i < L::size; ++i) {
+            float scaled = std::nearbyint(features[i] * observationInt16Scale);
+            scaled = std::min(std::max(scaled, (float) INT16_MIN), (float) INT16_MAX);
+            mismatches += fixed[i] != (int16_t) scaled;
+        }
+        CHECK(mismatches == 0);
+        CHECK(fixed[L::aliveMask] == observationInt16Scale);
+        CHECK(fixed[L::aliveMask + removedRow * Game::alienColumns + removedColumn] == 0);
+        CHECK(fixed[L::shieldDamage + 2 * L::shieldColumns + 5] == observationInt16Scale);
+        CHECK(fixed[L::alienLasers + 2] == observationInt16Scale);
+        CHECK(fixed[L::alienLasers + L::alienLaserCount * 3 - 1] == observationInt16Scale);
+    }
+}
+
+#include "src/invadersenv.h"
+
+/**
+ * @brief Делает шаги одной игры с выстрелом, пока она не закончится.
+ *
+ * @return Количество шагов или -1, если игра не закончилась за maxSteps шагов.
+ */
+static int StepUntilDone(InvadersEnv *env, float *observation, float &totalReward, float &lastScore, int maxSteps) {
+    totalReward = 0;
+    for (int step = 1; step <= maxSteps; ++step) {
+        lastScore = observation[ObservationLayout::status] * 10000;
+        float reward;
+        uint8_t done;
+        invaders_env_step(env, 0, INVADERS_ACTION_FIRE, observation, &reward, &done);
+        totalReward += reward;
+        if (done) {
+            return step;
+        }
+    }
+    return -1;
+}
+
+TEST_CASE("Testing environment C API") {
+    typedef ObservationLayout L;
+    CHECK(invaders_env_api_version() == INVADERS_ENV_API_VERSION);
+
+    SUBCASE("Invalid parameters are rejected") {
+        CHECK(invaders_env_create(0, INVADERS_OBS_FEATURES, 0, 0, 0, 0, 1) == nullptr);
+        CHECK(invaders_env_create(1, 7, 0, 0, 0, 0, 1) == nullptr);
+        CHECK(invaders_env_create(1, INVADERS_OBS_PIXELS, 84, 84, 0, 0, 1) == nullptr);
+    }
+
+    SUBCASE("Batched steps write each game's slot") {
+        InvadersEnv *env = invaders_env_create(3, INVADERS_OBS_FEATURES, 0, 0, 0, 1, 5);
+        REQUIRE(env != nullptr);
+        CHECK(invaders_env_num_envs(env) == 3);
+        REQUIRE(invaders_env_observation_size(env) == L::size);
+        std::vector<float> observations(3 * L::size, -1.0f);
+        invaders_env_reset_all(env, observations.data());
+        for (int i = 0; i < 3; ++i) {
+            CHECK(observations[i * L::size + L::ship + 1] == 1.0f);
+            CHECK(observations[i * L::size + L::status + 1] == 0.0f);
+        }
+
+        // Стреляет только вторая игра: ее лазер появляется в ее наблюдении
+        int32_t actions[3] = {0, INVADERS_ACTION_FIRE, INVADERS_ACTION_LEFT};
+        float rewards[3];
+        uint8_t dones[3];
+        invaders_env_step_all(env, actions, observations.data(), rewards, dones);
+        for (int i = 0; i < 3; ++i) {
+            CHECK(dones[i] == 0);
+            CHECK(rewards[i] == 0.0f);
+            CHECK(observations[i * L::size + L::playerLasers + 2] == (i == 1 ? 1.0f : 0.0f));
+        }
+        CHECK(observations[2 * L::size + L::ship] < observations[L::size + L::ship]);
+        invaders_env_destroy(env);
+    }
+
+    SUBCASE("Episode boundary with auto reset") {
+        InvadersEnv *env = invaders_env_create(1, INVADERS_OBS_FEATURES, 0, 0, 0, 1, 3);
+        REQUIRE(env != nullptr);
+        std::vector<float> observation(L::size);
+        invaders_env_reset(env, 0, 0, observation.data());
+
+        float totalReward, lastScore;
+        int steps = StepUntilDone(env, observation.data(), totalReward, lastScore, 100000);
+        REQUIRE(steps > 0);
+        // Награда - прирост счета: ее сумма за эпизод равна счету в конце эпизода
+        CHECK(totalReward > 0);
+        CHECK(totalReward >= doctest::Approx(lastScore));
+
+        // После окончания игры в буфере первое наблюдение новой игры
+        CHECK(observation[L::status] == 0.0f);
+        CHECK(observation[L::status + 1] == 0.0f);
+        CHECK(observation[L::ship + 1] == 1.0f);
+
+        // Корабль новой игры стреляет на первом тике
+        float reward;
+        uint8_t done;
+        invaders_env_step(env, 0, INVADERS_ACTION_FIRE, observation.data(), &reward, &done);
+        CHECK(done == 0);
+        CHECK(observation[L::playerLasers + 2] == 1.0f);
+        invaders_env_destroy(env);
+    }
+
+    SUBCASE("Episode boundary without auto reset") {
+        InvadersEnv *env = invaders_env_create(1, INVADERS_OBS_FEATURES, 0, 0, 0, 0, 3);
+        REQUIRE(env != nullptr);
+        std::vector<float> observation(L::size);
+        invaders_env_reset(env, 0, 0, observation.data());
+
+        float totalReward, lastScore;
+        REQUIRE(StepUntilDone(env, observation.data(), totalReward, lastScore, 100000) > 0);
+        CHECK(observation[L::status + 1] == 1.0f);
+        CHECK(observation[L::ship + 1] == 0.0f);
+
+        // Закончившаяся игра остается законченной до явного перезапуска
+        float reward;
+        uint8_t done;
+        invaders_env_step(env, 0, INVADERS_ACTION_FIRE, observation.data(), &reward, &done);
+        CHECK(done == 1);
+        CHECK(reward == 0.0f);
+        invaders_env_reset(env, 0, 0, observation.data());
+        CHECK(observation[L::status + 1] == 0.0f);
+        invaders_env_step(env, 0, INVADERS_ACTION_FIRE, observation.data(), &reward, &done);
+        CHECK(done == 0);
+        CHECK(observation[L::playerLasers + 2] == 1.0f);
+        invaders_env_destroy(env);
+    }
+
+    SUBCASE("Seed 0 is an ordinary seed at creation") {
+        // Две пары игр с seed = 0 проходят одинаково; без начального значения у игры 0 пары расходились бы
+        InvadersEnv *envs[2];
+        std::vector<float> observations[2];
+        for (int e = 0; e < 2; ++e) {
+            envs[e] = invaders_env_create(2, INVADERS_OBS_FEATURES, 0, 0, 0, 1, 0);
+            REQUIRE(envs[e] != nullptr);
+            observations[e].resize(2 * L::size);
+            invaders_env_reset_all(envs[e], observations[e].data());
+        }
+        int32_t actions[2] = {INVADERS_ACTION_FIRE, INVADERS_ACTION_FIRE};
+        float rewards[2];
+        uint8_t dones[2];
+        int mismatches = 0;
+        for (int tick = 0; tick < 600; ++tick) {
+            for (int e = 0; e < 2; ++e) {
+                invaders_env_step_all(envs[e], actions, observations[e].data(), rewards, dones);
+            }
+            mismatches += observations[0] != observations[1];
+        }
+        CHECK(mismatches == 0);
+        for (int e = 0; e < 2; ++e) {
+            invaders_env_destroy(envs[e]);
+        }
+    }
+
+    SUBCASE("Pixel observations start with a full stack") {
+        InvadersEnv *env = invaders_env_create(1, INVADERS_OBS_PIXELS, 84, 84, 4, 0, 3);
+        REQUIRE(env != nullptr);
+        REQUIRE(invaders_env_observation_size(env) == 84 * 84 * 4);
+        std::vector<uint8_t> frames(84 * 84 * 4);
+        invaders_env_reset(env, 0, 0, frames.data());
+        for (int i = 0; i < 3; ++i) {
+            CHECK(std::equal(frames.begin() + i * 84 * 84, frames.begin() + (i + 1) * 84 * 84,
+                             frames.begin() + 3 * 84 * 84));
+        }
+        invaders_env_destroy(env);
+    }
+}
+
+#include "src/gamesnapshot.hpp"
+
+/**
+ * @brief Возвращает детерминированную команду игрока для тика.
+ */
+static int ScriptedInput(int tick, int player) {
+    uint32_t value = (uint32_t) (tick / 7) * 2654435761u + player * 40503u;
+    return (value >> 13) % 8 | INPUT_RESTART;
+}
+
+/**
+ * @brief Продвигает совместную игру на тик и возвращает хеш ее снимка.
+ */
+static uint64_t StepAndHash(Game &game, int tick, GameSnapshot &scratch) {
+    game.ApplyInput(ScriptedInput(tick, 0), 0);
+    game.ApplyInput(ScriptedInput(tick, 1), 1);
+    game.Update();
+    SaveSnapshot(game, scratch);
+    return HashSnapshot(scratch);
+}
+
+TEST_CASE("Testing game snapshots") {
+    Game game(true);
+    game.Seed(11);
+    game.EnableCoop();
+    game.Reset();
+    game.InitGame();
+
+    // Загадочный корабль появляется через 10-20 с, поэтому проверка идет дольше 20 с после снимка
+    const int saveTick = 300;
+    const int ticks = saveTick + 1500;
+    GameSnapshot saved;
+    GameSnapshot scratch;
+    std::vector<uint64_t> hashes(ticks);
+    bool mysterySpawned = false;
+    int alienShots = 0;
+    for (int tick = 0; tick < ticks; ++tick) {
+        if (tick == saveTick) {
+            SaveSnapshot(game, saved);
+        }
+        size_t lasers = game.alienLasers.size();
+        hashes[tick] = StepAndHash(game, tick, scratch);
+        if (tick >= saveTick) {
+            mysterySpawned |= game.mysteryship.alive;
+            alienShots += game.alienLasers.size() > lasers;
+        }
+    }
+    // Снимок покрывает оба таймера: выстрелы инопланетян и появление загадочного корабля
+    REQUIRE(mysterySpawned);
+    REQUIRE(alienShots > 10);
+
+    SUBCASE("Restored game replays the same ticks") {
+        RestoreSnapshot(saved, game);
+        int mismatches = 0;
+        for (int tick = saveTick; tick < ticks; ++tick) {
+            mismatches += StepAndHash(game, tick, scratch) != hashes[tick];
+        }
+        CHECK(mismatches == 0);
+    }
+
+    SUBCASE("Snapshot bytes restore another game") {
+        std::vector<uint8_t> bytes;
+        WriteSnapshot(saved, bytes);
+        GameSnapshot read;
+        REQUIRE(ReadSnapshot(bytes, read));
+        CHECK(HashSnapshot(read) == HashSnapshot(saved));
+        CHECK_FALSE(ReadSnapshot(std::vector<uint8_t>(bytes.begin(), bytes.end() - 1), read));
+
+        Game other(true);
+        other.EnableCoop();
+        RestoreSnapshot(read, other);
+        int mismatches = 0;
+        for (int tick = saveTick; tick < ticks; ++tick) {
+            mismatches += StepAndHash(other, tick, scratch) != hashes[tick];
+        }
+        CHECK(mismatches == 0);
+    }
+
+    SUBCASE("Repeated rollbacks stay on the recorded timeline") {
+        // Как при откате сетевой игры: восстановление на несколько тиков назад посреди игры
+        RestoreSnapshot(saved, game);
+        GameSnapshot rollback;
+        int mismatches = 0;
+        for (int tick = saveTick; tick < ticks; ++tick) {
+            if (tick % 50 == 0) {
+                SaveSnapshot(game, rollback);
+                for (int i = 0; i < 7; ++i) {
+                    StepAndHash(game, tick + i, scratch);
+                }
+                RestoreSnapshot(rollback, game);
+            }
+            mismatches += StepAndHash(game, tick, scratch) != hashes[tick];
+        }
+        CHECK(mismatches == 0);
+    }
+}
+
+TEST_CASE("Testing thread count independence") {
+    // Нагрузочный режим: формация и лазеры больше шага разбиения, поэтому части тика идут параллельно
+    const int ticks = 600;
+    std::vector<uint64_t> hashes[2];
+    size_t peakLasers = 0;
+    for (int run = 0; run < 2; ++run) {
+        Game game(true);
+        game.Seed(17);
+        game.SetThreads(run == 0 ? 1 : 4);
+        game.EnableStress(2000, 4, 1, 32);
+        GameSnapshot scratch;
+        for (int tick = 0; tick < ticks; ++tick) {
+            game.lives = 1000;
+            game.ApplyInput(ScriptedInput(tick, 0));
+            game.Update();
+            if (!game.run) {
+                game.Reset();
+                game.InitGame();
+            }
+            peakLasers = std::max(peakLasers, game.alienLasers.size());
+            SaveSnapshot(game, scratch);
+            hashes[run].push_back(HashSnapshot(scratch));
+        }
+    }
+    CHECK(peakLasers > 256);
+    int mismatches = 0;
+    for (int tick = 0; tick < ticks; ++tick) {
+        mismatches += hashes[0][tick] != hashes[1][tick];
+    }
+    CHECK(mismatches == 0);
+}
+
+#include "src/assetpack.hpp"
+#include <cstdio>
+
+TEST_CASE("Testing packed asset parameters") {
+    // Пиксели изображения 2x2 и запись, чьи размеры не умещаются в ее данных
+    const char *path = "test_game_assets.pak";
+    std::vector<uint8_t> pixels(2 * 2 * 4, 200);
+    AssetPackWriter writer;
+    REQUIRE(writer.Add("Graphics/alien_1.png", ASSET_IMAGE, {2, 2, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8},
+                       pixels.data(), pixels.size()));
+    REQUIRE(writer.Add("Graphics/spaceship.png", ASSET_IMAGE, {1000, 1000, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8},
+                       pixels.data(), pixels.size()));
+    REQUIRE(writer.Write(path));
+    REQUIRE(MountAssetPack(path));
+
+    Image packed = LoadGameImage("../Graphics/alien_1.png");
+    CHECK(packed.width == 2);
+    CHECK(packed.height == 2);
+    CHECK(((const unsigned char *) packed.data)[0] == 200);
+    UnloadGameImage(packed);
+
+    // Несогласованная запись не читается, изображение загружается из файла
+    Image fallback = LoadGameImage("../Graphics/spaceship.png");
+    REQUIRE(fallback.data != nullptr);
+    CHECK(fallback.width != 1000);
+    Image file = LoadImage("../Graphics/spaceship.png");
+    CHECK(fallback.width == file.width);
+    CHECK(fallback.height == file.height);
+    UnloadImage(file);
+    UnloadGameImage(fallback);
+    Texture2D texture = LoadGameTexture("../Graphics/spaceship.png");
+    CHECK(texture.width == fallback.width);
+
+    CHECK_FALSE(MountAssetPack("missing.pak"));
+    remove(path);
+}